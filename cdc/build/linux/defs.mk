@@ -37,6 +37,17 @@ ifeq ($(LINUX_ENABLE_SET_AFFINITY), true)
 CVM_DEFINES += -DLINUX_ENABLE_SET_AFFINITY
 endif
 
+# Map zip files on the class path read-only instead of reading them
+# through a file descriptor. Entry reads need no lock, stored class
+# files are parsed in place, and mTASK children share the mappings.
+# A jar that is truncated while mapped will raise SIGBUS on access.
+CVM_ZIP_USE_MMAP ?= false
+CVM_FLAGS	+= CVM_ZIP_USE_MMAP
+CVM_ZIP_USE_MMAP_CLEANUP_ACTION = $(CVM_DEFAULT_CLEANUP_ACTION)
+ifeq ($(CVM_ZIP_USE_MMAP), true)
+CVM_DEFINES += -DCVM_ZIP_USE_MMAP
+endif
+
 CVM_TARGETROOT	= $(CVM_TOP)/src/$(TARGET_OS)
 
 #
@@ -357,6 +357,12 @@ CVM_JIT_DEBUG           ?= false
 # mTASK
 CVM_MTASK                ?= false
 
+# Application class archive (-XclassArchive)
+CVM_CLASS_ARCHIVE        ?= false
+
+# Persistent GC stackmap cache (-Xgc:stackmapCache)
+CVM_STACKMAP_CACHE       ?= false
+
 # AOT
 CVM_AOT			?= false
 
@@ -375,6 +381,7 @@ endif
 
 ifneq ($(CVM_CLASSLOADING), true)
         override CVM_PRELOAD_LIB = true
+        override CVM_CLASS_ARCHIVE = false
 endif
 
 ifdef CVM_ALLOW_UNRESOLVED
@@ -746,6 +753,12 @@ endif
 ifeq ($(CVM_SPLIT_VERIFY), true)
 	CVM_DEFINES   += -DCVM_SPLIT_VERIFY
 endif
+ifeq ($(CVM_CLASS_ARCHIVE), true)
+	CVM_DEFINES   += -DCVM_CLASS_ARCHIVE
+endif
+ifeq ($(CVM_STACKMAP_CACHE), true)
+	CVM_DEFINES   += -DCVM_STACKMAP_CACHE
+endif
 ifeq ($(CVM_JIT_REGISTER_LOCALS), true)
 	CVM_DEFINES   += -DCVM_JIT_REGISTER_LOCALS
 endif
@@ -923,6 +936,8 @@ CVM_FLAGS += \
 	USE_CDC_COM \
 	CVM_DUAL_STACK \
 	CVM_SPLIT_VERIFY \
+	CVM_CLASS_ARCHIVE \
+	CVM_STACKMAP_CACHE \
 	CVM_KNI \
 	CVM_JIT_REGISTER_LOCALS \
 	CVM_INTERPRETER_LOOP \
@@ -1094,6 +1109,8 @@ USE_GCI_CLEANUP_ACTION         = \
         $(CVM_JAVAC_DEBUG_CLEANUP_ACTION)
 CVM_DUAL_STACK_CLEANUP_ACTION          = $(CVM_DEFAULT_CLEANUP_ACTION)
 CVM_SPLIT_VERIFY_CLEANUP_ACTION        = $(CVM_DEFAULT_CLEANUP_ACTION)
+CVM_CLASS_ARCHIVE_CLEANUP_ACTION       = $(CVM_DEFAULT_CLEANUP_ACTION)
+CVM_STACKMAP_CACHE_CLEANUP_ACTION      = $(CVM_DEFAULT_CLEANUP_ACTION)
 CVM_KNI_CLEANUP_ACTION                 = $(CVM_DEFAULT_CLEANUP_ACTION)
 CVM_JIT_REGISTER_LOCALS_CLEANUP_ACTION = $(CVM_JIT_CLEANUP_ACTION)
 CVM_JIT_COLLECT_STATS_CLEANUP_ACTION   = $(CVM_JIT_CLEANUP_ACTION)
@@ -1257,6 +1274,24 @@ ifeq ($(CVM_SPLIT_VERIFY), true)
 	split_verify.o
 endif
 
+#
+# Object needed for the application class archive
+#
+ifeq ($(CVM_CLASS_ARCHIVE), true)
+    CVM_SHAREOBJS_SPACE += \
+	classarchive.o
+    CVM_TEST_CLASSES += \
+	ClassArchiveTest
+endif
+
+#
+# Object needed for the stackmap cache
+#
+ifeq ($(CVM_STACKMAP_CACHE), true)
+    CVM_SHAREOBJS_SPACE += \
+	stackmapcache.o
+endif
+
 #
 # Stuff needed for KNI support
 #
@@ -540,7 +540,8 @@ CVM_POLICY_SRC  ?= $(CVM_TOP)/src/share/lib/security/java.policy
 # (native support does nothing if JIT unsupported)
 #
 CVM_BUILDTIME_CLASSES += \
-    sun.misc.JIT
+    sun.misc.JIT \
+    sun.misc.JIT$$CompilerThread
 
 #
 # Classes to be loaded at runtime.
@@ -77,6 +77,20 @@ ifeq ($(CVM_JIT_COPY_CCMCODE_TO_CODECACHE), true)
 CVM_DEFINES     += -DCVM_JIT_COPY_CCMCODE_TO_CODECACHE
 endif
 
+# Use the SSE2 versions of the String intrinsics in ccmintrinsics_share.c.
+# Requires a Pentium 4 or later.
+CVM_JIT_USE_SSE2 ?= false
+
+CVM_FLAGS += \
+        CVM_JIT_USE_SSE2
+
+CVM_JIT_USE_SSE2_CLEANUP_ACTION = $(CVM_DEFAULT_CLEANUP_ACTION)
+
+ifeq ($(CVM_JIT_USE_SSE2), true)
+CVM_DEFINES     += -DCVM_JIT_USE_SSE2
+CC_ARCH_FLAGS   += -msse2
+endif
+
 # irparser files generated by jcs
 CVM_TARGETOBJS_SPACE += \
         jitcodegen.o \
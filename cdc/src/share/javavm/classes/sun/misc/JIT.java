@@ -44,4 +44,37 @@ public class JIT {
     public static native boolean neverCompileMethod(Member m);
 
     public static native boolean reparseJitOptions(String optionString);
+
+    //
+    // Background compilation (-Xjit:asyncCompile)
+    //
+
+    // Compiles the methods queued by the interpreter until the calling
+    // thread is interrupted. Returns false if the thread should exit.
+    private static native boolean compileQueuedMethods();
+
+    private static class CompilerThread extends Thread {
+        private CompilerThread(ThreadGroup tg) {
+            super(tg, "JIT Compiler");
+        }
+
+        public void run() {
+            while (!ThreadRegistry.exitRequested()) {
+                if (!compileQueuedMethods()) {
+                    break;
+                }
+            }
+        }
+    }
+
+    // Called by the VM during startup if -Xjit:asyncCompile is set.
+    static void startCompilerThread() {
+        ThreadGroup tg = Thread.currentThread().getThreadGroup();
+        for (ThreadGroup tgn = tg;
+             tgn != null;
+             tg = tgn, tgn = tg.getParent());
+        Thread t = new CompilerThread(tg);
+        t.setDaemon(true);
+        t.start();
+    }
 }
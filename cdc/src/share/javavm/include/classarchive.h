@@ -0,0 +1,132 @@
+/*
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ *
+ */
+
+#ifndef _INCLUDED_CLASSARCHIVE_H
+#define _INCLUDED_CLASSARCHIVE_H
+
+#ifdef CVM_CLASS_ARCHIVE
+
+#include "javavm/include/defs.h"
+#include "javavm/include/classes.h"
+
+/*
+ * The application class archive holds the class files that were loaded
+ * from the application class path in an earlier run of the VM. A VM
+ * started with -XclassArchiveDump=<file> appends every class it finds
+ * on the class path to <file>. A VM started with -XclassArchive=<file>
+ * maps <file> and serves class files straight out of the mapping,
+ * without searching the class path, opening files or inflating zip
+ * entries. The mapped pages are shared by all VMs that use the archive
+ * and, with mTASK, by every process forked from the server.
+ *
+ * Only the jar files at the start of the class path, up to the first
+ * directory, are archived: the files in a directory can change without
+ * notice. The archive records these jar files with a fingerprint of
+ * the CRCs and sizes of their entries. It is only used if they are a
+ * prefix of the current class path and their fingerprints still match.
+ *
+ * The archive file layout (all words are CVMUint32 in native byte
+ * order, every item is padded to a multiple of 4 bytes):
+ *
+ *     magic, version, numPathEntries
+ *     numPathEntries * { type, fingerprint, pathLength, path }
+ *     records until end of file:
+ *         { nameLength, dataLength, pathIndex, name, data }
+ */
+
+#define CVM_CLASS_ARCHIVE_MAGIC	    0xCAFEC1A5
+#define CVM_CLASS_ARCHIVE_VERSION   2
+
+typedef struct CVMClassArchiveEntry CVMClassArchiveEntry;
+struct CVMClassArchiveEntry {
+    const char*      name;	  /* class name, '/' separated */
+    const CVMUint8*  classData;
+    CVMUint32        classSize;
+    CVMUint32        pathIndex;	  /* index into the app class path */
+    CVMUint32        hash;
+    CVMInt32         next;	  /* next entry in bucket, or -1 */
+};
+
+typedef struct CVMClassArchive {
+    char*                  fileName;
+    CVMBool                dump;	/* -XclassArchiveDump */
+    CVMBool                active;	/* usable for lookup or dump */
+    CVMUint32              numPathEntries; /* archived path entries */
+
+    /* Used by -XclassArchive */
+    CVMUint8*              base;
+    CVMUint32              size;
+    CVMBool                mapped;
+    CVMClassArchiveEntry*  entries;
+    CVMUint32              numEntries;
+    CVMInt32*              buckets;
+    CVMUint32              numBuckets;
+
+    /* Used by -XclassArchiveDump, under CVMglobals.classArchiveLock */
+    CVMInt32               fd;
+} CVMClassArchive;
+
+/*
+ * Remembers the archive file and mode given on the command line.
+ */
+extern CVMBool
+CVMclassArchiveInit(const char* fileName, CVMBool dump);
+
+/*
+ * Maps and validates the archive, or writes the archive header in dump
+ * mode. Called once the application class path has been set up. Any
+ * failure is reported and leaves the archive unused.
+ */
+extern void
+CVMclassArchiveOpen(CVMClassPath* path);
+
+/*
+ * Looks up the class file of 'classname' (e.g. "java/lang/Object") in
+ * the archive. Returns CVM_TRUE and the class file bytes and the index
+ * of the class path entry they came from if found. The bytes stay valid
+ * until the VM exits and must not be freed.
+ */
+extern CVMBool
+CVMclassArchiveFind(const char* classname, const CVMUint8** classData,
+		    CVMUint32* classSize, CVMUint32* pathIndex);
+
+/*
+ * Appends a class file found on the application class path to the
+ * archive in dump mode. Does nothing otherwise.
+ */
+extern void
+CVMclassArchiveAdd(CVMExecEnv* ee, const char* classname,
+		   const CVMUint8* classData, CVMUint32 classSize,
+		   CVMUint32 pathIndex);
+
+/*
+ * Unmaps or closes the archive on VM exit.
+ */
+extern void
+CVMclassArchiveDestroy();
+
+#endif /* CVM_CLASS_ARCHIVE */
+
+#endif /* _INCLUDED_CLASSARCHIVE_H */
@@ -1602,6 +1602,67 @@ CVMclassLookupByTypeFromClassLoader(CVMExecEnv* ee, CVMClassTypeID typeID,
 				    CVMObjectICell* pd,
 				    CVMBool throwError);
 
+#ifdef CVM_CLASSLOADING
+/*
+ * Classes being loaded by the NULL classloader each get a placeholder
+ * instead of being loaded under a single global lock, so that threads
+ * loading different classes don't wait for each other. A thread that
+ * wants to load a class another thread is loading waits until the
+ * placeholder is released. The owner may enter its own placeholder
+ * again. The list of placeholders is protected by the
+ * classPlaceholderLock.
+ */
+struct CVMClassPlaceholder {
+    CVMClassTypeID        typeID;
+    CVMExecEnv*           owner;
+    CVMUint32             depth;	/* times entered by the owner */
+    CVMUint32             waiters;
+    CVMClassPlaceholder*  next;
+};
+
+typedef struct {
+    CVMUint32  entered;		/* placeholders created */
+    CVMUint32  reentered;	/* entered again by the owner */
+    CVMUint32  contended;	/* had to wait for another thread */
+    CVMUint32  circularities;	/* waits that would have deadlocked */
+    CVMUint32  blocked;		/* waited for a class redefinition */
+    CVMUint32  maxActive;	/* most placeholders at the same time */
+    CVMUint32  maxWaiters;	/* most threads waiting for one class */
+    CVMInt64   waitMillis;	/* total time spent waiting */
+} CVMClassPlaceholderStats;
+
+/*
+ * Enters the placeholder of class 'typeID' for the NULL classloader,
+ * waiting while another thread owns it. Returns CVM_FALSE with an
+ * exception thrown on failure, which includes a ClassCircularityError
+ * if the wait would deadlock. Must be called GC safe.
+ */
+extern CVMBool
+CVMclassPlaceholderEnter(CVMExecEnv* ee, CVMClassTypeID typeID);
+
+extern void
+CVMclassPlaceholderExit(CVMExecEnv* ee, CVMClassTypeID typeID);
+
+/*
+ * Keeps other threads from loading classes with the NULL classloader
+ * while classes are being redefined. CVMclassPlaceholdersBlock() waits
+ * until no other thread owns a placeholder. Threads that start loading
+ * a class wait until CVMclassPlaceholdersUnblock(). Must be called GC
+ * safe and without holding the nullClassLoaderLock.
+ */
+extern void
+CVMclassPlaceholdersBlock(CVMExecEnv* ee);
+
+extern void
+CVMclassPlaceholdersUnblock(CVMExecEnv* ee);
+
+/*
+ * Traces the placeholder contention statistics on VM exit.
+ */
+extern void
+CVMclassPlaceholderDumpStats();
+#endif
+
 /*
  * Get an array class with elements of type elemCb, but only if it
  * is already created.
@@ -1954,9 +2015,15 @@ CVMloaderCacheIterateGetCB(CVMExecEnv* ee, CVMLoaderCacheIterator *iter);
     CVMsysMutexLock(ee, &CVMglobals.nullClassLoaderLock)
 #define CVM_NULL_CLASSLOADER_UNLOCK(ee) \
     CVMsysMutexUnlock(ee, &CVMglobals.nullClassLoaderLock)
+#define CVM_PACKAGES_LOCK(ee)   \
+    CVMsysMutexLock(ee, &CVMglobals.packagesLock)
+#define CVM_PACKAGES_UNLOCK(ee) \
+    CVMsysMutexUnlock(ee, &CVMglobals.packagesLock)
 #else
 #define CVM_NULL_CLASSLOADER_LOCK(ee)
 #define CVM_NULL_CLASSLOADER_UNLOCK(ee)
+#define CVM_PACKAGES_LOCK(ee)
+#define CVM_PACKAGES_UNLOCK(ee)
 #endif
 
 /*
@@ -2026,6 +2093,32 @@ CVMclassClassPathDestroy(CVMExecEnv* ee);
 JNIEXPORT jobject JNICALL
 CVMclassFindContainer(JNIEnv *env, jobject tthis, jstring name);
 
+/*
+ * Class path element, which is either a directory or zip file.
+ */
+
+typedef enum {
+    CVM_CPE_DIR, CVM_CPE_ZIP, CVM_CPE_INVALID
+} CVMClassPathEntryType;
+
+struct CVMClassPathEntry {
+    CVMClassPathEntryType type;
+    struct jzfile *zip;
+    char *path;
+    /* The cached CodeSource object of this path component */
+    CVMObjectICell* codeSource;
+    /* The cached protection domain of this path component */
+    CVMObjectICell* protectionDomain;   
+    /* The cached URL object of this path component */
+    CVMObjectICell* url;   
+    /* The cached JarFile object of this path component */
+    CVMObjectICell* jfile;
+    /* The class path entry is a signed jar file */
+    CVMBool isSigned;
+    /* Has the Java side of this been initialized */
+    CVMBool javaInitialized;
+};
+
 typedef struct {
     CVMClassPathEntry*   entries;
     CVMUint16            numEntries;
@@ -197,6 +197,7 @@ CVM_STRUCT_TYPEDEF(CVMLoaderCacheEntry);
 CVM_STRUCT_TYPEDEF(CVMLoaderConstraint);
 CVM_STRUCT_TYPEDEF(CVMSeenClass);
 CVM_STRUCT_TYPEDEF(CVMClassPathEntry);
+CVM_STRUCT_TYPEDEF(CVMClassPlaceholder);
 #endif
 
 /*
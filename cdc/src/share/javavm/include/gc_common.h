@@ -85,9 +85,15 @@ struct CVMGCCommonGlobalState {
     CVMStackMaps *firstStackMaps;
     CVMStackMaps *lastStackMaps;
     CVMUint32 stackMapsTotalMemoryUsed;
+    CVMUint32 stackMapsComputed;
 };
 
+#ifdef CVM_STACKMAP_CACHE
+#define CVM_GC_SHARED_OPTIONS "[maxStackMapsMemorySize=<size>][,stat=true]"\
+			      "[,stackmapCache=<file>]"
+#else
 #define CVM_GC_SHARED_OPTIONS "[maxStackMapsMemorySize=<size>][,stat=true]"
+#endif
 #ifdef CVM_GCIMPL_GC_OPTIONS
 #define CVM_GC_OPTIONS "[-Xgc:"\
 			CVM_GC_SHARED_OPTIONS\
@@ -40,6 +40,13 @@ void CVMgcstatStartGCMeasurement(void);
  */
 void CVMgcstatEndGCMeasurement(void);
 
+/*
+ * Start and end measurement of the stackmap computation that precedes
+ * the current GC invocation.
+ */
+void CVMgcstatStartStackmapMeasurement(void);
+void CVMgcstatEndStackmapMeasurement(void);
+
 /*
  * Set the flag indicating whether to do the GC measurement or not.
  * If the flag is set to false, the other two functions won't do anything.
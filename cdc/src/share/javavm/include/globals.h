@@ -36,6 +36,12 @@
 #include "javavm/include/cstates.h"
 #include "javavm/include/jni_impl.h"
 #include "javavm/include/packages.h"
+#ifdef CVM_CLASS_ARCHIVE
+#include "javavm/include/classarchive.h"
+#endif
+#ifdef CVM_STACKMAP_CACHE
+#include "javavm/include/stackmapcache.h"
+#endif
 #include "javavm/include/utils.h"
 #include "javavm/include/jvmtiExport.h"
 #include "javavm/include/jvmpi_impl.h"
@@ -100,6 +106,10 @@ struct CVMOptions {
 #ifdef CVM_SPLIT_VERIFY
     CVMBool splitVerify;
 #endif
+#ifdef CVM_CLASS_ARCHIVE
+    const char *classArchiveStr;
+    CVMBool classArchiveDump;
+#endif
 #endif
 #ifdef CVM_HAVE_PROCESS_MODEL
     CVMBool fullShutdownFlag;
@@ -259,6 +269,19 @@ struct CVMGlobalState {
 
 #ifdef CVM_CLASSLOADING
     CVMSysMutex nullClassLoaderLock; /* The NULL classloader lock */
+
+    /*
+     * Placeholders of the classes the NULL classloader is loading.
+     * See CVMclassPlaceholderEnter().
+     */
+    CVMSysMutex          classPlaceholderLock;
+    CVMCondVar           classPlaceholderCV;
+    CVMClassPlaceholder* classPlaceholders;
+    CVMUint32            numClassPlaceholders;
+    CVMUint32            classPlaceholderBlockers; /* redefining threads */
+    CVMClassPlaceholderStats classPlaceholderStats;
+
+    CVMSysMutex packagesLock;	/* The system packages table lock */
 #endif
     
 #ifdef CVM_JVMTI
@@ -306,6 +329,8 @@ struct CVMGlobalState {
      */
     CVMJITGlobalState jit;
     CVMSysMutex       jitLock;
+    CVMSysMutex       jitCompileQueueLock;
+    CVMCondVar        jitCompileQueueCV;
 #ifdef CVM_CCM_COLLECT_STATS
     CVMCCMGlobalStats ccmStats;
 #endif /* CVM_CCM_COLLECT_STATS */
@@ -436,6 +461,14 @@ struct CVMGlobalState {
 
     CVMClassPath         bootClassPath;
     CVMClassPath         appClassPath;
+#ifdef CVM_CLASS_ARCHIVE
+    CVMClassArchive      classArchive;
+    CVMSysMutex          classArchiveLock;
+#endif
+#ifdef CVM_STACKMAP_CACHE
+    CVMStackmapCache     stackmapCache;
+    CVMSysMutex          stackmapCacheLock;
+#endif
     
     CVMUint16            classVerificationLevel;
 #ifdef CVM_SPLIT_VERIFY
@@ -495,6 +528,7 @@ struct CVMGlobalState {
      * all access to it.
      */
     CVMSysMutex typeidLock; /* protect table insertion */
+    CVMSysMutex typeidMemberNameLock; /* same, for the member name table */
     CVMUint32	typeIDscalarSegmentSize;
     CVMUint32	typeIDmethodTypeSegmentSize;
     CVMUint32	typeIDmemberNameSegmentSize;
@@ -633,6 +667,10 @@ struct CVMGlobalState {
     CVMInt64 totalGCTime;
     CVMInt64 startGCTime;
     CVMInt64 initFreeMemory;
+    CVMInt64 stackmapTime;
+    CVMInt64 totalStackmapTime;
+    CVMInt64 startStackmapTime;
+    CVMUint32 stackMapsComputedInPause;
 
 #ifndef CDC_10
     /* java assertion related globals */
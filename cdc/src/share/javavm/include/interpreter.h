@@ -281,6 +281,11 @@ struct CVMExecEnv {
     CVMObjMonitor *objLocksPinned[CVM_PINNED_OBJMON_COUNT];
     CVMSize objLocksPinnedCount;
 
+#ifdef CVM_CLASSLOADING
+    /* The class placeholder this thread waits for, if any */
+    CVMClassPlaceholder* classPlaceholderWait;
+#endif
+
 #ifdef CVM_TRACE
     CVMUint32 traceDepth;
 #endif
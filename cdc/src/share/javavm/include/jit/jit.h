@@ -60,6 +60,29 @@ typedef enum CVMJITReturnValue {
 extern CVMJITReturnValue
 CVMJITcompileMethod(CVMExecEnv *ee, CVMMethodBlock* mb);
 
+/*
+ * Called by the interpreter when mb crosses the compilation threshold.
+ * Queues mb for the compiler thread if there is one, otherwise compiles
+ * it right away.
+ */
+extern void
+CVMJITrequestCompile(CVMExecEnv *ee, CVMMethodBlock* mb);
+
+/*
+ * Body of the compiler thread. Returns CVM_FALSE when the thread is
+ * interrupted or stopped, after which requests are compiled
+ * synchronously again.
+ */
+extern CVMBool
+CVMJITserveCompileQueue(CVMExecEnv *ee);
+
+/*
+ * Drops queued compilation requests for the methods of cb.
+ * The caller must hold the jitLock.
+ */
+extern void
+CVMJITcompileQueueRemoveClass(CVMExecEnv *ee, CVMClassBlock* cb);
+
 extern void
 CVMJITdecompileMethod(CVMExecEnv* ee, CVMMethodBlock* mb);
 
@@ -38,6 +38,7 @@ CVM_STRUCT_TYPEDEF(CVMJITCompilationContext);
 CVM_STRUCT_TYPEDEF(CVMJITTargetCompilationContext);
 CVM_STRUCT_TYPEDEF(CVMJITLoop);
 CVM_STRUCT_TYPEDEF(CVMJITNestedLoop);
+CVM_STRUCT_TYPEDEF(CVMJITCountedLoop);
 CVM_STRUCT_TYPEDEF(CVMJITIRNode);
 CVM_STRUCT_TYPEDEF(CVMJITIRRange);
 CVM_STRUCT_TYPEDEF(CVMJITIRBlock);
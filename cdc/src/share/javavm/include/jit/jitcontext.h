@@ -119,6 +119,13 @@ struct CVMJITMethodContext {
      */
     CVMBool                  removeNullChecksOfLocal_0;
 
+    /*
+     * Counted loops whose array accesses need no null or bounds
+     * checks. See CVMJITirblockFindCountedLoops().
+     */
+    CVMJITCountedLoop*       countedLoops;
+    CVMUint32                numCountedLoops;
+
     /*
      * Used to abort the translation of a block when a conditional
      * branch is converted into a goto.
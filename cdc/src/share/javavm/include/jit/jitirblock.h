@@ -314,6 +314,23 @@ struct CVMJITJsrRetEntry {
 #define CVMJITirblockIsPCInBlockRange(bk, codeLength, pc) \
     (pc <= CVMJITirblockMaxPC(bk, codeLength))
 
+/*
+ * A counted loop of the form javac generates for
+ *
+ *     for (i = c; i < a.length; i++) { ... }  where c >= 0
+ *
+ * in which neither 'i' nor 'a' is assigned in the loop body. Every
+ * a[i] in the body is known to be in bounds and 'a' to be non-null, so
+ * no null or bounds check is needed for it. See
+ * CVMJITirblockFindCountedLoops() for the exact bytecode pattern.
+ */
+struct CVMJITCountedLoop {
+    CVMUint16 bodyPC;     /* Loop body (target of the back branch) */
+    CVMUint16 iincPC;     /* 'iinc i, 1' at the end of the body */
+    CVMUint16 indexLocal; /* 'i' */
+    CVMUint16 arrayLocal; /* 'a' */
+};
+
 extern CVMJITIRBlock*
 CVMJITirblockCreate(CVMJITCompilationContext* con, CVMUint16 pc);
 
@@ -341,6 +358,9 @@ CVMJITirblockFindAllExceptionLabels(CVMJITCompilationContext* con);
 extern void
 CVMJITirblockFindAllNormalLabels(CVMJITCompilationContext* con);
 
+extern void
+CVMJITirblockFindCountedLoops(CVMJITCompilationContext* con);
+
 extern void
 CVMJITirblockAtHandlerEntry(CVMJITCompilationContext* con, 
     CVMJITIRBlock* bk);
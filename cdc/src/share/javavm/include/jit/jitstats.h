@@ -69,6 +69,7 @@ enum CVMJITStatsTag {
     CVMJIT_STATS_NULL_CHECKS_ELIMINATED,       /* Number of eliminated nulls */
     CVMJIT_STATS_NUMBER_OF_BOUNDS_CHECK_NODES, /* Number of gen bound checks */
     CVMJIT_STATS_BOUNDS_CHECKS_ELIMINATED,     /* Number of gen bound checks */
+    CVMJIT_STATS_LOOP_BOUNDS_CHECKS_ELIMINATED, /* Covered by loop test */
     CVMJIT_STATS_NUMBER_OF_INVOKE_NODES,
     CVMJIT_STATS_NUMBER_OF_RESOLVE_NODES,
     CVMJIT_STATS_NUMBER_OF_CHECKINIT_NODES,
@@ -215,6 +216,12 @@ struct CVMJITGlobalStats
 
     /* List of per compilation stats records: */
     CVMJITStats *perCompilationStats;
+
+    /* Background compilation queue stats (see CVMJITrequestCompile()): */
+    CVMUint32  numberOfQueuedCompilations;
+    CVMUint32  maxCompileQueueLength;
+    CVMUint32  totalCompileQueueLatency;    /* in milliseconds */
+    CVMUint32  maxCompileQueueLatency;      /* in milliseconds */
 };
 
 extern const char* CVMJITstatsNames[]; /* The names of these categories */
@@ -295,6 +302,18 @@ extern void
 CVMJITstatsAddConstant(CVMJITCompilationContext *con, CVMInt32 value,
                        const char *category, CVMUint32 refCount);
 
+/*
+ * Record the length of the compilation queue after a method was added.
+ */
+extern void
+CVMJITstatsRecordCompileQueueLength(CVMUint32 length);
+
+/*
+ * Record how long a method waited on the compilation queue.
+ */
+extern void
+CVMJITstatsRecordCompileQueueLatency(CVMInt32 latency);
+
 /*
  * Dump current stats
  */
@@ -334,6 +353,8 @@ CVMJITstatsDumpGlobalStats();
 #define CVMJITstatsUpdateStats(con)
 #define CVMJITstatsAddConstant(con, value, category, refCount)
 #define CVMJITstatsDump(con)
+#define CVMJITstatsRecordCompileQueueLength(length)
+#define CVMJITstatsRecordCompileQueueLatency(latency)
 #define CVMJITstatsInitGlobalStats(jgs)      (CVM_TRUE)
 #define CVMJITstatsDestroyGlobalStats(jgs)
 #define CVMJITstatsDumpGlobalStats()
@@ -357,6 +357,20 @@ typedef struct CVMCCMCodeCacheCopyEntry {
 #define CVM_VHINT_MASK                  (CVM_MAX_INVOKE_VIRTUAL_HINTS - 1)
 #define CVM_IHINT_MASK                  (CVM_MAX_INVOKE_INTERFACE_HINTS - 1)
 
+/*
+ * Background compilation queue. When -Xjit:asyncCompile is set, methods
+ * that cross the compilation threshold in the interpreter are put on
+ * this queue and compiled by the "JIT Compiler" daemon thread instead of
+ * by the thread that invoked them. See CVMJITrequestCompile().
+ */
+#define CVMJIT_COMPILE_QUEUE_SIZE       32
+
+typedef struct {
+    CVMMethodBlock* mb;
+    CVMUint32 priority;     /* invocation cost accumulated while queued */
+    CVMInt64  enqueueTime;  /* CVMtimeMillis() when the mb was queued */
+} CVMJITCompileQueueEntry;
+
 /*********************************************************************
  * CVMJITGlobalState - where all the jit globals go.
  *********************************************************************/
@@ -370,6 +384,7 @@ typedef struct {
     CVMInt32 compileThreshold;
     CVMJITWhenToCompileOption whenToCompile;
     CVMUint32 whatToInline;
+    CVMBool  asyncCompile;
     CVMBool  registerPhis;
 #ifdef CVM_JIT_REGISTER_LOCALS
     CVMBool  registerLocals;
@@ -408,6 +423,11 @@ typedef struct {
     CVMBool     csNeedDisable;  /* true if CVMcsResumeConsistentState needs
 				   to disable gc checkpoints */
 
+    /* the background compilation queue, protected by jitCompileQueueLock */
+    CVMBool     compileQueueActive; /* true while the compiler thread runs */
+    CVMUint32   compileQueueLength;
+    CVMJITCompileQueueEntry compileQueue[CVMJIT_COMPILE_QUEUE_SIZE];
+
     /* the code cache */
     CVMUint8*      codeCacheStart;  /* start of allocated code cache */
     CVMUint8*      codeCacheEnd;    /* end of allocated code cache */
@@ -131,6 +131,17 @@ void *CVMmemCommit(void *addr, size_t requestedSize, size_t *committedSize);
 void *CVMmemDecommit(void *addr, size_t requestedSize,
 		     size_t *decommittedSize);
 
+/* Purpose: Maps the first size bytes of the file open on fd read-only.
+            The mapping stays valid after fd is closed, and the pages
+	    are shared with other processes that map the same file.
+   Returns: The starting address of the mapping if successful.
+            Else, NULL is returned.
+*/
+void *CVMmemMapFile(CVMInt32 fd, size_t size);
+
+/* Purpose: Relinquishes a mapping returned by CVMmemMapFile(). */
+void CVMmemUnmapFile(void *addr, size_t size);
+
 #endif /* CVM_USE_MMAP_APIS */
 
 /* The platform may choose to provide implementations for the following by
@@ -350,6 +350,8 @@ extern CVMAddr * const CVM_staticData;
 extern CVMUint32 CVM_nStaticData;
 extern CVMAddr CVM_StaticDataMaster[];
 extern const int CVM_nROMClasses;
+/* Hash of the romized code, see CVMWriter.fingerprintCode() */
+extern const CVMUint32 CVM_ROMImageFingerprint;
 #if defined(CVM_JIT) && defined(CVM_MTASK)
 extern const int CVM_nROMMethods;
 /* Pointer to the invokeCost array for romized methods. */
@@ -0,0 +1,153 @@
+/*
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ *
+ */
+
+#ifndef _INCLUDED_STACKMAPCACHE_H
+#define _INCLUDED_STACKMAPCACHE_H
+
+#ifdef CVM_STACKMAP_CACHE
+
+#include "javavm/include/defs.h"
+#include "javavm/include/classes.h"
+
+/*
+ * The stackmap cache keeps the GC stackmaps of interpreted methods
+ * across VM instances. A VM started with -Xgc:stackmapCache=<file>
+ * reads the stackmaps computed by earlier runs from <file>, uses them
+ * instead of running the stackmap computer, and writes any stackmaps
+ * it had to compute itself back to <file> on exit. This takes the
+ * stackmap computation out of the first GCs after startup, which
+ * otherwise have to compute maps for every method on the stacks.
+ *
+ * Stackmaps of romized methods are keyed by class typeid and method
+ * index, and are only used if the file was written by a VM with the
+ * same ROM image (see CVM_ROMImageFingerprint). Stackmaps of
+ * dynamically loaded methods are keyed by class name, method index,
+ * and the size and hash of the class file the class was created from.
+ *
+ * The file layout (all words are CVMUint32 in native byte order,
+ * every item is padded to a multiple of 4 bytes):
+ *
+ *     magic, version, config, romFingerprint
+ *     records until end of file:
+ *         { flags, classKey, classSize, methodIndex,
+ *           nameLength, mapsSize, name, maps }
+ *
+ * 'maps' is the CVMStackMaps image with its internal pointers made
+ * relative to its start (see CVMstackmapRebase).
+ */
+
+#define CVM_STACKMAP_CACHE_MAGIC	0xCAFE5AA5
+#define CVM_STACKMAP_CACHE_VERSION	1
+
+typedef struct CVMStackmapCacheRecord CVMStackmapCacheRecord;
+
+/*
+ * Class file hash of a dynamically loaded class. The class name follows
+ * the entry as a NUL terminated string.
+ */
+typedef struct CVMStackmapCacheClass CVMStackmapCacheClass;
+struct CVMStackmapCacheClass {
+    CVMClassBlock*          cb;
+    CVMUint32               classHash;
+    CVMUint32               classSize;
+    CVMStackmapCacheClass*  next;
+};
+
+typedef struct CVMStackmapCache {
+    char*                    fileName;
+    CVMBool                  active;
+    CVMBool                  dirty;	/* has records not in the file */
+
+    /* File contents, which the records read from it point into */
+    CVMUint8*                fileData;
+
+    CVMStackmapCacheRecord** buckets;
+    CVMUint32                numBuckets;
+    CVMUint32                numRecords;
+
+    CVMStackmapCacheClass**  classBuckets;
+    CVMUint32                numClassBuckets;
+
+    /* Statistics */
+    CVMUint32                hits;
+    CVMUint32                misses;
+} CVMStackmapCache;
+
+/*
+ * Reads the cache file given with -Xgc:stackmapCache. A missing or
+ * unusable file just leaves the cache empty. Returns CVM_FALSE if out
+ * of memory.
+ */
+extern CVMBool
+CVMstackmapCacheInit(const char* fileName);
+
+/*
+ * Remembers the hash of the class file a dynamically loaded class was
+ * created from. Stackmaps of classes that were not recorded here are
+ * not cached.
+ */
+extern void
+CVMstackmapCacheClassCreated(CVMExecEnv* ee, CVMClassBlock* cb,
+			     const CVMUint8* classData, CVMUint32 classSize);
+
+/*
+ * Forgets a class that is being freed.
+ */
+extern void
+CVMstackmapCacheClassFreed(CVMExecEnv* ee, CVMClassBlock* cb);
+
+/*
+ * Returns a fresh copy of the cached stackmaps for 'mb', or NULL if
+ * there are none. The caller owns the copy and must add it to the
+ * global stackmaps list. Called with the heapLock held.
+ */
+extern CVMStackMaps*
+CVMstackmapCacheLookup(CVMExecEnv* ee, CVMMethodBlock* mb,
+		       CVMBool doConditionalGcPoints);
+
+/*
+ * Adds stackmaps that were just computed for 'mb' to the cache.
+ * Called with the heapLock held.
+ */
+extern void
+CVMstackmapCacheAdd(CVMExecEnv* ee, CVMMethodBlock* mb,
+		    CVMBool doConditionalGcPoints, CVMStackMaps* maps);
+
+/*
+ * Writes the cache file if stackmaps were added since it was read.
+ * Called when the VM is about to exit.
+ */
+extern void
+CVMstackmapCacheWrite(CVMExecEnv* ee);
+
+/*
+ * Frees the cache on VM shutdown.
+ */
+extern void
+CVMstackmapCacheDestroy();
+
+#endif /* CVM_STACKMAP_CACHE */
+
+#endif /* _INCLUDED_STACKMAPCACHE_H */
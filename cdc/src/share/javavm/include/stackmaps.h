@@ -89,6 +89,17 @@ extern CVMInt32
 CVMstackmapReverseMapPC(CVMJavaMethodDescriptor *jmd, int newOffset);
 #endif
 
+#ifdef CVM_STACKMAP_CACHE
+/*
+ * Relocates the internal pointers of a stackmaps image from base
+ * address 'from' to 'to', checking the image against 'mb'. Returns
+ * CVM_FALSE if the image does not fit the method.
+ */
+extern CVMBool
+CVMstackmapRebase(CVMStackMaps* maps, CVMMethodBlock* mb,
+		  CVMAddr from, CVMAddr to);
+#endif
+
 /*
  * Initialization and destruction routines
  */
@@ -86,6 +86,10 @@ struct java_lang_String_compressed {
  *
  * load is the current number of occupied slots.
  *
+ * live is the number of occupied slots that have not been deleted.
+ *   The GC uses it to skip empty segments and to stop scanning a
+ *   segment once all of its live slots have been visited.
+ *
  * maxLoad is:
  *  the maximum number of slots we want occupied: currently
  *	about 65% of the capacity for reasonably re-hash
@@ -104,6 +108,7 @@ struct java_lang_String_compressed {
  * 	CVMUint32	capacity;
  * 	CVMUint32	load;
  * 	CVMUint32	maxLoad;
+ * 	CVMUint32	live;
  * 	CVMStringICell	data[capacity];
  * 	CVMUint8	refCount[capacity];
  *	struct CVMInternSegment * next;
@@ -118,7 +123,8 @@ struct java_lang_String_compressed {
 	struct CVMInternSegment ** nextp; \
 	CVMUint32	capacity; \
 	CVMUint32	load; \
-	CVMUint32	maxLoad;
+	CVMUint32	maxLoad; \
+	CVMUint32	live;
 
 typedef struct CVMInternSegment {
     CVM_INTERN_SEGMENT_HEADER
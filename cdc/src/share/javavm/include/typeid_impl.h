@@ -205,7 +205,11 @@ extern struct scalarTableSegment CVMFieldTypeTable;
  */
 
 
-#define NCLASSHASH	11
+/* 
+ * IMPORTANT:
+ * When you change NCLASSHASH also change it in CVMpkg in jcc.
+ */
+#define NCLASSHASH	31
 #define NPACKAGEHASH	17
 
 struct pkg {
@@ -250,7 +250,9 @@ class CVMInternSegment {
 	out.print(capacity);
 	out.print(", ");
 	out.print(content);
-	out.println(", 1, {");
+	out.print(", 1, ");
+	out.print(content);
+	out.println(", {");
 
 	//
 	// write the String reference array.
@@ -107,6 +107,10 @@ public class CVMWriter implements CoreImageWriter, Const, CVMConst {
     private String			sharedConstantPoolName;
     private int				sharedConstantPoolSize;
 
+    // Hash of the romized code, which the VM uses to tell whether
+    // data it saved about ROM methods (stackmaps) is still valid.
+    private int				romImageFingerprint = 0x811c9dc5;
+
     private CVMMethodType[]		methodTypes;
     private int[]			nMethodTypes;
     private int				totalMethodTypes;
@@ -410,6 +414,32 @@ public class CVMWriter implements CoreImageWriter, Const, CVMConst {
 	return u.toUTF();
     }
 
+    private void fingerprint( int value ){
+	romImageFingerprint = (romImageFingerprint ^ value) * 0x01000193;
+    }
+
+    /*
+     * Adds everything the stackmaps of a method depend on to the
+     * ROM image fingerprint.
+     */
+    private void fingerprintCode( MethodInfo mi ){
+	fingerprint( mi.qualifiedName().hashCode() );
+	fingerprint( getUTF( mi.type ).hashCode() );
+	fingerprint( mi.stack );
+	fingerprint( mi.locals );
+	for ( int i = 0; i < mi.code.length; i++ ){
+	    fingerprint( mi.code[i] & 0xff );
+	}
+	if ( mi.exceptionTable != null ){
+	    for ( int i = 0; i < mi.exceptionTable.length; i++ ){
+		ExceptionEntry e = mi.exceptionTable[i];
+		fingerprint( e.startPC );
+		fingerprint( e.endPC );
+		fingerprint( e.handlerPC );
+	    }
+	}
+    }
+
     /*
      * For Java methods,
      * write out the structure which will be initialized with a
@@ -434,6 +464,8 @@ public class CVMWriter implements CoreImageWriter, Const, CVMConst {
 
 	boolean impureCode = noPureCode || !meth.isCodePure();
 
+	fingerprintCode( mi );
+
 	classOut.println("\n/* Code block for "+meth.method.qualifiedName()+" */");
 
 
@@ -3287,6 +3319,8 @@ public class CVMWriter implements CoreImageWriter, Const, CVMConst {
 		    "STATIC_STORE_ADDRESS(" + clRefOff + ");");
 		auxOut.println("const int CVMROMNumClassLoaders = " +
 		    components.ClassTable.getNumClassLoaders() + ";");
+		auxOut.println("const CVMUint32 CVM_ROMImageFingerprint = 0x" +
+		    Integer.toHexString(romImageFingerprint) + ";");
 	    }
 	} catch ( java.io.IOException e ){
 	    failureMode = e;
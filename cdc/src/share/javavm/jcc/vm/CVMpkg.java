@@ -36,7 +36,11 @@ public class CVMpkg {
     public CVMDataType typeData[];
     public int	        entryNo;
 
-    public final static int NCLASSHASH = 11;
+    /* 
+     * When you change this, also change the constant NCLASSHASH
+     * in typeid_impl.h 
+     */
+    public final static int NCLASSHASH = 31;
     public final static int NPACKAGEHASH = 17;
 
     public static Vector pkgVector = new Vector(); // must come before nullPackage!
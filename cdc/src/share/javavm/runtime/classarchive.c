@@ -0,0 +1,536 @@
+/*
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ *
+ */
+
+/*
+ * The application class archive. See classarchive.h for the file format.
+ */
+
+#ifdef CVM_CLASS_ARCHIVE
+
+#include "javavm/include/classarchive.h"
+#include "javavm/include/classes.h"
+#include "javavm/include/globals.h"
+#include "javavm/include/utils.h"
+#include "javavm/include/porting/io.h"
+#include "javavm/include/porting/doubleword.h"
+#include "javavm/include/porting/memory.h"
+#include "javavm/include/porting/ansi/string.h"
+#include "javavm/include/porting/ansi/stdlib.h"
+#include "native/java/util/zip/zip_util.h"
+
+#define CVM_ARCHIVE_ALIGN(n)	(((n) + 3) & ~3)
+
+static CVMUint32
+archiveHash(const char* s)
+{
+    CVMUint32 h = 0;
+    while (*s != '\0') {
+	h = 31 * h + (CVMUint8)*s++;
+    }
+    return h;
+}
+
+/* Invalid class path entries have no path */
+static const char*
+pathEntryPath(CVMClassPathEntry* entry)
+{
+    return (entry->path != NULL) ? entry->path : "";
+}
+
+/*
+ * Computes the fingerprint of a jar file on the class path from the
+ * CRC, sizes and name hash of every entry, as read from its central
+ * directory when the class path was opened. Any change to a class in
+ * the jar changes the fingerprint, even if the jar keeps its size.
+ * Returns CVM_FALSE for entries that cannot be archived: directories,
+ * whose files could change unnoticed, and unreadable entries.
+ */
+static CVMBool
+pathEntryFingerprint(CVMClassPathEntry* entry, CVMUint32* fingerprint)
+{
+    jzfile* zip = entry->zip;
+    CVMUint32 h;
+    jint i;
+
+    if (entry->type != CVM_CPE_ZIP || zip == NULL) {
+	return CVM_FALSE;
+    }
+    h = (CVMUint32)zip->total;
+    for (i = 0; i < zip->total; i++) {
+	jzcell* cell = &zip->entries[i];
+	h = 31 * h + cell->hash;
+	h = 31 * h + (CVMUint32)cell->crc;
+	h = 31 * h + (CVMUint32)cell->size;
+	h = 31 * h + (CVMUint32)cell->csize;
+    }
+    *fingerprint = h;
+    return CVM_TRUE;
+}
+
+/*
+ * Returns the number of entries at the start of the class path that
+ * can be archived. Classes found after the first entry that cannot be
+ * archived are not archived either, so that the archive never hides a
+ * class file in a directory that comes earlier on the class path.
+ */
+static CVMUint32
+archivablePathEntries(CVMClassPath* path)
+{
+    CVMUint32 i;
+    CVMUint32 fingerprint;
+
+    for (i = 0; i < path->numEntries; i++) {
+	if (!pathEntryFingerprint(&path->entries[i], &fingerprint)) {
+	    break;
+	}
+    }
+    return i;
+}
+
+static void
+archiveDisable(const char* reason)
+{
+    CVMClassArchive* archive = &CVMglobals.classArchive;
+    CVMconsolePrintf("Class archive %s not used: %s\n",
+		     archive->fileName, reason);
+    archive->active = CVM_FALSE;
+}
+
+/*
+ * Reads the next word of the archive at *offset. Returns CVM_FALSE if
+ * the archive ends before it.
+ */
+static CVMBool
+readWord(CVMClassArchive* archive, CVMUint32* offset, CVMUint32* word)
+{
+    if (*offset > archive->size || archive->size - *offset < 4) {
+	return CVM_FALSE;
+    }
+    *word = *(CVMUint32*)(archive->base + *offset);
+    *offset += 4;
+    return CVM_TRUE;
+}
+
+/*
+ * Maps the archive file, or reads it in if the platform cannot map
+ * files.
+ */
+static CVMBool
+archiveMap(CVMClassArchive* archive)
+{
+    CVMInt32 fd;
+    CVMInt64 size64;
+    CVMUint32 total;
+    CVMBool success = CVM_FALSE;
+
+    fd = CVMioOpen(archive->fileName, O_RDONLY, 0);
+    if (fd < 0) {
+	return CVM_FALSE;
+    }
+    if (CVMioFileSizeFD(fd, &size64) != 0) {
+	goto done;
+    }
+    archive->size = (CVMUint32)CVMlong2Int(size64);
+    if (archive->size == 0) {
+	goto done;
+    }
+#if CVM_USE_MMAP_APIS
+    archive->base = (CVMUint8*)CVMmemMapFile(fd, archive->size);
+    if (archive->base != NULL) {
+	archive->mapped = CVM_TRUE;
+	success = CVM_TRUE;
+	goto done;
+    }
+#endif
+    archive->base = (CVMUint8*)malloc(archive->size);
+    if (archive->base == NULL) {
+	goto done;
+    }
+    /* read() may return less than asked for */
+    total = 0;
+    while (total < archive->size) {
+	CVMInt32 n = CVMioRead(fd, archive->base + total,
+			       archive->size - total);
+	if (n < 0) {
+	    total = 0;
+	    break;
+	}
+	if (n == 0) {
+	    /* The file got shorter, a partial last record is ignored */
+	    break;
+	}
+	total += n;
+    }
+    if (total == 0) {
+	free(archive->base);
+	archive->base = NULL;
+	goto done;
+    }
+    archive->size = total;
+    success = CVM_TRUE;
+ done:
+    CVMioClose(fd);
+    return success;
+}
+
+/*
+ * Checks that the class path entries recorded in the archive header
+ * are a prefix of 'path'. Returns the offset of the first record, or 0
+ * if the archive cannot be used.
+ */
+static CVMUint32
+archiveCheckHeader(CVMClassArchive* archive, CVMClassPath* path)
+{
+    CVMUint32 offset = 0;
+    CVMUint32 magic, version, numPathEntries, i;
+
+    if (!readWord(archive, &offset, &magic) ||
+	!readWord(archive, &offset, &version) ||
+	!readWord(archive, &offset, &numPathEntries)) {
+	archiveDisable("truncated header");
+	return 0;
+    }
+    if (magic != CVM_CLASS_ARCHIVE_MAGIC ||
+	version != CVM_CLASS_ARCHIVE_VERSION) {
+	archiveDisable("bad magic or version");
+	return 0;
+    }
+    if (numPathEntries > path->numEntries) {
+	archiveDisable("class path has changed");
+	return 0;
+    }
+    for (i = 0; i < numPathEntries; i++) {
+	CVMClassPathEntry* entry = &path->entries[i];
+	CVMUint32 type, fingerprint, current, pathLength;
+	const char* entryPath;
+
+	if (!readWord(archive, &offset, &type) ||
+	    !readWord(archive, &offset, &fingerprint) ||
+	    !readWord(archive, &offset, &pathLength) ||
+	    archive->size - offset < CVM_ARCHIVE_ALIGN(pathLength)) {
+	    archiveDisable("truncated header");
+	    return 0;
+	}
+	entryPath = (const char*)(archive->base + offset);
+	offset += CVM_ARCHIVE_ALIGN(pathLength);
+	if (type != (CVMUint32)entry->type ||
+	    strlen(pathEntryPath(entry)) != pathLength ||
+	    strncmp(pathEntryPath(entry), entryPath, pathLength) != 0) {
+	    archiveDisable("class path has changed");
+	    return 0;
+	}
+	if (!pathEntryFingerprint(entry, &current) ||
+	    fingerprint != current) {
+	    archiveDisable("a jar file on the class path has changed");
+	    return 0;
+	}
+    }
+    archive->numPathEntries = numPathEntries;
+    return offset;
+}
+
+/*
+ * Builds the lookup table over the class records that follow the header.
+ * A record cut short at the end of the file, e.g. by a dumping VM that
+ * exited while writing, is ignored.
+ */
+static CVMBool
+archiveBuildTable(CVMClassArchive* archive, CVMUint32 offset,
+		  CVMUint32 numPathEntries)
+{
+    CVMUint32 start = offset;
+    CVMUint32 count = 0;
+    CVMUint32 i;
+
+    /* Count the complete records */
+    for (;;) {
+	CVMUint32 nameLength, dataLength, pathIndex;
+	if (!readWord(archive, &offset, &nameLength) ||
+	    !readWord(archive, &offset, &dataLength) ||
+	    !readWord(archive, &offset, &pathIndex)) {
+	    break;
+	}
+	if (nameLength >= archive->size || dataLength >= archive->size ||
+	    archive->size - offset < CVM_ARCHIVE_ALIGN(nameLength + 1) +
+	                             CVM_ARCHIVE_ALIGN(dataLength) ||
+	    pathIndex >= numPathEntries ||
+	    archive->base[offset + nameLength] != '\0') {
+	    break;
+	}
+	offset += CVM_ARCHIVE_ALIGN(nameLength + 1) +
+	          CVM_ARCHIVE_ALIGN(dataLength);
+	count++;
+    }
+    if (count == 0) {
+	archiveDisable("no classes");
+	return CVM_FALSE;
+    }
+
+    archive->numBuckets = count | 1;
+    archive->entries = (CVMClassArchiveEntry*)
+	malloc(count * sizeof(CVMClassArchiveEntry));
+    archive->buckets = (CVMInt32*)
+	malloc(archive->numBuckets * sizeof(CVMInt32));
+    if (archive->entries == NULL || archive->buckets == NULL) {
+	archiveDisable("out of memory");
+	return CVM_FALSE;
+    }
+    for (i = 0; i < archive->numBuckets; i++) {
+	archive->buckets[i] = -1;
+    }
+
+    /* Now enter them. The first record of a class wins. */
+    offset = start;
+    for (i = 0; i < count; i++) {
+	CVMClassArchiveEntry* entry = &archive->entries[archive->numEntries];
+	CVMUint32 nameLength, dataLength, bucket;
+	const CVMUint8* classData;
+	CVMInt32 idx;
+
+	readWord(archive, &offset, &nameLength);
+	readWord(archive, &offset, &dataLength);
+	readWord(archive, &offset, &entry->pathIndex);
+	/* The name is NUL terminated in the archive */
+	entry->name = (const char*)(archive->base + offset);
+	offset += CVM_ARCHIVE_ALIGN(nameLength + 1);
+	classData = archive->base + offset;
+	offset += CVM_ARCHIVE_ALIGN(dataLength);
+
+	entry->classData = classData;
+	entry->classSize = dataLength;
+	entry->hash = archiveHash(entry->name);
+	bucket = entry->hash % archive->numBuckets;
+	for (idx = archive->buckets[bucket]; idx != -1;
+	     idx = archive->entries[idx].next) {
+	    if (archive->entries[idx].hash == entry->hash &&
+		strcmp(archive->entries[idx].name, entry->name) == 0) {
+		break;
+	    }
+	}
+	if (idx == -1) {
+	    entry->next = archive->buckets[bucket];
+	    archive->buckets[bucket] = archive->numEntries++;
+	}
+    }
+    return CVM_TRUE;
+}
+
+/*
+ * Writes len bytes followed by padding to the dump file.
+ */
+static CVMBool
+writePadded(CVMInt32 fd, const void* buf, CVMUint32 len)
+{
+    static const CVMUint8 zeros[4] = {0, 0, 0, 0};
+    CVMUint32 pad = CVM_ARCHIVE_ALIGN(len) - len;
+    return CVMioWrite(fd, buf, len) == (CVMInt32)len &&
+	(pad == 0 || CVMioWrite(fd, zeros, pad) == (CVMInt32)pad);
+}
+
+static CVMBool
+archiveWriteHeader(CVMClassArchive* archive, CVMClassPath* path)
+{
+    CVMUint32 header[3];
+    CVMUint32 i;
+
+    header[0] = CVM_CLASS_ARCHIVE_MAGIC;
+    header[1] = CVM_CLASS_ARCHIVE_VERSION;
+    header[2] = archive->numPathEntries;
+    if (!writePadded(archive->fd, header, sizeof(header))) {
+	return CVM_FALSE;
+    }
+    for (i = 0; i < archive->numPathEntries; i++) {
+	CVMClassPathEntry* entry = &path->entries[i];
+	const char* entryPath = pathEntryPath(entry);
+	CVMUint32 words[3];
+
+	words[0] = (CVMUint32)entry->type;
+	pathEntryFingerprint(entry, &words[1]);
+	words[2] = (CVMUint32)strlen(entryPath);
+	if (!writePadded(archive->fd, words, sizeof(words)) ||
+	    !writePadded(archive->fd, entryPath, words[2])) {
+	    return CVM_FALSE;
+	}
+    }
+    return CVM_TRUE;
+}
+
+CVMBool
+CVMclassArchiveInit(const char* fileName, CVMBool dump)
+{
+    CVMClassArchive* archive = &CVMglobals.classArchive;
+
+    archive->fd = -1;
+    if (fileName == NULL) {
+	return CVM_TRUE;
+    }
+    archive->fileName = strdup(fileName);
+    if (archive->fileName == NULL) {
+	return CVM_FALSE;
+    }
+    archive->dump = dump;
+    return CVM_TRUE;
+}
+
+void
+CVMclassArchiveOpen(CVMClassPath* path)
+{
+    CVMClassArchive* archive = &CVMglobals.classArchive;
+    CVMUint32 offset;
+
+    if (archive->fileName == NULL || archive->active) {
+	return;
+    }
+    archive->active = CVM_TRUE;
+
+    if (archive->dump) {
+	archive->numPathEntries = archivablePathEntries(path);
+	if (archive->numPathEntries == 0) {
+	    archiveDisable("the class path does not start with a jar file");
+	    return;
+	}
+	archive->fd = CVMioOpen(archive->fileName,
+				O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (archive->fd < 0) {
+	    archiveDisable("cannot create file");
+	    return;
+	}
+	if (!archiveWriteHeader(archive, path)) {
+	    archiveDisable("write error");
+	    CVMioClose(archive->fd);
+	    archive->fd = -1;
+	}
+	return;
+    }
+
+    if (!archiveMap(archive)) {
+	archiveDisable("cannot read file");
+	return;
+    }
+    offset = archiveCheckHeader(archive, path);
+    if (offset == 0) {
+	return;
+    }
+    /* numPathEntries is the third word of the header */
+    archiveBuildTable(archive, offset, ((CVMUint32*)archive->base)[2]);
+}
+
+CVMBool
+CVMclassArchiveFind(const char* classname, const CVMUint8** classData,
+		    CVMUint32* classSize, CVMUint32* pathIndex)
+{
+    CVMClassArchive* archive = &CVMglobals.classArchive;
+    CVMUint32 hash;
+    CVMInt32 idx;
+
+    if (!archive->active || archive->dump) {
+	return CVM_FALSE;
+    }
+    hash = archiveHash(classname);
+    for (idx = archive->buckets[hash % archive->numBuckets]; idx != -1;
+	 idx = archive->entries[idx].next) {
+	CVMClassArchiveEntry* entry = &archive->entries[idx];
+	if (entry->hash == hash && strcmp(entry->name, classname) == 0) {
+	    *classData = entry->classData;
+	    *classSize = entry->classSize;
+	    *pathIndex = entry->pathIndex;
+	    return CVM_TRUE;
+	}
+    }
+    return CVM_FALSE;
+}
+
+void
+CVMclassArchiveAdd(CVMExecEnv* ee, const char* classname,
+		   const CVMUint8* classData, CVMUint32 classSize,
+		   CVMUint32 pathIndex)
+{
+    CVMClassArchive* archive = &CVMglobals.classArchive;
+    CVMUint32 words[3];
+    CVMBool success;
+
+    if (!archive->active || !archive->dump ||
+	pathIndex >= archive->numPathEntries) {
+	return;
+    }
+    words[0] = (CVMUint32)strlen(classname);
+    words[1] = classSize;
+    words[2] = pathIndex;
+
+    CVMsysMutexLock(ee, &CVMglobals.classArchiveLock);
+    if (archive->fd < 0) {
+	CVMsysMutexUnlock(ee, &CVMglobals.classArchiveLock);
+	return;
+    }
+    /* Write the name with its NUL so lookups can use it in place */
+    success = writePadded(archive->fd, words, sizeof(words)) &&
+	writePadded(archive->fd, classname, words[0] + 1) &&
+	writePadded(archive->fd, classData, classSize);
+    if (!success) {
+	/* A partial record is dropped when the archive is read */
+	CVMconsolePrintf("Class archive %s: write error, dump stopped\n",
+			 archive->fileName);
+	CVMioClose(archive->fd);
+	archive->fd = -1;
+    }
+    CVMsysMutexUnlock(ee, &CVMglobals.classArchiveLock);
+}
+
+void
+CVMclassArchiveDestroy()
+{
+    CVMClassArchive* archive = &CVMglobals.classArchive;
+
+    if (archive->fd >= 0) {
+	CVMioClose(archive->fd);
+	archive->fd = -1;
+    }
+    if (archive->base != NULL) {
+#if CVM_USE_MMAP_APIS
+	if (archive->mapped) {
+	    CVMmemUnmapFile(archive->base, archive->size);
+	} else
+#endif
+	{
+	    free(archive->base);
+	}
+	archive->base = NULL;
+    }
+    if (archive->entries != NULL) {
+	free(archive->entries);
+	archive->entries = NULL;
+    }
+    if (archive->buckets != NULL) {
+	free(archive->buckets);
+	archive->buckets = NULL;
+    }
+    if (archive->fileName != NULL) {
+	free(archive->fileName);
+	archive->fileName = NULL;
+    }
+    archive->active = CVM_FALSE;
+}
+
+#endif /* CVM_CLASS_ARCHIVE */
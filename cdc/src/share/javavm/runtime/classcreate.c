@@ -410,7 +410,11 @@ CVMclassCreateArrayClass(CVMExecEnv* ee, CVMClassTypeID arrayTypeId,
     if (arrayLoader != loader) {
 	/* Need to lock the arrayLoader too */
 	if (arrayLoader == NULL) {
-	    CVM_NULL_CLASSLOADER_LOCK(ee);
+#ifdef CVM_CLASSLOADING
+	    if (!CVMclassPlaceholderEnter(ee, arrayTypeId)) {
+		return NULL; /* exception already thrown */
+	    }
+#endif
 	} else {
 	    if (!CVMgcSafeObjectLock(ee, arrayLoader)) {
 		CVMthrowOutOfMemoryError(ee, NULL);
@@ -609,7 +613,9 @@ CVMclassCreateArrayClass(CVMExecEnv* ee, CVMClassTypeID arrayTypeId,
     if (arrayLoader != loader) {
 	/* Need to unlock the arrayLoader */
 	if (arrayLoader == NULL) {
-	    CVM_NULL_CLASSLOADER_UNLOCK(ee);
+#ifdef CVM_CLASSLOADING
+	    CVMclassPlaceholderExit(ee, arrayTypeId);
+#endif
 	} else {
 	    CVMBool success = CVMgcSafeObjectUnlock(ee, arrayLoader);
 	    CVMassert(success); (void) success;
@@ -1530,10 +1536,14 @@ CVMclassCreateInternalClass(CVMExecEnv* ee,
 
     /* Add package information */
     if (dirNameOrZipFileName != NULL) {
+	CVMBool added = CVM_TRUE;
+	CVM_PACKAGES_LOCK(ee);
 	if (CVMpackagesGetEntry(classname) == NULL) {
-	    if (!CVMpackagesAddEntry(classname, dirNameOrZipFileName)) {
-		CVMoutOfMemoryHandler(ee, context);
-	    }
+	    added = CVMpackagesAddEntry(classname, dirNameOrZipFileName);
+	}
+	CVM_PACKAGES_UNLOCK(ee);
+	if (!added) {
+	    CVMoutOfMemoryHandler(ee, context);
 	}
     }
 
@@ -1574,6 +1584,9 @@ CVMclassCreateInternalClass(CVMExecEnv* ee,
      * have jumped to (via a goto) doCleanup below:
      */
 
+#ifdef CVM_STACKMAP_CACHE
+    CVMstackmapCacheClassCreated(ee, cb, buffer, bufferLength);
+#endif
     CVMtraceClassLoading(("CL: Created cb=0x%x for class %s\n",
 			  cb, classname));
 #ifdef CVM_JVMPI
@@ -2612,6 +2625,10 @@ CVMclassFree(CVMExecEnv* ee, CVMClassBlock* cb)
 	free((char*)(gcMap & ~CVM_GCMAP_LONGGCMAP_FLAG));
     }
 
+#ifdef CVM_STACKMAP_CACHE
+    CVMstackmapCacheClassFreed(ee, cb);
+#endif
+
     /* Free the Class global root. */
     CVMassert(CVMID_icellIsNull(CVMcbJavaInstance(cb)));
     CVMID_freeClassGlobalRoot(ee, CVMcbJavaInstance(cb));
@@ -3348,6 +3365,14 @@ CVMclassFreeCompiledMethods(CVMExecEnv* ee, CVMClassBlock* cb)
 {
     int i;
     CVMJITGlobalState* jgs = &CVMglobals.jit;
+
+    /* Make sure the compiler thread won't pick up any of the methods. */
+    if (ee != NULL) {
+	CVMsysMutexLock(ee, &CVMglobals.jitLock);
+	CVMJITcompileQueueRemoveClass(ee, cb);
+	CVMsysMutexUnlock(ee, &CVMglobals.jitLock);
+    }
+
     for (i = 0; i < CVMcbMethodCount(cb); i++) {
 	CVMMethodBlock* mb = CVMcbMethodSlot(cb, i);
 	if (CVMmbIsJava(mb)) {
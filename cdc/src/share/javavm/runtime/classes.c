@@ -416,6 +416,9 @@ CVMclassModuleDestroy(CVMExecEnv* ee)
 {
     CVMclassTableFreeAllClasses(ee);
     CVMloaderCacheDestroy(ee);
+#ifdef CVM_CLASSLOADING
+    CVMclassPlaceholderDumpStats();
+#endif
 }
 
 /*
@@ -299,37 +299,12 @@ CVMclassLoadClass0(CVMExecEnv* ee, CVMClassLoaderICell* loader,
     return cb;
 }
 
-/*
- * Class path element, which is either a directory or zip file.
- */
-
-typedef enum {
-    CVM_CPE_DIR, CVM_CPE_ZIP, CVM_CPE_INVALID
-} CVMClassPathEntryType;
-
-struct CVMClassPathEntry {
-    CVMClassPathEntryType type;
-    jzfile *zip;
-    char *path;
-    /* The cached CodeSource object of this path component */
-    CVMObjectICell* codeSource;
-    /* The cached protection domain of this path component */
-    CVMObjectICell* protectionDomain;   
-    /* The cached URL object of this path component */
-    CVMObjectICell* url;   
-    /* The cached JarFile object of this path component */
-    CVMObjectICell* jfile;
-    /* The class path entry is a signed jar file */
-    CVMBool isSigned;
-    /* Has the Java side of this been initialized */
-    CVMBool javaInitialized;
-};
-
 /*
  * Found item on a classpath
  */
 typedef struct ClassInfo {
     CVMUint8*           classData;
+    CVMBool             classDataMapped; /* points into a mapped file */
     CVMUint32           fileSize32;
     const char*         dirname;
     const char*         entryname;
@@ -342,6 +317,7 @@ static void
 initInfo(ClassInfo* info)
 {
     info->classData     = NULL;
+    info->classDataMapped = CVM_FALSE;
     info->fileSize32    = 0;
     info->dirname       = NULL;
     info->entryname     = NULL;
@@ -350,6 +326,20 @@ initInfo(ClassInfo* info)
     info->classFound    = CVM_FALSE;
 }
 
+/*
+ * Frees the class file bytes of a found class, unless they are the
+ * stored zip entry itself in a mapped zip file or come from the class
+ * archive.
+ */
+static void
+freeClassData(ClassInfo* info)
+{
+    if (!info->classDataMapped) {
+	free(info->classData);
+    }
+    info->classData = NULL;
+}
+
 static void
 searchPathAndFindClassInfo(CVMExecEnv* ee, const char* classname, 
 			   char* filename, CVMClassPath* path, 
@@ -382,7 +372,7 @@ CVMclassLoadBootClass(CVMExecEnv* ee, const char* classname)
 	    CVMclassCreateInternalClass(ee, info.classData, info.fileSize32,
 					NULL, classname, info.dirname,
 					CVM_FALSE);
-	free(info.classData);
+	freeClassData(&info);
 	if (classRoot == NULL) {
 	    goto done;
 	}
@@ -426,6 +416,17 @@ CVMclassLoadSystemClassFileFromPath(CVMExecEnv *ee, const char *classname,
     if (info.classFound) {
         CVMassert(info.classData != NULL);
         *classfileSize = info.fileSize32;
+        if (info.classDataMapped) {
+            /* The caller frees the class file, so hand out a copy */
+            CVMUint8 *copy = (CVMUint8 *)malloc(info.fileSize32);
+            if (copy == NULL) {
+                CVMthrowOutOfMemoryError(ee, NULL);
+                *classfileSize = 0;
+            } else {
+                memcpy(copy, info.classData, info.fileSize32);
+            }
+            info.classData = copy;
+        }
     } else {
         CVMassert(info.classData == NULL);
         *classfileSize = 0;
@@ -569,6 +570,20 @@ getClassInfoFromZipFile(CVMExecEnv* ee,
     info->dirname    = zipfile->name;
     info->fromZip    = CVM_TRUE;
 
+#ifdef CVM_ZIP_USE_MMAP
+    {
+	/* Parse a stored class file in place in the mapped zip file */
+	const unsigned char* data = ZIP_GetEntryData(zipfile, zipEntry);
+	if (data != NULL) {
+	    ZIP_FreeEntry(zipfile, zipEntry);
+	    info->classData       = (CVMUint8 *)data;
+	    info->classDataMapped = CVM_TRUE;
+	    info->classFound      = CVM_TRUE;
+	    return;
+	}
+    }
+#endif
+
     /* Allocate space for the class file. */
     externalClass = (CVMUint8 *)malloc(fileSize);
     if (externalClass == NULL) {
@@ -656,6 +671,48 @@ searchPathAndFindClassInfo(CVMExecEnv* ee, const char* classname,
     }
 }
 
+#ifdef CVM_CLASS_ARCHIVE
+/*
+ * Like searchPathAndFindClassInfo(), but for the application class
+ * path: serves the class file out of the class archive if it is there,
+ * and in dump mode adds what was found on the path to the archive.
+ */
+static void
+searchArchiveAndFindClassInfo(CVMExecEnv* ee, const char* classname,
+			      char* filename, CVMClassPath* path,
+			      ClassInfo* info)
+{
+    const CVMUint8* classData;
+    CVMUint32 classSize;
+    CVMUint32 idx;
+
+    if (CVMclassArchiveFind(classname, &classData, &classSize, &idx)) {
+	CVMClassPathEntry* currEntry = &path->entries[idx];
+
+	/* Only jar files are archived, and with the same path */
+	CVMassert(currEntry->type == CVM_CPE_ZIP);
+	sprintf(filename, "%s.%s", classname, CVM_PATH_CLASSFILEEXT);
+	info->dirname         = currEntry->zip->name;
+	info->fromZip         = CVM_TRUE;
+	info->entryname       = filename;
+	info->pathComponent   = currEntry;
+	info->classData       = (CVMUint8 *)classData;
+	info->classDataMapped = CVM_TRUE;
+	info->fileSize32      = classSize;
+	info->classFound      = CVM_TRUE;
+	CVMtraceClassLoading(("CL: class \"%s\" found in class archive\n",
+			      classname));
+	return;
+    }
+
+    searchPathAndFindClassInfo(ee, classname, filename, path, info);
+    if (info->classFound && !info->pathComponent->isSigned) {
+	CVMclassArchiveAdd(ee, classname, info->classData, info->fileSize32,
+			   (CVMUint32)(info->pathComponent - path->entries));
+    }
+}
+#endif
+
 /*
  * Takes class name, converts it to a C utf name, and replaces '.' with '/'
  */
@@ -792,8 +849,13 @@ CVMclassFindContainer(JNIEnv *env, jobject this, jstring name) {
 
     initInfo(&info);
 
+#ifdef CVM_CLASS_ARCHIVE
+    searchArchiveAndFindClassInfo(ee, clPlatformSlashName,
+				  filename, appPath, &info);
+#else
     searchPathAndFindClassInfo(ee, clPlatformSlashName,
                                filename, appPath, &info);
+#endif
     if (info.classFound) {
 	jobject jfile;
 	jclass ccClass;
@@ -878,7 +940,7 @@ CVMclassFindContainer(JNIEnv *env, jobject this, jstring name) {
  
  end:
     if (info.classFound) {
-        free(info.classData);
+        freeClassData(&info);
     }
     if (clPlatformSlashName != clPlatformName) {
         free(clPlatformSlashName);
@@ -914,8 +976,14 @@ CVMclassBootClassPathInit(JNIEnv *env)
 CVMBool
 CVMclassClassPathInit(JNIEnv *env)
 {
-    return CVMclassPathInit(env, &CVMglobals.appClassPath, NULL,
-			    CVM_TRUE, CVM_TRUE);
+    if (!CVMclassPathInit(env, &CVMglobals.appClassPath, NULL,
+			  CVM_TRUE, CVM_TRUE)) {
+	return CVM_FALSE;
+    }
+#ifdef CVM_CLASS_ARCHIVE
+    CVMclassArchiveOpen(&CVMglobals.appClassPath);
+#endif
+    return CVM_TRUE;
 }
 
 #ifdef CVM_MTASK
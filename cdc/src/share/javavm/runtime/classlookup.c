@@ -41,6 +41,9 @@
 #include "javavm/include/stackwalk.h"
 #include "javavm/include/globalroots.h"
 #include "javavm/include/localroots.h"
+#include "javavm/include/porting/time.h"
+#include "javavm/include/porting/threads.h"
+#include "javavm/include/porting/doubleword.h"
 
 #ifdef CVM_CLASSLOADING
 #include "generated/offsets/java_lang_ClassLoader.h"
@@ -176,6 +179,252 @@ CVMclassLookupByTypeFromClassLoader(CVMExecEnv* ee, CVMClassTypeID typeID,
 }
 
 
+#ifdef CVM_CLASSLOADING
+
+static CVMClassPlaceholder*
+CVMclassPlaceholderFind(CVMClassTypeID typeID)
+{
+    CVMClassPlaceholder* ph;
+    for (ph = CVMglobals.classPlaceholders; ph != NULL; ph = ph->next) {
+	if (ph->typeID == typeID) {
+	    return ph;
+	}
+    }
+    return NULL;
+}
+
+/*
+ * Waiting for 'ph' deadlocks if its owner waits, directly or through
+ * other threads, for a placeholder owned by 'ee'. That only happens
+ * when the classes being loaded are circular.
+ */
+static CVMBool
+CVMclassPlaceholderWouldDeadlock(CVMExecEnv* ee, CVMClassPlaceholder* ph)
+{
+    while (ph != NULL && ph->owner != NULL) {
+	if (ph->owner == ee) {
+	    return CVM_TRUE;
+	}
+	ph = ph->owner->classPlaceholderWait;
+    }
+    return CVM_FALSE;
+}
+
+static CVMUint32
+CVMclassPlaceholderCountOwned(CVMExecEnv* ee)
+{
+    CVMClassPlaceholder* ph;
+    CVMUint32 count = 0;
+    for (ph = CVMglobals.classPlaceholders; ph != NULL; ph = ph->next) {
+	if (ph->owner == ee) {
+	    count++;
+	}
+    }
+    return count;
+}
+
+CVMBool
+CVMclassPlaceholderEnter(CVMExecEnv* ee, CVMClassTypeID typeID)
+{
+    CVMClassPlaceholderStats* stats = &CVMglobals.classPlaceholderStats;
+    CVMClassPlaceholder* ph;
+    CVMBool circular = CVM_FALSE;
+
+    CVMassert(CVMD_isgcSafe(ee));
+    CVMsysMutexLock(ee, &CVMglobals.classPlaceholderLock);
+
+    /*
+     * While classes are being redefined, only threads that are already
+     * loading classes may go on, so that their placeholders drain.
+     */
+    if (CVMglobals.classPlaceholderBlockers > 0 &&
+	CVMclassPlaceholderCountOwned(ee) == 0) {
+	CVMBool interrupted = CVM_FALSE;
+
+	stats->blocked++;
+	do {
+	    if (!CVMsysMutexWait(ee, &CVMglobals.classPlaceholderLock,
+				 &CVMglobals.classPlaceholderCV,
+				 CVMlongConstZero())) {
+		interrupted = CVM_TRUE;
+	    }
+	} while (CVMglobals.classPlaceholderBlockers > 0);
+	if (interrupted) {
+	    CVMthreadInterruptWait(CVMexecEnv2threadID(ee));
+	}
+    }
+
+    ph = CVMclassPlaceholderFind(typeID);
+    if (ph != NULL && ph->owner == ee) {
+	ph->depth++;
+	stats->reentered++;
+	CVMsysMutexUnlock(ee, &CVMglobals.classPlaceholderLock);
+	return CVM_TRUE;
+    }
+
+    if (ph != NULL) {
+	CVMInt64 start = CVMtimeMillis();
+	CVMBool interrupted = CVM_FALSE;
+
+	stats->contended++;
+	CVMtraceClassLoading(("CL: <%d> waiting for <%!C>\n",
+			      ee->threadID, typeID));
+	/*
+	 * The class may be claimed again by another waiter before we
+	 * get to run, so look it up again after every wakeup.
+	 */
+	do {
+	    if (CVMclassPlaceholderWouldDeadlock(ee, ph)) {
+		stats->circularities++;
+		circular = CVM_TRUE;
+		break;
+	    }
+	    ph->waiters++;
+	    if (ph->waiters > stats->maxWaiters) {
+		stats->maxWaiters = ph->waiters;
+	    }
+	    ee->classPlaceholderWait = ph;
+	    if (!CVMsysMutexWait(ee, &CVMglobals.classPlaceholderLock,
+				 &CVMglobals.classPlaceholderCV,
+				 CVMlongConstZero())) {
+		interrupted = CVM_TRUE;
+	    }
+	    ee->classPlaceholderWait = NULL;
+	    /* The last waiter frees a released placeholder */
+	    if (--ph->waiters == 0 && ph->owner == NULL) {
+		free(ph);
+	    }
+	    ph = CVMclassPlaceholderFind(typeID);
+	} while (ph != NULL);
+
+	stats->waitMillis = CVMlongAdd(stats->waitMillis,
+				       CVMlongSub(CVMtimeMillis(), start));
+	if (interrupted) {
+	    CVMthreadInterruptWait(CVMexecEnv2threadID(ee));
+	}
+    }
+
+    if (!circular) {
+	ph = (CVMClassPlaceholder*)malloc(sizeof(CVMClassPlaceholder));
+	if (ph != NULL) {
+	    ph->typeID = typeID;
+	    ph->owner = ee;
+	    ph->depth = 1;
+	    ph->waiters = 0;
+	    ph->next = CVMglobals.classPlaceholders;
+	    CVMglobals.classPlaceholders = ph;
+	    CVMglobals.numClassPlaceholders++;
+	    if (CVMglobals.numClassPlaceholders > stats->maxActive) {
+		stats->maxActive = CVMglobals.numClassPlaceholders;
+	    }
+	    stats->entered++;
+	}
+    }
+
+    CVMsysMutexUnlock(ee, &CVMglobals.classPlaceholderLock);
+
+    if (circular) {
+	CVMthrowClassCircularityError(ee, "%!C", typeID);
+	return CVM_FALSE;
+    }
+    if (ph == NULL) {
+	CVMthrowOutOfMemoryError(ee, NULL);
+	return CVM_FALSE;
+    }
+    return CVM_TRUE;
+}
+
+void
+CVMclassPlaceholderExit(CVMExecEnv* ee, CVMClassTypeID typeID)
+{
+    CVMClassPlaceholder** prev;
+    CVMClassPlaceholder* ph;
+
+    CVMsysMutexLock(ee, &CVMglobals.classPlaceholderLock);
+
+    for (prev = &CVMglobals.classPlaceholders; (ph = *prev) != NULL;
+	 prev = &ph->next) {
+	if (ph->typeID == typeID) {
+	    break;
+	}
+    }
+    CVMassert(ph != NULL && ph->owner == ee);
+
+    if (--ph->depth == 0) {
+	*prev = ph->next;
+	CVMglobals.numClassPlaceholders--;
+	ph->owner = NULL;
+	/* Redefining threads wait for the placeholders to drain */
+	if (ph->waiters != 0 || CVMglobals.classPlaceholderBlockers > 0) {
+	    CVMcondvarNotifyAll(&CVMglobals.classPlaceholderCV);
+	}
+	if (ph->waiters == 0) {
+	    free(ph);
+	}
+    }
+
+    CVMsysMutexUnlock(ee, &CVMglobals.classPlaceholderLock);
+}
+
+void
+CVMclassPlaceholdersBlock(CVMExecEnv* ee)
+{
+    CVMBool interrupted = CVM_FALSE;
+    CVMUint32 owned;
+
+    CVMassert(CVMD_isgcSafe(ee));
+    CVMsysMutexLock(ee, &CVMglobals.classPlaceholderLock);
+
+    CVMglobals.classPlaceholderBlockers++;
+    /* The redefining thread may itself be loading a class */
+    owned = CVMclassPlaceholderCountOwned(ee);
+    while (CVMglobals.numClassPlaceholders > owned) {
+	if (!CVMsysMutexWait(ee, &CVMglobals.classPlaceholderLock,
+			     &CVMglobals.classPlaceholderCV,
+			     CVMlongConstZero())) {
+	    interrupted = CVM_TRUE;
+	}
+    }
+
+    CVMsysMutexUnlock(ee, &CVMglobals.classPlaceholderLock);
+    if (interrupted) {
+	CVMthreadInterruptWait(CVMexecEnv2threadID(ee));
+    }
+}
+
+void
+CVMclassPlaceholdersUnblock(CVMExecEnv* ee)
+{
+    CVMsysMutexLock(ee, &CVMglobals.classPlaceholderLock);
+
+    CVMassert(CVMglobals.classPlaceholderBlockers > 0);
+    if (--CVMglobals.classPlaceholderBlockers == 0) {
+	CVMcondvarNotifyAll(&CVMglobals.classPlaceholderCV);
+    }
+
+    CVMsysMutexUnlock(ee, &CVMglobals.classPlaceholderLock);
+}
+
+void
+CVMclassPlaceholderDumpStats()
+{
+    CVMClassPlaceholderStats* stats = &CVMglobals.classPlaceholderStats;
+
+    CVMtraceClassLoading(("CL: placeholders: %d entered, %d reentered, "
+			  "%d contended (%d ms), %d circular\n",
+			  stats->entered, stats->reentered, stats->contended,
+			  CVMlong2Int(stats->waitMillis),
+			  stats->circularities));
+    CVMtraceClassLoading(("CL: placeholders: at most %d active, "
+			  "at most %d waiters for one class, "
+			  "%d blocked by class redefinition\n",
+			  stats->maxActive, stats->maxWaiters,
+			  stats->blocked));
+}
+
+#endif /* CVM_CLASSLOADING */
+
+
 /*
  * CVMclassLookupFromClassLoader - The main lookup function. The class
  * typeID is passed in, but the name may be NULL. If both are passed in
@@ -243,7 +492,11 @@ CVMclassLookupFromClassLoader(CVMExecEnv* ee,
     }
 
     if (loader == NULL) {
-	CVM_NULL_CLASSLOADER_LOCK(ee);
+#ifdef CVM_CLASSLOADING
+	if (!CVMclassPlaceholderEnter(ee, typeID)) {
+	    return NULL; /* exception already thrown */
+	}
+#endif
     } else {
          /* 
 	  * Although class loaders are supposed to define loadClass as
@@ -331,7 +584,9 @@ CVMclassLookupFromClassLoader(CVMExecEnv* ee,
 
     /* unlock the class loader we used. */
     if (loader == NULL) {
-	CVM_NULL_CLASSLOADER_UNLOCK(ee);
+#ifdef CVM_CLASSLOADING
+	CVMclassPlaceholderExit(ee, typeID);
+#endif
     } else {
 	CVMBool success = CVMgcSafeObjectUnlock(ee, loader);
 	CVMassert(success); (void) success;
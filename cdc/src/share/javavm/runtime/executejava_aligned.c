@@ -2888,7 +2888,7 @@ dispatch_opcode:
 		    if (cost <= 0) {
 			CVMD_gcSafeExec(ee, {
 			    CVMmbInvokeCostSet(mb, 0);
-			    CVMJITcompileMethod(ee, mb);
+			    CVMJITrequestCompile(ee, mb);
 			});
 			if (CVMmbIsCompiled(mb)) {
 			    goto invoke_compiled;
@@ -2159,7 +2159,7 @@ invoke_compiled:
 		    if (cost <= 0) {
 			CVMD_gcSafeExec(ee, {
 			    CVMmbInvokeCostSet(mb, 0);
-			    CVMJITcompileMethod(ee, mb);
+			    CVMJITrequestCompile(ee, mb);
 			});
 			if (CVMmbIsCompiled(mb)) {
 			    goto invoke_compiled;
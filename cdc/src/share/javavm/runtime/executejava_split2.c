@@ -2242,7 +2242,7 @@ return_to_compiled:
 		    if (cost <= 0) {
 			CVMD_gcSafeExec(ee, {
 			    CVMmbInvokeCostSet(mb, 0);
-			    CVMJITcompileMethod(ee, mb);
+			    CVMJITrequestCompile(ee, mb);
 			});
 			if (CVMmbIsCompiled(mb)) {
                             goto invoke_compiled;
@@ -3422,7 +3422,7 @@ new_transition:
 		    if (cost <= 0) {
 			CVMD_gcSafeExec(ee, {
 			    CVMmbInvokeCostSet(mb, 0);
-			    CVMJITcompileMethod(ee, mb);
+			    CVMJITrequestCompile(ee, mb);
 			});
 			if (CVMmbIsCompiled(mb)) {
 			    goto invoke_compiled;
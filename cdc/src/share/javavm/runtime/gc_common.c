@@ -136,6 +136,18 @@ handleSmLimits()
     }
 }
 
+#ifdef CVM_STACKMAP_CACHE
+static CVMBool
+handleSmCache()
+{
+    const char* smCacheAttr;
+
+    smCacheAttr = CVMgetParsedSubOption(&CVMglobals.gcCommon.gcOptions,
+                                        "stackmapCache");
+    return CVMstackmapCacheInit(smCacheAttr);
+}
+#endif
+
 #ifdef CVM_MTASK
 CVMBool
 CVMgcParseXgcOptions(CVMExecEnv* ee, const char* xgcOpts)
@@ -205,6 +217,13 @@ CVMgcInitHeap(CVMOptions *options)
 
     handleGcStats();
     handleSmLimits();
+#ifdef CVM_STACKMAP_CACHE
+    if (!handleSmCache()) {
+	CVMconsolePrintf("Cannot start VM "
+			 "(out of memory reading the stackmap cache)\n");
+	return CVM_FALSE;
+    }
+#endif
     
 #ifdef CVM_JVMPI
     if (CVMjvmpiEventArenaNewIsEnabled()) {
@@ -1266,6 +1285,7 @@ stopTheWorldAndDoAction(CVMExecEnv *ee, void *data,
                  void* retryData)
 {
     CVMBool success = CVM_FALSE;
+    CVMBool stackmapsReady;
     CVMUint32 preActionStatus = 0;
 
 #ifdef CVM_JIT
@@ -1292,7 +1312,10 @@ stopTheWorldAndDoAction(CVMExecEnv *ee, void *data,
         }
     }
 
-    if (CVMgcEnsureStackmapsForRootScans(ee)) {
+    CVMgcstatStartStackmapMeasurement();
+    stackmapsReady = CVMgcEnsureStackmapsForRootScans(ee);
+    CVMgcstatEndStackmapMeasurement();
+    if (stackmapsReady) {
         /* Do callback for the Action: */
         success = actionCallback(ee, data);
     }
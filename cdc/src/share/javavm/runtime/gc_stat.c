@@ -44,6 +44,11 @@ CVMgcstatPrintGCStat(CVMInt64 curGCTime)
 		     CVMlong2Int(curGCTime));
     CVMconsolePrintf("Total GC pause time: %d ms\n", 
 		     CVMlong2Int(CVMglobals.totalGCTime));
+    CVMconsolePrintf("Stackmap computation time: %d ms (%d maps computed)\n",
+		     CVMlong2Int(CVMglobals.stackmapTime),
+		     CVMglobals.stackMapsComputedInPause);
+    CVMconsolePrintf("Total stackmap computation time: %d ms\n",
+		     CVMlong2Int(CVMglobals.totalStackmapTime));
     CVMconsolePrintf("Free memory before GC: %d bytes\n", 
 		     CVMlong2Int(CVMglobals.initFreeMemory));
     CVMconsolePrintf("Free memory after GC: %d bytes\n", 
@@ -76,6 +81,36 @@ CVMgcstatEndGCMeasurement(void)
     }
 }
 
+/*
+ * The stackmaps of the frames on the stacks are computed after all
+ * threads have stopped, but before the GC proper is started, so
+ * measure that separately.
+ */
+void 
+CVMgcstatStartStackmapMeasurement(void) 
+{
+    if (CVMglobals.measureGC) {
+	CVMglobals.startStackmapTime = CVMtimeMillis();
+	CVMglobals.stackMapsComputedInPause =
+	    CVMglobals.gcCommon.stackMapsComputed;
+    }
+}
+
+void 
+CVMgcstatEndStackmapMeasurement(void) 
+{
+    if (CVMglobals.measureGC) {
+	CVMglobals.stackmapTime =
+	    CVMlongSub(CVMtimeMillis(), CVMglobals.startStackmapTime);
+	CVMglobals.totalStackmapTime =
+	    CVMlongAdd(CVMglobals.totalStackmapTime,
+		       CVMglobals.stackmapTime);
+	CVMglobals.stackMapsComputedInPause =
+	    CVMglobals.gcCommon.stackMapsComputed -
+	    CVMglobals.stackMapsComputedInPause;
+    }
+}
+
 void 
 CVMgcstatDoGCMeasurement(CVMBool doGCMeasurement) 
 {
@@ -215,8 +215,22 @@ static const CVMGlobalSysMutexEntry globalSysMutexes[] = {
     CVM_SYSMUTEX_ENTRY(globalRootsLock, "global roots lock"),
     CVM_SYSMUTEX_ENTRY(weakGlobalRootsLock, "weak global roots lock"),
     CVM_SYSMUTEX_ENTRY(typeidLock, "typeid lock"),
+    CVM_SYSMUTEX_ENTRY(typeidMemberNameLock, "typeid member name lock"),
     CVM_SYSMUTEX_ENTRY(syncLock, "fast sync lock"),
     CVM_SYSMUTEX_ENTRY(internLock, "intern table lock"),
+#ifdef CVM_CLASSLOADING
+    CVM_SYSMUTEX_ENTRY(classPlaceholderLock, "class placeholder lock"),
+    CVM_SYSMUTEX_ENTRY(packagesLock, "packages lock"),
+#endif
+#ifdef CVM_CLASS_ARCHIVE
+    CVM_SYSMUTEX_ENTRY(classArchiveLock, "class archive lock"),
+#endif
+#ifdef CVM_STACKMAP_CACHE
+    CVM_SYSMUTEX_ENTRY(stackmapCacheLock, "stackmap cache lock"),
+#endif
+#ifdef CVM_JIT
+    CVM_SYSMUTEX_ENTRY(jitCompileQueueLock, "jit compile queue lock"),
+#endif
 #if defined(CVM_INSPECTOR) || defined(CVM_JVMPI) || defined(CVM_JVMTI)
     CVM_SYSMUTEX_ENTRY(gcLockerLock, "gc locker lock"),
 #endif
@@ -816,6 +830,20 @@ CVMBool CVMinitVMGlobalState(CVMGlobalState *gs, CVMOptions *options)
 	goto out_of_memory;
     }
 
+#ifdef CVM_CLASSLOADING
+    if (!CVMcondvarInit(&gs->classPlaceholderCV,
+			&gs->classPlaceholderLock.rmutex.mutex)) {
+	goto out_of_memory;
+    }
+#endif
+
+#ifdef CVM_JIT
+    if (!CVMcondvarInit(&gs->jitCompileQueueCV,
+			&gs->jitCompileQueueLock.rmutex.mutex)) {
+	goto out_of_memory;
+    }
+#endif
+
 #ifdef CVM_INSPECTOR
     CVMgcLockerInit(&gs->inspectorGCLocker);
     if (!CVMcondvarInit(&gs->gcLockerCV, &gs->gcLockerLock.rmutex.mutex)) {
@@ -1103,6 +1131,8 @@ CVMBool CVMinitVMGlobalState(CVMGlobalState *gs, CVMOptions *options)
     /* For GC statistics */
     gs->measureGC = CVM_FALSE;
     gs->totalGCTime = CVMint2Long(0);
+    gs->stackmapTime = CVMint2Long(0);
+    gs->totalStackmapTime = CVMint2Long(0);
 
 #ifdef CVM_JIT
     if (!CVMjitInit(ee, &gs->jit, options->jitAttributesStr)) {
@@ -1148,6 +1178,19 @@ CVMBool CVMinitVMGlobalState(CVMGlobalState *gs, CVMOptions *options)
     if (options->appclasspathStr != NULL) {
         gs->appClassPath.pathString = strdup(options->appclasspathStr);
     }
+#ifdef CVM_CLASS_ARCHIVE
+#ifdef CVM_MTASK
+    if (options->isServer && options->classArchiveDump) {
+	/* Forked clients would all append to the same file */
+	CVMconsolePrintf("-XclassArchiveDump is ignored with -Xserver\n");
+	options->classArchiveStr = NULL;
+    }
+#endif
+    if (!CVMclassArchiveInit(options->classArchiveStr,
+			     options->classArchiveDump)) {
+	goto out_of_memory;
+    }
+#endif
 #endif
 
     /*
@@ -1265,6 +1308,14 @@ void CVMdestroyVMGlobalState(CVMExecEnv *ee, CVMGlobalState *gs)
     CVMgcLockerDestroy(&gs->inspectorGCLocker);
 #endif
     CVMcondvarDestroy(&gs->threadCountCV);
+#ifdef CVM_CLASSLOADING
+    CVMassert(gs->classPlaceholders == NULL);
+    CVMassert(gs->classPlaceholderBlockers == 0);
+    CVMcondvarDestroy(&gs->classPlaceholderCV);
+#endif
+#ifdef CVM_JIT
+    CVMcondvarDestroy(&gs->jitCompileQueueCV);
+#endif
 
     CVMdetachExecEnv(ee);
     CVMdestroyExecEnv(ee);
@@ -1310,6 +1361,9 @@ void CVMdestroyVMGlobalState(CVMExecEnv *ee, CVMGlobalState *gs)
      * Destroy stackmap computer related data structures
      */
     CVMstackmapComputerDestroy();
+#ifdef CVM_STACKMAP_CACHE
+    CVMstackmapCacheDestroy();
+#endif
 
 /* Java SE Zip doesn't have this function.  Comment out for now.
    FIXME - make sure this doesn't introduce a leak.
@@ -1336,6 +1390,9 @@ void CVMdestroyVMGlobalState(CVMExecEnv *ee, CVMGlobalState *gs)
     if (gs->appClassPath.pathString != NULL) {
         free(gs->appClassPath.pathString);
     }
+#ifdef CVM_CLASS_ARCHIVE
+    CVMclassArchiveDestroy();
+#endif
 #endif
 
     CVMdestroyJNIStatics();
@@ -2712,6 +2712,7 @@ CVMlocksForGCAcquire(CVMExecEnv* ee)
     CVMsysMutexLock(ee, &CVMglobals.globalRootsLock);
     CVMsysMutexLock(ee, &CVMglobals.weakGlobalRootsLock);
     CVMsysMutexLock(ee, &CVMglobals.typeidLock);
+    CVMsysMutexLock(ee, &CVMglobals.typeidMemberNameLock);
     CVMsysMutexLock(ee, &CVMglobals.syncLock);
     CVMsysMutexLock(ee, &CVMglobals.internLock);
 #if defined(CVM_INSPECTOR) || defined(CVM_JVMPI)
@@ -2727,6 +2728,7 @@ CVMlocksForGCRelease(CVMExecEnv* ee)
 #endif
     CVMsysMutexUnlock(ee, &CVMglobals.internLock);
     CVMsysMutexUnlock(ee, &CVMglobals.syncLock);
+    CVMsysMutexUnlock(ee, &CVMglobals.typeidMemberNameLock);
     CVMsysMutexUnlock(ee, &CVMglobals.typeidLock);
     CVMsysMutexUnlock(ee, &CVMglobals.weakGlobalRootsLock);
     CVMsysMutexUnlock(ee, &CVMglobals.globalRootsLock);
@@ -3340,6 +3342,9 @@ CVMprepareToExit(void)
     }
     /* reset the globally static defined exit_procs */
     CVMglobals.exit_procs = NULL;
+#ifdef CVM_STACKMAP_CACHE
+    CVMstackmapCacheWrite(CVMgetEE());
+#endif
     return CVMshutdown();
 }
 
@@ -55,11 +55,8 @@
 
 #include "javavm/include/clib.h"
 #include "javavm/include/porting/ansi/setjmp.h"
-#if defined(CVM_JIT_COLLECT_STATS) || \
-    defined(CVM_JIT_ESTIMATE_COMPILATION_SPEED)
 #include "javavm/include/porting/doubleword.h"
 #include "javavm/include/porting/time.h"
-#endif
 
 #ifdef CVM_DEBUG_ASSERTS
 #include "generated/offsets/java_lang_String.h"
@@ -1009,6 +1006,183 @@ doBackOff:
     return retVal;
 }
 
+/*
+ * Background compilation
+ *
+ * With -Xjit:asyncCompile, the interpreter hands methods that cross the
+ * compilation threshold to CVMJITrequestCompile(), which puts them on
+ * CVMglobals.jit.compileQueue and returns right away. The invoking
+ * thread keeps interpreting the method and switches to the compiled
+ * code on the first invocation after the "JIT Compiler" daemon thread
+ * (see sun.misc.JIT) has compiled it.
+ *
+ * A method that is invoked again while it waits asks for compilation
+ * again every CVMJIT_COMPILE_QUEUE_REQUEST_COST of invocation cost, and
+ * each request adds that cost to its priority. The compiler thread
+ * always takes the queued method with the highest priority, so hot
+ * methods overtake methods that merely crossed the threshold first.
+ *
+ * The queue is protected by the jitCompileQueueLock. The compiler thread
+ * also holds the jitLock from the time it takes a method off the queue
+ * until it is done compiling it. Class unloading removes the methods of
+ * unloaded classes from the queue with the jitLock held, so the compiler
+ * thread never sees an mb that has been freed.
+ */
+#define CVMJIT_COMPILE_QUEUE_REQUEST_COST(jgs) \
+    ((jgs)->compileThreshold / 8 + 1)
+
+void
+CVMJITrequestCompile(CVMExecEnv *ee, CVMMethodBlock* mb)
+{
+    CVMJITGlobalState* jgs = &CVMglobals.jit;
+    CVMInt32 requestCost;
+    CVMUint32 i;
+
+    CVMassert(CVMD_isgcSafe(ee));
+
+    /* Compile synchronously if there is no compiler thread, or if this
+       is the compiler thread itself running some Java code. */
+    if (!jgs->compileQueueActive ||
+	CVMsysMutexIAmOwner(ee, &CVMglobals.jitLock)) {
+	CVMJITcompileMethod(ee, mb);
+	return;
+    }
+
+    requestCost = CVMJIT_COMPILE_QUEUE_REQUEST_COST(jgs);
+
+    CVMsysMutexLock(ee, &CVMglobals.jitCompileQueueLock);
+
+    for (i = 0; i < jgs->compileQueueLength; i++) {
+	CVMJITCompileQueueEntry* entry = &jgs->compileQueue[i];
+	if (entry->mb == mb) {
+	    entry->priority += requestCost;
+	    goto queued;
+	}
+    }
+
+    if (jgs->compileQueueLength == CVMJIT_COMPILE_QUEUE_SIZE) {
+	/* The compiler thread is falling behind. Try again later. */
+	CVMsysMutexUnlock(ee, &CVMglobals.jitCompileQueueLock);
+	backOff(mb, jgs->compileThreshold / 2);
+	return;
+    }
+
+    {
+	CVMJITCompileQueueEntry* entry =
+	    &jgs->compileQueue[jgs->compileQueueLength++];
+	entry->mb = mb;
+	entry->priority = jgs->compileThreshold;
+	entry->enqueueTime = CVMtimeMillis();
+	CVMJITstatsRecordCompileQueueLength(jgs->compileQueueLength);
+	CVMcondvarNotify(&CVMglobals.jitCompileQueueCV);
+    }
+
+ queued:
+    /* Don't ask again until some more cost has accumulated. */
+    if (!CVMmbIsCompiled(mb)) {
+	CVMmbInvokeCostSet(mb, requestCost);
+    }
+    CVMsysMutexUnlock(ee, &CVMglobals.jitCompileQueueLock);
+}
+
+CVMBool
+CVMJITserveCompileQueue(CVMExecEnv *ee)
+{
+    CVMJITGlobalState* jgs = &CVMglobals.jit;
+
+    CVMassert(CVMD_isgcSafe(ee));
+
+    CVMsysMutexLock(ee, &CVMglobals.jitCompileQueueLock);
+    jgs->compileQueueActive = CVM_TRUE;
+
+    while (CVM_TRUE) {
+	CVMMethodBlock* mb;
+	CVMInt64 enqueueTime;
+	CVMUint32 best;
+	CVMUint32 i;
+
+	while (jgs->compileQueueLength == 0) {
+	    if (!CVMsysMutexWait(ee, &CVMglobals.jitCompileQueueLock,
+				 &CVMglobals.jitCompileQueueCV,
+				 CVMlongConstZero())) {
+		goto interrupted;
+	    }
+	}
+
+	/* The jitLock has to be taken before the queue lock. */
+	CVMsysMutexUnlock(ee, &CVMglobals.jitCompileQueueLock);
+	CVMsysMutexLock(ee, &CVMglobals.jitLock);
+	CVMsysMutexLock(ee, &CVMglobals.jitCompileQueueLock);
+
+	if (jgs->compileQueueLength == 0) {
+	    /* Class unloading emptied the queue in the meantime. */
+	    CVMsysMutexUnlock(ee, &CVMglobals.jitLock);
+	    continue;
+	}
+
+	best = 0;
+	for (i = 1; i < jgs->compileQueueLength; i++) {
+	    if (jgs->compileQueue[i].priority >
+		jgs->compileQueue[best].priority) {
+		best = i;
+	    }
+	}
+	mb = jgs->compileQueue[best].mb;
+	enqueueTime = jgs->compileQueue[best].enqueueTime;
+	jgs->compileQueue[best] =
+	    jgs->compileQueue[--jgs->compileQueueLength];
+
+	CVMsysMutexUnlock(ee, &CVMglobals.jitCompileQueueLock);
+
+	CVMJITstatsRecordCompileQueueLatency(
+	    CVMlong2Int(CVMlongSub(CVMtimeMillis(), enqueueTime)));
+
+	CVMJITcompileMethod(ee, mb);
+
+	CVMsysMutexUnlock(ee, &CVMglobals.jitLock);
+
+	/* A failed compilation must not end or wedge the thread. */
+	if (CVMlocalExceptionOccurred(ee)) {
+	    CVMclearLocalException(ee);
+	}
+	CVMsysMutexLock(ee, &CVMglobals.jitCompileQueueLock);
+	if (CVMremoteExceptionOccurred(ee)) {
+	    /* Thread.stop(): let the exception end the thread. */
+	    goto interrupted;
+	}
+    }
+
+ interrupted:
+    /* The thread exits. Whatever is still queued will be requested
+       again by the interpreter, and compiled synchronously from now
+       on. */
+    jgs->compileQueueActive = CVM_FALSE;
+    jgs->compileQueueLength = 0;
+    CVMsysMutexUnlock(ee, &CVMglobals.jitCompileQueueLock);
+    return CVM_FALSE;
+}
+
+void
+CVMJITcompileQueueRemoveClass(CVMExecEnv *ee, CVMClassBlock* cb)
+{
+    CVMJITGlobalState* jgs = &CVMglobals.jit;
+    CVMUint32 i;
+
+    CVMassert(CVMsysMutexIAmOwner(ee, &CVMglobals.jitLock));
+
+    CVMsysMutexLock(ee, &CVMglobals.jitCompileQueueLock);
+    i = 0;
+    while (i < jgs->compileQueueLength) {
+	if (CVMmbClassBlock(jgs->compileQueue[i].mb) == cb) {
+	    jgs->compileQueue[i] =
+		jgs->compileQueue[--jgs->compileQueueLength];
+	} else {
+	    i++;
+	}
+    }
+    CVMsysMutexUnlock(ee, &CVMglobals.jitCompileQueueLock);
+}
+
 #ifdef CVM_JIT_PATCHED_METHOD_INVOCATIONS
 /*
  * Removes any patch records for decompiledMb as a callerMb. Also
@@ -1358,6 +1358,39 @@ arrayFetchExpressionSlot(CVMJITCompilationContext* con, CVMInt32 arrid)
     return &con->arrayFetchExprs[arrid];
 }
 
+/*
+ * Return TRUE if the test of an enclosing counted loop has already
+ * established that 'arrayrefNode' is not null and that 'indexNode' is
+ * within its bounds. See CVMJITirblockFindCountedLoops().
+ */
+static CVMBool
+checkedByCountedLoop(CVMJITCompilationContext* con,
+		     CVMJITIRNode* arrayrefNode, CVMJITIRNode* indexNode)
+{
+    CVMJITMethodContext* mc = con->mc;
+    CVMUint16 pc = mc->startPC - mc->code;
+    CVMUint32 i;
+
+    for (i = 0; i < mc->numCountedLoops; i++) {
+	CVMJITCountedLoop* loop = &mc->countedLoops[i];
+	CVMJITIRNode* arrayLocal;
+	CVMJITIRNode* indexLocal;
+
+	if (pc < loop->bodyPC || pc >= loop->iincPC) {
+	    continue;
+	}
+	arrayLocal = mc->locals[loop->arrayLocal];
+	indexLocal = mc->locals[loop->indexLocal];
+	if (arrayLocal != NULL && indexLocal != NULL &&
+	    isSameSimple(con, arrayrefNode, arrayLocal) &&
+	    isSameSimple(con, indexNode, indexLocal))
+	{
+	    return CVM_TRUE;
+	}
+    }
+    return CVM_FALSE;
+}
+
 /* 
  * array[index] operation
  *
@@ -1475,7 +1508,15 @@ indexArrayOperation(CVMJITCompilationContext* con, CVMJITIRBlock* curbk,
 #endif /* IAI_ARRAY_INIT_BOUNDS_CHECK_ELIMINATION*/
 
     /* Arrayref null and bounds check if needed */
-    if (!boundsCheckEmitted) {
+    if (!boundsCheckEmitted &&
+	checkedByCountedLoop(con, origArrayrefNode, origIndexNode))
+    {
+	/* Neither check is needed, and both operands are locals, so there
+	   is no evaluation order to preserve either. */
+	arrayrefNode = origArrayrefNode;
+        CVMJITstatsRecordInc(con,
+			     CVMJIT_STATS_LOOP_BOUNDS_CHECKS_ELIMINATED);
+    } else if (!boundsCheckEmitted) {
 	CVMJITIRNode* lengthNode;
         CVMJITIRNode* cachedArrayLengthNode;
 
@@ -7286,6 +7327,9 @@ firstPass(CVMJITCompilationContext* con)
 
     /* Now find the rest of the blocks */
     CVMJITirblockFindAllNormalLabels(con);
+
+    /* Find loops whose array accesses need no checks */
+    CVMJITirblockFindCountedLoops(con);
     CVMJITirblockConnectBlocksInOrder(con);
 }
 
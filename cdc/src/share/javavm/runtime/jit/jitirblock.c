@@ -599,6 +599,320 @@ CVMJITsplitNot(CVMJITCompilationContext *con, CVMUint32 i, void *data)
     CVMJITsetRemove(con, &mc->notSeq, pcIndex);
 }
 
+/*
+ * Counted loop detection. We look for the bytecode javac generates for
+ *
+ *     for (i = c; i < a.length; i++) { body }  where c >= 0
+ *
+ *     storePC:  iconst/bipush/sipush c
+ *               istore i
+ *     gotoPC:   goto testPC
+ *     bodyPC:   body
+ *     iincPC:   iinc i, 1
+ *     testPC:   iload i
+ *               aload a
+ *               arraylength
+ *     branchPC: if_icmplt bodyPC
+ *
+ * and accept the loop if the body stores to neither 'i' nor 'a', does
+ * not contain subroutine calls, and if nothing but the body, the goto
+ * and the loop branch jumps into the loop. Then 'a' is non-null and
+ * 0 <= i < a.length holds throughout the body, and i++ cannot overflow.
+ */
+
+#define CVMJIT_MAX_COUNTED_LOOPS 16
+
+typedef struct CountedLoopCandidate {
+    CVMJITCountedLoop loop;
+    CVMUint16 storePC;
+    CVMUint16 gotoPC;
+    CVMUint16 testPC;
+    CVMUint16 branchPC;
+    CVMBool   isValid;
+} CountedLoopCandidate;
+
+/*
+ * If the instruction at 'pc' is 'op', 'op_0' .. 'op_3' or 'wide op',
+ * return the local it accesses. Otherwise return -1.
+ */
+static CVMInt32
+localOfInstruction(CVMUint8* pc, CVMOpcode op, CVMOpcode op_0)
+{
+    if (pc[0] == op) {
+	return pc[1];
+    } else if (pc[0] >= op_0 && pc[0] <= op_0 + 3) {
+	return pc[0] - op_0;
+    } else if (pc[0] == opc_wide && pc[1] == op) {
+	return CVMgetUint16(pc + 2);
+    }
+    return -1;
+}
+
+static CVMBool
+storesToLocal(CVMUint8* pc, CVMUint16 localNo)
+{
+    CVMInt32 stored;
+
+    if ((stored = localOfInstruction(pc, opc_istore, opc_istore_0)) >= 0 ||
+	(stored = localOfInstruction(pc, opc_fstore, opc_fstore_0)) >= 0 ||
+	(stored = localOfInstruction(pc, opc_astore, opc_astore_0)) >= 0)
+    {
+	return stored == localNo;
+    }
+    if ((stored = localOfInstruction(pc, opc_lstore, opc_lstore_0)) >= 0 ||
+	(stored = localOfInstruction(pc, opc_dstore, opc_dstore_0)) >= 0)
+    {
+	/* Two word stores also overwrite the next local */
+	return stored == localNo || stored + 1 == localNo;
+    }
+    if (pc[0] == opc_iinc) {
+	return pc[1] == localNo;
+    }
+    if (pc[0] == opc_wide && pc[1] == opc_iinc) {
+	return CVMgetUint16(pc + 2) == localNo;
+    }
+    return CVM_FALSE;
+}
+
+static CVMBool
+isNonNegativeIntConstant(CVMUint8* pc)
+{
+    switch (pc[0]) {
+    case opc_iconst_0:
+    case opc_iconst_1:
+    case opc_iconst_2:
+    case opc_iconst_3:
+    case opc_iconst_4:
+    case opc_iconst_5:
+	return CVM_TRUE;
+    case opc_bipush:
+	return (CVMInt8)pc[1] >= 0;
+    case opc_sipush:
+	return CVMgetInt16(pc + 1) >= 0;
+    default:
+	return CVM_FALSE;
+    }
+}
+
+/*
+ * Match the loop test at 'pc', which must be preceded by the increment
+ * of the index at 'prevPC'.
+ */
+static CVMBool
+matchLoopTest(CountedLoopCandidate* c, CVMUint8* codeBegin,
+	      CVMUint8* codeEnd, CVMUint8* prevPC, CVMUint8* pc)
+{
+    CVMInt32 arrayLocal;
+
+    if (prevPC == NULL || prevPC - codeBegin < c->loop.bodyPC ||
+	prevPC[0] != opc_iinc || prevPC[1] != c->loop.indexLocal ||
+	(CVMInt8)prevPC[2] != 1)
+    {
+	return CVM_FALSE;
+    }
+    if (localOfInstruction(pc, opc_iload, opc_iload_0) !=
+	c->loop.indexLocal)
+    {
+	return CVM_FALSE;
+    }
+    pc += CVMopcodeGetLength(pc);
+    if (pc >= codeEnd) {
+	return CVM_FALSE;
+    }
+    arrayLocal = localOfInstruction(pc, opc_aload, opc_aload_0);
+    if (arrayLocal < 0) {
+	return CVM_FALSE;
+    }
+    pc += CVMopcodeGetLength(pc);
+    if (pc >= codeEnd || pc[0] != opc_arraylength) {
+	return CVM_FALSE;
+    }
+    pc++;
+    if (pc + 3 > codeEnd || pc[0] != opc_if_icmplt ||
+	pc + CVMgetInt16(pc + 1) - codeBegin != c->loop.bodyPC)
+    {
+	return CVM_FALSE;
+    }
+
+    c->loop.iincPC = prevPC - codeBegin;
+    c->loop.arrayLocal = arrayLocal;
+    c->branchPC = pc - codeBegin;
+    return CVM_TRUE;
+}
+
+/*
+ * Only the loop itself may branch into [storePC, branchPC]: the body
+ * and the loop branch to anywhere in [bodyPC, testPC], and the goto to
+ * the loop test.
+ */
+static void
+checkCountedLoopBranch(CountedLoopCandidate* candidates, int numCandidates,
+		       CVMInt32 fromPC, CVMInt32 toPC)
+{
+    int i;
+    for (i = 0; i < numCandidates; i++) {
+	CountedLoopCandidate* c = &candidates[i];
+	if (!c->isValid || toPC < c->storePC || toPC > c->branchPC) {
+	    continue;
+	}
+	if (fromPC >= c->loop.bodyPC && fromPC <= c->branchPC &&
+	    toPC >= c->loop.bodyPC && toPC <= c->testPC) {
+	    continue;
+	}
+	if (fromPC == c->gotoPC && toPC == c->testPC) {
+	    continue;
+	}
+	c->isValid = CVM_FALSE;
+    }
+}
+
+void
+CVMJITirblockFindCountedLoops(CVMJITCompilationContext* con)
+{
+    CVMJITMethodContext* mc = con->mc;
+    CVMJavaMethodDescriptor* jmd = mc->jmd;
+    CVMUint8*  codeBegin = CVMjmdCode(jmd);
+    CVMUint8*  codeEnd = &codeBegin[CVMmbCodeLength(mc->mb)];
+    CVMUint8*  pc;
+    CVMUint8*  prevPC = NULL;
+    CVMUint8*  prevPrevPC = NULL;
+    CountedLoopCandidate candidates[CVMJIT_MAX_COUNTED_LOOPS];
+    int numCandidates = 0;
+    int numLoops = 0;
+    int i;
+
+    mc->countedLoops = NULL;
+    mc->numCountedLoops = 0;
+
+    /* Find loops that look right */
+    for (pc = codeBegin; pc < codeEnd; pc += CVMopcodeGetLength(pc)) {
+	for (i = 0; i < numCandidates; i++) {
+	    CountedLoopCandidate* c = &candidates[i];
+	    if (c->testPC == pc - codeBegin) {
+		c->isValid = matchLoopTest(c, codeBegin, codeEnd, prevPC, pc);
+	    }
+	}
+
+	if (pc[0] == opc_goto && CVMgetInt16(pc + 1) > 3 &&
+	    numCandidates < CVMJIT_MAX_COUNTED_LOOPS &&
+	    prevPrevPC != NULL && isNonNegativeIntConstant(prevPrevPC))
+	{
+	    CVMInt32 indexLocal =
+		localOfInstruction(prevPC, opc_istore, opc_istore_0);
+	    if (indexLocal >= 0) {
+		CountedLoopCandidate* c = &candidates[numCandidates++];
+		c->storePC = prevPC - codeBegin;
+		c->gotoPC = pc - codeBegin;
+		c->testPC = pc + CVMgetInt16(pc + 1) - codeBegin;
+		c->loop.bodyPC = c->gotoPC + 3;
+		c->loop.indexLocal = indexLocal;
+		c->isValid = CVM_FALSE;
+	    }
+	}
+
+	prevPrevPC = prevPC;
+	prevPC = pc;
+    }
+
+    /* Now verify that nothing else changes the index or the array */
+    for (pc = codeBegin; pc < codeEnd; pc += CVMopcodeGetLength(pc)) {
+	CVMInt32 pcIndex = pc - codeBegin;
+	CVMOpcode instr = pc[0];
+
+	for (i = 0; i < numCandidates; i++) {
+	    CountedLoopCandidate* c = &candidates[i];
+	    if (!c->isValid || pcIndex < c->loop.bodyPC ||
+		pcIndex > c->branchPC) {
+		continue;
+	    }
+	    if ((pcIndex < c->loop.iincPC &&
+		 storesToLocal(pc, c->loop.indexLocal)) ||
+		storesToLocal(pc, c->loop.arrayLocal) ||
+		instr == opc_jsr || instr == opc_jsr_w || instr == opc_ret ||
+		(instr == opc_wide && pc[1] == opc_ret))
+	    {
+		c->isValid = CVM_FALSE;
+	    }
+	}
+
+	if (!CVMbcAttr(instr, BRANCH)) {
+	    continue;
+	}
+	switch (instr) {
+	case opc_goto:
+	case opc_jsr:
+	    checkCountedLoopBranch(candidates, numCandidates, pcIndex,
+				   pcIndex + CVMgetInt16(pc + 1));
+	    break;
+	case opc_goto_w:
+	case opc_jsr_w:
+	    checkCountedLoopBranch(candidates, numCandidates, pcIndex,
+				   pcIndex + CVMgetInt32(pc + 1));
+	    break;
+	case opc_lookupswitch: {
+	    CVMInt32* lpc  = (CVMInt32*)CVMalignWordUp(pc+1);
+	    CVMInt32  npairs = CVMgetAlignedInt32(&lpc[1]);
+	    int cnt;
+
+	    checkCountedLoopBranch(candidates, numCandidates, pcIndex,
+				   pcIndex + CVMgetAlignedInt32(lpc));
+	    for (cnt = 0; cnt < npairs; cnt++) {
+		lpc += 2;
+		checkCountedLoopBranch(candidates, numCandidates, pcIndex,
+				       pcIndex + CVMgetAlignedInt32(&lpc[1]));
+	    }
+	    break;
+	}
+	case opc_tableswitch: {
+	    CVMInt32* lpc  = (CVMInt32*)CVMalignWordUp(pc+1);
+	    CVMInt32  low  = CVMgetAlignedInt32(&lpc[1]);
+	    CVMInt32  high = CVMgetAlignedInt32(&lpc[2]);
+	    int cnt;
+
+	    checkCountedLoopBranch(candidates, numCandidates, pcIndex,
+				   pcIndex + CVMgetAlignedInt32(&lpc[0]));
+	    for (cnt = 0; cnt < high - low + 1; cnt++) {
+		checkCountedLoopBranch(candidates, numCandidates, pcIndex,
+				       pcIndex + CVMgetAlignedInt32(&lpc[3+cnt]));
+	    }
+	    break;
+	}
+	default:
+	    /* One of the 'if' instructions */
+	    checkCountedLoopBranch(candidates, numCandidates, pcIndex,
+				   pcIndex + CVMgetInt16(pc + 1));
+	    break;
+	}
+    }
+
+    /* Exception handlers enter the loop with unknown index values */
+    {
+	CVMExceptionHandler* handler = CVMjmdExceptionTable(jmd);
+	int n;
+	for (n = CVMjmdExceptionTableLength(jmd); n > 0; --n, handler++) {
+	    checkCountedLoopBranch(candidates, numCandidates, -1,
+				   handler->handlerpc);
+	}
+    }
+
+    for (i = 0; i < numCandidates; i++) {
+	if (candidates[i].isValid) {
+	    numLoops++;
+	}
+    }
+    if (numLoops == 0) {
+	return;
+    }
+
+    mc->countedLoops = (CVMJITCountedLoop*)CVMJITmemNew(con,
+	JIT_ALLOC_IRGEN_OTHER, numLoops * sizeof(CVMJITCountedLoop));
+    for (i = 0; i < numCandidates; i++) {
+	if (candidates[i].isValid) {
+	    mc->countedLoops[mc->numCountedLoops++] = candidates[i].loop;
+	}
+    }
+}
+
 /*
  * Merge (set) local refs information 'localRefs' into that of 'targetbk'.
  *
@@ -340,6 +340,40 @@ CVMJITstatsDestroyGlobalStats(CVMJITGlobalStats **gstats)
     *gstats = NULL;
 }
 
+/* Purpose: Records the length of the compilation queue after a method
+            was added to it.
+   NOTE: Called with the jitCompileQueueLock held. */
+void
+CVMJITstatsRecordCompileQueueLength(CVMUint32 length)
+{
+    CVMJITGlobalStats *gs = CVMglobals.jit.globalStats;
+    if (gs == NULL) {
+        return;
+    }
+    if (length > gs->maxCompileQueueLength) {
+        gs->maxCompileQueueLength = length;
+    }
+}
+
+/* Purpose: Records the time a method spent on the compilation queue.
+   NOTE: Only called by the compiler thread. */
+void
+CVMJITstatsRecordCompileQueueLatency(CVMInt32 latency)
+{
+    CVMJITGlobalStats *gs = CVMglobals.jit.globalStats;
+    if (gs == NULL) {
+        return;
+    }
+    if (latency < 0) {
+        latency = 0;
+    }
+    gs->numberOfQueuedCompilations++;
+    gs->totalCompileQueueLatency += latency;
+    if ((CVMUint32)latency > gs->maxCompileQueueLatency) {
+        gs->maxCompileQueueLatency = latency;
+    }
+}
+
 /* Purpose: Fills in the ratio fields based on other fields.
    NOTE: It is assumed that all the needed input fields have already been
          initialized before hand. */
@@ -864,6 +898,7 @@ static const char* const tagNames[] = {
     "Number of NullChecks eliminated  ",
     "Number of ArrayBoundsCheck Nodes ",
     "Number of ArrayBoundsCheck Elim. ",
+    "Number of Loop BoundsCheck Elim. ",
     "Number of Invoke Nodes           ",
     "Number of Resolve Nodes          ",
     "Number of CheckInit Nodes        ",
@@ -1180,6 +1215,18 @@ CVMJITstatsDumpGlobalStats()
     CVMconsolePrintf("  Number of Compilations = %d\n",
                      gstats->numberOfCompilations);
 
+    /* Print the background compilation queue stats if it was used: */
+    if (gstats->numberOfQueuedCompilations > 0) {
+        CVMconsolePrintf("  Number of Queued Compilations = %d\n",
+                         gstats->numberOfQueuedCompilations);
+        CVMconsolePrintf("  Max Compile Queue Length = %d\n",
+                         gstats->maxCompileQueueLength);
+        CVMconsolePrintf("  Compile Queue Latency (ms) avg = %d max = %d\n",
+                         gstats->totalCompileQueueLatency /
+                         gstats->numberOfQueuedCompilations,
+                         gstats->maxCompileQueueLatency);
+    }
+
     /* Print the other stats: */
     sectionIndex = 0;
     section = &statsSections[0];
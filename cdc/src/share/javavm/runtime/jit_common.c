@@ -1414,6 +1414,11 @@ static const CVMSubOptionData knownJitSubOptions[] = {
      {{0, CVMJIT_MAX_INVOKE_COST, CVMJIT_DEFAULT_CLIMIT}},
      &CVMglobals.jit.compileThreshold},
 
+    {"asyncCompile", "Compile in a background thread", 
+     CVM_BOOLEAN_OPTION, 
+     {{CVM_FALSE, CVM_TRUE, CVM_FALSE}},
+     &CVMglobals.jit.asyncCompile},
+
     {"compile", "When to compile", 
      CVM_MULTI_STRING_OPTION, 
      {{CVMJIT_COMPILE_NUM_OPTIONS, 
@@ -3400,6 +3405,8 @@ CVMjitInit(CVMExecEnv* ee, CVMJITGlobalState* jgs,
 {
     jgs->compiling = CVM_FALSE;
     jgs->destroyed = CVM_FALSE;
+    jgs->compileQueueActive = CVM_FALSE;
+    jgs->compileQueueLength = 0;
 
     /*
      * Initialize any experimental options that we may not end up
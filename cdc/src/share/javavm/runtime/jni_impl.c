@@ -3032,10 +3032,11 @@ CVMjniInitializeDirectBufferSupport(JNIEnv* env)
     }
 
     /* Note that lookupDirectBufferClasses() does lookups on the NULL
-       classloader.  This means that it can lock the nullClassLoaderLock.
+       classloader, which may load classes and lock most other sysMutexes.
        Hence, we cannot use a sysMutex of higher rank than the
        nullClassLoaderLock to synchronize this initialization.  Hence,
-       the nullClassLoaderLock is used.
+       the nullClassLoaderLock is used.  Class loading itself never
+       holds it, so this does not block other threads' lookups.
     */
     CVMsysMutexLock(ee, &CVMglobals.nullClassLoaderLock);
 
@@ -3593,6 +3594,13 @@ initializeThreadObjects(JNIEnv* env)
 #define CVM_SPLIT_VERIFY_OPTIONS
 #endif
 
+#ifdef CVM_CLASS_ARCHIVE
+#define CVM_CLASS_ARCHIVE_OPTIONS \
+    "[-XclassArchive=<file> | -XclassArchiveDump=<file>] "
+#else
+#define CVM_CLASS_ARCHIVE_OPTIONS
+#endif
+
 #ifdef CVM_DEBUG
 #define CVM_DEBUG_OPTIONS "[-Xtrace:<val>] "
 #else
@@ -3645,6 +3653,7 @@ initializeThreadObjects(JNIEnv* env)
 	CVM_JAVA_ASSERTION_OPTIONS \
 	CVM_CLASSLOADING_OPTIONS \
 	CVM_SPLIT_VERIFY_OPTIONS \
+	CVM_CLASS_ARCHIVE_OPTIONS \
 	CVM_JVMTI_OPTIONS \
 	CVM_JVMPI_OPTIONS \
 	CVM_XRUN_OPTIONS \
@@ -4167,6 +4176,14 @@ JNI_CreateJavaVM(JavaVM **p_jvm, void **p_env, void *args)
 		errorNo = JNI_EINVAL;
 		goto done;
 	    }	    
+#endif
+#ifdef CVM_CLASS_ARCHIVE
+	} else if (!strncmp(str, "-XclassArchive=", 15)) {
+	    options.classArchiveStr = str + 15;
+	    options.classArchiveDump = CVM_FALSE;
+	} else if (!strncmp(str, "-XclassArchiveDump=", 19)) {
+	    options.classArchiveStr = str + 19;
+	    options.classArchiveDump = CVM_TRUE;
 #endif
 	}
         else if (!strncmp(str, "-Xbootclasspath=", 16) ||
@@ -4606,6 +4623,32 @@ JNI_CreateJavaVM(JavaVM **p_jvm, void **p_env, void *args)
     }
 #endif
     
+#ifdef CVM_JIT
+    /* Start the background compiler thread. Threads don't survive the
+       fork of an mTASK client, so the server compiles synchronously. */
+    if (CVMglobals.jit.asyncCompile
+#ifdef CVM_MTASK
+	&& !CVMglobals.isServer
+#endif
+	) {
+	jclass jitClass = (*env)->FindClass(env, "sun/misc/JIT");
+	if (jitClass != NULL) {
+	    jmethodID startID = (*env)->GetStaticMethodID(env, jitClass,
+		"startCompilerThread", "()V");
+	    if (startID != NULL) {
+		(*env)->CallStaticVoidMethod(env, jitClass, startID);
+	    }
+	    (*env)->DeleteLocalRef(env, jitClass);
+	}
+	if ((*env)->ExceptionCheck(env)) {
+	    (*env)->ExceptionDescribe(env);
+	    errorStr = "error starting the JIT compiler thread";
+	    errorNo = JNI_ERR;
+	    goto done;
+	}
+    }
+#endif
+
 #ifdef CVM_LVM /* %begin lvm */
     /* Finish-up the main LVM bootstrapping after the VM gets 
      * fully initialized */
@@ -5503,6 +5503,14 @@ jvmti_RedefineClasses(jvmtiEnv* jvmtienv,
 	 * Fixup all constant pools in other classes that point back to us 
 	 * as well as method table entries
 	 */
+        /*
+         * Class loading by the NULL classloader no longer holds the
+         * nullClassLoaderLock, so also wait for the threads that own
+         * class placeholders and keep new ones out.
+         */
+#ifdef CVM_CLASSLOADING
+        CVMclassPlaceholdersBlock(ee);
+#endif
         /* Roll all threads to safe points. */
         CVM_NULL_CLASSLOADER_LOCK(ee);
 #ifdef CVM_JIT
@@ -5597,6 +5605,9 @@ jvmti_RedefineClasses(jvmtiEnv* jvmtienv,
         CVMsysMutexUnlock(ee, &CVMglobals.jitLock);
 #endif
         CVM_NULL_CLASSLOADER_UNLOCK(ee);
+#ifdef CVM_CLASSLOADING
+        CVMclassPlaceholdersUnblock(ee);
+#endif
         CVMcpResolveCbEntriesWithoutClassLoading(ee, oldcb);
 
 #if 0
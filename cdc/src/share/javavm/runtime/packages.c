@@ -165,9 +165,9 @@ JVM_GetSystemPackage(JNIEnv *env, jstring str)
     const char* name = (*env)->GetStringUTFChars(env, str, 0);
     if (name != NULL) {
 	char* fn;
-	CVM_NULL_CLASSLOADER_LOCK(CVMjniEnv2ExecEnv(env));
+	CVM_PACKAGES_LOCK(CVMjniEnv2ExecEnv(env));
 	fn = CVMpackagesGetEntry(name);
-	CVM_NULL_CLASSLOADER_UNLOCK(CVMjniEnv2ExecEnv(env));
+	CVM_PACKAGES_UNLOCK(CVMjniEnv2ExecEnv(env));
 	(*env)->ReleaseStringUTFChars(env, str, name);
 	if (fn != 0) {
 	    return JNU_NewStringPlatform(env, fn);
@@ -191,13 +191,13 @@ JVM_GetSystemPackages(JNIEnv *env)
     /*
      * Get all of the package names in one char* array.
      */
-    CVM_NULL_CLASSLOADER_LOCK(CVMjniEnv2ExecEnv(env));
+    CVM_PACKAGES_LOCK(CVMjniEnv2ExecEnv(env));
     size = CVMglobals.numPackages;
     names = (char **)malloc(size * sizeof(char*));
     if (names != NULL) {
 	CVMpackagesGetNames(names, size);
     }
-    CVM_NULL_CLASSLOADER_UNLOCK(CVMjniEnv2ExecEnv(env));
+    CVM_PACKAGES_UNLOCK(CVMjniEnv2ExecEnv(env));
 
     if (names != NULL) {
 	jobjectArray result = NULL;
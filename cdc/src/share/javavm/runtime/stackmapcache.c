@@ -0,0 +1,607 @@
+/*
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ *
+ */
+
+/*
+ * The stackmap cache. See stackmapcache.h for the file format.
+ */
+
+#ifdef CVM_STACKMAP_CACHE
+
+#include "javavm/include/stackmapcache.h"
+#include "javavm/include/stackmaps.h"
+#include "javavm/include/classes.h"
+#include "javavm/include/globals.h"
+#include "javavm/include/preloader.h"
+#include "javavm/include/typeid.h"
+#include "javavm/include/utils.h"
+#include "javavm/include/jvmtiExport.h"
+#include "javavm/include/porting/io.h"
+#include "javavm/include/porting/doubleword.h"
+#include "javavm/include/porting/ansi/stdio.h"
+#include "javavm/include/porting/ansi/string.h"
+#include "javavm/include/porting/ansi/stdlib.h"
+
+#define CVM_SMCACHE_ALIGN(n)	(((n) + 3) & ~3)
+
+#define CVM_SMCACHE_NUM_BUCKETS		1021
+#define CVM_SMCACHE_NUM_CLASS_BUCKETS	251
+
+/* Record flags */
+#define CVM_SMCACHE_ROM			0x1
+#define CVM_SMCACHE_COND_GCPOINTS	0x2
+
+/*
+ * Stackmaps depend on how the method was disambiguated, which differs
+ * between builds with and without the JIT, and the file holds native
+ * pointers. Don't share files between such VMs.
+ */
+#ifdef CVM_JIT
+#define CVM_SMCACHE_CONFIG	((CVMUint32)sizeof(void*) | 0x100)
+#else
+#define CVM_SMCACHE_CONFIG	((CVMUint32)sizeof(void*))
+#endif
+
+struct CVMStackmapCacheRecord {
+    CVMUint32               flags;
+    CVMUint32               classKey;	/* class file hash, or typeid */
+    CVMUint32               classSize;	/* class file size, or 0 */
+    CVMUint32               methodIndex;
+    const char*             className;	/* "" for romized classes */
+    CVMUint32               mapsSize;
+    const CVMUint8*         maps;
+    CVMStackmapCacheRecord* next;
+};
+
+static CVMUint32
+smcacheHashBytes(CVMUint32 h, const CVMUint8* p, CVMUint32 len)
+{
+    while (len-- > 0) {
+	h = 31 * h + *p++;
+    }
+    return h;
+}
+
+static CVMUint32
+smcacheRecordHash(CVMUint32 flags, CVMUint32 classKey, CVMUint32 methodIndex)
+{
+    return (classKey * 31 + methodIndex) * 31 + flags;
+}
+
+static CVMStackmapCacheClass*
+smcacheFindClass(CVMStackmapCache* cache, CVMClassBlock* cb)
+{
+    CVMStackmapCacheClass* c;
+    CVMUint32 bucket = (CVMUint32)(((CVMAddr)cb >> 4) %
+				   cache->numClassBuckets);
+    for (c = cache->classBuckets[bucket]; c != NULL; c = c->next) {
+	if (c->cb == cb) {
+	    return c;
+	}
+    }
+    return NULL;
+}
+
+static CVMStackmapCacheRecord*
+smcacheFindRecord(CVMStackmapCache* cache, CVMUint32 flags,
+		  CVMUint32 classKey, CVMUint32 classSize,
+		  CVMUint32 methodIndex, const char* className)
+{
+    CVMStackmapCacheRecord* r;
+    CVMUint32 bucket = smcacheRecordHash(flags, classKey, methodIndex) %
+	cache->numBuckets;
+    for (r = cache->buckets[bucket]; r != NULL; r = r->next) {
+	if (r->flags == flags && r->classKey == classKey &&
+	    r->classSize == classSize && r->methodIndex == methodIndex &&
+	    strcmp(r->className, className) == 0) {
+	    return r;
+	}
+    }
+    return NULL;
+}
+
+static void
+smcacheEnterRecord(CVMStackmapCache* cache, CVMStackmapCacheRecord* r)
+{
+    CVMUint32 bucket = smcacheRecordHash(r->flags, r->classKey,
+					 r->methodIndex) % cache->numBuckets;
+    r->next = cache->buckets[bucket];
+    cache->buckets[bucket] = r;
+    cache->numRecords++;
+}
+
+/*
+ * Works out the key of the method's stackmaps. Returns CVM_FALSE if
+ * its stackmaps cannot be cached.
+ */
+static CVMBool
+smcacheGetKey(CVMStackmapCache* cache, CVMMethodBlock* mb,
+	      CVMBool doConditionalGcPoints, CVMUint32* flags,
+	      CVMUint32* classKey, CVMUint32* classSize,
+	      const char** className)
+{
+    CVMClassBlock* cb = CVMmbClassBlock(mb);
+
+#ifdef CVM_JVMTI
+    /* The agent may redefine or instrument methods behind our back */
+    if (CVMjvmtiIsEnabled()) {
+	return CVM_FALSE;
+    }
+#endif
+    *flags = doConditionalGcPoints ? CVM_SMCACHE_COND_GCPOINTS : 0;
+    if (CVMcbIsInROM(cb)) {
+	*flags |= CVM_SMCACHE_ROM;
+	*classKey = CVMcbClassName(cb);
+	*classSize = 0;
+	*className = "";
+    } else {
+	CVMStackmapCacheClass* c = smcacheFindClass(cache, cb);
+	if (c == NULL) {
+	    return CVM_FALSE;
+	}
+	*classKey = c->classHash;
+	*classSize = c->classSize;
+	*className = (const char*)(c + 1);
+    }
+    return CVM_TRUE;
+}
+
+/*
+ * Reads the next word of the file at *offset. Returns CVM_FALSE if the
+ * file ends before it.
+ */
+static CVMBool
+readWord(const CVMUint8* data, CVMUint32 size, CVMUint32* offset,
+	 CVMUint32* word)
+{
+    if (*offset > size || size - *offset < 4) {
+	return CVM_FALSE;
+    }
+    *word = *(const CVMUint32*)(data + *offset);
+    *offset += 4;
+    return CVM_TRUE;
+}
+
+static CVMUint8*
+smcacheReadFile(const char* fileName, CVMUint32* sizeRet)
+{
+    CVMInt32 fd;
+    CVMInt64 size64;
+    CVMUint32 size;
+    CVMUint8* data = NULL;
+
+    fd = CVMioOpen(fileName, O_RDONLY, 0);
+    if (fd < 0) {
+	return NULL;
+    }
+    if (CVMioFileSizeFD(fd, &size64) == 0) {
+	size = (CVMUint32)CVMlong2Int(size64);
+	if (size > 0) {
+	    data = (CVMUint8*)malloc(size);
+	}
+	if (data != NULL &&
+	    CVMioRead(fd, data, size) != (CVMInt32)size) {
+	    free(data);
+	    data = NULL;
+	}
+	*sizeRet = size;
+    }
+    CVMioClose(fd);
+    return data;
+}
+
+/*
+ * Enters the records of the file. Romized records are dropped if the
+ * ROM image has changed. A record cut short at the end of the file is
+ * ignored.
+ */
+static CVMBool
+smcacheLoad(CVMStackmapCache* cache)
+{
+    CVMUint32 size = 0;
+    CVMUint32 offset = 0;
+    CVMUint32 magic, version, config, romFingerprint;
+    CVMBool romValid;
+    CVMUint8* data;
+
+    data = smcacheReadFile(cache->fileName, &size);
+    if (data == NULL) {
+	return CVM_TRUE;
+    }
+    cache->fileData = data;
+
+    if (!readWord(data, size, &offset, &magic) ||
+	!readWord(data, size, &offset, &version) ||
+	!readWord(data, size, &offset, &config) ||
+	!readWord(data, size, &offset, &romFingerprint) ||
+	magic != CVM_STACKMAP_CACHE_MAGIC ||
+	version != CVM_STACKMAP_CACHE_VERSION ||
+	config != CVM_SMCACHE_CONFIG) {
+	CVMconsolePrintf("Stackmap cache %s not used: bad header\n",
+			 cache->fileName);
+	/* Rewrite it from scratch on exit */
+	cache->dirty = CVM_TRUE;
+	return CVM_TRUE;
+    }
+    romValid = (romFingerprint == CVM_ROMImageFingerprint);
+    if (!romValid) {
+	cache->dirty = CVM_TRUE;
+    }
+
+    for (;;) {
+	CVMUint32 flags, classKey, classSize, methodIndex;
+	CVMUint32 nameLength, mapsSize;
+	CVMStackmapCacheRecord* r;
+
+	if (!readWord(data, size, &offset, &flags) ||
+	    !readWord(data, size, &offset, &classKey) ||
+	    !readWord(data, size, &offset, &classSize) ||
+	    !readWord(data, size, &offset, &methodIndex) ||
+	    !readWord(data, size, &offset, &nameLength) ||
+	    !readWord(data, size, &offset, &mapsSize)) {
+	    break;
+	}
+	if (nameLength >= size || mapsSize >= size ||
+	    size - offset < CVM_SMCACHE_ALIGN(nameLength + 1) +
+	                    CVM_SMCACHE_ALIGN(mapsSize) ||
+	    data[offset + nameLength] != '\0' ||
+	    mapsSize < sizeof(CVMStackMaps)) {
+	    break;
+	}
+	if ((flags & CVM_SMCACHE_ROM) != 0 && !romValid) {
+	    offset += CVM_SMCACHE_ALIGN(nameLength + 1) +
+		      CVM_SMCACHE_ALIGN(mapsSize);
+	    continue;
+	}
+	r = (CVMStackmapCacheRecord*)malloc(sizeof(CVMStackmapCacheRecord));
+	if (r == NULL) {
+	    return CVM_FALSE;
+	}
+	r->flags = flags;
+	r->classKey = classKey;
+	r->classSize = classSize;
+	r->methodIndex = methodIndex;
+	/* The name is NUL terminated in the file */
+	r->className = (const char*)(data + offset);
+	offset += CVM_SMCACHE_ALIGN(nameLength + 1);
+	r->maps = data + offset;
+	r->mapsSize = mapsSize;
+	offset += CVM_SMCACHE_ALIGN(mapsSize);
+	smcacheEnterRecord(cache, r);
+    }
+    return CVM_TRUE;
+}
+
+CVMBool
+CVMstackmapCacheInit(const char* fileName)
+{
+    CVMStackmapCache* cache = &CVMglobals.stackmapCache;
+
+    if (fileName == NULL || cache->active) {
+	return CVM_TRUE;
+    }
+    cache->fileName = strdup(fileName);
+    cache->numBuckets = CVM_SMCACHE_NUM_BUCKETS;
+    cache->buckets = (CVMStackmapCacheRecord**)
+	calloc(cache->numBuckets, sizeof(CVMStackmapCacheRecord*));
+    cache->numClassBuckets = CVM_SMCACHE_NUM_CLASS_BUCKETS;
+    cache->classBuckets = (CVMStackmapCacheClass**)
+	calloc(cache->numClassBuckets, sizeof(CVMStackmapCacheClass*));
+    if (cache->fileName == NULL || cache->buckets == NULL ||
+	cache->classBuckets == NULL) {
+	return CVM_FALSE;
+    }
+    if (!smcacheLoad(cache)) {
+	return CVM_FALSE;
+    }
+    cache->active = CVM_TRUE;
+    return CVM_TRUE;
+}
+
+void
+CVMstackmapCacheClassCreated(CVMExecEnv* ee, CVMClassBlock* cb,
+			     const CVMUint8* classData, CVMUint32 classSize)
+{
+    CVMStackmapCache* cache = &CVMglobals.stackmapCache;
+    CVMStackmapCacheClass* c;
+    char* className;
+    size_t nameLength;
+    CVMUint32 bucket;
+
+    if (!cache->active) {
+	return;
+    }
+    className = CVMtypeidClassNameToAllocatedCString(CVMcbClassName(cb));
+    if (className == NULL) {
+	return;
+    }
+    /* Keep the name right behind the entry */
+    nameLength = strlen(className);
+    c = (CVMStackmapCacheClass*)
+	malloc(sizeof(CVMStackmapCacheClass) + nameLength + 1);
+    if (c == NULL) {
+	free(className);
+	return;
+    }
+    c->cb = cb;
+    c->classHash = smcacheHashBytes(0, classData, classSize);
+    c->classSize = classSize;
+    memcpy(c + 1, className, nameLength + 1);
+    free(className);
+
+    bucket = (CVMUint32)(((CVMAddr)cb >> 4) % cache->numClassBuckets);
+    CVMsysMutexLock(ee, &CVMglobals.stackmapCacheLock);
+    c->next = cache->classBuckets[bucket];
+    cache->classBuckets[bucket] = c;
+    CVMsysMutexUnlock(ee, &CVMglobals.stackmapCacheLock);
+}
+
+void
+CVMstackmapCacheClassFreed(CVMExecEnv* ee, CVMClassBlock* cb)
+{
+    CVMStackmapCache* cache = &CVMglobals.stackmapCache;
+    CVMStackmapCacheClass** prev;
+    CVMUint32 bucket;
+
+    if (!cache->active) {
+	return;
+    }
+    bucket = (CVMUint32)(((CVMAddr)cb >> 4) % cache->numClassBuckets);
+    CVMsysMutexLock(ee, &CVMglobals.stackmapCacheLock);
+    for (prev = &cache->classBuckets[bucket]; *prev != NULL;
+	 prev = &(*prev)->next) {
+	if ((*prev)->cb == cb) {
+	    CVMStackmapCacheClass* c = *prev;
+	    *prev = c->next;
+	    free(c);
+	    break;
+	}
+    }
+    CVMsysMutexUnlock(ee, &CVMglobals.stackmapCacheLock);
+}
+
+CVMStackMaps*
+CVMstackmapCacheLookup(CVMExecEnv* ee, CVMMethodBlock* mb,
+		       CVMBool doConditionalGcPoints)
+{
+    CVMStackmapCache* cache = &CVMglobals.stackmapCache;
+    CVMStackmapCacheRecord* r = NULL;
+    CVMStackMaps* maps = NULL;
+    CVMUint32 flags, classKey, classSize;
+    const char* className;
+
+    if (!cache->active) {
+	return NULL;
+    }
+    CVMsysMutexLock(ee, &CVMglobals.stackmapCacheLock);
+    if (smcacheGetKey(cache, mb, doConditionalGcPoints, &flags,
+		      &classKey, &classSize, &className)) {
+	r = smcacheFindRecord(cache, flags, classKey, classSize,
+			      CVMmbMethodIndex(mb), className);
+    }
+    if (r != NULL) {
+	maps = (CVMStackMaps*)malloc(r->mapsSize);
+	if (maps != NULL) {
+	    memcpy(maps, r->maps, r->mapsSize);
+	    maps->next = NULL;
+	    maps->prev = NULL;
+	    maps->mb = mb;
+	    if (maps->size != r->mapsSize ||
+		!CVMstackmapRebase(maps, mb, 0, (CVMAddr)maps)) {
+		/* Corrupt record. Compute the maps instead. */
+		free(maps);
+		maps = NULL;
+	    }
+	}
+    }
+    if (maps != NULL) {
+	cache->hits++;
+    } else {
+	cache->misses++;
+    }
+    CVMsysMutexUnlock(ee, &CVMglobals.stackmapCacheLock);
+    return maps;
+}
+
+void
+CVMstackmapCacheAdd(CVMExecEnv* ee, CVMMethodBlock* mb,
+		    CVMBool doConditionalGcPoints, CVMStackMaps* maps)
+{
+    CVMStackmapCache* cache = &CVMglobals.stackmapCache;
+    CVMUint32 flags, classKey, classSize;
+    const char* className;
+    CVMStackmapCacheRecord* r;
+    CVMUint8* p;
+    size_t nameSize;
+
+    if (!cache->active) {
+	return;
+    }
+    CVMsysMutexLock(ee, &CVMglobals.stackmapCacheLock);
+    if (!smcacheGetKey(cache, mb, doConditionalGcPoints, &flags,
+		       &classKey, &classSize, &className) ||
+	smcacheFindRecord(cache, flags, classKey, classSize,
+			  CVMmbMethodIndex(mb), className) != NULL) {
+	goto done;
+    }
+    /* Keep the name and maps right behind the record */
+    nameSize = strlen(className) + 1;
+    r = (CVMStackmapCacheRecord*)
+	malloc(sizeof(CVMStackmapCacheRecord) + nameSize + maps->size);
+    if (r == NULL) {
+	goto done;
+    }
+    p = (CVMUint8*)(r + 1);
+    memcpy(p, className, nameSize);
+    r->className = (const char*)p;
+    p += nameSize;
+    memcpy(p, maps, maps->size);
+    if (!CVMstackmapRebase((CVMStackMaps*)p, mb, (CVMAddr)maps, 0)) {
+	free(r);
+	goto done;
+    }
+    r->maps = p;
+    r->mapsSize = maps->size;
+    r->flags = flags;
+    r->classKey = classKey;
+    r->classSize = classSize;
+    r->methodIndex = CVMmbMethodIndex(mb);
+    smcacheEnterRecord(cache, r);
+    cache->dirty = CVM_TRUE;
+ done:
+    CVMsysMutexUnlock(ee, &CVMglobals.stackmapCacheLock);
+}
+
+/*
+ * Writes len bytes followed by padding to the file.
+ */
+static CVMBool
+writePadded(CVMInt32 fd, const void* buf, CVMUint32 len)
+{
+    static const CVMUint8 zeros[4] = {0, 0, 0, 0};
+    CVMUint32 pad = CVM_SMCACHE_ALIGN(len) - len;
+    return CVMioWrite(fd, buf, len) == (CVMInt32)len &&
+	(pad == 0 || CVMioWrite(fd, zeros, pad) == (CVMInt32)pad);
+}
+
+static CVMBool
+smcacheWriteRecords(CVMStackmapCache* cache, CVMInt32 fd)
+{
+    CVMUint32 header[4];
+    CVMUint32 i;
+
+    header[0] = CVM_STACKMAP_CACHE_MAGIC;
+    header[1] = CVM_STACKMAP_CACHE_VERSION;
+    header[2] = CVM_SMCACHE_CONFIG;
+    header[3] = CVM_ROMImageFingerprint;
+    if (!writePadded(fd, header, sizeof(header))) {
+	return CVM_FALSE;
+    }
+    for (i = 0; i < cache->numBuckets; i++) {
+	CVMStackmapCacheRecord* r;
+	for (r = cache->buckets[i]; r != NULL; r = r->next) {
+	    CVMUint32 words[6];
+	    words[0] = r->flags;
+	    words[1] = r->classKey;
+	    words[2] = r->classSize;
+	    words[3] = r->methodIndex;
+	    words[4] = (CVMUint32)strlen(r->className);
+	    words[5] = r->mapsSize;
+	    if (!writePadded(fd, words, sizeof(words)) ||
+		!writePadded(fd, r->className, words[4] + 1) ||
+		!writePadded(fd, r->maps, r->mapsSize)) {
+		return CVM_FALSE;
+	    }
+	}
+    }
+    return CVM_TRUE;
+}
+
+void
+CVMstackmapCacheWrite(CVMExecEnv* ee)
+{
+    CVMStackmapCache* cache = &CVMglobals.stackmapCache;
+    char* tmpName;
+    CVMInt32 fd;
+    CVMBool success;
+
+    if (!cache->active) {
+	return;
+    }
+    CVMsysMutexLock(ee, &CVMglobals.stackmapCacheLock);
+    if (!cache->dirty) {
+	goto done;
+    }
+    /*
+     * Write to a temporary file and rename it, so that VMs starting up
+     * meanwhile never see a partially written file.
+     */
+    tmpName = (char*)malloc(strlen(cache->fileName) + 5);
+    if (tmpName == NULL) {
+	goto done;
+    }
+    strcpy(tmpName, cache->fileName);
+    strcat(tmpName, ".tmp");
+    fd = CVMioOpen(tmpName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+	CVMconsolePrintf("Cannot write stackmap cache %s\n", tmpName);
+	free(tmpName);
+	goto done;
+    }
+    success = smcacheWriteRecords(cache, fd);
+    CVMioClose(fd);
+    if (success && rename(tmpName, cache->fileName) == 0) {
+	cache->dirty = CVM_FALSE;
+    } else {
+	CVMconsolePrintf("Cannot write stackmap cache %s\n",
+			 cache->fileName);
+	remove(tmpName);
+    }
+    free(tmpName);
+ done:
+    CVMsysMutexUnlock(ee, &CVMglobals.stackmapCacheLock);
+}
+
+void
+CVMstackmapCacheDestroy()
+{
+    CVMStackmapCache* cache = &CVMglobals.stackmapCache;
+    CVMUint32 i;
+
+    cache->active = CVM_FALSE;
+    if (cache->buckets != NULL) {
+	for (i = 0; i < cache->numBuckets; i++) {
+	    CVMStackmapCacheRecord* r = cache->buckets[i];
+	    while (r != NULL) {
+		CVMStackmapCacheRecord* next = r->next;
+		free(r);
+		r = next;
+	    }
+	}
+	free(cache->buckets);
+	cache->buckets = NULL;
+    }
+    if (cache->classBuckets != NULL) {
+	for (i = 0; i < cache->numClassBuckets; i++) {
+	    CVMStackmapCacheClass* c = cache->classBuckets[i];
+	    while (c != NULL) {
+		CVMStackmapCacheClass* next = c->next;
+		free(c);
+		c = next;
+	    }
+	}
+	free(cache->classBuckets);
+	cache->classBuckets = NULL;
+    }
+    if (cache->fileData != NULL) {
+	free(cache->fileData);
+	cache->fileData = NULL;
+    }
+    if (cache->fileName != NULL) {
+	free(cache->fileName);
+	cache->fileName = NULL;
+    }
+}
+
+#endif /* CVM_STACKMAP_CACHE */
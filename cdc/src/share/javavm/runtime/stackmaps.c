@@ -36,6 +36,9 @@
 #include "javavm/include/opcodes.h"
 #include "javavm/include/globals.h"
 #include "javavm/include/stackmaps.h"
+#ifdef CVM_STACKMAP_CACHE
+#include "javavm/include/stackmapcache.h"
+#endif
 #include "javavm/include/indirectmem.h"
 
 #ifdef CVM_JIT
@@ -3791,6 +3794,75 @@ doStatistics(CVMStackmapContext *c)
     */
 }
 
+#ifdef CVM_STACKMAP_CACHE
+/*
+ * Moves the internal pointers of the stackmaps from an image based at
+ * 'from' to one based at 'to'. The stackmap cache stores the maps with
+ * a base of 0, i.e. with offsets in place of the pointers. Since the
+ * image may come from a file, everything is bounds checked against
+ * 'mb' first.
+ */
+CVMBool
+CVMstackmapRebase(CVMStackMaps* maps, CVMMethodBlock* mb,
+		  CVMAddr from, CVMAddr to)
+{
+    CVMJavaMethodDescriptor* jmd = CVMmbJmd(mb);
+    CVMStackMapSuperExtendedMaps** seMapsPtr;
+    CVMStackMapSuperExtendedMaps* seMaps;
+    CVMUint32 basicSize;
+    CVMAddr seOffset;
+    CVMUint32 i;
+
+    if (maps->noGcPoints > CVMjmdCodeLength(jmd)) {
+	return CVM_FALSE;
+    }
+    basicSize = (CVMUint8*)&maps->smEntries[maps->noGcPoints] -
+	(CVMUint8*)maps;
+    if (basicSize > maps->size) {
+	return CVM_FALSE;
+    }
+    for (i = 0; i < maps->noGcPoints; i++) {
+	if (maps->smEntries[i].pc >= CVMjmdCodeLength(jmd)) {
+	    return CVM_FALSE;
+	}
+    }
+    if (CVMjmdMaxLocals(jmd) + CVMjmdMaxStack(jmd) <=
+	CVM_STACKMAP_ENTRY_NUMBER_OF_BASIC_BITS) {
+	/* No extended region, hence no pointers */
+	return CVM_TRUE;
+    }
+    if (maps->size - basicSize < sizeof(CVMStackMapSuperExtendedMaps*)) {
+	return CVM_FALSE;
+    }
+    seMapsPtr = (CVMStackMapSuperExtendedMaps**)
+	&maps->smEntries[maps->noGcPoints];
+    if (*seMapsPtr == NULL) {
+	return CVM_TRUE;
+    }
+    seOffset = (CVMAddr)*seMapsPtr - from;
+    if (seOffset < basicSize + sizeof(CVMStackMapSuperExtendedMaps*) ||
+	seOffset != CVMalignWordUp(seOffset) ||
+	seOffset > maps->size - sizeof(CVMStackMapSuperExtendedMaps)) {
+	return CVM_FALSE;
+    }
+    seMaps = (CVMStackMapSuperExtendedMaps*)((CVMUint8*)maps + seOffset);
+    if (seMaps->numberOfEntries >
+	(maps->size - seOffset) / sizeof(CVMStackMapEntry*)) {
+	return CVM_FALSE;
+    }
+    for (i = 0; i < seMaps->numberOfEntries; i++) {
+	CVMAddr entryOffset = (CVMAddr)seMaps->entries[i] - from;
+	if (entryOffset < basicSize ||
+	    entryOffset > maps->size - sizeof(CVMStackMapEntry)) {
+	    return CVM_FALSE;
+	}
+	seMaps->entries[i] = (CVMStackMapEntry*)(entryOffset + to);
+    }
+    *seMapsPtr = (CVMStackMapSuperExtendedMaps*)(seOffset + to);
+    return CVM_TRUE;
+}
+#endif
+
 /*
  * Compute stackmaps 
  */
@@ -3802,6 +3874,16 @@ CVMstackmapCompute(CVMExecEnv* ee, CVMMethodBlock* mb,
     CVMBool 	       needRewritePass;
     CVMStackMaps *maps;
 
+#ifdef CVM_STACKMAP_CACHE
+    maps = CVMstackmapCacheLookup(ee, mb, doConditionalGcPoints);
+    if (maps != NULL) {
+	CVMtraceStackmaps(("Stackmaps for %C.%M found in cache\n",
+			   CVMmbClassBlock(mb), mb));
+	CVMstackmapAddToGlobalList(ee, maps);
+	return maps;
+    }
+#endif
+
     /*
      * Assume method is properly disambiguated.
      * so just go for it.
@@ -3834,6 +3916,10 @@ CVMstackmapCompute(CVMExecEnv* ee, CVMMethodBlock* mb,
     CVMstackmapAddToGlobalList(ee, maps);
     c.stackMaps = 0;
     CVMstackmapDestroyContext(&c);
+    CVMglobals.gcCommon.stackMapsComputed++;
+#ifdef CVM_STACKMAP_CACHE
+    CVMstackmapCacheAdd(ee, mb, doConditionalGcPoints, maps);
+#endif
 
     return maps;
 }
@@ -169,6 +169,10 @@ CVMInternValidateSegment( struct CVMInternSegment * segp, CVMBool verbose ) {
 	CVMconsolePrintf("Intern segment 0x%x->load == %d, should be %d\n",
 	    segp->load, ( nSticky+nDeleted+nNoRef+nRef ) );
     }
+    if ( segp->live != ( nSticky+nNoRef+nRef ) ){
+	CVMconsolePrintf("Intern segment 0x%x->live == %d, should be %d\n",
+	    segp, segp->live, ( nSticky+nNoRef+nRef ) );
+    }
     if ( nBad != 0 ){
 	CVMconsolePrintf("Intern segment 0x%x has %d bad cells\n", segp, nBad );
     }
@@ -330,6 +334,114 @@ internUTFConsume( CVMExecEnv* ee,  CVMStringICell * stringCell, CVMUint8 * refCe
  *	that class UNloading will cause these to be decremented.
  */
 
+/* calculate hash code.
+ * This is similar to the one in java.lang.String, but this
+ * is just a coincidence. Make sure that the ROMizer uses the
+ * same one! (in order to make this easier, we will mask off
+ * the high order bit.)
+ */
+static CVMUint32
+internHash( CVMJavaChar buffer[], CVMSize bufferLength ){
+    CVMUint32	h = 0;
+    CVMSize	i, n;
+
+    n = MIN(bufferLength, MAX_HASH_LENGTH);
+    for ( i = 0; i < n; i++ ){
+	h = (h*37) + buffer[i];
+    }
+    return h & ~0x80000000;
+}
+
+/*
+ * Look for a string in the table without taking the internLock.
+ * This is the common case for programs that intern the same few
+ * strings over and over again, and for the class loader resolving
+ * ROMized constants.
+ *
+ * MUST BE CALLED GC-UNSAFE. That keeps the GC from deleting or moving
+ * entries under us, so the only thing that can change while we look
+ * is an insertion by a thread holding the internLock. An insertion
+ * only ever turns an unused or deleted slot into a used one, and
+ * appends a segment only after it is fully set up, so any match we
+ * find is real. A miss is not conclusive, and the caller must go on
+ * to internInner. To bound the time spent gc-unsafe, only strings
+ * that fit in the prefix buffer are looked up here.
+ *
+ * If stickyOnly is set, only sticky entries are matched. The class
+ * loader needs that, as it cannot bump a reference count without
+ * the lock.
+ *
+ * Returns the matching cell, or NULL.
+ */
+static CVMStringICell *
+internLookupUnsafe(
+    CVMExecEnv *	ee,
+    CVMJavaChar 	buffer[],
+    CVMSize		length,
+    CVMUint32		h,
+    CVMBool		stickyOnly
+){
+    CVMUint32		h1 = (h&15)+1;
+    CVMSize		i, j, capacity;
+    CVMUint8		refCount;
+    CVMUint8*		refArray;
+    CVMInternSegment*	curSeg;
+    CVMJavaChar		candidateData[PREFIX_BUFFER_SIZE];
+
+    CVMassert( CVMD_isgcUnsafe(ee) );
+    CVMassert( length <= PREFIX_BUFFER_SIZE );
+
+    curSeg = (CVMInternSegment*)&CVMInternTable; /* cast away const */
+    do {
+	capacity = curSeg->capacity;
+	refArray = CVMInternRefCount(curSeg);
+	i = h % capacity;
+
+	while ( (refCount=refArray[i]) != CVMInternUnused ){
+	    if ( refCount != CVMInternDeleted &&
+		 ( !stickyOnly || refCount == CVMInternSticky ) ){
+		CVMObject *	stringDirect;
+		CVMObject *	theChars;
+		CVMJavaInt	candidateLength;
+		CVMJavaInt	offset;
+
+		/* NULL if the slot is still being filled in */
+		stringDirect = CVMID_icellDirect(ee, &curSeg->data[i]);
+		if ( stringDirect != NULL ){
+		    CVMD_fieldReadInt( stringDirect,
+			CVMoffsetOfjava_lang_String_count,
+			candidateLength );
+		    if ( candidateLength == length ){
+			CVMD_fieldReadInt( stringDirect,
+			    CVMoffsetOfjava_lang_String_offset,
+			    offset );
+			CVMD_fieldReadRef( stringDirect,
+			    CVMoffsetOfjava_lang_String_value,
+			    theChars );
+			if ( length > 0 ){
+			    CVMD_arrayReadBodyChar( candidateData,
+				(CVMArrayOfChar*)theChars, offset, length );
+			}
+			for ( j = 0; j < length; j++ ){
+			    if ( candidateData[j] != buffer[j] )
+				break;
+			}
+			if ( j == length ){
+			    return &curSeg->data[i];
+			}
+		    }
+		}
+	    }
+	    i += h1;
+	    if ( i >= capacity )
+		i -= capacity;
+	}
+	curSeg = CVMInternNext(curSeg);
+    } while ( curSeg != NULL );
+
+    return NULL;
+}
+
 
 static void
 internInner(
@@ -344,7 +456,7 @@ internInner(
 ){
 
     CVMUint32		h, h1;
-    CVMSize 		i, j, n;
+    CVMSize 		i, j;
     CVMSize		slotWithOpening=0;
     CVMSize		capacity;
     CVMUint8		refCount;
@@ -355,18 +467,7 @@ internInner(
     CVMStringICell  *	candidate;
 
 
-    /* calculate hash code.
-     * This is similar to the one in java.lang.String, but this
-     * is just a coincidence. Make sure that the ROMizer uses the
-     * same one! (in order to make this easier, we will mask off
-     * the high order bit.)
-     */
-    n = MIN(bufferLength, MAX_HASH_LENGTH);
-    h = 0;
-    for ( i = 0; i < n; i++ ){
-	h = (h*37) + buffer[i];
-    }
-    h &= ~0x80000000;
+    h = internHash( buffer, bufferLength );
     h1 = (h&15)+1;
 
     /*
@@ -467,13 +568,19 @@ internInner(
 	/* insert in current segment */
 	if ( curSeg->load > curSeg->maxLoad ){
 	    CVMInternSegment * newSeg;
-	    if ( (CVMInternNext(curSeg) = newSeg = allocateNewSegment()) == NULL ){
+	    if ( (newSeg = allocateNewSegment()) == NULL ){
 		/*
 		 * running out of memory. fail here by returning NULL
 		 */
 		candidate = NULL;
 		goto failure;
 	    }
+	    /*
+	     * Lock-free readers may follow the link as soon as it
+	     * is stored, so make sure they see an initialized segment.
+	     */
+	    CVM_MEM_BARRIER();
+	    CVMInternNext(curSeg) = newSeg;
 	    curSeg = newSeg;
 	    i = h % curSeg->capacity;
 	}
@@ -493,6 +600,7 @@ internInner(
      * incrementRefcount == TRUE, then we increment it in 'found:'.
      */
     CVMInternRefCount(curSeg)[i] = 0;
+    curSeg->live += 1;
     candidate = &(curSeg->data[i]);
 
     (*produce)( ee, candidate, callbackData );
@@ -531,6 +639,7 @@ allocateNewSegment(){
     if ( seg == NULL ) return NULL;
     seg->capacity = (CVMUint32)dataSize;
     seg->load  = 0;
+    seg->live  = 0;
     /*
      * make sure maxLoad is even on dynamically allocated
      * segments.
@@ -584,6 +693,7 @@ CVMstringIntern(JNIEnv *env, jstring thisString){
     d.result = NULL;
     CVMID_localrootBegin( ee );{
 	CVMID_localrootDeclare( CVMArrayOfCharICell, body );
+	CVMID_localrootDeclare( CVMStringICell, found );
 	d.srcString = (CVMStringICell*)thisString;
 	d.body = body;
 	CVMD_gcUnsafeExec(ee,{
@@ -603,6 +713,16 @@ CVMstringIntern(JNIEnv *env, jstring thisString){
 	    d.bufferLength = MIN(d.length, PREFIX_BUFFER_SIZE);
 	    if ( d.bufferLength > 0 )
 		CVMD_arrayReadBodyChar( d.buffer, (CVMArrayOfChar*)theChars, d.offset, d.bufferLength );
+	    /* try the lock-free lookup while we are gc-unsafe anyway */
+	    if ( d.length <= PREFIX_BUFFER_SIZE ){
+		CVMStringICell * cell;
+		cell = internLookupUnsafe( ee, d.buffer, d.bufferLength,
+			internHash( d.buffer, d.bufferLength ), CVM_FALSE );
+		if ( cell != NULL ){
+		    CVMID_icellSetDirect( ee, found,
+			CVMID_icellDirect( ee, cell ) );
+		}
+	    }
 	});
 
 	/*DEBUG
@@ -616,11 +736,18 @@ CVMstringIntern(JNIEnv *env, jstring thisString){
 	     }
 	*/
 
-	/*
-	 * need the local root to the char array live across this call.
-	 */
-	internInner( ee,  d.buffer, d.bufferLength, d.length,
+	if ( !CVMID_icellIsNull( found ) ){
+	    d.result = (*env)->NewLocalRef( env, (jobject)found );
+	    if ( !CVMglobals.gcCommon.stringInternedSinceLastGC ){
+		CVMglobals.gcCommon.stringInternedSinceLastGC = CVM_TRUE;
+	    }
+	} else {
+	    /*
+	     * need the local root to the char array live across this call.
+	     */
+	    internInner( ee,  d.buffer, d.bufferLength, d.length,
 			internJavaCompare, internJavaProduce, internJavaConsume, &d );
+	}
     } CVMID_localrootEnd();
     /*DEBUG CVMconsolePrintf("... at cell %x\n", d.result );*/
     /*
@@ -706,6 +833,8 @@ internJavaCompare( CVMExecEnv* ee,  CVMStringICell * candidate, void * stuff){
 static CVMBool
 internJavaProduce( CVMExecEnv *ee, CVMStringICell * target, void * stuff ){
     struct stringInternData* dp = (struct stringInternData *)stuff;
+    /* make the String visible before lock-free readers can find it */
+    CVM_MEM_BARRIER();
     CVMID_icellAssign( ee, target, dp->srcString );
     return CVM_TRUE;
 }
@@ -756,6 +885,24 @@ CVMinternUTF(
     d.srcPosition = CVMutfCountedCopyIntoCharArray( src, d.buffer, d.bufferLength );
     d.result = NULL;
 
+    /*
+     * Most constant pool strings are ROMized and hence sticky, which
+     * means we can hand out their cell without taking the lock or
+     * allocating the String we would need for an insertion.
+     */
+    if ( d.targetLength <= PREFIX_BUFFER_SIZE ){
+	CVMD_gcUnsafeExec(ee, {
+	    d.result = internLookupUnsafe( ee, d.buffer, d.bufferLength,
+			internHash( d.buffer, d.bufferLength ), CVM_TRUE );
+	});
+	if ( d.result != NULL ){
+	    if ( !CVMglobals.gcCommon.stringInternedSinceLastGC ){
+		CVMglobals.gcCommon.stringInternedSinceLastGC = CVM_TRUE;
+	    }
+	    return d.result;
+	}
+    }
+
     /*DEBUG
       {
      	char printbuffer[ PREFIX_BUFFER_SIZE+1 ];
@@ -927,8 +1074,10 @@ internUTFProduce( CVMExecEnv *ee, CVMStringICell * target, void * stuff ){
     }
     /*
      * Finally, assign reference to the String object to the
-     * result location.
+     * result location. Lock-free readers may find it as soon as
+     * it is stored, so make sure they see all of the String first.
      */
+    CVM_MEM_BARRIER();
     CVMID_icellAssign( ee, target, dp->allocatedString );
 
     return CVM_TRUE;
@@ -1013,14 +1162,17 @@ CVMscanInternedStrings( CVMRefCallbackFunc func, void * data ){
     while ( thisSeg != NULL ){
 	int i;
 	int thisSegCapacity = thisSeg->capacity;
+	CVMUint32 liveLeft = thisSeg->live;
 	CVMUint8 * refArray = CVMInternRefCount( thisSeg );
-	for ( i=0 ; i < thisSegCapacity ; i ++ ){
+	/* stop as soon as we have seen all the live cells */
+	for ( i=0 ; liveLeft > 0 && i < thisSegCapacity ; i ++ ){
 	    CVMStringICell * cellp;
 	    switch ( refArray[i] ){
 	    case CVMInternUnused:
 	    case CVMInternDeleted:
 		continue;
 	    }
+	    liveLeft -= 1;
 	    cellp = &(thisSeg->data[i]);
 	    CVMassert( !CVMID_icellIsNull( cellp ) );
 	    /* here for sticky, 0 and none of the above non-zero */
@@ -1063,14 +1215,20 @@ CVMinternProcessNonStrong(CVMRefLivenessQueryFunc isLive,
     while ( thisSeg != NULL ){
 	int i;
 	int thisSegCapacity = thisSeg->capacity;
+	CVMUint32 liveLeft = thisSeg->live;
 	CVMUint8 * refArray = CVMInternRefCount( thisSeg );
-	for ( i=0 ; i < thisSegCapacity ; i ++ ){
+	/* stop as soon as we have seen all the live cells */
+	for ( i=0 ; liveLeft > 0 && i < thisSegCapacity ; i ++ ){
 	    CVMStringICell * cellp;
+	    switch ( refArray[i] ){
+	    case CVMInternUnused:
+	    case CVMInternDeleted:
+		continue;
+	    }
+	    liveLeft -= 1;
 	    if ( refArray[i] != 0 ){
 		/*
-		 * already deleted,
-		 * or still unused,
-		 * or sticky
+		 * sticky
 		 * or having a non-zero ref count so we know
 		 * they're live
 		 */
@@ -1084,6 +1242,7 @@ CVMinternProcessNonStrong(CVMRefLivenessQueryFunc isLive,
 		/*  DEAD cell in the table. Delete it */
 		refArray[i] = CVMInternDeleted;
 		CVMID_icellSetNull( cellp );
+		thisSeg->live -= 1;
 	    }
 	}
 	thisSeg = CVMInternNext(thisSeg);
@@ -84,7 +84,15 @@ static struct idstat{
     int nMethodFormsDeleted;
     int nMethodDetailsAdded;
     int nMethodDetailsDeleted;
-}idstat = {0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+    int nTypeLocks;
+    int nTypeLocksContended;
+    int nNameLocks;
+    int nNameLocksContended;
+    int nClassLookups;
+    int nClassProbes;
+    int nNameLookups;
+    int nNameProbes;
+}idstat = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
 static const char * const idstatName[] = {
     "member names added:",
@@ -101,6 +109,14 @@ static const char * const idstatName[] = {
     "           deleted:",
     " sig details added:",
     "           deleted:",
+    "  typeid lock taken:",
+    "       contended:",
+    "    name lock taken:",
+    "       contended:",
+    "     class lookups:",
+    "      chain probes:",
+    "      name lookups:",
+    "      chain probes:",
     NULL
 };
 
@@ -115,8 +131,46 @@ void CVMtypeidPrintStats(){
     memset( &idstat, 0, sizeof(idstat));
 }
 
+/*
+ * Count how often the typeid locks are taken and how often
+ * another thread holds them at that time.
+ */
+static void
+lockCounted( CVMExecEnv *ee, CVMSysMutex *m, int *nLocks, int *nContended ){
+    if ( !CVMsysMutexTryLock(ee, m) ){
+	CVMsysMutexLock(ee, m);
+	*nContended += 1;
+    }
+    *nLocks += 1;
+}
+
 #endif
 
+/*
+ * The tables are protected by two locks. The member name table has
+ * its own typeidMemberNameLock, so that method and field lookups by
+ * name don't wait for class and signature table updates. All other
+ * tables are protected by the typeidLock. Code that needs both takes
+ * the typeidLock first.
+ */
+#ifdef CVM_DEBUG
+#define TYPEID_LOCK(ee) \
+    lockCounted(ee, &CVMglobals.typeidLock, \
+		&idstat.nTypeLocks, &idstat.nTypeLocksContended)
+#define MEMBERNAME_LOCK(ee) \
+    lockCounted(ee, &CVMglobals.typeidMemberNameLock, \
+		&idstat.nNameLocks, &idstat.nNameLocksContended)
+#else
+#define TYPEID_LOCK(ee) \
+    CVMsysMutexLock(ee, &CVMglobals.typeidLock)
+#define MEMBERNAME_LOCK(ee) \
+    CVMsysMutexLock(ee, &CVMglobals.typeidMemberNameLock)
+#endif
+#define TYPEID_UNLOCK(ee) \
+    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock)
+#define MEMBERNAME_UNLOCK(ee) \
+    CVMsysMutexUnlock(ee, &CVMglobals.typeidMemberNameLock)
+
 static void deletePackage( struct pkg * );
 static int getSignatureInfo( struct methodTypeTableEntry *mp, CVMUint32 **formp, CVMTypeIDTypePart** detailp );
 
@@ -127,52 +181,62 @@ static int getSignatureInfo( struct methodTypeTableEntry *mp, CVMUint32 **formp,
 #define INITIAL_SEGMENT_SIZE	1000
 
 #define ASSERT_LOCKED CVMassert(CVMreentrantMutexIAmOwner( (CVMgetEE()),  CVMsysMutexGetReentrantMutex(&CVMglobals.typeidLock)))
+#define ASSERT_MEMBERNAME_LOCKED CVMassert(CVMreentrantMutexIAmOwner( (CVMgetEE()),  CVMsysMutexGetReentrantMutex(&CVMglobals.typeidMemberNameLock)))
 
 /*
  * If we run out of memory or of table space, we want to throw an exception.
- * However, this can only be done with the typeidLock unlocked. Bracket the
+ * However, this can only be done with the typeid locks unlocked. Bracket the
  * throwing by conditional unlock/lock calls. They will usually be necessary.
  * (Also, since these errors seldom occur, we won't bother passing ee around just
  * for this case, but instead fetch it: locally more expensive, globally cheaper.)
  * OBVIOUSLY, make sure that the table is in a consistent state before unlocking!
  */
+static CVMUint32
+unlockTypeidLocks( CVMExecEnv * ee ){
+    CVMUint32 owned = 0;
+    if ( CVMsysMutexIAmOwner(ee, &CVMglobals.typeidMemberNameLock ) ){
+	MEMBERNAME_UNLOCK(ee);
+	owned |= 2;
+    }
+    if ( CVMsysMutexIAmOwner(ee, &CVMglobals.typeidLock ) ){
+	TYPEID_UNLOCK(ee);
+	owned |= 1;
+    }
+    return owned;
+}
+
+static void
+relockTypeidLocks( CVMExecEnv * ee, CVMUint32 owned ){
+    if ( owned & 1 ){
+	TYPEID_LOCK(ee);
+    }
+    if ( owned & 2 ){
+	MEMBERNAME_LOCK(ee);
+    }
+}
+
 static void
 unlockThrowInternalError( const char * msg ){
     CVMExecEnv * ee   = CVMgetEE();
-    CVMBool lockOwner = CVMsysMutexIAmOwner(ee, &CVMglobals.typeidLock );
-    if ( lockOwner ){
-	CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
-    }
+    CVMUint32 owned = unlockTypeidLocks( ee );
     CVMthrowInternalError( ee, msg );
-    if ( lockOwner ){
-	CVMsysMutexLock(ee, &CVMglobals.typeidLock );
-    }
+    relockTypeidLocks( ee, owned );
 }
 
 static void
 unlockThrowOutOfMemoryError(){
     CVMExecEnv * ee   = CVMgetEE();
-    CVMBool lockOwner = CVMsysMutexIAmOwner(ee, &CVMglobals.typeidLock );
-    if ( lockOwner ){
-	CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
-    }
+    CVMUint32 owned = unlockTypeidLocks( ee );
     CVMthrowOutOfMemoryError( ee, NULL );
-    if ( lockOwner ){
-	CVMsysMutexLock(ee, &CVMglobals.typeidLock );
-    }
+    relockTypeidLocks( ee, owned );
 }
 
 static void
 unlockThrowNoClassDefFoundError(const char * name) {
     CVMExecEnv * ee = CVMgetEE();
-    CVMBool lockOwner = CVMsysMutexIAmOwner(ee, &CVMglobals.typeidLock );
-    if ( lockOwner ) {
-        CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
-    }
+    CVMUint32 owned = unlockTypeidLocks( ee );
     CVMthrowNoClassDefFoundError( ee, name);
-    if ( lockOwner) {
-        CVMsysMutexLock(ee, &CVMglobals.typeidLock );
-    }
+    relockTypeidLocks( ee, owned );
 }
 
 /*
@@ -626,7 +690,13 @@ findFreeTableEntry(
     size_t			 allocationSize;
     size_t			 newIndexVal;
 
-    ASSERT_LOCKED;
+#ifdef CVM_DEBUG_ASSERTS
+    if ( initialSeg == (struct genericTableSegment *)&CVMMemberNames ){
+	ASSERT_MEMBERNAME_LOCKED;
+    } else {
+	ASSERT_LOCKED;
+    }
+#endif
     do{
 	thisSeg = nextSeg;
 #ifdef NO_RECYCLE
@@ -1357,7 +1427,7 @@ deleteMemberEntry(
      */
     unsigned 	hashVal = computeHash( thisEntry->name, (int)strlen(thisEntry->name) ) % NMEMBERNAMEHASH;
     CVMTypeIDNamePart * pCell = &CVMMemberNameHash[ hashVal ];
-    ASSERT_LOCKED;
+    ASSERT_MEMBERNAME_LOCKED;
     CVMtraceTypeID(("Typeid: Deleting member name %s\n", thisEntry->name));
     unlinkEntry( thisCookie, thisEntry->nextIndex,
 	    pCell, 
@@ -1390,8 +1460,14 @@ referenceMemberName(
     CVMTypeIDNamePart	thisIndex;
     struct memberName * thisName = NULL;
 
+#ifdef CVM_DEBUG
+    idstat.nNameLookups++;
+#endif
     for ( thisIndex = *hashbucket; thisIndex != TYPEID_NOENTRY; thisIndex = thisName->nextIndex ){
 	const char * namestring;
+#ifdef CVM_DEBUG
+	idstat.nNameProbes++;
+#endif
 	thisName = indexMemberName( thisIndex , NULL);
 	namestring = thisName->name;
 	/* Assert that we don't have a race with a client deleting the
@@ -1415,7 +1491,7 @@ referenceMemberName(
 	    CVMFieldTypeID freeEntry;
 	    char * newname;
 	    size_t namelength = strlen(name);
-	    ASSERT_LOCKED;
+	    ASSERT_MEMBERNAME_LOCKED;
 	    thisName = findFreeMemberEntry( &freeEntry );
 	    newname = (char *)malloc( namelength+1 );
 	    if ( (thisName==NULL) || (newname==NULL) ){
@@ -1471,14 +1547,14 @@ CVMtypeidNewMembername( CVMExecEnv * ee, const char * name ){
     CVMTypeID thisIndex;
     CVMTypeIDNamePart thisCookie;
     struct memberName * thisName;
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_LOCK(ee);
     thisName = referenceMemberName( ee, name, &thisCookie, CVM_TRUE );
     if ( thisName == NULL ){
 	thisIndex = CVM_TYPEID_ERROR;
     } else {
 	thisIndex = CVMtypeidCreateTypeIDFromParts(thisCookie, 0);
     }
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_UNLOCK(ee);
     return thisIndex;
 }
 
@@ -1490,28 +1566,34 @@ CVMtypeidCloneMembername( CVMExecEnv *ee, CVMTypeID cookie ){
     cookie >>= CVMtypeidNameShift; /* name part only! */
     thisName = indexMemberName( cookie, &thisSeg );
 
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_LOCK(ee);
     conditionalIncRef(thisName);
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_UNLOCK(ee);
 
     return cookie;
 }
 
-
-void
-CVMtypeidDisposeMembername( CVMExecEnv *ee, CVMTypeID cookie ){
+/*
+ * Drop one reference to a member name and delete it if it was the last.
+ */
+static void
+releaseMemberName( CVMExecEnv *ee, CVMTypeIDNamePart nameCookie ){
     struct memberName * 	   thisName;
     struct genericTableSegment *thisSeg;
-    CVMTypeIDNamePart nameCookie = CVMtypeidGetNamePart(cookie);
     thisName = indexMemberName( nameCookie, &thisSeg );
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_LOCK(ee);
     if ( thisName->refCount != MAX_COUNT ){
 	if ( --(thisName->refCount) == 0 ){
 	    deleteMemberEntry( thisName, nameCookie,
 			       (struct memberNameTableSegment*)thisSeg );
 	}
     }
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_UNLOCK(ee);
+}
+
+void
+CVMtypeidDisposeMembername( CVMExecEnv *ee, CVMTypeID cookie ){
+    releaseMemberName( ee, CVMtypeidGetNamePart(cookie) );
 }
 
 /****************************************************************************
@@ -1884,10 +1966,16 @@ lookupClass(
 
     /* DEBUG printf( "looking for class %s in package %s\n",
 	classname, pkgp->pkgname ); */
+#ifdef CVM_DEBUG
+    idstat.nClassLookups++;
+#endif
     for ( classIndex = *hashbucket;
 	  classIndex != TYPEID_NOENTRY;
 	  classIndex = classp->nextIndex
     ){
+#ifdef CVM_DEBUG
+	idstat.nClassProbes++;
+#endif
         classp = indexScalarEntry(classIndex, NULL);
 	if ( classp->tag != CVM_TYPE_ENTRY_OBJ)
 	    continue;
@@ -2300,7 +2388,7 @@ CVMtypeidIncrementArrayDepth(
      * parameter doInsertion to TRUE for the case that an array of this
      * depth, of this base type has never been seen before.
      */
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+    TYPEID_LOCK(ee);
     arrayEntry = lookupArray( base, baseEntry, newDepth, basePackage,
 	CVM_TRUE, &arrayretval );
     if ( arrayEntry == NULL ){
@@ -2308,7 +2396,7 @@ CVMtypeidIncrementArrayDepth(
     } else {
 	arrayretval |=  CVMtypeidBigArray;
     }
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    TYPEID_UNLOCK(ee);
 
     return arrayretval;
 }
@@ -2347,7 +2435,7 @@ CVMtypeidNewClassID(
     /* Detect an empty string */ 
     CVMassert(name[0] != '\0');
 
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+    TYPEID_LOCK(ee);
     if ( name[0] == CVM_SIGNATURE_ARRAY ){
 	/* it starts with a [ so it is really an array */
 	ep = referenceFieldSignature( ee, name, nameLength, CVM_TRUE, &retval );
@@ -2358,7 +2446,7 @@ CVMtypeidNewClassID(
 	    retval = CVM_TYPEID_ERROR;
 	}
     }
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    TYPEID_UNLOCK(ee);
     return retval;
 }
 
@@ -2368,10 +2456,10 @@ CVMtypeidCloneClassID( CVMExecEnv *ee, CVMClassTypeID cookie ){
     struct scalarTableEntry*	thisType;
 
     if ( isTableEntry( typeCookie ) ){
-	CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+	TYPEID_LOCK(ee);
 	thisType = indexScalarEntry( typeCookie, NULL );
 	conditionalIncRef(thisType);
-	CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+	TYPEID_UNLOCK(ee);
     }
 
     return cookie;
@@ -2382,9 +2470,9 @@ CVMtypeidDisposeClassID( CVMExecEnv *ee, CVMClassTypeID cookie ){
     CVMTypeIDTypePart typeCookie = (CVMTypeIDTypePart)(cookie&CVMtypeidBasetypeMask);
 
     if ( isTableEntry( typeCookie ) ){
-	CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+	TYPEID_LOCK(ee);
 	decrefScalarTypeEntry( (CVMTypeIDTypePart)cookie );
-	CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+	TYPEID_UNLOCK(ee);
     }
 
 }
@@ -2842,7 +2930,7 @@ static CVMUint32    staticSyllableBuffer[FORM_DATAWORDS(MAX_SIGITEMS)];
 #define USE_STATIC_BUFFERS \
     if ( !doInsertion ){ \
 	needToUnlock = CVM_TRUE; \
-	CVMsysMutexLock(ee, &CVMglobals.typeidLock ); \
+	TYPEID_LOCK(ee); \
     } \
     detailp = staticDetailBuffer; \
     memcpy( detailp, localDetailBuffer, NLOCALDETAIL*sizeof(localDetailBuffer[0]) ); \
@@ -3076,7 +3164,7 @@ referenceMethodSignature(
 	}
     }
     if (needToUnlock){
-	CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+	TYPEID_UNLOCK(ee);
     }
     if ( nameCookie != NULL )
 	*nameCookie = thisSigNo;
@@ -3097,7 +3185,7 @@ parseFailure:
 	}
     }
     if (needToUnlock){
-	CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+	TYPEID_UNLOCK(ee);
     }
     if ( nameCookie != NULL )
 	*nameCookie = TYPEID_NOENTRY;
@@ -3392,31 +3480,26 @@ CVMtypeidNewMethodIDFromNameAndSig(
     CVMTypeIDTypePart	sigCookie;
     CVMMethodTypeID	result;
 
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_LOCK(ee);
     name = referenceMemberName( ee, memberName, &nameCookie, CVM_TRUE );
+    MEMBERNAME_UNLOCK(ee);
     if (name==NULL){
-	result = CVM_TYPEID_ERROR;
-	goto exit;
+	return CVM_TYPEID_ERROR;
     }
 
+    TYPEID_LOCK(ee);
     sig = referenceMethodSignature( ee, memberSig, (int)strlen(memberSig), &sigCookie, CVM_TRUE );
+    TYPEID_UNLOCK(ee);
     if (sig==NULL){
 	/* there was a parse or malloc failure. somewhere. */
-	/* delete anything that needs deleting */
-	/* Since we call the reference functions with doInsertion == CVM_TRUE,
-	 * a reference count of 1 means that an entry was just inserted by
-	 * us, so we should delete it.
+	/* Give back the reference to the name we just took, which
+	 * deletes it if it was inserted by us.
 	 */
-	if ( (name != NULL) && (name->refCount == 1) ){
-	    name->refCount = 0;
-	    deleteMemberEntry( name, nameCookie, NULL );
-	}
+	releaseMemberName( ee, nameCookie );
 	result = CVM_TYPEID_ERROR;
-	goto exit;
+    } else {
+	result = CVMtypeidCreateTypeIDFromParts(nameCookie, sigCookie);
     }
-    result = CVMtypeidCreateTypeIDFromParts(nameCookie, sigCookie);
-exit:
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
     return result;
 }
 
@@ -3428,11 +3511,12 @@ CVMtypeidCloneMethodID( CVMExecEnv *ee, CVMMethodTypeID cookie ){
     struct memberName *			thisName;
     struct methodTypeTableEntry*	thisType;
 
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
-
     thisName = indexMemberName( nameCookie, NULL );
+    MEMBERNAME_LOCK(ee);
     conditionalIncRef(thisName);
+    MEMBERNAME_UNLOCK(ee);
 
+    TYPEID_LOCK(ee);
     thisType = indexMethodEntry( typeCookie, NULL );
     conditionalIncRef(thisType);
 
@@ -3441,7 +3525,7 @@ CVMtypeidCloneMethodID( CVMExecEnv *ee, CVMMethodTypeID cookie ){
 	CVMconsolePrintf("               and  of type 0x%x->refCount to %d\n", typeCookie, thisType->refCount);
     */
 
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    TYPEID_UNLOCK(ee);
 
     return cookie;
 }
@@ -3451,21 +3535,12 @@ void
 CVMtypeidDisposeMethodID( CVMExecEnv *ee, CVMMethodTypeID cookie ){
     CVMTypeIDNamePart nameCookie = CVMtypeidGetNamePart(cookie);
     CVMTypeIDTypePart typeCookie = CVMtypeidGetTypePart(cookie);
-    struct memberName *			thisName;
-    struct genericTableSegment*	        nameSeg;
     struct methodTypeTableEntry*	thisType;
     struct genericTableSegment *	typeSeg;
 
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
-
-    thisName = indexMemberName( nameCookie, &nameSeg );
-    if ( thisName->refCount != MAX_COUNT ){
-	if ( --(thisName->refCount) == 0 ){
-	    deleteMemberEntry( thisName, nameCookie,
-			       (struct memberNameTableSegment*)nameSeg );
-	}
-    }
+    releaseMemberName( ee, nameCookie );
 
+    TYPEID_LOCK(ee);
     thisType = indexMethodEntry( typeCookie, &typeSeg );
     if ( thisType->refCount != MAX_COUNT ){
 	if ( --(thisType->refCount) == 0 ){
@@ -3475,7 +3550,7 @@ CVMtypeidDisposeMethodID( CVMExecEnv *ee, CVMMethodTypeID cookie ){
 	}
     }
 
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    TYPEID_UNLOCK(ee);
 }
 
 /*
@@ -3516,30 +3591,25 @@ CVMtypeidNewFieldIDFromNameAndSig( CVMExecEnv * ee, const CVMUtf8* memberName,
     CVMFieldTypeID	sigCookie;
     CVMFieldTypeID	result;
 
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
+    MEMBERNAME_LOCK(ee);
     name = referenceMemberName( ee, memberName, &nameCookie, CVM_TRUE );
+    MEMBERNAME_UNLOCK(ee);
     if ( name == NULL ){
-	result = CVM_TYPEID_ERROR;
-	goto exit;
+	return CVM_TYPEID_ERROR;
     }
+    TYPEID_LOCK(ee);
     type = referenceFieldSignature( ee, memberSig, (int)strlen(memberSig), CVM_TRUE, &sigCookie );
+    TYPEID_UNLOCK(ee);
     if (sigCookie>=TYPEID_NOENTRY){
 	/* there was a malloc failure in referenceFieldSignature */
-	/* Since we call the reference functions with doInsertion == CVM_TRUE,
-	 * a reference count of 1 means that an entry was just inserted by
-	 * us, so we should delete it.
+	/* Give back the reference to the name we just took, which
+	 * deletes it if it was inserted by us.
 	 */
-	if (name->refCount == 1){
-	    name->refCount = 0;
-	    deleteMemberEntry( name, nameCookie, NULL );
-	}
+	releaseMemberName( ee, nameCookie );
 	result = CVM_TYPEID_ERROR;
-	goto exit;
+    } else {
+	result = CVMtypeidCreateTypeIDFromParts(nameCookie, sigCookie);
     }
-    result = CVMtypeidCreateTypeIDFromParts(nameCookie, sigCookie);
-
-exit:
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
 
     return result;
 }
@@ -3551,17 +3621,18 @@ CVMtypeidCloneFieldID( CVMExecEnv *ee, CVMFieldTypeID cookie ){
     struct memberName *		thisName;
     struct scalarTableEntry*	thisType;
 
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
-
     thisName = indexMemberName( nameCookie, NULL );
+    MEMBERNAME_LOCK(ee);
     conditionalIncRef(thisName);
+    MEMBERNAME_UNLOCK(ee);
 
+    TYPEID_LOCK(ee);
     if ( isTableEntry( typeCookie ) ){
 	thisType = indexScalarEntry( typeCookie, NULL );
 	conditionalIncRef(thisType);
     }
 
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    TYPEID_UNLOCK(ee);
 
     return cookie;
 }
@@ -3571,24 +3642,15 @@ void
 CVMtypeidDisposeFieldID( CVMExecEnv *ee, CVMFieldTypeID cookie ){
     CVMTypeIDNamePart nameCookie = CVMtypeidGetNamePart(cookie);
     CVMTypeIDTypePart typeCookie = CVMtypeidGetTypePart(cookie);
-    struct memberName *			thisName;
-    struct genericTableSegment*		nameSeg;
-
-    CVMsysMutexLock(ee, &CVMglobals.typeidLock );
 
-    thisName = indexMemberName( nameCookie, &nameSeg );
-    if ( thisName->refCount != MAX_COUNT ){
-	if ( --(thisName->refCount) == 0 ){
-	    deleteMemberEntry( thisName, nameCookie,
-			       (struct memberNameTableSegment*)nameSeg );
-	}
-    }
+    releaseMemberName( ee, nameCookie );
 
+    TYPEID_LOCK(ee);
     if ( isTableEntry( typeCookie ) ){
 	decrefScalarTypeEntry( typeCookie );
     }
 
-    CVMsysMutexUnlock(ee, &CVMglobals.typeidLock );
+    TYPEID_UNLOCK(ee);
 }
 
 
@@ -0,0 +1,182 @@
+/*
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ *
+ */
+
+import java.io.*;
+import java.util.zip.*;
+
+/*
+ * Checks that an application class archive is not used once a class on
+ * the class path has changed. Each step runs the Hello class below in a
+ * new VM, since the archive is only read at startup.
+ *
+ * A jar file is rewritten with a changed class of the same size, so that
+ * only the entry CRCs tell the two jar files apart. A directory on the
+ * class path is never archived, so a class changed in it is always seen.
+ */
+public class ClassArchiveTest {
+
+    public static class Hello {
+	public static void main(String args[]) {
+	    System.out.println("archive-v1");
+	}
+    }
+
+    private static final String HELLO = "ClassArchiveTest$Hello";
+    private static final String V1 = "archive-v1";
+    private static final String V2 = "archive-v2";
+    private static final String NOT_USED = "not used";
+
+    public static void main(String args[]) throws Exception {
+	File tmp = new File(System.getProperty("java.io.tmpdir"));
+	File jar = new File(tmp, "ClassArchiveTest.jar");
+	File dir = new File(tmp, "ClassArchiveTest.dir");
+	File archive = new File(tmp, "ClassArchiveTest.archive");
+	byte[] v1 = helloClass();
+	byte[] v2 = patch(v1);
+
+	/* A jar file changed without changing its size */
+	writeJar(jar, v1);
+	check(run(jar, archive, true), V1, false);
+	check(run(jar, archive, false), V1, false);
+	long size = jar.length();
+	writeJar(jar, v2);
+	if (jar.length() != size) {
+	    throw new RuntimeException("jar file size changed");
+	}
+	check(run(jar, archive, false), V2, true);
+
+	/* A directory is not archived */
+	dir.mkdir();
+	writeClass(dir, v1);
+	check(run(dir, archive, true), V1, true);
+	writeClass(dir, v2);
+	check(run(dir, archive, false), V2, true);
+
+	jar.delete();
+	new File(dir, HELLO + ".class").delete();
+	dir.delete();
+	archive.delete();
+	System.out.println("ClassArchiveTest passed");
+    }
+
+    private static byte[] helloClass() throws IOException {
+	InputStream in =
+	    ClassArchiveTest.class.getResourceAsStream(HELLO + ".class");
+	ByteArrayOutputStream out = new ByteArrayOutputStream();
+	byte[] buf = new byte[512];
+	int n;
+	while ((n = in.read(buf)) > 0) {
+	    out.write(buf, 0, n);
+	}
+	in.close();
+	return out.toByteArray();
+    }
+
+    /* Changes the string printed by Hello, keeping the class size */
+    private static byte[] patch(byte[] data) {
+	byte[] from = V1.getBytes();
+	byte[] to = V2.getBytes();
+	byte[] result = (byte[])data.clone();
+	for (int i = 0; i + from.length <= data.length; i++) {
+	    int j = 0;
+	    while (j < from.length && data[i + j] == from[j]) {
+		j++;
+	    }
+	    if (j == from.length) {
+		System.arraycopy(to, 0, result, i, to.length);
+		return result;
+	    }
+	}
+	throw new RuntimeException(V1 + " not found in " + HELLO);
+    }
+
+    /* Stored, not deflated, so that the jar file keeps its size */
+    private static void writeJar(File jar, byte[] data) throws IOException {
+	ZipOutputStream out = new ZipOutputStream(new FileOutputStream(jar));
+	ZipEntry entry = new ZipEntry(HELLO + ".class");
+	CRC32 crc = new CRC32();
+	crc.update(data);
+	entry.setMethod(ZipEntry.STORED);
+	entry.setSize(data.length);
+	entry.setCompressedSize(data.length);
+	entry.setCrc(crc.getValue());
+	entry.setTime(0);
+	out.putNextEntry(entry);
+	out.write(data);
+	out.closeEntry();
+	out.close();
+    }
+
+    private static void writeClass(File dir, byte[] data) throws IOException {
+	FileOutputStream out =
+	    new FileOutputStream(new File(dir, HELLO + ".class"));
+	out.write(data);
+	out.close();
+    }
+
+    private static String run(File classPath, File archive, boolean dump)
+	throws Exception
+    {
+	String[] command = {
+	    System.getProperty("java.home") + File.separator + "bin" +
+		File.separator + "cvm",
+	    (dump ? "-XclassArchiveDump=" : "-XclassArchive=") +
+		archive.getPath(),
+	    "-cp", classPath.getPath(),
+	    HELLO
+	};
+	Process p = Runtime.getRuntime().exec(command);
+	StringBuffer output = new StringBuffer();
+	read(p.getInputStream(), output);
+	read(p.getErrorStream(), output);
+	p.waitFor();
+	System.out.print(output);
+	return output.toString();
+    }
+
+    private static void read(InputStream in, StringBuffer output)
+	throws IOException
+    {
+	BufferedReader reader = new BufferedReader(new InputStreamReader(in));
+	String line;
+	while ((line = reader.readLine()) != null) {
+	    output.append(line).append('\n');
+	}
+	reader.close();
+    }
+
+    private static void check(String output, String expected,
+			      boolean archiveRejected)
+    {
+	if (output.indexOf(expected) < 0) {
+	    throw new RuntimeException("expected " + expected +
+				       ", got: " + output);
+	}
+	if ((output.indexOf(NOT_USED) >= 0) != archiveRejected) {
+	    throw new RuntimeException("archive should " +
+		(archiveRejected ? "" : "not ") + "be rejected: " + output);
+	}
+    }
+}
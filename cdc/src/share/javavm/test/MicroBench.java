@@ -124,6 +124,70 @@ class MicroBench {
 	}
     }
 
+    /* Strings long enough for the vectorized String intrinsics to matter */
+    static final String longStr1 =
+	"The quick brown fox jumps over the lazy dog, then does it again. ";
+    static final String longStr2 =
+	"The quick brown fox jumps over the lazy dog, then does it again! ";
+
+    /* benchmark the String.equals() intrinsic on long Strings */
+    public static void benchStringEqualsLong() {
+	int i = 600000;
+	String str1 = longStr1;
+	String str2 = new String(longStr1);
+	while (i > 0) {
+	    str1.equals(str2);
+	    i--;
+	}
+    }
+
+    /* benchmark the String.compareTo() intrinsic on long Strings that
+       only differ in the last char */
+    public static void benchStringCompareToLong() {
+	int i = 600000;
+	String str1 = longStr1;
+	String str2 = longStr2;
+	while (i > 0) {
+	    str1.compareTo(str2);
+	    i--;
+	}
+    }
+
+    /* benchmark the String.indexOf() intrinsic scanning a long String */
+    public static void benchStringIndexOfLong() {
+	int i = 600000;
+	String str = longStr1;
+	while (i > 0) {
+	    str.indexOf('!');
+	    i--;
+	}
+    }
+
+    /* benchmark System.arraycopy() of a char array */
+    public static void benchCharArrayCopy() {
+	int i = 600000;
+	char[] src = new char[256];
+	char[] dst = new char[256];
+	while (i > 0) {
+	    System.arraycopy(src, 0, dst, 0, 256);
+	    i--;
+	}
+    }
+
+    /* benchmark a[i] in a counted loop, which needs no null or
+       bounds check */
+    public static void benchCountedArrayLoop() {
+	int i = 100000;
+	int[] a = new int[256];
+	int sum = 0;
+	while (i > 0) {
+	    for (int j = 0; j < a.length; j++) {
+		sum += a[j];
+	    }
+	    i--;
+	}
+    }
+
     /* benchmark an array assignment check when the object type 
        is the element type */
     public static void benchCheckInit() {
@@ -35,6 +35,7 @@
 #define ZIP_Lock CVMziputilLock
 #define ZIP_Unlock CVMziputilUnlock
 #define ZIP_Read CVMziputilRead
+#define ZIP_GetEntryData CVMziputilGetEntryData
 #define ZIP_DosToUnixTime CVMziputilDosToUnixTime
 #define ZIP_Open CVMziputilOpen
 #define ZIP_FindEntry CVMziputilFindEntry
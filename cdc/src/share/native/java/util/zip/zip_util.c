@@ -37,6 +37,10 @@
 #include "javavm/include/ansi2cvm.h"
 #include "javavm/include/porting/path.h"
 
+#ifdef CVM_ZIP_USE_MMAP
+#include <sys/mman.h>
+#endif
+
 #define MAXREFS 0xFFFF	/* max number of open zip file references */
 #define MAXSIZE INT_MAX	/* max size of zip file or zip entry */
 
@@ -81,6 +85,7 @@ DestroyZip()
     }
 }
 
+#ifndef CVM_ZIP_USE_MMAP
 /*
  * Reads len bytes of data into buf. Returns 0 if all bytes could be read,
  * otherwise returns -1.
@@ -98,6 +103,29 @@ static jint readFully(jint fd, void *buf, jint len)
     }
     return 0;
 }
+#endif
+
+/*
+ * Reads len bytes of data at file position pos into buf. Returns 0 if
+ * all bytes could be read, otherwise returns -1. With CVM_ZIP_USE_MMAP
+ * this is a copy out of the mapped file and needs no lock.
+ */
+static jint readFullyAt(jzfile *zip, jint pos, void *buf, jint len)
+{
+#ifdef CVM_ZIP_USE_MMAP
+    if (pos < 0 || len < 0 || pos > zip->len - len) {
+	return -1;
+    }
+    memcpy(buf, zip->maddr + pos, len);
+    return 0;
+#else
+    if (jlong_to_jint(JVM_Lseek(zip->fd, jint_to_jlong(pos), SEEK_SET))
+	== -1) {
+	return -1;
+    }
+    return readFully(zip->fd, buf, len);
+#endif
+}
 
 /*
  * Allocates a new zip file object for the specified file name.
@@ -124,6 +152,21 @@ jzfile *allocZip(const char *name)
     return zip;
 }
 
+/*
+ * Releases the file descriptor or mapping of the specified zip file.
+ */
+static void closeZipFile(jzfile *zip)
+{
+#ifdef CVM_ZIP_USE_MMAP
+    if (zip->maddr != 0) {
+	munmap((void *)zip->maddr, zip->len);
+	zip->maddr = 0;
+    }
+#else
+    JVM_Close(zip->fd);
+#endif
+}
+
 /*
  * Frees the specified zip file object.
  */
@@ -176,13 +219,16 @@ static jint findEND(jzfile *zip, void *endbuf)
 {
     unsigned char buf[ENDHDR * 2];
     jint len, pos;
-    jint fd = zip->fd;
 
     /* Get the length of the zip file */
-    len = pos = jlong_to_jint(JVM_Lseek(fd, jlong_zero, SEEK_END));
+#ifdef CVM_ZIP_USE_MMAP
+    len = pos = zip->len;
+#else
+    len = pos = jlong_to_jint(JVM_Lseek(zip->fd, jlong_zero, SEEK_END));
     if (len == -1) {
 	return -1;
     }
+#endif
     /*
      * Search backwards ENDHDR bytes at a time from end of file stopping
      * when the END header has been found. We need to make sure that we
@@ -202,10 +248,7 @@ static jint findEND(jzfile *zip, void *endbuf)
 	memcpy(buf + count, buf, count);
 	/* Update position and read next block */
 	pos -= count;
-	if (jlong_to_jint(JVM_Lseek(fd, jint_to_jlong(pos), SEEK_SET)) == -1) {
-	    return -1;
-	}
-	if (readFully(fd, buf, count) == -1) {
+	if (readFullyAt(zip, pos, buf, count) == -1) {
 	    return -1;
 	}
 	/* Now scan the block for END header signature */
@@ -217,18 +260,13 @@ static jint findEND(jzfile *zip, void *endbuf)
 		if (endpos + ENDHDR + clen == len) {
 		    /* Found END header */
 		    memcpy(endbuf, bp, ENDHDR);
-		    if (jlong_to_jint(JVM_Lseek(fd,
-						jint_to_jlong(endpos + ENDHDR),
-						SEEK_SET))
-			== -1) {
-			return -1;
-		    }
 		    if (clen > 0) {
 			zip->comment = (char *)malloc(clen + 1);
 			if (zip->comment == 0) {
 			    return -1;
 			}
-			if (readFully(zip->fd, zip->comment, clen) == -1) {
+			if (readFullyAt(zip, endpos + ENDHDR,
+					zip->comment, clen) == -1) {
 			    free(zip->comment);
 			    zip->comment = 0;
 			    return -1;
@@ -396,6 +434,16 @@ addEntryComment(jzfile *zip, int index, char *comment)
     }
 }
 
+/*
+ * With CVM_ZIP_USE_MMAP the central directory is parsed in place in the
+ * mapped file. Otherwise it is read into a temporary buffer.
+ */
+#ifdef CVM_ZIP_USE_MMAP
+#define freeCEN(cenbuf)
+#else
+#define freeCEN(cenbuf) free(cenbuf)
+#endif
+
 /*
  * Reads zip file central directory. Returns the file position of first
  * CEN header, otherwise returns 0 if central directory not found or -1
@@ -451,26 +499,25 @@ static jint readCEN(jzfile *zip)
 	zip->msg = "too many entries in ZIP file";
 	return -1;
     }
-    /* Seek to first CEN header */
-    if (jlong_to_jint(JVM_Lseek(zip->fd, jint_to_jlong(cenpos), SEEK_SET))
-	== -1) {
-	return -1;
-    }
-
+#ifdef CVM_ZIP_USE_MMAP
+    /* The central directory ends at endpos, so it lies within the map */
+    cenbuf = zip->maddr + cenpos;
+#else
     /* Allocate temporary buffer for central directory bytes */
     cenbuf = (unsigned char *)malloc(cenlen);
     if (cenbuf == 0) {
 	return -1;
     }
     /* Read central directory */
-    if (readFully(zip->fd, cenbuf, cenlen) == -1) {
+    if (readFullyAt(zip, cenpos, cenbuf, cenlen) == -1) {
 	free(cenbuf);
 	return -1;
     }
+#endif
     /* Allocate array for item descriptors */
     entries = zip->entries = (jzcell *)calloc(total, sizeof(jzcell));
     if (entries == 0) {
-	free(cenbuf);
+	freeCEN(cenbuf);
 	return -1;
     }
     /* Allocate hash table */
@@ -478,7 +525,7 @@ static jint readCEN(jzfile *zip)
     tablelen = zip->tablelen = (tmplen > 0 ? tmplen : 1);
     table = zip->table = (unsigned short *)calloc(tablelen, sizeof(unsigned short));
     if (table == 0) {
-	free(cenbuf);
+	freeCEN(cenbuf);
 	free(entries);
 	zip->entries = 0;
 	return -1;
@@ -542,7 +589,7 @@ static jint readCEN(jzfile *zip)
                 free(name);
             name = (char *)malloc(namelen);
 	    if (name == 0) {
-		free(cenbuf);
+		freeCEN(cenbuf);
 		free(entries);
 		zip->entries = 0;
 		return -1;
@@ -596,7 +643,7 @@ static jint readCEN(jzfile *zip)
     }
     /* Free up temporary buffers */
 error:
-    free(cenbuf);
+    freeCEN(cenbuf);
     if (name != namebuf)
         free(name);
 
@@ -656,6 +703,7 @@ ZIP_Open_Generic(const char *name, char **pmsg, int mode, jlong lastModified)
     MUNLOCK(JNI_STATIC(zip_util, zfiles_lock));
     if (zip == 0) {
 	jlong len;
+	jint fd;
 	/* If not found then allocate a new zip object */
 	zip = allocZip(name);
 	if (zip == 0) {
@@ -664,8 +712,8 @@ ZIP_Open_Generic(const char *name, char **pmsg, int mode, jlong lastModified)
 	zip->refs = 1;
         zip->lastModified = lastModified;
 	zip->mode = mode;
-	zip->fd = JVM_Open(name, mode, 0);
-	if (zip->fd == -1) {
+	fd = JVM_Open(name, mode, 0);
+	if (fd == -1) {
             if (pmsg != 0) {
                 char* buf = errbuf;
                 if (JVM_GetLastErrorString(buf, 256) > 0) {
@@ -675,7 +723,7 @@ ZIP_Open_Generic(const char *name, char **pmsg, int mode, jlong lastModified)
 	    freeZip(zip);
 	    return 0;
 	}
-	len = JVM_Lseek(zip->fd, jlong_zero, SEEK_END);
+	len = JVM_Lseek(fd, jlong_zero, SEEK_END);
 	if (CVMlongEq(len, jint_to_jlong(-1))) {
             if (pmsg != 0) {
                 char* buf = errbuf;
@@ -683,7 +731,7 @@ ZIP_Open_Generic(const char *name, char **pmsg, int mode, jlong lastModified)
                     *pmsg = buf;
                 }
             }
-            JVM_Close(zip->fd);
+            JVM_Close(fd);
 	    freeZip(zip);
 	    return 0;
 	}
@@ -691,17 +739,43 @@ ZIP_Open_Generic(const char *name, char **pmsg, int mode, jlong lastModified)
 	    if (pmsg != 0) {
 		*pmsg = "zip file too large";
 	    }
-            JVM_Close(zip->fd);
+            JVM_Close(fd);
 	    freeZip(zip);
 	    return 0;
 	}
+#ifdef CVM_ZIP_USE_MMAP
+	/*
+	 * Map the whole file read-only. The mapping outlives the
+	 * descriptor, so no fd is kept open. Processes forked by mTASK
+	 * inherit the mapping and share its pages, including the CEN.
+	 */
+	zip->len = jlong_to_jint(len);
+	if (zip->len > 0) {
+	    void *maddr = mmap(NULL, zip->len, PROT_READ, MAP_SHARED, fd, 0);
+	    if (maddr == MAP_FAILED) {
+		if (pmsg != 0) {
+		    char* buf = errbuf;
+		    if (JVM_GetLastErrorString(buf, 256) > 0) {
+			*pmsg = buf;
+		    }
+		}
+		JVM_Close(fd);
+		freeZip(zip);
+		return 0;
+	    }
+	    zip->maddr = (unsigned char *)maddr;
+	}
+	JVM_Close(fd);
+#else
+	zip->fd = fd;
+#endif
 	if (readCEN(zip) <= 0) {
 	    /* An error occurred while trying to read the zip file */
 	    if (pmsg != 0) {
 		/* Set the zip error message */
 		*pmsg = zip->msg;
 	    }
-	    JVM_Close(zip->fd);
+	    closeZipFile(zip);
 	    freeZip(zip);
 	    return 0;
 	}
@@ -714,18 +788,22 @@ ZIP_Open_Generic(const char *name, char **pmsg, int mode, jlong lastModified)
 }
 
 #ifdef CVM_MTASK
+#ifndef CVM_ZIP_USE_MMAP
 static jboolean 
 zipInitialized()
 {
     return JNI_STATIC(zip_util, inited);
 }
+#endif
 
 /*
- * Close fd's of zip files we have handled
+ * Close fd's of zip files we have handled. Mapped zip files have no
+ * fd open, and their mappings stay valid in the forked process.
  */
 void JNICALL
 ZIP_Closefds()
 {
+#ifndef CVM_ZIP_USE_MMAP
     jzfile* zip;
 
     if (!zipInitialized()) {
@@ -743,6 +821,7 @@ ZIP_Closefds()
 	zip->fd = -1;
     }
     MUNLOCK(JNI_STATIC(zip_util, zfiles_lock));
+#endif
 }
 
 /*
@@ -751,6 +830,7 @@ ZIP_Closefds()
 jboolean JNICALL
 ZIP_Reopenfds()
 {
+#ifndef CVM_ZIP_USE_MMAP
     jzfile* zip;
 
     if (!zipInitialized()) {
@@ -771,6 +851,7 @@ ZIP_Reopenfds()
 	}
     }
     MUNLOCK(JNI_STATIC(zip_util, zfiles_lock));
+#endif
     return JNI_TRUE;
 }
 #endif
@@ -811,7 +892,7 @@ void ZIP_Close(jzfile *zip)
 	}
     }
     MUNLOCK(JNI_STATIC(zip_util, zfiles_lock));
-    JVM_Close(zip->fd);
+    closeZipFile(zip);
     freeZip(zip);
     return;
 }
@@ -828,13 +909,6 @@ readLOC(jzfile *zip, jzcell *zc)
     jint nlen, elen;
     jzentry *ze = 0;
 
-    /* Seek to beginning of LOC header */
-    if (jlong_to_jint(JVM_Lseek(zip->fd, jint_to_jlong(zc->pos), SEEK_SET))
-	== -1) {
-	zip->msg = "seek failed";
-	return NULL;
-    }
-
     /* Allocate buffer for LOC header only */
     locbuf = (unsigned char *)malloc(LOCHDR);
     if (locbuf == 0) {
@@ -843,7 +917,7 @@ readLOC(jzfile *zip, jzcell *zc)
     }
 
     /* Try to read in the LOC header */
-    if (readFully(zip->fd, locbuf, LOCHDR) == -1) {
+    if (readFullyAt(zip, zc->pos, locbuf, LOCHDR) == -1) {
 	zip->msg = "couldn't read LOC header";
 	goto FREE_AND_RETURN_NULL;
     }
@@ -879,7 +953,7 @@ readLOC(jzfile *zip, jzcell *zc)
     }
 
     /* Read in the entry name and zero terminate it */
-    if (readFully(zip->fd, ze->name, nlen) == -1) {
+    if (readFullyAt(zip, zc->pos + LOCHDR, ze->name, nlen) == -1) {
 	zip->msg = "couldn't read name";
         goto FREE_AND_RETURN_NULL;
     }
@@ -896,13 +970,8 @@ readLOC(jzfile *zip, jzcell *zc)
 	ze->extra[0] = (unsigned char)elen;
 	ze->extra[1] = (unsigned char)(elen >> 8);
 
-	/* Seek to begin of CEN header extra field */
-        if (jlong_to_jint(JVM_Lseek(zip->fd, jint_to_jlong(off), SEEK_SET)) == -1) {
-	    zip->msg = "seek failed";
-            goto FREE_AND_RETURN_NULL;
-	}
 	/* Try to read in the CEN Extra */
-	if (readFully(zip->fd, &ze->extra[2], elen) == -1) {
+	if (readFullyAt(zip, off, &ze->extra[2], elen) == -1) {
 	    zip->msg = "couldn't read CEN extra";
             goto FREE_AND_RETURN_NULL;
 	}
@@ -919,7 +988,8 @@ readLOC(jzfile *zip, jzcell *zc)
 	ze->extra[1] = (unsigned char)(elen >> 8);
 
        	/* Try to read in the extra data */
-	if (readFully(zip->fd, &ze->extra[2], elen) == -1) {
+	if (readFullyAt(zip, zc->pos + LOCHDR + nlen,
+			&ze->extra[2], elen) == -1) {
 	    zip->msg = "couldn't read extra";
             goto FREE_AND_RETURN_NULL;
 	}
@@ -1087,6 +1157,8 @@ void ZIP_Unlock(jzfile *zip)
  * file had been previously locked with ZIP_Lock(). Returns the
  * number of bytes read, or -1 if an error occurred. If err->msg != 0
  * then a zip error occurred and err->msg contains the error text.
+ * With CVM_ZIP_USE_MMAP the read is a copy out of the mapped file,
+ * so callers that do not look at zip->msg need not take the lock.
  */
 jint ZIP_Read(jzfile *zip, jzentry *entry, jint pos, void *buf, jint len)
 {
@@ -1108,16 +1180,43 @@ jint ZIP_Read(jzfile *zip, jzentry *entry, jint pos, void *buf, jint len)
 	len = avail;
     }
 
+#ifdef CVM_ZIP_USE_MMAP
+    if (entry->pos + pos > zip->len - len) {
+	zip->msg = "ZIP_Read: entry extends past end of file";
+	return -1;
+    }
+    memcpy(buf, zip->maddr + entry->pos + pos, len);
+    n = len;
+#else
     /* Seek to beginning of entry data and read bytes */
     n = jlong_to_jint(JVM_Lseek(zip->fd, jint_to_jlong(entry->pos + pos),
 				SEEK_SET));
     if (n != -1) {
 	n = (jint)JVM_Read(zip->fd, buf, len);
     }
+#endif
 
     return n;
 }
 
+#ifdef CVM_ZIP_USE_MMAP
+/*
+ * Returns the address of the data of a stored (uncompressed) entry in
+ * the mapped zip file, or NULL if the entry is compressed or invalid.
+ * The data stays valid until the zip file is closed. No lock is needed.
+ */
+const unsigned char *
+ZIP_GetEntryData(jzfile *zip, jzentry *entry)
+{
+    if (entry->csize != 0 || zip->maddr == 0 ||
+	entry->pos < 0 || entry->size < 0 ||
+	entry->pos > zip->len - entry->size) {
+	return NULL;
+    }
+    return zip->maddr + entry->pos;
+}
+#endif
+
 /*
  * Converts DOS (ZIP) time to UNIX time.
  */
@@ -1152,7 +1251,9 @@ jboolean
 InflateFully(jzfile *zip, jzentry *entry, void *buf, char **msg)
 {
     z_stream strm;
+#ifndef CVM_ZIP_USE_MMAP
     char tmp[BUF_SIZE];
+#endif
     jint pos = 0, count = entry->csize;
 
     *msg = NULL; /* Reset error message */
@@ -1176,6 +1277,16 @@ InflateFully(jzfile *zip, jzentry *entry, void *buf, char **msg)
     strm.avail_out = entry->size;
 
     while (count > 0) {
+#ifdef CVM_ZIP_USE_MMAP
+	/* Inflate the whole entry straight out of the mapped file */
+	jint n = count;
+	if (entry->pos < 0 || entry->pos > zip->len - n) {
+	    inflateEnd(&strm);
+	    *msg = "inflateFully: Unexpected end of file";
+	    return JNI_FALSE;
+	}
+	strm.next_in = (Bytef *)(zip->maddr + entry->pos + pos);
+#else
 	jint n = count > (jint)sizeof(tmp) ? (jint)sizeof(tmp) : count;
 	ZIP_Lock(zip);
 	n = ZIP_Read(zip, entry, pos, tmp, n);
@@ -1188,9 +1299,10 @@ InflateFully(jzfile *zip, jzentry *entry, void *buf, char **msg)
 	    *msg = "inflateFully: ZIP_Read error";
 	    return JNI_FALSE;
 	}
+	strm.next_in = (Bytef *)tmp;
+#endif
 	pos += n;
 	count -= n;
-	strm.next_in = (Bytef *)tmp;
 	strm.avail_in = n;
 	do {
 	    switch (inflate(&strm, Z_PARTIAL_FLUSH)) {
@@ -1245,6 +1357,14 @@ ZIP_ReadEntry(jzfile *zip, jzentry *entry, unsigned char *buf, char *entryname)
 	jint pos = 0, count = entry->size;
 	while (count > 0) {
 	    jint n;
+#ifdef CVM_ZIP_USE_MMAP
+	    const unsigned char *data = ZIP_GetEntryData(zip, entry);
+	    if (data != NULL) {
+		/* A single copy out of the mapped file, no lock needed */
+		memcpy(buf, data, count);
+		break;
+	    }
+#endif
 	    ZIP_Lock(zip);
 	    n = ZIP_Read(zip, entry, pos, buf, count);
 	    msg = zip->msg;
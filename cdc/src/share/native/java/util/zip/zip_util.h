@@ -45,7 +45,7 @@
 /*
  * Header sizes including signatures
  */
-#ifdef USE_MMAP
+#ifdef CVM_ZIP_USE_MMAP
 #define SIGSIZ  4
 #endif
 #define LOCHDR 30
@@ -167,7 +167,7 @@ typedef struct jzfile {   /* Zip file */
     char *name;	  	  /* zip file name */
     jint mode;            /* zip file mode */
     jint refs;		  /* number of active references */
-#ifdef USE_MMAP
+#ifdef CVM_ZIP_USE_MMAP
     unsigned char *maddr; /* beginning address of mapped file */
     jint len;		  /* length (in bytes) of mapped file */
 #else
@@ -248,6 +248,9 @@ void ZIP_Close(jzfile *zip);
 void ZIP_Lock(jzfile *zip);
 void ZIP_Unlock(jzfile *zip);
 jint ZIP_Read(jzfile *zip, jzentry *entry, jint pos, void *buf, jint len);
+#ifdef CVM_ZIP_USE_MMAP
+const unsigned char *ZIP_GetEntryData(jzfile *zip, jzentry *entry);
+#endif
 jint ZIP_DosToUnixTime(jint dostime);
 void ZIP_FreeEntry(jzfile *zip, jzentry *ze);
 #endif /* !_ZIP_H_ */ 
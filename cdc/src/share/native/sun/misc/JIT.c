@@ -52,6 +52,12 @@ Java_sun_misc_JIT_reparseJitOptions(JNIEnv *env, jclass cls,
 {
     return JNI_FALSE;
 }
+
+JNIEXPORT jboolean JNICALL 
+Java_sun_misc_JIT_compileQueuedMethods(JNIEnv *env, jclass cls)
+{
+    return JNI_FALSE;
+}
 #else
 #include "javavm/include/reflect.h"
 #include "javavm/include/objects.h"
@@ -180,4 +186,11 @@ Java_sun_misc_JIT_reparseJitOptions(JNIEnv *env, jclass cls,
     return result;
 }
 
+JNIEXPORT jboolean JNICALL 
+Java_sun_misc_JIT_compileQueuedMethods(JNIEnv *env, jclass cls)
+{
+    return CVMJITserveCompileQueue(CVMjniEnv2ExecEnv(env)) ?
+	JNI_TRUE : JNI_FALSE;
+}
+
 #endif /* CVM_JIT */
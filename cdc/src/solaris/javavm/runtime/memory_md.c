@@ -370,4 +370,20 @@ void *CVMmemDecommit(void *requestedAddr, size_t requestedSize,
     return decommittedAddr;
 }
 
+/* Purpose: Maps the first size bytes of the file open on fd read-only.
+   Returns: The starting address of the mapping if successful.
+            Else, NULL is returned.
+*/
+void *CVMmemMapFile(CVMInt32 fd, size_t size)
+{
+    void *addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    return (addr == (void *)MAP_FAILED) ? NULL : addr;
+}
+
+/* Purpose: Relinquishes a mapping returned by CVMmemMapFile(). */
+void CVMmemUnmapFile(void *addr, size_t size)
+{
+    munmap(addr, size);
+}
+
 #endif /* CVM_USE_MMAP_APIS */
@@ -424,4 +424,28 @@ void *CVMmemDecommit(void *requestedAddr, size_t requestedSize,
     return decommittedAddr;
 }
 
+/* Purpose: Maps the first size bytes of the file open on fd read-only.
+   Returns: The starting address of the mapping if successful.
+            Else, NULL is returned.
+*/
+void *CVMmemMapFile(CVMInt32 fd, size_t size)
+{
+    void *addr;
+    HANDLE mapping = CreateFileMapping((HANDLE)fd, NULL, PAGE_READONLY,
+				       0, (DWORD)size, NULL);
+    if (mapping == NULL) {
+	return NULL;
+    }
+    addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    /* The view keeps the mapping object alive */
+    CloseHandle(mapping);
+    return addr;
+}
+
+/* Purpose: Relinquishes a mapping returned by CVMmemMapFile(). */
+void CVMmemUnmapFile(void *addr, size_t size)
+{
+    UnmapViewOfFile(addr);
+}
+
 #endif /* CVM_USE_MMAP_APIS */
@@ -30,6 +30,15 @@
 #include "javavm/include/jit/jitintrinsic.h"
 #include "javavm/include/jit/jitirnode.h"
 
+#ifdef CVM_JIT_USE_SSE2
+#include "javavm/include/ccee.h"
+#include "javavm/include/common_exceptions.h"
+#include "javavm/include/directmem.h"
+#include "javavm/include/interpreter.h"
+#include "generated/offsets/java_lang_String.h"
+#include <emmintrin.h>
+#endif
+
 #ifdef CVMJIT_INTRINSICS
 
 extern const CVMJITIntrinsicEmitterVtbl
@@ -45,6 +54,209 @@ extern const CVMJITIntrinsicEmitterVtbl
     CVMJITRISCintrinsicSimpleLockReleaseEmitter;
 #endif
 
+#if defined(CVM_JIT_USE_SSE2) && defined(CVMGC_HAS_NO_CHAR_READ_BARRIER)
+
+/*
+ * SSE2 versions of the String intrinsics. They override the shared C
+ * versions in ccmintrinsics.c and compare or scan 8 chars at a time.
+ * Like the shared versions, they read the char arrays directly, which
+ * is only safe because they never become GC safe while doing so.
+ * Unaligned loads are used throughout since String offsets are
+ * arbitrary, and the last (count % 8) chars are done one at a time
+ * so that we never read past the end of an array.
+ */
+
+#define FIELD_READ_COUNT(obj, val) \
+    CVMD_fieldReadInt(obj, CVMoffsetOfjava_lang_String_count, val)
+
+#define FIELD_READ_VALUE(obj, val) \
+    CVMD_fieldReadRef(obj, CVMoffsetOfjava_lang_String_value, val)
+
+#define FIELD_READ_OFFSET(obj, val) \
+    CVMD_fieldReadInt(obj, CVMoffsetOfjava_lang_String_offset, val)
+
+#define STRING_CHARS(value, offset) \
+    ((CVMJavaChar *)CVMDprivate_arrayElemLoc((CVMArrayOfChar *)(value), \
+                                             (offset)))
+
+/* Number of chars in one SSE2 register: */
+#define CHARS_PER_VECTOR 8
+
+/* Purpose: Returns the index of the first char whose bits are clear in
+            the 16 bit mask returned by _mm_movemask_epi8() on the
+            result of _mm_cmpeq_epi16(). */
+static int
+firstUnequalChar(CVMUint32 mask)
+{
+    int i = 0;
+    while ((mask & 0x1) != 0) {
+        mask >>= 2;
+        i++;
+    }
+    return i;
+}
+
+/* Purpose: Returns the index of the first char whose bits are set. */
+static int
+firstEqualChar(CVMUint32 mask)
+{
+    return firstUnequalChar(~mask);
+}
+
+/* Purpose: Returns the index of the first mismatch between c1p and c2p in
+            the first n chars, or n if they are the same. */
+static CVMJavaInt
+findMismatch(const CVMJavaChar *c1p, const CVMJavaChar *c2p, CVMJavaInt n)
+{
+    CVMJavaInt i = 0;
+    while (i + CHARS_PER_VECTOR <= n) {
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(c1p + i));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(c2p + i));
+        CVMUint32 mask = _mm_movemask_epi8(_mm_cmpeq_epi16(v1, v2));
+        if (mask != 0xffff) {
+            return i + firstUnequalChar(mask);
+        }
+        i += CHARS_PER_VECTOR;
+    }
+    while (i < n && c1p[i] == c2p[i]) {
+        i++;
+    }
+    return i;
+}
+
+/* Purpose: SSE2 version of String.equals(). */
+static CVMJavaBoolean
+CVMCCMX86intrinsic_java_lang_String_equals(CVMObject *self, CVMObject *other)
+{
+    CVMJavaInt count1, count2;
+    CVMObject *value1, *value2;
+    CVMJavaInt offset1, offset2;
+
+    CVMassert(CVMD_isgcUnsafe(CVMgetEE()));
+    if (self == other) {
+        return CVM_TRUE;
+    } else if (other == NULL) {
+        /* A NULL self has already been rejected by the caller. */
+        return CVM_FALSE;
+    }
+    if (CVMobjectGetClass(other) != CVMsystemClass(java_lang_String)) {
+        return CVM_FALSE;
+    }
+
+    FIELD_READ_COUNT(self, count1);
+    FIELD_READ_COUNT(other, count2);
+    if (count1 != count2) {
+        return CVM_FALSE;
+    }
+
+    FIELD_READ_VALUE(self, value1);
+    FIELD_READ_VALUE(other, value2);
+    FIELD_READ_OFFSET(self, offset1);
+    FIELD_READ_OFFSET(other, offset2);
+
+    return findMismatch(STRING_CHARS(value1, offset1),
+                        STRING_CHARS(value2, offset2), count1) == count1;
+}
+
+/* Purpose: SSE2 version of String.compareTo(). */
+static CVMJavaInt
+CVMCCMX86intrinsic_java_lang_String_compareTo(CVMCCExecEnv *ccee,
+                                              CVMObject *self,
+                                              CVMObject *other)
+{
+    CVMObject *value1, *value2;
+    CVMJavaInt offset1, offset2;
+    CVMJavaInt len1, len2;
+    CVMJavaInt n, i;
+    const CVMJavaChar *c1p, *c2p;
+
+    CVMassert(CVMD_isgcUnsafe(CVMcceeGetEE(ccee)));
+
+    /* The caller is responsible for NULL checking self. */
+    if (other == NULL) {
+        CVMExecEnv *ee = CVMcceeGetEE(ccee);
+        CVMCCMruntimeLazyFixups(ee);
+        CVMthrowNullPointerException(ee, NULL);
+        CVMCCMhandleException(ccee);
+        return 0;
+    }
+
+    FIELD_READ_COUNT(self, len1);
+    FIELD_READ_COUNT(other, len2);
+    n = (len1 < len2) ? len1 : len2;
+
+    FIELD_READ_VALUE(self, value1);
+    FIELD_READ_VALUE(other, value2);
+    FIELD_READ_OFFSET(self, offset1);
+    FIELD_READ_OFFSET(other, offset2);
+    c1p = STRING_CHARS(value1, offset1);
+    c2p = STRING_CHARS(value2, offset2);
+
+    i = findMismatch(c1p, c2p, n);
+    if (i < n) {
+        return (CVMJavaInt)c1p[i] - (CVMJavaInt)c2p[i];
+    }
+    return len1 - len2;
+}
+
+/* Purpose: SSE2 version of String.indexOf(int ch, int fromIndex). */
+static CVMJavaInt
+CVMCCMX86intrinsic_java_lang_String_indexOf_II(CVMObject *thisObj,
+                                               CVMJavaInt ch,
+                                               CVMJavaInt fromIndex)
+{
+    CVMObject *value;
+    CVMJavaInt offset;
+    CVMJavaInt count;
+    const CVMJavaChar *cp;
+    __m128i key;
+    CVMJavaInt i;
+
+    FIELD_READ_COUNT(thisObj, count);
+    if (fromIndex >= count) {
+        return -1;
+    }
+    if (fromIndex < 0) {
+        fromIndex = 0;
+    }
+    /* Supplementary code points can never match a single char: */
+    if (((CVMUint32)ch) > 0xffff) {
+        return -1;
+    }
+
+    FIELD_READ_OFFSET(thisObj, offset);
+    FIELD_READ_VALUE(thisObj, value);
+    cp = STRING_CHARS(value, offset);
+
+    key = _mm_set1_epi16((short)ch);
+    i = fromIndex;
+    while (i + CHARS_PER_VECTOR <= count) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(cp + i));
+        CVMUint32 mask = _mm_movemask_epi8(_mm_cmpeq_epi16(v, key));
+        if (mask != 0) {
+            return i + firstEqualChar(mask);
+        }
+        i += CHARS_PER_VECTOR;
+    }
+    while (i < count) {
+        if (cp[i] == ch) {
+            return i;
+        }
+        i++;
+    }
+    return -1;
+}
+
+/* Purpose: SSE2 version of String.indexOf(int ch). */
+static CVMJavaInt
+CVMCCMX86intrinsic_java_lang_String_indexOf_I(CVMObject *thisObj,
+                                              CVMJavaInt ch)
+{
+    return CVMCCMX86intrinsic_java_lang_String_indexOf_II(thisObj, ch, 0);
+}
+
+#endif /* CVM_JIT_USE_SSE2 && CVMGC_HAS_NO_CHAR_READ_BARRIER */
+
 CVMJIT_INTRINSIC_CONFIG_BEGIN(CVMJITriscIntrinsicsList)
     {
         "java/lang/Math", "abs", "(I)I",
@@ -94,6 +306,45 @@ CVMJIT_INTRINSIC_CONFIG_BEGIN(CVMJITriscIntrinsicsList)
         CVMJITIRNODE_NULL_FLAGS,
         (void *)&CVMJITRISCintrinsicIMinEmitter,
     },
+#if defined(CVM_JIT_USE_SSE2) && defined(CVMGC_HAS_NO_CHAR_READ_BARRIER)
+    {
+        "java/lang/String", "compareTo", "(Ljava/lang/String;)I",
+        CVMJITINTRINSIC_IS_NOT_STATIC | CVMJITINTRINSIC_ADD_CCEE_ARG |
+        CVMJITINTRINSIC_C_ARGS | CVMJITINTRINSIC_NEED_MAJOR_SPILL |
+        CVMJITINTRINSIC_NEED_STACKMAP | CVMJITINTRINSIC_CP_DUMP_OK |
+        CVMJITINTRINSIC_NEED_TO_KILL_CACHED_REFS |
+        CVMJITINTRINSIC_FLUSH_JAVA_STACK_FRAME,
+        CVMJITIRNODE_THROWS_EXCEPTIONS,
+        (void*)CVMCCMX86intrinsic_java_lang_String_compareTo,
+    },
+    {
+        "java/lang/String", "equals", "(Ljava/lang/Object;)Z",
+        CVMJITINTRINSIC_IS_NOT_STATIC |
+        CVMJITINTRINSIC_C_ARGS | CVMJITINTRINSIC_NEED_MINOR_SPILL |
+        CVMJITINTRINSIC_STACKMAP_NOT_NEEDED | CVMJITINTRINSIC_CP_DUMP_OK |
+        CVMJITINTRINSIC_NEED_TO_KILL_CACHED_REFS,
+        CVMJITIRNODE_HAS_UNDEFINED_SIDE_EFFECT,
+        (void*)CVMCCMX86intrinsic_java_lang_String_equals,
+    },
+    {
+        "java/lang/String", "indexOf", "(I)I",
+        CVMJITINTRINSIC_IS_NOT_STATIC |
+        CVMJITINTRINSIC_C_ARGS | CVMJITINTRINSIC_NEED_MINOR_SPILL |
+        CVMJITINTRINSIC_STACKMAP_NOT_NEEDED | CVMJITINTRINSIC_CP_DUMP_OK,
+        CVMJITINTRINSIC_NEED_TO_KILL_CACHED_REFS |
+        CVMJITIRNODE_HAS_UNDEFINED_SIDE_EFFECT,
+        (void*)CVMCCMX86intrinsic_java_lang_String_indexOf_I,
+    },
+    {
+        "java/lang/String", "indexOf", "(II)I",
+        CVMJITINTRINSIC_IS_NOT_STATIC |
+        CVMJITINTRINSIC_C_ARGS | CVMJITINTRINSIC_NEED_MINOR_SPILL |
+        CVMJITINTRINSIC_STACKMAP_NOT_NEEDED | CVMJITINTRINSIC_CP_DUMP_OK,
+        CVMJITINTRINSIC_NEED_TO_KILL_CACHED_REFS |
+        CVMJITIRNODE_HAS_UNDEFINED_SIDE_EFFECT,
+        (void*)CVMCCMX86intrinsic_java_lang_String_indexOf_II,
+    },
+#endif /* CVM_JIT_USE_SSE2 && CVMGC_HAS_NO_CHAR_READ_BARRIER */
     {
         "java/lang/Thread", "currentThread", "()Ljava/lang/Thread;",
         CVMJITINTRINSIC_IS_STATIC |
@@ -52,6 +52,9 @@ extern Os_Thread Os_CreateThread(int proc(void *parameter), void *arg,
                                  jboolean *status);
 extern void Os_DisposeThread(Os_Thread thread);
 
+/* No event reactor: ANI_BlockThreadOnSocket() is not available */
+#define OS_REACTOR_SUPPORTED 0
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,9 @@
  */
 
 #include <anilib_impl.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
 
 Os_Event Os_CreateEvent(jboolean *status) {
   Os_Event event = (Os_Event) malloc(sizeof(Os_EventStruct));
@@ -143,3 +146,129 @@ Os_Thread Os_CreateThread(int proc(void *parameter), void *arg,
 void Os_DisposeThread(Os_Thread thread) {
   /* IMPL_NOTE: nothing to do? */
 }
+
+/*
+ * The reactor consists of an epoll instance and a pipe. The read end
+ * of the pipe is registered with epoll so that Os_ReactorWakeup() can
+ * interrupt Os_ReactorWait(), e.g., when a pool thread has finished.
+ */
+#define OS_REACTOR_MAX_EVENTS 64
+
+static int reactor_epoll_fd = -1;
+static int reactor_wakeup_pipe[2] = {-1, -1};
+
+jboolean Os_CreateReactor() {
+  struct epoll_event ev;
+  int i;
+
+  reactor_epoll_fd = epoll_create(OS_REACTOR_MAX_EVENTS);
+  if (reactor_epoll_fd < 0) {
+    return KNI_FALSE;
+  }
+  if (pipe(reactor_wakeup_pipe) != 0) {
+    Os_DisposeReactor();
+    return KNI_FALSE;
+  }
+  for (i=0; i<2; i++) {
+    fcntl(reactor_wakeup_pipe[i], F_SETFL,
+          fcntl(reactor_wakeup_pipe[i], F_GETFL) | O_NONBLOCK);
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = reactor_wakeup_pipe[0];
+  if (epoll_ctl(reactor_epoll_fd, EPOLL_CTL_ADD, reactor_wakeup_pipe[0],
+                &ev) != 0) {
+    Os_DisposeReactor();
+    return KNI_FALSE;
+  }
+  return KNI_TRUE;
+}
+
+void Os_DisposeReactor() {
+  int i;
+
+  for (i=0; i<2; i++) {
+    if (reactor_wakeup_pipe[i] >= 0) {
+      close(reactor_wakeup_pipe[i]);
+      reactor_wakeup_pipe[i] = -1;
+    }
+  }
+  if (reactor_epoll_fd >= 0) {
+    close(reactor_epoll_fd);
+    reactor_epoll_fd = -1;
+  }
+}
+
+jboolean Os_ReactorAdd(int fd) {
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+  ev.data.fd = fd;
+  if (epoll_ctl(reactor_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0 &&
+      errno != EEXIST) {
+    return KNI_FALSE;
+  }
+  return KNI_TRUE;
+}
+
+void Os_ReactorRemove(int fd) {
+  struct epoll_event ev;
+
+  /* Kernels before 2.6.9 require a non-NULL event for EPOLL_CTL_DEL */
+  memset(&ev, 0, sizeof(ev));
+  epoll_ctl(reactor_epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+void Os_ReactorWakeup() {
+  char c = 0;
+
+  /* A full pipe already guarantees a wakeup, so errors are ignored */
+  (void)write(reactor_wakeup_pipe[1], &c, 1);
+}
+
+int Os_ReactorWait(Os_ReactorEvent *events, int max_events, jlong ms) {
+  struct epoll_event ready[OS_REACTOR_MAX_EVENTS];
+  int timeout, n, i, count = 0;
+
+  if (ms < 0) {
+    timeout = -1;
+  } else if (ms > 0x7fffffff) {
+    timeout = 0x7fffffff;
+  } else {
+    timeout = (int)ms;
+  }
+  if (max_events > OS_REACTOR_MAX_EVENTS) {
+    max_events = OS_REACTOR_MAX_EVENTS;
+  }
+
+  n = epoll_wait(reactor_epoll_fd, ready, max_events, timeout);
+  for (i=0; i<n; i++) {
+    int fd = ready[i].data.fd;
+    unsigned int ev = ready[i].events;
+
+    if (fd == reactor_wakeup_pipe[0]) {
+      char buf[64];
+      while (read(fd, buf, sizeof(buf)) > 0) {
+        /* drain */
+      }
+      continue;
+    }
+
+    events[count].fd = fd;
+    events[count].events = 0;
+    if (ev & (EPOLLERR | EPOLLHUP)) {
+      /* Let both readers and writers retry and discover the error */
+      events[count].events = ANI_SOCKET_READ | ANI_SOCKET_WRITE;
+    }
+    if (ev & EPOLLIN) {
+      events[count].events |= ANI_SOCKET_READ;
+    }
+    if (ev & EPOLLOUT) {
+      events[count].events |= ANI_SOCKET_WRITE;
+    }
+    count++;
+  }
+  return count;
+}
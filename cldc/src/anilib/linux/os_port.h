@@ -62,6 +62,25 @@ extern void Os_DisposeThread(Os_Thread thread);
 
 extern void Os_DisposeEvent(Os_Event event);
 
+/*
+ * Readiness notification for non-blocking sockets, implemented with
+ * epoll(7). Sockets are registered once in edge-triggered mode and
+ * stay registered until Os_ReactorRemove() is called.
+ */
+#define OS_REACTOR_SUPPORTED 1
+
+typedef struct {
+  int fd;
+  int events;           /* ANI_SOCKET_READ and/or ANI_SOCKET_WRITE */
+} Os_ReactorEvent;
+
+extern jboolean Os_CreateReactor();
+extern void Os_DisposeReactor();
+extern jboolean Os_ReactorAdd(int fd);
+extern void Os_ReactorRemove(int fd);
+extern void Os_ReactorWakeup();
+extern int  Os_ReactorWait(Os_ReactorEvent *events, int max_events, jlong ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,11 +31,17 @@ static jint waiter_count;
 
 void ANI_Initialize() {
   PoolThread_InitializePool();
+  Reactor_Initialize();
   waiter_count = 0;
 }
 
 void ANI_Dispose() {
+  /*
+   * Pool threads wake the reactor through its pipe when they finish, so
+   * the pool must go before the pipe is closed.
+   */
   PoolThread_DisposePool();
+  Reactor_Dispose();
 }
 
 jboolean ANI_Start() {
@@ -53,6 +59,8 @@ jboolean ANI_Start() {
     p->type = ANI_BLOCK_INFO;
     p->pt = PoolThread_Allocate();
     p->parameter_block_allocated = KNI_FALSE;
+    p->socket_fd = -1;
+    p->socket_events = 0;
   } else {
     if (p->pt == NULL) {
       /* This invocation had call ANI_Wait() before. Let's try again to
@@ -167,7 +175,7 @@ void ANI_WaitForThreadUnblocking(JVMSPI_BlockedThreadInfo * blocked_threads,
         /*
          * OK, we've found a Java thread that's blocked by ANI
          */
-        if (p->pt == NULL) {
+        if (p->pt == NULL && p->socket_fd < 0) {
           /*
            * This thread called ANI_Wait() because no PoolThread were
            * available at the time. Let's try again.
@@ -185,6 +193,63 @@ void ANI_WaitForThreadUnblocking(JVMSPI_BlockedThreadInfo * blocked_threads,
 
     timeout_milli_seconds = 0;
   }
+
+  if (Reactor_IsActive()) {
+    /*
+     * Pool threads wake up the reactor when they finish, so a single
+     * wait covers both kinds of blocked threads.
+     */
+    Reactor_WaitForEvents(timeout_milli_seconds);
+    for (i=0; i<blocked_threads_count; i++) {
+      JVMSPI_BlockedThreadInfo *info = &blocked_threads[i];
+      jint size = info->reentry_data_size;
+      p = (ANI_BlockingInfo *)info->reentry_data;
+
+      if ((size == sizeof(*p)) && (p->type == ANI_BLOCK_INFO) &&
+          p->socket_fd >= 0 &&
+          Reactor_TakeReadiness(p->socket_fd, p->socket_events)) {
+        SNI_UnblockThread(info->thread_id);
+      }
+    }
+    timeout_milli_seconds = 0;
+  }
+
   PoolThread_WaitForFinishOrTimeout(blocked_threads, blocked_threads_count,
                                     timeout_milli_seconds);
 }
+
+jboolean ANI_BlockThreadOnSocket(int fd, jint events) {
+  ANI_BlockingInfo * p = (ANI_BlockingInfo*)SNI_GetReentryData(NULL);
+
+  if (!Reactor_Watch(fd, events)) {
+    return KNI_FALSE;
+  }
+  if (p == NULL) {
+    p = (ANI_BlockingInfo*)SNI_AllocateReentryData(sizeof(ANI_BlockingInfo));
+    if (p == NULL) {
+      return KNI_FALSE;
+    }
+    p->type = ANI_BLOCK_INFO;
+    p->pt = NULL;
+    p->parameter_block_allocated = KNI_FALSE;
+  }
+  JVM_ASSERT(p->pt == NULL, "cannot mix pool threads and the reactor");
+
+  p->is_blocked = KNI_TRUE;
+  p->socket_fd = fd;
+  p->socket_events = events;
+  SNI_BlockThread();
+  return KNI_TRUE;
+}
+
+int ANI_GetBlockedSocket() {
+  ANI_BlockingInfo * p = (ANI_BlockingInfo*)SNI_GetReentryData(NULL);
+  if (p == NULL) {
+    return -1;
+  }
+  return p->socket_fd;
+}
+
+void ANI_CloseSocket(int fd) {
+  Reactor_Forget(fd);
+}
@@ -221,6 +221,56 @@ void ANI_WaitForThreadUnblocking(JVMSPI_BlockedThreadInfo *blocked_threads,
                                  int blocked_threads_count,
                                  jlong timeout_milli_seconds);
 
+/**---------------------------------------------------------------------
+ *
+ * Event-driven socket I/O without native threads:
+ *
+ *----------------------------------------------------------------------*/
+
+/**
+ * Readiness conditions that can be passed to 'ANI_BlockThreadOnSocket()'.
+ */
+#define ANI_SOCKET_READ    0x01
+#define ANI_SOCKET_WRITE   0x02
+
+/**
+ * Suspend the current Java thread until the non-blocking socket 'fd'
+ * becomes ready for one of the operations in 'events' (a combination
+ * of ANI_SOCKET_READ and ANI_SOCKET_WRITE).
+ *
+ * Use this instead of 'ANI_Start()' / 'ANI_BlockThread()' when the
+ * native method operates on a socket that has been put into
+ * non-blocking mode and the operation has failed with EWOULDBLOCK or
+ * EINPROGRESS. No native thread is associated with the Java thread,
+ * so the number of concurrently blocked sockets is not limited by the
+ * size of the native thread pool.
+ *
+ * The socket is registered with the event reactor the first time it is
+ * passed here and stays registered until 'ANI_CloseSocket()' is called.
+ * After calling this, return from the native method and anticipate
+ * reentry, upon which the operation should simply be retried.
+ *
+ * Returns 'KNI_FALSE' if the event reactor is not available on this
+ * platform or the socket could not be registered. In this case the
+ * current Java thread is not blocked.
+ */
+jboolean ANI_BlockThreadOnSocket(int fd, jint events);
+
+/**
+ * Returns the socket passed to 'ANI_BlockThreadOnSocket()' in the
+ * preceding activation of the current native method, or -1 if the
+ * native method has been entered for the first time.
+ */
+int ANI_GetBlockedSocket();
+
+/**
+ * Remove 'fd' from the event reactor. Call this right before closing
+ * a socket that may have been passed to 'ANI_BlockThreadOnSocket()',
+ * so that a new socket that reuses the same descriptor does not
+ * inherit stale readiness state.
+ */
+void ANI_CloseSocket(int fd);
+
 /*
  * Initialize the ANI library for the VM.
  */
@@ -130,6 +130,135 @@ static jboolean set_blocking_flags(int *fd, jboolean is_blocking) {
 #endif
 }
 
+#if OS_REACTOR_SUPPORTED
+/*
+ * Event-driven versions of the socket natives. The socket is kept in
+ * non-blocking mode and each operation is attempted directly in the
+ * Java thread. If it would block, the Java thread is suspended with
+ * ANI_BlockThreadOnSocket() and the operation is retried on reentry,
+ * so no pool thread is tied up for the duration of the wait.
+ */
+
+static jint reactor_socket_open() {
+  struct sockaddr_in destination_sin;
+  struct hostent *phostent;
+  char *hostname;
+  int fd = ANI_GetBlockedSocket();
+
+  if (fd >= 0) {
+    /*
+     * Reentry after the connecting socket became writable: find out
+     * whether connect() has succeeded.
+     */
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (char*)&error, &length) != 0 ||
+        error != 0) {
+      ANI_CloseSocket(fd);
+      shutdown(fd, 2);
+      closesocket(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  KNI_StartHandles(1);
+  KNI_DeclareHandle(hostname_object);
+  KNI_GetParameterAsObject(1, hostname_object);
+
+  // hostname is always NUL terminated. See socket/Protocol.java for detail.
+  hostname = (char *)(SNI_GetRawArrayPointer(hostname_object));
+  phostent = gethostbyname(hostname);
+  KNI_EndHandles();
+
+  if (phostent == NULL) {
+    return -1;
+  }
+  destination_sin.sin_family = AF_INET;
+  destination_sin.sin_port = htons((short)KNI_GetParameterAsInt(2));
+  memcpy((char *) &destination_sin.sin_addr,
+         phostent->h_addr, phostent->h_length);
+
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0 || !set_blocking_flags(&fd, /*is_blocking*/ KNI_FALSE)) {
+    return -1;
+  }
+
+  if (connect(fd, (struct sockaddr *) &destination_sin,
+              sizeof(destination_sin)) != 0) {
+    // When the socket is ready for connect, it becomes *writable*
+    if (GET_LAST_ERROR() == EINPROGRESS &&
+        ANI_BlockThreadOnSocket(fd, ANI_SOCKET_WRITE)) {
+      return -1; // ignored, we will be reentered
+    }
+    shutdown(fd, 2);
+    closesocket(fd);
+    fd = -1;
+  }
+  return fd;
+}
+
+static jint reactor_socket_recv(int fd, char *buffer, int length) {
+  int n = recv(fd, buffer, length, 0);
+  if (n == 0) {
+    // Remote side has shut down the connection gracefully
+    n = -1;
+  } else if (n < 0 && GET_LAST_ERROR() == EWOULDBLOCK) {
+    ANI_BlockThreadOnSocket(fd, ANI_SOCKET_READ);
+  }
+  return n;
+}
+
+static jint reactor_socket_send(int fd, char *buffer, int length) {
+  int n = send(fd, buffer, length, 0);
+  if (n < 0 && GET_LAST_ERROR() == EWOULDBLOCK) {
+    ANI_BlockThreadOnSocket(fd, ANI_SOCKET_WRITE);
+  }
+  return n;
+}
+
+static jint reactor_socket_read_buf() {
+  jint result;
+  int fd = KNI_GetParameterAsInt(1);
+  int offset = KNI_GetParameterAsInt(3);
+  int length = KNI_GetParameterAsInt(4);
+
+  KNI_StartHandles(1);
+  KNI_DeclareHandle(buffer_object);
+  KNI_GetParameterAsObject(2, buffer_object);
+  result = reactor_socket_recv(fd,
+      (char *) SNI_GetRawArrayPointer(buffer_object) + offset, length);
+  KNI_EndHandles();
+  return result;
+}
+
+static jint reactor_socket_read_byte() {
+  unsigned char byte;
+  int n = reactor_socket_recv(KNI_GetParameterAsInt(1), (char *)&byte, 1);
+  return (n == 1) ? (jint)byte : -1; // do not sign-extend
+}
+
+static jint reactor_socket_write_buf() {
+  jint result;
+  int fd = KNI_GetParameterAsInt(1);
+  int offset = KNI_GetParameterAsInt(3);
+  int length = KNI_GetParameterAsInt(4);
+
+  KNI_StartHandles(1);
+  KNI_DeclareHandle(buffer_object);
+  KNI_GetParameterAsObject(2, buffer_object);
+  result = reactor_socket_send(fd,
+      (char *) SNI_GetRawArrayPointer(buffer_object) + offset, length);
+  KNI_EndHandles();
+  return result;
+}
+
+static jint reactor_socket_write_byte() {
+  char byte = (char)(KNI_GetParameterAsInt(2) & 0x000000ff);
+  return reactor_socket_send(KNI_GetParameterAsInt(1), &byte, 1);
+}
+#endif /* OS_REACTOR_SUPPORTED */
+
 static jboolean
 asynchronous_connect_socket(void* parameter, jboolean is_non_blocking) {
   SocketOpenParameter *p = (SocketOpenParameter *)(parameter);
@@ -150,6 +279,12 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_open0() {
   int port;
   int result;
 
+#if OS_REACTOR_SUPPORTED
+  if (Reactor_IsActive()) {
+    KNI_ReturnInt(reactor_socket_open());
+  }
+#endif
+
   init_sockets();
 
   if (!ANI_Start()) {
@@ -247,6 +382,12 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_readBuf() {
   int result = -1;
   SocketBufferParameter *p;
 
+#if OS_REACTOR_SUPPORTED
+  if (Reactor_IsActive()) {
+    KNI_ReturnInt(reactor_socket_read_buf());
+  }
+#endif
+
   if (!ANI_Start()) {
     ANI_Wait();
     KNI_ReturnInt(-1);
@@ -284,6 +425,12 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_readByte() {
   int result = -1;
   SocketBufferParameter *p;
 
+#if OS_REACTOR_SUPPORTED
+  if (Reactor_IsActive()) {
+    KNI_ReturnInt(reactor_socket_read_byte());
+  }
+#endif
+
   if (!ANI_Start()) {
     ANI_Wait();
     KNI_ReturnInt(-1);
@@ -332,6 +479,12 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_writeBuf() {
   int result = -1;
   SocketBufferParameter *p;
 
+#if OS_REACTOR_SUPPORTED
+  if (Reactor_IsActive()) {
+    KNI_ReturnInt(reactor_socket_write_buf());
+  }
+#endif
+
   if (!ANI_Start()) {
     ANI_Wait();
     KNI_ReturnInt(-1);
@@ -368,6 +521,12 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_writeByte() {
   int result = -1;
   SocketBufferParameter *p;
 
+#if OS_REACTOR_SUPPORTED
+  if (Reactor_IsActive()) {
+    KNI_ReturnInt(reactor_socket_write_byte());
+  }
+#endif
+
   if (!ANI_Start()) {
     ANI_Wait();
     KNI_ReturnInt(-1);
@@ -407,6 +566,7 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_close0() {
 
   // NOTE: this would block the VM. A real implementation should
   // make this a async native method.
+  ANI_CloseSocket(sock);
   shutdown(sock, 2);
   closesocket(sock);
 }
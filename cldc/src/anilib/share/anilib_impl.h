@@ -55,6 +55,7 @@
 
 #include "os_port.h"
 #include "poolthread.h"
+#include "reactor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -69,6 +70,8 @@ typedef struct _ANI_BlockingInfo {
   PoolThread * pt;
   jboolean is_blocked;
   jboolean parameter_block_allocated;
+  int socket_fd;       /* -1 unless blocked by ANI_BlockThreadOnSocket() */
+  jint socket_events;
 } ANI_BlockingInfo; 
 
 #define ANI_BLOCK_INFO 0x12340000
@@ -164,6 +164,7 @@ static int PoolThread_Run(void* arg) {
     pt->is_idle = KNI_TRUE;
     pt->function = NULL;
     Os_SignalEvent(thread_finished_event);
+    Reactor_Wakeup();
   }
 
   Os_DisposeEvent(pt->execute_event);
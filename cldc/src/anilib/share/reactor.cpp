@@ -0,0 +1,178 @@
+/*
+ *   
+ *
+ * Copyright  1990-2007 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ * 
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ * 
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ */
+
+#include "incls/_precompiled.incl"
+#include "anilib_impl.h"
+
+#if OS_REACTOR_SUPPORTED
+
+/*
+ * One byte of state per file descriptor: whether the descriptor has been
+ * registered with the OS reactor, plus the readiness conditions that have
+ * been reported by the OS but not yet consumed by a blocked Java thread.
+ * Since sockets are registered in edge-triggered mode, a readiness edge
+ * that arrives while no thread is waiting must be remembered here.
+ */
+#define REACTOR_REGISTERED      0x80
+#define REACTOR_PENDING_MASK    (ANI_SOCKET_READ | ANI_SOCKET_WRITE)
+#define REACTOR_MAX_EVENTS      64
+
+static unsigned char *socket_state;
+static int socket_state_size;
+static jboolean reactor_active;
+
+static jboolean ensure_state_capacity(int fd) {
+  int new_size;
+  unsigned char *new_state;
+
+  if (fd < socket_state_size) {
+    return KNI_TRUE;
+  }
+  new_size = (socket_state_size > 0) ? socket_state_size : 64;
+  while (new_size <= fd) {
+    new_size *= 2;
+  }
+  new_state = (unsigned char *)realloc(socket_state, new_size);
+  if (new_state == NULL) {
+    return KNI_FALSE;
+  }
+  memset(new_state + socket_state_size, 0, new_size - socket_state_size);
+  socket_state = new_state;
+  socket_state_size = new_size;
+  return KNI_TRUE;
+}
+
+jboolean Reactor_Initialize() {
+  socket_state = NULL;
+  socket_state_size = 0;
+  reactor_active = Os_CreateReactor();
+  return reactor_active;
+}
+
+void Reactor_Dispose() {
+  if (reactor_active) {
+    Os_DisposeReactor();
+    reactor_active = KNI_FALSE;
+  }
+  free(socket_state);
+  socket_state = NULL;
+  socket_state_size = 0;
+}
+
+jboolean Reactor_IsActive() {
+  return reactor_active;
+}
+
+jboolean Reactor_Watch(int fd, jint events) {
+  if (!reactor_active || fd < 0 || !ensure_state_capacity(fd)) {
+    return KNI_FALSE;
+  }
+  if ((socket_state[fd] & REACTOR_REGISTERED) == 0) {
+    if (!Os_ReactorAdd(fd)) {
+      return KNI_FALSE;
+    }
+    socket_state[fd] = REACTOR_REGISTERED;
+  } else if (socket_state[fd] & events) {
+    /*
+     * The socket became ready after the caller's last attempt had
+     * already failed with EWOULDBLOCK; no new edge will be reported,
+     * so make sure the next Reactor_WaitForEvents() does not sleep.
+     */
+    Reactor_Wakeup();
+  }
+  return KNI_TRUE;
+}
+
+void Reactor_Forget(int fd) {
+  if (reactor_active && fd >= 0 && fd < socket_state_size &&
+      (socket_state[fd] & REACTOR_REGISTERED) != 0) {
+    Os_ReactorRemove(fd);
+    socket_state[fd] = 0;
+  }
+}
+
+void Reactor_Wakeup() {
+  if (reactor_active) {
+    Os_ReactorWakeup();
+  }
+}
+
+void Reactor_WaitForEvents(jlong timeout_milli_seconds) {
+  Os_ReactorEvent events[REACTOR_MAX_EVENTS];
+  int i, n;
+
+  JVM_ASSERT(reactor_active, "sanity");
+  n = Os_ReactorWait(events, REACTOR_MAX_EVENTS, timeout_milli_seconds);
+  for (i=0; i<n; i++) {
+    int fd = events[i].fd;
+    if (fd < socket_state_size &&
+        (socket_state[fd] & REACTOR_REGISTERED) != 0) {
+      socket_state[fd] |= (events[i].events & REACTOR_PENDING_MASK);
+    }
+  }
+}
+
+jboolean Reactor_TakeReadiness(int fd, jint events) {
+  unsigned char ready;
+
+  if (fd < 0 || fd >= socket_state_size) {
+    return KNI_FALSE;
+  }
+  ready = socket_state[fd] & (events & REACTOR_PENDING_MASK);
+  if (ready == 0) {
+    return KNI_FALSE;
+  }
+  socket_state[fd] &= ~ready;
+  return KNI_TRUE;
+}
+
+#else /* !OS_REACTOR_SUPPORTED */
+
+jboolean Reactor_Initialize() {
+  return KNI_FALSE;
+}
+
+void Reactor_Dispose() {}
+
+jboolean Reactor_IsActive() {
+  return KNI_FALSE;
+}
+
+jboolean Reactor_Watch(int fd, jint events) {
+  return KNI_FALSE;
+}
+
+void Reactor_Forget(int fd) {}
+
+void Reactor_Wakeup() {}
+
+void Reactor_WaitForEvents(jlong timeout_milli_seconds) {}
+
+jboolean Reactor_TakeReadiness(int fd, jint events) {
+  return KNI_FALSE;
+}
+
+#endif /* OS_REACTOR_SUPPORTED */
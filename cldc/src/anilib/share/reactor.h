@@ -0,0 +1,53 @@
+/*
+ *   
+ *
+ * Copyright  1990-2007 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ * 
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ * 
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ */
+
+/**
+ * Reactor - readiness notification for non-blocking sockets used by ANI.
+ * (See ani.h for more details on using ANI_BlockThreadOnSocket)
+ */
+
+#ifndef _REACTOR_H_
+#define _REACTOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern jboolean Reactor_Initialize();
+extern void     Reactor_Dispose();
+extern jboolean Reactor_IsActive();
+
+extern jboolean Reactor_Watch(int fd, jint events);
+extern void     Reactor_Forget(int fd);
+extern void     Reactor_Wakeup();
+extern void     Reactor_WaitForEvents(jlong timeout_milli_seconds);
+extern jboolean Reactor_TakeReadiness(int fd, jint events);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _REACTOR_H_ */
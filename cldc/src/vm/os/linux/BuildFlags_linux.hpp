@@ -32,6 +32,12 @@
 // We use BSDSocket.cpp to implement sockets on this platform
 #define USE_BSD_SOCKET 1
 
+// Linux 2.6 provides epoll(7) for waiting on blocked sockets. Override
+// with -DSUPPORTS_EPOLL=0 in your gcc command-line for older kernels.
+#ifndef SUPPORTS_EPOLL
+#define SUPPORTS_EPOLL 1
+#endif
+
 // Override with -DSUPPORTS_TIMER_THREAD=<value> in your gcc command-line.
 #ifndef SUPPORTS_TIMER_THREAD
 #define SUPPORTS_TIMER_THREAD 1
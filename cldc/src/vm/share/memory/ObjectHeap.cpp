@@ -797,6 +797,8 @@ void ObjectHeap::finalize( FinalizerConsDesc** list ) {
   }
 }
 
+juint     ObjectHeap::_collection_count;
+
 #if ENABLE_PERFORMANCE_COUNTERS || ENABLE_TTY_TRACE || USE_DEBUG_PRINTING
 jlong     ObjectHeap::_internal_collect_start_time;
 size_t    ObjectHeap::_old_gen_size_before;
@@ -3592,6 +3594,7 @@ inline void ObjectHeap::internal_collect_prologue(size_t min_free_after_collecti
       min_free_after_collection ));
   }
 
+  _collection_count ++;
   PERFORMANCE_COUNTER_INCREMENT(num_of_gc, 1);
   if (_collection_area_start == _heap_start) {
     PERFORMANCE_COUNTER_INCREMENT(num_of_full_gc, 1);
@@ -668,6 +668,10 @@ public:
                          int /*endstack*/) PRODUCT_RETURN0;
 #endif
 
+  // Number of collections so far. Native code that keeps raw object
+  // pointers between calls compares it to find out if they have moved.
+  static juint collection_count() { return _collection_count; }
+
   // Counting
   static int count_objects();
   static int code_size_summary();
@@ -1078,6 +1082,8 @@ private:
   static OopDesc** _saved_compiler_area_top_quick;
 #endif
 
+  static juint _collection_count;
+
 #if ENABLE_PERFORMANCE_COUNTERS || ENABLE_TTY_TRACE || USE_DEBUG_PRINTING
   static jlong  _internal_collect_start_time;
   static size_t _old_gen_size_before;
@@ -74,8 +74,17 @@ extern "C" {
 #endif
 #define init_sockets()
 #define closesocket(x)          jvm_close(x)
+
+#if SUPPORTS_EPOLL && !defined(USE_LIBC_GLUE)
+#define USE_EPOLL_EVENTS 1
+#include <sys/epoll.h>
+#endif
 #endif // LINUX
 
+#ifndef USE_EPOLL_EVENTS
+#define USE_EPOLL_EVENTS 0
+#endif
+
 #if USE_WINSOCK_SOCKETS
 #undef FIELD_OFFSET
 #define WIN32_LEAN_AND_MEAN
@@ -166,6 +175,258 @@ typedef struct {
   int check_flags;     /* Should we check for read/write/exception? */
 } SocketOpenParameter;
 
+struct BlockingSocket {
+  int fd;                   /* The socket that returned EWOULDBLOCK */
+  int check_flags;          /* Should we check for read/write/exception? */
+};
+
+#if USE_EPOLL_EVENTS
+/*
+ * Blocked sockets are kept in a persistent, edge-triggered epoll set.
+ * A socket is added the first time a thread blocks on it and removed
+ * by close0(), so JVMSPI_CheckEvents() no longer rebuilds fd sets from
+ * the whole blocked-thread list and is not limited by FD_SETSIZE.
+ *
+ * Readiness reported by epoll is accumulated in _socket_events[fd] as
+ * CHECK_XXX bits until a blocked thread consumes it: with edge-triggered
+ * notification, an edge that arrives while nobody waits for it would
+ * otherwise be lost.
+ *
+ * The threads blocked on a registered socket are listed in
+ * _socket_waiters[fd], so after epoll_wait() only the threads whose
+ * sockets were reported are looked at. A waiter holds raw pointers to
+ * the thread and its reentry data, which stay valid until the heap is
+ * collected. If a GC has happened since the index was last brought up
+ * to date, it is rebuilt from the blocked-thread list.
+ *
+ * If epoll cannot be used for any reason, we permanently fall back
+ * to select(), which always looks at all blocked threads and is
+ * therefore safe to switch to at any time.
+ */
+#define EPOLL_REGISTERED        0x80
+#define EPOLL_MAX_EVENTS        64
+
+struct EpollWaiter {
+  OopDesc        *thread;
+  BlockingSocket *socket;
+  EpollWaiter    *next;
+};
+
+static int  _epoll_fd = -1;
+static bool _epoll_failed = false;
+static unsigned char *_socket_events = NULL;
+static EpollWaiter  **_socket_waiters = NULL;
+static int  _socket_events_size = 0;
+static bool  _epoll_index_valid = false;
+static juint _epoll_index_gc_count = 0;
+// Sockets that were already ready when a thread blocked on them
+static int *_epoll_pending_fds = NULL;
+static int  _epoll_pending_count = 0;
+static int  _epoll_pending_size = 0;
+#if ENABLE_JAVA_DEBUGGER
+static int  _epoll_debugger_fd = -1;
+#endif
+
+static bool epoll_is_usable() {
+  if (_epoll_fd < 0 && !_epoll_failed) {
+    _epoll_fd = epoll_create(EPOLL_MAX_EVENTS);
+    _epoll_failed = (_epoll_fd < 0);
+  }
+  return !_epoll_failed;
+}
+
+static bool epoll_ensure_capacity(int fd) {
+  if (fd < _socket_events_size) {
+    return true;
+  }
+  int new_size = (_socket_events_size > 0) ? _socket_events_size : 64;
+  while (new_size <= fd) {
+    new_size *= 2;
+  }
+  unsigned char *new_events = (unsigned char*)jvm_malloc(new_size);
+  EpollWaiter **new_waiters =
+      (EpollWaiter**)jvm_malloc(new_size * sizeof(EpollWaiter*));
+  if (new_events == NULL || new_waiters == NULL) {
+    if (new_events != NULL) {
+      jvm_free(new_events);
+    }
+    if (new_waiters != NULL) {
+      jvm_free(new_waiters);
+    }
+    return false;
+  }
+  if (_socket_events != NULL) {
+    jvm_memcpy(new_events, _socket_events, _socket_events_size);
+    jvm_memcpy(new_waiters, _socket_waiters,
+               _socket_events_size * sizeof(EpollWaiter*));
+    jvm_free(_socket_events);
+    jvm_free(_socket_waiters);
+  }
+  jvm_memset(new_events + _socket_events_size, 0,
+             new_size - _socket_events_size);
+  jvm_memset(new_waiters + _socket_events_size, 0,
+             (new_size - _socket_events_size) * sizeof(EpollWaiter*));
+  _socket_events = new_events;
+  _socket_waiters = new_waiters;
+  _socket_events_size = new_size;
+  return true;
+}
+
+static void epoll_free_waiters(int fd) {
+  EpollWaiter *w = _socket_waiters[fd];
+  while (w != NULL) {
+    EpollWaiter *next = w->next;
+    jvm_free(w);
+    w = next;
+  }
+  _socket_waiters[fd] = NULL;
+}
+
+static bool epoll_add_waiter(int fd, OopDesc *thread,
+                             BlockingSocket *socket) {
+  EpollWaiter *w;
+  for (w = _socket_waiters[fd]; w != NULL; w = w->next) {
+    if (w->thread == thread) {
+      w->socket = socket;
+      return true;
+    }
+  }
+  w = (EpollWaiter*)jvm_malloc(sizeof(EpollWaiter));
+  if (w == NULL) {
+    return false;
+  }
+  w->thread = thread;
+  w->socket = socket;
+  w->next = _socket_waiters[fd];
+  _socket_waiters[fd] = w;
+  return true;
+}
+
+// A thread may have been unblocked, or even be blocked on another fd,
+// since its waiter was added. Such waiters are dropped when found.
+static bool epoll_waiter_is_blocked(EpollWaiter *w, int fd) {
+  Thread::Raw thread = w->thread;
+  if (thread().async_redo() == 0) {
+    return false;
+  }
+  TypeArray::Raw info = thread().async_info();
+  return info.not_null() &&
+         (BlockingSocket*)info().base_address() == w->socket &&
+         w->socket->fd == fd;
+}
+
+// Called on every blocking call: only indexes the current thread, or
+// leaves the whole index to be rebuilt if objects have moved since.
+static void epoll_index_current_thread(int fd) {
+  if (!_epoll_index_valid ||
+      _epoll_index_gc_count != ObjectHeap::collection_count()) {
+    _epoll_index_valid = false;
+    return;
+  }
+  BlockingSocket *socket = (BlockingSocket *)SNI_GetReentryData(NULL);
+  if (!epoll_add_waiter(fd, Thread::current()->obj(), socket)) {
+    _epoll_index_valid = false;
+  }
+}
+
+// O(blocked threads), only needed after a GC or when out of memory
+static void epoll_rebuild_index(JVMSPI_BlockedThreadInfo * blocked_threads,
+                                int blocked_threads_count) {
+  int i;
+  for (i = 0; i < _socket_events_size; i++) {
+    epoll_free_waiters(i);
+  }
+  _epoll_index_valid = true;
+  _epoll_index_gc_count = ObjectHeap::collection_count();
+  for (i = 0; i < blocked_threads_count; i++) {
+    BlockingSocket *socket =
+        (BlockingSocket *)blocked_threads[i].reentry_data;
+    if (socket == NULL ||
+        blocked_threads[i].reentry_data_size < (int)sizeof(*socket)) {
+      continue;
+    }
+    int fd = socket->fd;
+    if (fd < 0 || fd >= _socket_events_size ||
+        (_socket_events[fd] & EPOLL_REGISTERED) == 0) {
+      continue;
+    }
+    if (!epoll_add_waiter(fd, (OopDesc*)blocked_threads[i].thread_id,
+                          socket)) {
+      _epoll_index_valid = false;
+    }
+  }
+}
+
+static void epoll_add_pending(int fd) {
+  if (_epoll_pending_count == _epoll_pending_size) {
+    int new_size = (_epoll_pending_size > 0) ? _epoll_pending_size * 2 : 16;
+    int *new_fds = (int*)jvm_malloc(new_size * sizeof(int));
+    if (new_fds == NULL) {
+      _epoll_failed = true;
+      return;
+    }
+    if (_epoll_pending_fds != NULL) {
+      jvm_memcpy(new_fds, _epoll_pending_fds,
+                 _epoll_pending_count * sizeof(int));
+      jvm_free(_epoll_pending_fds);
+    }
+    _epoll_pending_fds = new_fds;
+    _epoll_pending_size = new_size;
+  }
+  _epoll_pending_fds[_epoll_pending_count++] = fd;
+}
+
+static void epoll_watch(int fd, int check_flags) {
+  if (!epoll_is_usable()) {
+    return;
+  }
+  if (!epoll_ensure_capacity(fd)) {
+    _epoll_failed = true;
+    return;
+  }
+  if ((_socket_events[fd] & EPOLL_REGISTERED) == 0) {
+    struct epoll_event ev;
+    jvm_memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.fd = fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      _epoll_failed = true;
+      return;
+    }
+    _socket_events[fd] = EPOLL_REGISTERED;
+  } else if (_socket_events[fd] & check_flags) {
+    // The socket became ready after the caller's last attempt had
+    // failed. No new edge will be reported, so don't sleep next time.
+    epoll_add_pending(fd);
+  }
+  epoll_index_current_thread(fd);
+}
+
+static void epoll_forget(int fd) {
+  if (fd >= 0 && fd < _socket_events_size &&
+      (_socket_events[fd] & EPOLL_REGISTERED) != 0) {
+    struct epoll_event ev;
+    jvm_memset(&ev, 0, sizeof(ev));
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+    _socket_events[fd] = 0;
+    epoll_free_waiters(fd);
+  }
+}
+#endif // USE_EPOLL_EVENTS
+
+static void block_on_socket(int fd, int check_flags) {
+  if (SNI_GetReentryData(NULL) == NULL) {
+    BlockingSocket *socket =
+        (BlockingSocket *)SNI_AllocateReentryData(sizeof(*socket));
+    socket->fd = fd;
+    socket->check_flags = check_flags;
+  }
+#if USE_EPOLL_EVENTS
+  epoll_watch(fd, check_flags);
+#endif
+  SNI_BlockThread();
+}
+
 static jboolean set_blocking_flags(int *fd, jboolean is_blocking) {
 #if USE_UNISTD_SOCKETS
   int flags = jvm_fcntl(*fd, F_GETFL);
@@ -242,7 +503,7 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_open0() {
         // When the socket is ready for connect, it becomes *writable*
         // (according to BSD socket spec of select())
         p->check_flags = CHECK_WRITE | CHECK_EXCEPTION;
-        SNI_BlockThread();
+        block_on_socket(p->fd, p->check_flags);
       } else {
         jvm_shutdown(p->fd, 2);
         closesocket(p->fd);
@@ -260,11 +521,6 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_open0() {
   }
 }
 
-struct BlockingSocket {
-  int fd;                   /* The socket that returned EWOULDBLOCK */
-  int check_flags;          /* Should we check for read/write/exception? */
-};
-
 KNIEXPORT KNI_RETURNTYPE_INT
 Java_com_sun_cldc_io_j2me_socket_Protocol_readBuf() {
   int result;
@@ -291,13 +547,7 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_readBuf() {
   else if (result < 0) {
     int err_code = GET_LAST_ERROR();
     if (err_code == EWOULDBLOCK) {
-      if (SNI_GetReentryData(NULL) == NULL) {
-        BlockingSocket *socket =
-            (BlockingSocket *)SNI_AllocateReentryData(sizeof(*socket));
-        socket->fd = fd;
-        socket->check_flags = CHECK_READ;
-      }
-      SNI_BlockThread();
+      block_on_socket(fd, CHECK_READ);
     }
   }
 
@@ -327,13 +577,7 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_readByte() {
   else {
     int err_code = GET_LAST_ERROR();
     if (err_code == EWOULDBLOCK) {
-      if (SNI_GetReentryData(NULL) == NULL) {
-        BlockingSocket *socket =
-            (BlockingSocket *)SNI_AllocateReentryData(sizeof(*socket));
-        socket->fd = fd;
-        socket->check_flags = CHECK_READ;
-      }
-      SNI_BlockThread();
+      block_on_socket(fd, CHECK_READ);
     } else {
       result = -1;
     }
@@ -360,13 +604,7 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_writeBuf() {
   if (result < 0) {
     int err_code = GET_LAST_ERROR();
     if (err_code == EWOULDBLOCK) {
-      if (SNI_GetReentryData(NULL) == NULL) {
-        BlockingSocket *socket =
-            (BlockingSocket *) SNI_AllocateReentryData(sizeof(*socket));
-        socket->fd = fd;
-        socket->check_flags = CHECK_WRITE;
-      }
-      SNI_BlockThread();
+      block_on_socket(fd, CHECK_WRITE);
     }
   }
 
@@ -384,19 +622,154 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_writeByte() {
   if (result < 0) {
     int err_code = GET_LAST_ERROR();
     if (err_code == EWOULDBLOCK) {
-      if (SNI_GetReentryData(NULL) == NULL) {
-        BlockingSocket *socket =
-            (BlockingSocket *)SNI_AllocateReentryData(sizeof(*socket));
-        socket->fd = fd;
-        socket->check_flags = CHECK_WRITE;
-      }
-      SNI_BlockThread();
+      block_on_socket(fd, CHECK_WRITE);
     }
   }
 
   KNI_ReturnInt(result);
 }
 
+#if USE_EPOLL_EVENTS
+// Unblocks the threads waiting for readiness that was reported on fd
+static void epoll_wake_waiters(int fd) {
+  if (fd < 0 || fd >= _socket_events_size) {
+    return;
+  }
+  EpollWaiter **link = &_socket_waiters[fd];
+  while (*link != NULL) {
+    EpollWaiter *w = *link;
+    if (!epoll_waiter_is_blocked(w, fd)) {
+      *link = w->next;
+      jvm_free(w);
+      continue;
+    }
+    BlockingSocket *socket = w->socket;
+    int is_ready = _socket_events[fd] & socket->check_flags;
+    if (!is_ready) {
+      link = &w->next;
+      continue;
+    }
+    JVMSPI_ThreadID thread_id = (JVMSPI_ThreadID)w->thread;
+    *link = w->next;
+    jvm_free(w);
+    _socket_events[fd] &= ~is_ready;
+    if (is_ready & CHECK_EXCEPTION) {
+      // connect() has failed. Close the socket and make sure open0()
+      // returns -1. This also drops the remaining waiters of fd.
+      epoll_forget(fd);
+      jvm_shutdown(fd, 2);
+      closesocket(fd);
+      socket->fd = -1;
+      SNI_UnblockThread(thread_id);
+      return;
+    }
+    SNI_UnblockThread(thread_id);
+  }
+}
+
+static bool epoll_check_events(JVMSPI_BlockedThreadInfo * blocked_threads,
+                               int blocked_threads_count,
+                               jlong timeout_milli_seconds)
+{
+  struct epoll_event ready[EPOLL_MAX_EVENTS];
+  int i, timeout, num_ready;
+
+  if (!epoll_is_usable()) {
+    return false;
+  }
+
+  bool debugger_active = JVM_IsDebuggerActive();
+  bool debugger_ready = false;
+#if ENABLE_JAVA_DEBUGGER
+  // The debugger socket is level-triggered and follows the debugger
+  // session, so re-register it whenever it changes.
+  int dbg_socket_fd = debugger_active ? JVM_GetDebuggerSocketFd() : -1;
+  if (dbg_socket_fd != _epoll_debugger_fd) {
+    struct epoll_event ev;
+    jvm_memset(&ev, 0, sizeof(ev));
+    if (_epoll_debugger_fd != -1) {
+      epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, _epoll_debugger_fd, &ev);
+    }
+    _epoll_debugger_fd = dbg_socket_fd;
+    if (dbg_socket_fd != -1) {
+      ev.events = EPOLLIN;
+      ev.data.fd = dbg_socket_fd;
+      if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, dbg_socket_fd, &ev) != 0) {
+        _epoll_debugger_fd = -1;
+        _epoll_failed = true;
+        return false;
+      }
+    }
+  }
+#endif
+
+  // [1] Wait for readiness of any registered socket
+  if (_epoll_pending_count > 0) {
+    timeout = 0;
+  } else if (timeout_milli_seconds < 0) {
+    // Sleep forever until an event happens
+    GUARANTEE(blocked_threads_count > 0,
+              "can't sleep forever with no event sources!");
+    timeout = -1;
+  } else if (!debugger_active && blocked_threads_count == 0) {
+    Os::sleep(timeout_milli_seconds);
+    return true;
+  } else if (timeout_milli_seconds > 0x7fffffff) {
+    timeout = 0x7fffffff;
+  } else {
+    timeout = (int)timeout_milli_seconds;
+  }
+
+  num_ready = epoll_wait(_epoll_fd, ready, EPOLL_MAX_EVENTS, timeout);
+
+  // [2] Accumulate the reported readiness, O(number of ready events)
+  for (i = 0; i < num_ready; i++) {
+    int fd = ready[i].data.fd;
+#if ENABLE_JAVA_DEBUGGER
+    if (fd == _epoll_debugger_fd) {
+      debugger_ready = true;
+      continue;
+    }
+#endif
+    if (fd >= _socket_events_size ||
+        (_socket_events[fd] & EPOLL_REGISTERED) == 0) {
+      continue;
+    }
+    unsigned int events = ready[i].events;
+    if (events & EPOLLIN) {
+      _socket_events[fd] |= CHECK_READ;
+    }
+    if (events & EPOLLOUT) {
+      _socket_events[fd] |= CHECK_WRITE;
+    }
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      // Readers and writers will discover the error when they retry
+      _socket_events[fd] |= CHECK_READ | CHECK_WRITE | CHECK_EXCEPTION;
+    }
+  }
+
+  // [3] Unblock the threads whose FD is ready, O(number of ready events)
+  if (num_ready > 0 || _epoll_pending_count > 0) {
+    if (!_epoll_index_valid ||
+        _epoll_index_gc_count != ObjectHeap::collection_count()) {
+      epoll_rebuild_index(blocked_threads, blocked_threads_count);
+    }
+    for (i = 0; i < num_ready; i++) {
+      epoll_wake_waiters(ready[i].data.fd);
+    }
+    for (i = 0; i < _epoll_pending_count; i++) {
+      epoll_wake_waiters(_epoll_pending_fds[i]);
+    }
+    _epoll_pending_count = 0;
+  }
+
+  if (debugger_ready) {
+    JVM_ProcessDebuggerCmds();
+  }
+  return true;
+}
+#endif // USE_EPOLL_EVENTS
+
 void JVMSPI_CheckEvents(JVMSPI_BlockedThreadInfo * blocked_threads,
                         int blocked_threads_count, jlong timeout_milli_seconds)
 {
@@ -405,6 +778,13 @@ void JVMSPI_CheckEvents(JVMSPI_BlockedThreadInfo * blocked_threads,
   fd_set except_fds;
   int i, num_fds, num_ready;
 
+#if USE_EPOLL_EVENTS
+  if (epoll_check_events(blocked_threads, blocked_threads_count,
+                         timeout_milli_seconds)) {
+    return;
+  }
+#endif
+
   bool debugger_active = JVM_IsDebuggerActive();
 #if ENABLE_JAVA_DEBUGGER
   int dbg_socket_fd = -1;
@@ -502,6 +882,9 @@ void JVMSPI_CheckEvents(JVMSPI_BlockedThreadInfo * blocked_threads,
           // the socket and make sure open0() returns -1:
           //
           // Note to QA: this block needs more testing!
+#if USE_EPOLL_EVENTS
+          epoll_forget(socket->fd);
+#endif
           jvm_shutdown(socket->fd, 2);
           closesocket(socket->fd);
           socket->fd = -1;
@@ -535,6 +918,9 @@ Java_com_sun_cldc_io_j2me_socket_Protocol_close0() {
 
   // NOTE: this would block the VM. A real implementation should
   // make this a async native method.
+#if USE_EPOLL_EVENTS
+  epoll_forget(sock);
+#endif
   jvm_shutdown(sock, 2);
   closesocket(sock);
 }
@@ -1329,6 +1329,9 @@ void JVM::print_performance_counters() {
   }
   P_HRT(T, "total_event_hrticks",   pc->total_event_hrticks);
   P_INT(T, "total_event_checks",    (int)pc->total_event_checks);
+  P_INT(T, "num_of_thread_switches", pc->num_of_thread_switches);
+  P_HRT(T, "total_thread_switch_hrticks", pc->total_thread_switch_hrticks);
+  P_HRT(T, "max_thread_switch_hrticks",   pc->max_thread_switch_hrticks);
 
   // GC counters
   //
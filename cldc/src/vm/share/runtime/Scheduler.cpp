@@ -43,6 +43,7 @@ OopDesc*   Scheduler::_gc_current_thread = NULL;
 
 int        Scheduler::_estimated_event_readiness = 0;
 bool       Scheduler::_timer_has_ticked = false;
+jlong      Scheduler::_next_wakeup_time = max_jlong;
 bool       Scheduler::_slave_mode_yielding = false;
 jlong      Scheduler::_slave_mode_timeout = -2;
 const char Scheduler::lowbits[16] = {1,1,2,1,3,1,2,1,4,1,2,1,3,1,2,1};
@@ -78,14 +79,26 @@ unsigned int Scheduler::_task_execute_counts[Task::PRIORITY_MAX+1];
 #endif
 
 inline ReturnOop Scheduler::find_waiting_thread(Oop* obj) {
-  Thread::Raw current, start;
-  current = start = Universe::scheduler_waiting();
-  while (!current.is_null()) {
-    JavaOop::Raw wait_object = current().wait_obj();
+  Thread::Raw previous_queue;
+  return find_waiting_queue(obj, &previous_queue);
+}
+
+// Returns the first thread waiting for obj, and sets previous_queue to
+// the queue head that precedes it in the _next_waiting list, so that the
+// caller can unlink it with remove_waiting_queue_head() without walking
+// the list again.
+inline ReturnOop Scheduler::find_waiting_queue(Oop* obj,
+                                               Thread* previous_queue) {
+  Thread::Raw current = Universe::scheduler_waiting();
+  Thread::Raw next = current().next_waiting();
+  while (!next.is_null()) {
+    JavaOop::Raw wait_object = next().wait_obj();
     if (wait_object.equals(obj)) {
-      return current;
+      *previous_queue = current.obj();
+      return next;
     }
-    current = current().next_waiting();
+    current = next;
+    next = next().next_waiting();
   }
   return (ReturnOop)NULL;
 }
@@ -441,6 +454,10 @@ void Scheduler::sleep_forever() {
  *     |
  *  threadD
  *
+ * The _previous pointer of the first thread waiting for an object points
+ * to the last thread waiting for that object, so that new waiters are
+ * appended in constant time. New sleepers are added at the front of the
+ * sleep queue since their order does not matter.
 */
 
 ReturnOop Scheduler::add_waiting_thread(Thread *thread, JavaOop *obj) {
@@ -457,15 +474,14 @@ ReturnOop Scheduler::add_waiting_thread(Thread *thread, JavaOop *obj) {
     tail().set_next_waiting(thread);
     wait_queue->set_global_next(thread);
     pending_waiters = thread->obj();
+    thread->set_previous(thread);
   } else {
     GUARANTEE(obj->equals(pending_waiters().wait_obj()),
               "Wait objects not equal");
-    //    thread->set_next(&pending_waiters);
-    Thread::Raw tail = pending_waiters;
-    while (tail().next() != NULL) {
-      tail = tail().next();
-    }
+    Thread::Raw tail = pending_waiters().previous();
+    GUARANTEE(tail().next() == NULL, "must be last waiter");
     tail().set_next(thread);
+    pending_waiters().set_previous(thread);
   }
   thread->clear_next();
   thread->clear_next_waiting();
@@ -491,46 +507,52 @@ ReturnOop Scheduler::add_sync_thread(Thread* thread, Thread *pending_waiters,
   return pending_waiters->obj();
 }
 
+// Unlink the first thread waiting for an object. previous_queue is the
+// queue head that precedes it in the _next_waiting list.
+void Scheduler::remove_waiting_queue_head(Thread* thread,
+                                          Thread* previous_queue) {
+  GUARANTEE(previous_queue->next_waiting() == thread->obj(),
+            "Waiting thread not in list");
+  Thread::Raw tail = Universe::scheduler_waiting()->global_next();
+  Thread::Raw next_waiting = thread->next_waiting();
+  Thread::Raw next = thread->next();
+  if (next.is_null()) {
+    // last thread waiting for this object
+    previous_queue->set_next_waiting(&next_waiting);
+    if (tail.equals(thread)) {
+      // removing last waiting queue head, previous_queue is now the tail
+      Universe::scheduler_waiting()->set_global_next(previous_queue);
+    }
+  } else {
+    // More threads waiting for this object, 'next' becomes the head
+    Thread::Raw last = thread->previous();
+    previous_queue->set_next_waiting(&next);
+    next().set_next_waiting(&next_waiting);
+    next().set_previous(&last);
+    if (tail.equals(thread)) {
+      // 'next' is now the tail
+      Universe::scheduler_waiting()->set_global_next(&next);
+    }
+  }
+  thread->clear_next_waiting();
+  thread->clear_next();
+  thread->clear_previous();
+}
+
 void Scheduler::remove_waiting_thread(Thread* thread) {
   Thread::Raw list;
+  Thread::Raw previous_queue;
   JavaOop obj = thread->wait_obj();
   if (obj.is_null()) {
     // sleeping thread
     list = Universe::scheduler_waiting();
   } else {
-    list = find_waiting_thread(&obj);
+    list = find_waiting_queue(&obj, &previous_queue);
     GUARANTEE(!list.is_null(), "Waiting thread not in any list");
   }
   if (list.equals(thread)) {
     // Removing the head of the list
-    Thread::Raw current, tail;
-    current = Universe::scheduler_waiting();
-    tail = current().global_next();
-    Thread::Raw next = current().next_waiting();
-    while(next.not_null() && !list.equals(&next)) {
-      current = next;
-      next = next().next_waiting();
-    }
-    GUARANTEE(list.equals(&next), "Waiting thread not in list");
-    if (thread->next() == NULL) {
-      // last thread waiting for this object
-      next = thread->next_waiting();
-      current().set_next_waiting(&next);
-      if (tail.equals(thread)) {
-        // removing last waiting queue head, current is now the tail
-        Universe::scheduler_waiting()->set_global_next(&current);
-      }
-    } else {
-      // More threads waiting for this object
-      Thread::Raw next_waiting = next().next_waiting();
-      next = thread->next();
-      current().set_next_waiting(&next);
-      next().set_next_waiting(&next_waiting);
-      if (tail.equals(thread)) {
-        // 'next' is now the tail
-        Universe::scheduler_waiting()->set_global_next(&next);
-      }
-    }
+    remove_waiting_queue_head(thread, &previous_queue);
   } else {
     // Removing thread from middle of list of threads waiting for object
     Thread::Raw current = list;
@@ -542,9 +564,14 @@ void Scheduler::remove_waiting_thread(Thread* thread) {
     GUARANTEE(thread->equals(&next), "Waiting thread not in list");
     next = thread->next();
     current().set_next(&next);
+    if (next.is_null() && !obj.is_null()) {
+      // Removed the last waiter, current is now the last one
+      list().set_previous(&current);
+    }
+    thread->clear_next_waiting();
+    thread->clear_next();
+    thread->clear_previous();
   }
-  thread->clear_next_waiting();
-  thread->clear_next();
 }
 
 
@@ -554,14 +581,10 @@ void Scheduler::add_to_sleeping(Thread* thread) {
                         ~THREAD_NOT_ACTIVE_MASK) | THREAD_SLEEPING);
 #endif
   // First list is the sleep queue.
-  Thread::Raw current = Universe::scheduler_waiting();
-  Thread::Raw next = current().next();
-  while(next.not_null()) {
-    current = next;
-    next = next().next();
-  }
-  current().set_next(thread);
-  thread->clear_next();
+  Thread* sleep_queue = Universe::scheduler_waiting();
+  Thread::Raw first = sleep_queue->next();
+  thread->set_next(&first);
+  sleep_queue->set_next(thread);
   thread->clear_wait_obj();
 }
 
@@ -689,18 +712,23 @@ void Scheduler::wake_up_timed_out_sleepers(JVM_SINGLE_ARG_TRAPS) {
 
   // Wake up all sleeping threads that have timed out.
   jlong time = Os::monotonic_time_millis();
+  if (time < _next_wakeup_time) {
+    // No timer can have expired yet, don't walk the wait queues
+    return;
+  }
   GUARANTEE(Universe::scheduler_waiting() != NULL, "Sleep queue at front");
   UsingFastOops fast_oops;
   Thread::Fast this_waiting, next_waiting;
   Thread::Fast this_thread, next_thread;
+  jlong next_wakeup_time = max_jlong;
   this_waiting = Universe::scheduler_waiting();
   while (!this_waiting.is_null()) {
     next_waiting = this_waiting().next_waiting();
     this_thread = this_waiting;
     while (!this_thread.is_null()) {
       next_thread = this_thread().next();
-      if ((this_thread().wakeup_time()) != 0 && 
-          (time >= this_thread().wakeup_time())) {
+      jlong wakeup_time = this_thread().wakeup_time();
+      if (wakeup_time != 0 && time >= wakeup_time) {
         if (TraceThreadsExcessive) {
           TTY_TRACE_CR(("wakeup_timed_out_sleepers: signaling thread 0x%x"
                         " (id=%d)", (int)this_thread().obj(),
@@ -708,11 +736,14 @@ void Scheduler::wake_up_timed_out_sleepers(JVM_SINGLE_ARG_TRAPS) {
         }
         remove_waiting_thread(&this_thread);
         notify_wakeup(&this_thread JVM_CHECK);
+      } else if (wakeup_time != 0 && wakeup_time < next_wakeup_time) {
+        next_wakeup_time = wakeup_time;
       }
       this_thread = next_thread;
     }
     this_waiting = next_waiting;
   }
+  _next_wakeup_time = next_wakeup_time;
 }
 
 bool Scheduler::initialize() {
@@ -916,6 +947,7 @@ void Scheduler::wait_for(Thread* thread, jlong timeout) {
     }
   }
   thread->set_wakeup_time(wakeup);
+  note_wakeup_time(wakeup);
 
   if (Thread::current()->equals(thread)) {
     yield();
@@ -997,16 +1029,20 @@ void Scheduler::notify(JavaOop* object, bool all, bool must_be_owner
   }
 
   UsingFastOops fast_oops;
-  Thread::Fast waiting_thread = find_waiting_thread(object);
+  Thread::Fast previous_queue;
+  Thread::Fast waiting_thread = find_waiting_queue(object, &previous_queue);
   Thread::Fast waker, next_waker;
   if (!waiting_thread.is_null()) {
     if (TraceThreadsExcessive) {
       TTY_TRACE_CR(("notify: signaling object 0x%x", object->obj()));
     }
+    // Each waker is the head of the object's queue when it is removed,
+    // and previous_queue stays its predecessor, so notifyAll() costs
+    // O(waiters of this object) after the initial lookup.
     waker = waiting_thread;
     do {
       next_waker = waker().next();
-      remove_waiting_thread(&waker);
+      remove_waiting_queue_head(&waker, &previous_queue);
       notify_wakeup(&waker JVM_CHECK);
       waker = next_waker;
     } while (all && !waker.is_null());
@@ -1083,28 +1119,15 @@ void Scheduler::yield() {
       slave_mode_wait_for_event_or_timer(0);
     }
   } else {
-    Thread::Raw wait_thrd;
-    Thread::Raw t;
     if (TraceThreadsExcessive) {
       TTY_TRACE_CR(("yield: no runnable threads"));
     }
     while (*get_next_runnable_thread() == NULL) {
       // All threads are waiting for something. Let's sleep until one
-      // of them wakes up.
-      jlong min_wakeup_time = max_jlong;
-      bool sleeper_found = false;
-      wait_thrd = Universe::scheduler_waiting();
-      while (!wait_thrd.is_null()) {
-        t = wait_thrd.obj();
-        while (!t.is_null()) {
-          if (t().wakeup_time() != 0) {
-            min_wakeup_time = min(min_wakeup_time, t().wakeup_time());
-            sleeper_found = true;
-          }
-          t = t().next();
-        }
-        wait_thrd = wait_thrd().next_waiting();
-      }
+      // of them wakes up. If _next_wakeup_time is stale we just wake up
+      // early, and wake_up_timed_out_sleepers() below makes it exact.
+      jlong min_wakeup_time = _next_wakeup_time;
+      bool sleeper_found = (min_wakeup_time != max_jlong);
 
       // Must check here before calling wait_for_event... since slave mode
       // will return 'true' and we'll never resume other threads
@@ -1224,6 +1247,7 @@ void Scheduler::sleep_current_thread(jlong millis) {
     wakeup = max_jlong;
   }
   thread->set_wakeup_time(wakeup);
+  note_wakeup_time(wakeup);
   add_to_sleeping(thread);
   yield();
 }
@@ -2055,6 +2079,9 @@ extern "C" void switch_thread(Thread* thread) {
       "Should not switch threads when throwing exception from quick native");
   
   SETUP_ERROR_CHECKER_ARG;
+#if ENABLE_PERFORMANCE_COUNTERS
+  jlong switch_start_time = Os::elapsed_counter();
+#endif
   if (Scheduler::_yield_on_thread_switch) {
     // We need to call yield() after Scheduler::block_current_thread() is
     // called. yield() may cause JVMSPI_CheckEvent() to be called, and the
@@ -2096,6 +2123,15 @@ extern "C" void switch_thread(Thread* thread) {
     }
   }
 
+#if ENABLE_PERFORMANCE_COUNTERS
+  if (!next_thread->is_null() && !next_thread->equals(thread)) {
+    jlong elapsed = Os::elapsed_counter() - switch_start_time;
+    jvm_perf_count.num_of_thread_switches ++;
+    jvm_perf_count.total_thread_switch_hrticks += elapsed;
+    PERFORMANCE_COUNTER_SET_MAX(max_thread_switch_hrticks, elapsed);
+  }
+#endif
+
   // call before actual thread swicth
 #if ENABLE_WTK_PROFILER
   if (!next_thread->is_null() && !next_thread->equals(thread)) {
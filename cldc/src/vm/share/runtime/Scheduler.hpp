@@ -54,6 +54,9 @@ private:
 #endif
 
   static ReturnOop find_waiting_thread(Oop* obj);
+  static ReturnOop find_waiting_queue(Oop* obj, Thread* previous_queue);
+  static void remove_waiting_queue_head(Thread* thread,
+                                        Thread* previous_queue);
 
   static bool is_in_list(Thread* thread, Thread* list);
 #if ENABLE_ISOLATES
@@ -220,6 +223,19 @@ private:
   static bool     _timer_has_ticked;
   static int      _estimated_event_readiness;
 
+  // A lower bound of the earliest wakeup_time() of all sleeping and
+  // timed-waiting threads, or max_jlong if there are none. It allows
+  // wake_up_timed_out_sleepers() to skip walking the wait queues on
+  // thread switches where no timer can have expired. The value may be
+  // stale (too early) after a timed waiter is notified; the next walk
+  // recomputes it.
+  static jlong    _next_wakeup_time;
+  static void note_wakeup_time(jlong wakeup_time) {
+    if (wakeup_time != 0 && wakeup_time < _next_wakeup_time) {
+      _next_wakeup_time = wakeup_time;
+    }
+  }
+
 #if ENABLE_PERFORMANCE_COUNTERS
   static jlong    _slave_mode_yield_start_time;
 #endif
@@ -481,6 +481,14 @@ typedef struct _JVM_PerformanceCounters {
    */
   int num_of_timer_ticks;
 
+  /*
+   * Thread switches done by the scheduler
+   */
+  int num_of_thread_switches;  /* Number of switches to a different thread */
+  jlong total_thread_switch_hrticks; /* Total hrticks spent in the scheduler
+                                * choosing the next thread to switch to */
+  jlong max_thread_switch_hrticks; /* The longest such decision */
+
   /*
    * The following fields are measured by high-resolution system time.
    * See vm_hrtick_frequency.
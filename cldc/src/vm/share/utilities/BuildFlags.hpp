@@ -946,6 +946,12 @@
 //
 // SUPPORTS_DIRECTORIES               Does the file system support directories?
 //
+// SUPPORTS_EPOLL                     Does this OS provide epoll(7)? If so,
+//                                    BSDSocket.cpp keeps blocked sockets in
+//                                    a persistent epoll set instead of
+//                                    rebuilding select() sets on every
+//                                    JVMSPI_CheckEvents() call.
+//
 // SUPPORTS_MEMORY_MAPPED_FILES       Does this OS port
 //                                    allow mapping files into a fixed
 //                                    memory space?
@@ -991,6 +997,10 @@
 #define SUPPORTS_DIRECTORIES 1
 #endif
 
+#ifndef SUPPORTS_EPOLL
+#define SUPPORTS_EPOLL 0
+#endif
+
 #ifndef HOST_LITTLE_ENDIAN
 // This should have be set in makefiles, but need to set a default value
 // for win32_i386_ide build.
@@ -320,6 +320,7 @@ extern "C" {
 #define MIDP_PRESSED    1
 #define MIDP_RELEASED   2
 #define MIDP_DRAGGED    3
+#define MIDP_REPEATED   3
 #define MIDP_FLICKERED  5
 /** @} */
 
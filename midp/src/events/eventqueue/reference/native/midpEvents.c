@@ -102,6 +102,12 @@ typedef struct _EventQueue {
     jboolean isActive;    
     /** Thread state for each Java native event monitor. */
     jboolean isMonitorBlocked;
+    /** Largest number of events that were pending at the same time */
+    int maxNumEvents;
+    /** Number of events merged into the event stored before them */
+    int numCoalescedEvents;
+    /** Number of events dropped because the queue was full */
+    int numDroppedEvents;
 } EventQueue;
 
 /** Queues of pending events, one per Isolate or 1 for SVM mode */
@@ -329,6 +335,17 @@ static void resetEventQueue(jint queueId) {
 
     gsEventQueues[queueId].isMonitorBlocked = KNI_FALSE;
 
+    if (gsEventQueues[queueId].maxNumEvents > 0) {
+        REPORT_INFO4(LC_EVENTS, "event queue %d: max depth %d, "
+                     "coalesced %d, dropped %d", queueId,
+                     gsEventQueues[queueId].maxNumEvents,
+                     gsEventQueues[queueId].numCoalescedEvents,
+                     gsEventQueues[queueId].numDroppedEvents);
+        gsEventQueues[queueId].maxNumEvents = 0;
+        gsEventQueues[queueId].numCoalescedEvents = 0;
+        gsEventQueues[queueId].numDroppedEvents = 0;
+    }
+
     while (getPendingMIDPEvent(&event, queueId) != -1) {
         freeMIDPEventFields(event);
     }
@@ -483,6 +500,62 @@ midp_resetEvents(void) {
 #endif
 }
 
+/**
+ * Merges an event into the most recently stored event of a queue if the
+ * Java event thread has not read that one yet and the new event only
+ * supersedes it: a pointer drag replaces the position of a preceding
+ * drag, and a key repeat that is identical to the preceding event is
+ * redundant. Pointer-drag storms then occupy a single queue slot
+ * instead of filling the queue.
+ * <p>
+ * Screen repaint events are not seen here, they are created and
+ * queued in Java.
+ *
+ * @param pEventQueue the queue to store the event in
+ * @param pEvent the event to enqueue
+ *
+ * @return KNI_TRUE if the event was merged and must not be stored,
+ *         KNI_FALSE otherwise
+ */
+static jboolean coalesceMIDPEvent(EventQueue* pEventQueue,
+                                  MidpEvent* pEvent) {
+    MidpEvent* pLast;
+    int last;
+
+    if (pEventQueue->numEvents == 0) {
+        return KNI_FALSE;
+    }
+
+    last = pEventQueue->eventIn - 1;
+    if (last < 0) {
+        last = MAX_EVENTS - 1;
+    }
+    pLast = &pEventQueue->events[last];
+
+    if (pLast->type != pEvent->type ||
+            pLast->ACTION != pEvent->ACTION ||
+            pLast->DISPLAY != pEvent->DISPLAY) {
+        return KNI_FALSE;
+    }
+
+    switch (pEvent->type) {
+    case MIDP_PEN_EVENT:
+        if (pEvent->ACTION != MIDP_DRAGGED) {
+            return KNI_FALSE;
+        }
+        pLast->X_POS = pEvent->X_POS;
+        pLast->Y_POS = pEvent->Y_POS;
+        return KNI_TRUE;
+
+    case MIDP_KEY_EVENT:
+        return (pEvent->ACTION == MIDP_REPEATED &&
+                pLast->CHR == pEvent->CHR);
+
+    default:
+        return KNI_FALSE;
+    }
+}
+
 /**
  * Helper function used by StoreMIDPEventInVmThread. Enqueues an event 
  * to be processed by the Java event thread for a given event queue.
@@ -499,7 +572,15 @@ static void StoreMIDPEventInVmThreadImp(MidpEvent event, jint queueId) {
 
     midp_waitAndLockEventQueue();
 
-    if (pEventQueue->numEvents != MAX_EVENTS) {
+    if (coalesceMIDPEvent(pEventQueue, &event)) {
+        freeMIDPEventFields(event);
+        pEventQueue->numCoalescedEvents++;
+
+        /*
+         * The monitor thread cannot be blocked: the merged event
+         * has not been read yet.
+         */
+    } else if (pEventQueue->numEvents != MAX_EVENTS) {
 
         pEventQueue->events[pEventQueue->eventIn] = event;
         pEventQueue->eventIn++;
@@ -509,6 +590,9 @@ static void StoreMIDPEventInVmThreadImp(MidpEvent event, jint queueId) {
         }
       
         pEventQueue->numEvents++;
+        if (pEventQueue->numEvents > pEventQueue->maxNumEvents) {
+            pEventQueue->maxNumEvents = pEventQueue->numEvents;
+        }
 
         if (pEventQueue->isMonitorBlocked) {
             unblockMonitorThread(queueId);
@@ -521,6 +605,7 @@ static void StoreMIDPEventInVmThreadImp(MidpEvent event, jint queueId) {
          */
         REPORT_CRIT1(LC_CORE,"**event queue %d full, dropping event",
                      queueId); 
+        pEventQueue->numDroppedEvents++;
     }
 
     midp_unlockEventQueue();
@@ -104,6 +104,11 @@ static jboolean checkForSocketPointerAndKeyboardSignal(MidpReentryData* pNewSign
 
     (void)pNewMidpEvent;
 
+#if ENABLE_DEFERRED_REFRESH
+    /* Show the areas repainted since the last check before blocking */
+    fbapp_flush_refresh();
+#endif
+
     if (keyboard_fd != -1) {
         /* Set keyboard descriptor for select */
         FD_SET(keyboard_fd, &read_fds);
@@ -48,6 +48,22 @@
 extern "C" {
 #endif
 
+/**
+ * By default every fbapp_refresh() call is copied to the screen at once.
+ * With deferred refresh the refreshed areas are collected into a damage
+ * region of non-overlapping rectangles and copied by fbapp_flush_refresh(),
+ * so areas refreshed several times between flushes are copied once.
+ *
+ * IMPL_NOTE: fbapp_refresh() and fbapp_flush_refresh() are not
+ *   synchronized, so deferred refresh can only be enabled in the master
+ *   mode, which flushes the region before waiting for system signals.
+ *   The linux_fb master mode build enables it unless
+ *   USE_DEFERRED_REFRESH=false is given.
+ */
+#ifndef ENABLE_DEFERRED_REFRESH
+#define ENABLE_DEFERRED_REFRESH 0
+#endif
+
 /**
  * Initializes the FB native resources.
  */
@@ -63,6 +79,12 @@ extern void fbapp_finalize();
  */
 extern void fbapp_refresh(int hardwareId, int x, int y, int w, int h);
 
+/**
+ * Copy the areas collected by fbapp_refresh() since the previous flush
+ * to the screen. Does nothing unless ENABLE_DEFERRED_REFRESH is set.
+ */
+extern void fbapp_flush_refresh();
+
 /**
  * Invert screen orientation flag
  */
@@ -131,6 +131,7 @@ int fbapp_get_fb_device_type() {
 /** Invert screen orientation flag */
 jboolean fbapp_reverse_orientation(int hardwareId) {
     (void)hardwareId;
+    fbapp_flush_refresh();
     reverse_orientation = !reverse_orientation;
     reverseScreenOrientation();
     return reverse_orientation;
@@ -143,6 +144,7 @@ void fbapp_handle_clamshell_event() {
 /**Set full screen mode on/off */
 void fbapp_set_fullscreen_mode(int hardwareId, int mode) {
     if (isFullScreen != mode) {
+        fbapp_flush_refresh();
         isFullScreen = mode;
         resizeScreenBuffer(
             fbapp_get_screen_width(hardwareId),
@@ -206,6 +208,101 @@ static void clipRect(int hardwareId, int *x1, int *y1, int *x2, int *y2) {
     if (*y1 > *y2) { *y1 = *y2 = 0; }
 }
 
+/** Copy screen buffer area to the screen in the current orientation */
+static void refreshScreen(int x1, int y1, int x2, int y2) {
+    if (!reverse_orientation) {
+        refreshScreenNormal(x1, y1, x2, y2);
+    } else {
+        refreshScreenRotated(x1, y1, x2, y2);
+    }
+}
+
+#if ENABLE_DEFERRED_REFRESH
+/**
+ * Maximal number of rectangles in the damage region. When the region is
+ * full, a new rectangle is merged with the one it enlarges the least.
+ */
+#define MAX_DAMAGE_RECTS 8
+
+/** Screen area to be copied on the next flush */
+typedef struct {
+    int x1, y1, x2, y2;
+} DamageRect;
+
+/** Non-overlapping rectangles refreshed since the last flush */
+static DamageRect damageRects[MAX_DAMAGE_RECTS];
+
+/** Number of rectangles in the damage region */
+static int damageCount = 0;
+
+/** Area of the smallest rectangle containing both given ones */
+static int unionArea(const DamageRect *a, const DamageRect *b) {
+    int x1 = a->x1 < b->x1 ? a->x1 : b->x1;
+    int y1 = a->y1 < b->y1 ? a->y1 : b->y1;
+    int x2 = a->x2 > b->x2 ? a->x2 : b->x2;
+    int y2 = a->y2 > b->y2 ? a->y2 : b->y2;
+    return (x2 - x1) * (y2 - y1);
+}
+
+/** Extends rectangle a to contain rectangle b */
+static void unionRect(DamageRect *a, const DamageRect *b) {
+    if (b->x1 < a->x1) a->x1 = b->x1;
+    if (b->y1 < a->y1) a->y1 = b->y1;
+    if (b->x2 > a->x2) a->x2 = b->x2;
+    if (b->y2 > a->y2) a->y2 = b->y2;
+}
+
+/**
+ * Adds an area to the damage region. Rectangles that overlap the area, or
+ * can be merged with it without copying more pixels than both of them,
+ * are replaced by their union, so the region never holds overlapping
+ * rectangles and touching ones are copied as a whole.
+ */
+static void addDamage(int x1, int y1, int x2, int y2) {
+    DamageRect r;
+    int i, best, bestGrowth;
+
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+    r.x1 = x1; r.y1 = y1; r.x2 = x2; r.y2 = y2;
+
+    for (i = 0; i < damageCount; i++) {
+        DamageRect *d = &damageRects[i];
+        int overlaps = r.x1 < d->x2 && d->x1 < r.x2 &&
+                       r.y1 < d->y2 && d->y1 < r.y2;
+        if (overlaps || unionArea(&r, d) <=
+                (r.x2 - r.x1) * (r.y2 - r.y1) +
+                (d->x2 - d->x1) * (d->y2 - d->y1)) {
+            /* The union may overlap other rectangles, so start over */
+            unionRect(&r, d);
+            damageRects[i] = damageRects[--damageCount];
+            i = -1;
+        }
+    }
+
+    if (damageCount == MAX_DAMAGE_RECTS) {
+        best = 0;
+        bestGrowth = -1;
+        for (i = 0; i < damageCount; i++) {
+            DamageRect *d = &damageRects[i];
+            int growth = unionArea(&r, d) - (d->x2 - d->x1) * (d->y2 - d->y1);
+            if (bestGrowth < 0 || growth < bestGrowth) {
+                best = i;
+                bestGrowth = growth;
+            }
+        }
+        unionRect(&r, &damageRects[best]);
+        damageRects[best] = damageRects[--damageCount];
+        /* The union can overlap the remaining rectangles again */
+        addDamage(r.x1, r.y1, r.x2, r.y2);
+        return;
+    }
+
+    damageRects[damageCount++] = r;
+}
+#endif /* ENABLE_DEFERRED_REFRESH */
+
 /**
  * Bridge function to request a repaint
  * of the area specified.
@@ -217,11 +314,36 @@ static void clipRect(int hardwareId, int *x1, int *y1, int *x2, int *y2) {
  */
 void fbapp_refresh(int hardwareId, int x1, int y1, int x2, int y2) {
     clipRect(hardwareId, &x1, &y1, &x2, &y2);
-    if (!reverse_orientation) {
-        refreshScreenNormal(x1, y1, x2, y2);
-    } else {
-        refreshScreenRotated(x1, y1, x2, y2);
+#if ENABLE_DEFERRED_REFRESH
+    addDamage(x1, y1, x2, y2);
+#else
+    refreshScreen(x1, y1, x2, y2);
+#endif
+}
+
+/**
+ * Copy the areas collected by fbapp_refresh() since the previous flush
+ * to the screen. The rectangles are copied top to bottom to walk the
+ * screen buffer and the frame buffer in address order.
+ */
+void fbapp_flush_refresh() {
+#if ENABLE_DEFERRED_REFRESH
+    int i, j;
+    DamageRect r;
+
+    for (i = 1; i < damageCount; i++) {
+        r = damageRects[i];
+        for (j = i; j > 0 && damageRects[j - 1].y1 > r.y1; j--) {
+            damageRects[j] = damageRects[j - 1];
+        }
+        damageRects[j] = r;
     }
+    for (i = 0; i < damageCount; i++) {
+        refreshScreen(damageRects[i].x1, damageRects[i].y1,
+                      damageRects[i].x2, damageRects[i].y2);
+    }
+    damageCount = 0;
+#endif /* ENABLE_DEFERRED_REFRESH */
 }
 
 /**
@@ -336,6 +458,9 @@ void fbapp_map_keycode_to_event(
  * Finalize the fb application native resources.
  */
 void fbapp_finalize() {
+#if ENABLE_DEFERRED_REFRESH
+    damageCount = 0;
+#endif
     clearScreen();
     finalizeFrameBuffer();
 }
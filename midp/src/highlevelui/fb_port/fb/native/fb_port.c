@@ -72,6 +72,31 @@
 #define ENABLE_FAST_COPY_ROTATED    1
 #endif
 
+/**
+ * By default copy rotated pixel data by square blocks that fit into the
+ * data cache, instead of walking the whole source row at a time.
+ * Rotated copying falls back to ENABLE_FAST_COPY_ROTATED otherwise.
+ */
+#ifndef ENABLE_BLOCKED_COPY_ROTATED
+#define ENABLE_BLOCKED_COPY_ROTATED 1
+#endif
+
+#if ENABLE_BLOCKED_COPY_ROTATED
+/**
+ * Side of the square blocks rotated at once, in pixels. Source and
+ * target blocks of 16-bit pixels take 4KB together.
+ */
+#define ROTATE_BLOCK_SIZE 32
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ROTATE_SIMD
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ROTATE_SIMD
+#endif
+#endif /* ENABLE_BLOCKED_COPY_ROTATED */
+
 /** @def PERROR Prints diagnostic message. */
 #define PERROR(msg) REPORT_ERROR2(0, "%s: %s", msg, strerror(errno))
 
@@ -363,6 +388,10 @@ void refreshScreenNormal(int x1, int y1, int x2, int y2) {
         x1 == 0 && y1 == 0) {
         // copy the entire screen with one memcpy
         memcpy(dst, src, srcWidth * sizeof(gxj_pixel_type) * srcHeight);
+    } else if (x1 == 0 && srcWidth == bufWidth && bufWidth == dstWidth) {
+        // full-width rows are contiguous in both buffers
+        memcpy(dst + y1 * dstWidth, src + y1 * bufWidth,
+            srcWidth * sizeof(gxj_pixel_type) * srcHeight);
     } else {
         src += y1 * bufWidth + x1;
         dst += y1 * dstWidth + x1;
@@ -375,7 +404,171 @@ void refreshScreenNormal(int x1, int y1, int x2, int y2) {
     }
 }
 
-#if ENABLE_FAST_COPY_ROTATED
+#if ENABLE_BLOCKED_COPY_ROTATED
+#ifdef ROTATE_SIMD
+/**
+ * Copies 8x8 pixel block with 90 CCW rotation. The rows of the source
+ * block are transposed in registers and become the target rows, which
+ * go upwards in the screen memory.
+ *
+ * @param src pointer to the left upper pixel of the source block
+ * @param srcWidth width of the source screen buffer
+ * @param dst pointer to the target pixel of the left upper source pixel
+ * @param dstWidth width of the screen
+ */
+static void rotate_block8x8(const gxj_pixel_type *src, int srcWidth,
+        gxj_pixel_type *dst, int dstWidth) {
+#if defined(__SSE2__)
+    __m128i r0, r1, r2, r3, r4, r5, r6, r7;
+    __m128i a0, a1, a2, a3, a4, a5, a6, a7;
+
+    r0 = _mm_loadu_si128((const __m128i *)(src));
+    r1 = _mm_loadu_si128((const __m128i *)(src + srcWidth));
+    r2 = _mm_loadu_si128((const __m128i *)(src + 2 * srcWidth));
+    r3 = _mm_loadu_si128((const __m128i *)(src + 3 * srcWidth));
+    r4 = _mm_loadu_si128((const __m128i *)(src + 4 * srcWidth));
+    r5 = _mm_loadu_si128((const __m128i *)(src + 5 * srcWidth));
+    r6 = _mm_loadu_si128((const __m128i *)(src + 6 * srcWidth));
+    r7 = _mm_loadu_si128((const __m128i *)(src + 7 * srcWidth));
+
+    a0 = _mm_unpacklo_epi16(r0, r1);
+    a1 = _mm_unpackhi_epi16(r0, r1);
+    a2 = _mm_unpacklo_epi16(r2, r3);
+    a3 = _mm_unpackhi_epi16(r2, r3);
+    a4 = _mm_unpacklo_epi16(r4, r5);
+    a5 = _mm_unpackhi_epi16(r4, r5);
+    a6 = _mm_unpacklo_epi16(r6, r7);
+    a7 = _mm_unpackhi_epi16(r6, r7);
+
+    r0 = _mm_unpacklo_epi32(a0, a2);
+    r1 = _mm_unpackhi_epi32(a0, a2);
+    r2 = _mm_unpacklo_epi32(a1, a3);
+    r3 = _mm_unpackhi_epi32(a1, a3);
+    r4 = _mm_unpacklo_epi32(a4, a6);
+    r5 = _mm_unpackhi_epi32(a4, a6);
+    r6 = _mm_unpacklo_epi32(a5, a7);
+    r7 = _mm_unpackhi_epi32(a5, a7);
+
+    _mm_storeu_si128((__m128i *)(dst), _mm_unpacklo_epi64(r0, r4));
+    _mm_storeu_si128((__m128i *)(dst - dstWidth),
+        _mm_unpackhi_epi64(r0, r4));
+    _mm_storeu_si128((__m128i *)(dst - 2 * dstWidth),
+        _mm_unpacklo_epi64(r1, r5));
+    _mm_storeu_si128((__m128i *)(dst - 3 * dstWidth),
+        _mm_unpackhi_epi64(r1, r5));
+    _mm_storeu_si128((__m128i *)(dst - 4 * dstWidth),
+        _mm_unpacklo_epi64(r2, r6));
+    _mm_storeu_si128((__m128i *)(dst - 5 * dstWidth),
+        _mm_unpackhi_epi64(r2, r6));
+    _mm_storeu_si128((__m128i *)(dst - 6 * dstWidth),
+        _mm_unpacklo_epi64(r3, r7));
+    _mm_storeu_si128((__m128i *)(dst - 7 * dstWidth),
+        _mm_unpackhi_epi64(r3, r7));
+#else /* __ARM_NEON__ */
+    uint16x8x2_t t0, t1, t2, t3;
+    uint32x4x2_t u0, u1, u2, u3;
+
+    t0 = vtrnq_u16(vld1q_u16(src), vld1q_u16(src + srcWidth));
+    t1 = vtrnq_u16(vld1q_u16(src + 2 * srcWidth),
+                   vld1q_u16(src + 3 * srcWidth));
+    t2 = vtrnq_u16(vld1q_u16(src + 4 * srcWidth),
+                   vld1q_u16(src + 5 * srcWidth));
+    t3 = vtrnq_u16(vld1q_u16(src + 6 * srcWidth),
+                   vld1q_u16(src + 7 * srcWidth));
+
+    // columns 0,4 and 2,6 of rows 0-3 and 4-7
+    u0 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[0]),
+                   vreinterpretq_u32_u16(t1.val[0]));
+    u2 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[0]),
+                   vreinterpretq_u32_u16(t3.val[0]));
+    // columns 1,5 and 3,7 of rows 0-3 and 4-7
+    u1 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[1]),
+                   vreinterpretq_u32_u16(t1.val[1]));
+    u3 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[1]),
+                   vreinterpretq_u32_u16(t3.val[1]));
+
+#define ROTATE_STORE(n, u, v, half) \
+    vst1q_u16(dst - (n) * dstWidth, vreinterpretq_u16_u32(vcombine_u32( \
+        vget_##half##_u32(u), vget_##half##_u32(v))))
+
+    ROTATE_STORE(0, u0.val[0], u2.val[0], low);
+    ROTATE_STORE(1, u1.val[0], u3.val[0], low);
+    ROTATE_STORE(2, u0.val[1], u2.val[1], low);
+    ROTATE_STORE(3, u1.val[1], u3.val[1], low);
+    ROTATE_STORE(4, u0.val[0], u2.val[0], high);
+    ROTATE_STORE(5, u1.val[0], u3.val[0], high);
+    ROTATE_STORE(6, u0.val[1], u2.val[1], high);
+    ROTATE_STORE(7, u1.val[1], u3.val[1], high);
+
+#undef ROTATE_STORE
+#endif /* __SSE2__ */
+}
+#endif /* ROTATE_SIMD */
+
+/**
+ * Blocked rotated copying of screen buffer area to the screen memory.
+ * The area is copied with 90 CCW rotation by square blocks, so both the
+ * source columns read and the target rows written by a block stay in
+ * the data cache. Inside a block 8x8 pixel squares are transposed with
+ * SIMD instructions where available.
+ *
+ * There are no alignment requirements for the buffers or the area.
+ *
+ * @param src pointer to source pixel data to start copying from
+ * @param dst pointer to destination pixel data to start copying to
+ * @param width width of the copied area
+ * @param height height of the copied area
+ * @param bufWidth width of the source screen buffer
+ * @param dstWidth width of the screen
+ */
+static void blocked_copy_rotated(const gxj_pixel_type *src,
+        gxj_pixel_type *dst, int width, int height,
+        int bufWidth, int dstWidth) {
+
+    int bx, by, bw, bh, x, y;
+    const gxj_pixel_type *s;
+    gxj_pixel_type *d;
+
+    for (by = 0; by < height; by += ROTATE_BLOCK_SIZE) {
+        bh = height - by;
+        if (bh > ROTATE_BLOCK_SIZE) bh = ROTATE_BLOCK_SIZE;
+
+        for (bx = 0; bx < width; bx += ROTATE_BLOCK_SIZE) {
+            bw = width - bx;
+            if (bw > ROTATE_BLOCK_SIZE) bw = ROTATE_BLOCK_SIZE;
+
+            s = src + by * bufWidth + bx;
+            d = dst - bx * dstWidth + by;
+            x = 0;
+#ifdef ROTATE_SIMD
+            for (; x + 8 <= bw; x += 8) {
+                for (y = 0; y + 8 <= bh; y += 8) {
+                    rotate_block8x8(s + y * bufWidth + x, bufWidth,
+                        d - x * dstWidth + y, dstWidth);
+                }
+                if (y < bh) {
+                    int x8, y8;
+                    for (x8 = x; x8 < x + 8; x8++) {
+                        for (y8 = y; y8 < bh; y8++) {
+                            d[y8 - x8 * dstWidth] = s[y8 * bufWidth + x8];
+                        }
+                    }
+                }
+            }
+#endif
+            for (; x < bw; x++) {
+                const gxj_pixel_type *sp = s + x;
+                gxj_pixel_type *dp = d - x * dstWidth;
+                for (y = 0; y < bh; y++) {
+                    dp[y] = *sp;
+                    sp += bufWidth;
+                }
+            }
+        }
+    }
+}
+
+#elif ENABLE_FAST_COPY_ROTATED
 /**
  * Fast rotated copying of screen buffer area to the screen memory.
  * The copying is optimized for 32bit architecture with read caching
@@ -421,7 +614,7 @@ static void fast_copy_rotated(short *src, short *dst, int x1, int y1, int x2, in
   }
 }
 
-#else /* ENABLE_FAST_COPY_ROTATED */
+#else /* ENABLE_BLOCKED_COPY_ROTATED */
 /**
  * Simple rotated copying of screen buffer area to the screen memory.
  * Source data is traversed by lines to benefit from read caching,
@@ -457,7 +650,7 @@ static void simple_copy_rotated(short *src, short *dst, int x1, int y1, int x2,
          src += srcInc;
     }
 }
-#endif /* ENABLE_FAST_COPY_ROTATED */
+#endif /* ENABLE_BLOCKED_COPY_ROTATED */
 
 /** Refresh rotated screen with offscreen buffer content */
 void refreshScreenRotated(int x1, int y1, int x2, int y2) {
@@ -506,7 +699,12 @@ void refreshScreenRotated(int x1, int y1, int x2, int y2) {
     srcInc = bufWidth - srcWidth;      // increment for src pointer at the end of row
     dstInc = srcWidth * dstWidth + 1;  // increment for dst pointer at the end of column
 
-#if ENABLE_FAST_COPY_ROTATED
+#if ENABLE_BLOCKED_COPY_ROTATED
+    (void)srcInc;
+    (void)dstInc;
+    blocked_copy_rotated(src, dst, srcWidth, srcHeight,
+        bufWidth, dstWidth);
+#elif ENABLE_FAST_COPY_ROTATED
     fast_copy_rotated(src, dst, x1, y1, x2, y2,
         bufWidth, dstWidth, srcInc, dstInc);
 #else
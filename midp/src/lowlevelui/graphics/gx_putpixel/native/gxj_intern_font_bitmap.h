@@ -47,6 +47,14 @@
 
 typedef unsigned char* pfontbitmap;
 
+/**
+ * Keep recently drawn glyphs expanded to row masks, and string widths
+ * measured by the port, in gxj_text.c.
+ */
+#ifndef ENABLE_GLYPH_CACHE
+#define ENABLE_GLYPH_CACHE 1
+#endif
+
 /* the 0-th element is the number of bitmap tables;
  * the parameters: width, height, ascent,descent, leading
  * MUST be the same for all bitmap tables pointed to from
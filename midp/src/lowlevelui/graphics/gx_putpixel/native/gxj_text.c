@@ -212,6 +212,161 @@ static void drawChar(gxj_screen_buffer *sbuf, jchar c0,
 #endif
 }
 
+#if ENABLE_GLYPH_CACHE
+
+/**
+ * @file
+ *
+ * Glyph cache. Recently drawn glyphs are kept expanded to one bit mask
+ * per row, leftmost pixel in the most significant bit, so drawing them
+ * needs no font table lookup and no bit addressing, skips empty rows
+ * and fills runs of foreground pixels. The cache is direct mapped by
+ * character code. The bitmap font is the same for every face, style
+ * and size, so the code is the whole key.
+ */
+#define GLYPH_CACHE_SIZE        128
+#define GLYPH_CACHE_MAX_WIDTH   32
+#define GLYPH_CACHE_MAX_HEIGHT  16
+
+/** Character code + 1 of each entry, 0 for an empty entry */
+static jint glyphCacheKeys[GLYPH_CACHE_SIZE];
+static unsigned int glyphCacheRows[GLYPH_CACHE_SIZE][GLYPH_CACHE_MAX_HEIGHT];
+static unsigned long glyphCacheHits;
+static unsigned long glyphCacheMisses;
+
+/**
+ * Expands the bitmap of character c0 to fontHeight row masks.
+ */
+static void expandGlyph(jchar c0, unsigned int *rows, pfontbitmap* pfonts,
+                        int fontWidth, int fontHeight) {
+    unsigned char const * fontbitmap =
+        selectFontBitmap(c0,pfonts) + FONT_DATA;
+    jchar const c = (c0 & 0xff) -
+        fontbitmap[FONT_CODE_FIRST_LOW-FONT_DATA];
+    unsigned long mapLen =
+        ((fontbitmap[FONT_CODE_LAST_LOW-FONT_DATA]
+        - fontbitmap[FONT_CODE_FIRST_LOW-FONT_DATA]
+        + 1) * fontWidth * fontHeight + 7) >> 3;
+    unsigned long pixelIndex = c * fontHeight * fontWidth;
+    int xSource;
+    int ySource;
+
+    for (ySource = 0; ySource < fontHeight; ySource++) {
+        unsigned int mask = 0;
+        for (xSource = 0; xSource < fontWidth; xSource++, pixelIndex++) {
+            if ((pixelIndex >> 3) < mapLen &&
+                (fontbitmap[pixelIndex >> 3] & BitMask[pixelIndex & 7]) != 0) {
+                mask |= 0x80000000U >> xSource;
+            }
+        }
+        rows[ySource] = mask;
+    }
+}
+
+/**
+ * Same as drawChar(), using the glyph cache.
+ */
+static void drawGlyph(gxj_screen_buffer *sbuf, jchar c,
+		      gxj_pixel_type pixelColor, int x, int y,
+		      int xSource, int ySource, int xLimit, int yLimit,
+		      pfontbitmap* pfonts,
+		      int fontWidth, int fontHeight) {
+    int slot = c & (GLYPH_CACHE_SIZE - 1);
+    unsigned int *rows = glyphCacheRows[slot];
+    unsigned int clipMask;
+    int destWidth = sbuf->width;
+    gxj_pixel_type *dest;
+
+    if (fontWidth > GLYPH_CACHE_MAX_WIDTH ||
+            fontHeight > GLYPH_CACHE_MAX_HEIGHT) {
+        drawChar(sbuf, c, pixelColor, x, y, xSource, ySource,
+                 xLimit, yLimit, pfonts, fontWidth, fontHeight);
+        return;
+    }
+
+    if (glyphCacheKeys[slot] == c + 1) {
+        glyphCacheHits++;
+    } else {
+        expandGlyph(c, rows, pfonts, fontWidth, fontHeight);
+        glyphCacheKeys[slot] = c + 1;
+        glyphCacheMisses++;
+    }
+    if (((glyphCacheHits + glyphCacheMisses) & 0xfff) == 0) {
+        REPORT_INFO2(LC_LOWUI, "glyph cache: %lu hits, %lu misses\n",
+                     glyphCacheHits, glyphCacheMisses);
+    }
+
+    clipMask = (0xFFFFFFFFU >> xSource) &
+        ~(xLimit >= 32 ? 0 : 0xFFFFFFFFU >> xLimit);
+    dest = sbuf->pixelData + y*destWidth + x;
+    for (; ySource < yLimit; ySource++, dest += destWidth) {
+        unsigned int bits = rows[ySource] & clipMask;
+        int xGlyph = 0;
+
+        while (bits != 0) {
+            while ((bits & 0xFF000000U) == 0) {
+                bits <<= 8;
+                xGlyph += 8;
+            }
+            while ((bits & 0x80000000U) == 0) {
+                bits <<= 1;
+                xGlyph++;
+            }
+            /* a span of foreground pixels */
+            while ((bits & 0x80000000U) != 0) {
+                dest[xGlyph - xSource] = pixelColor;
+                bits <<= 1;
+                xGlyph++;
+            }
+        }
+    }
+}
+
+/**
+ * @file
+ *
+ * String width cache for widths measured by the port, direct mapped by
+ * a hash of the font and the characters.
+ */
+#define WIDTH_CACHE_SIZE        32
+#define WIDTH_CACHE_MAX_CHARS   32
+
+typedef struct {
+    int face;
+    int style;
+    int size;
+    int n;          /**< number of characters, 0 for an empty entry */
+    int width;
+    jchar chars[WIDTH_CACHE_MAX_CHARS];
+} width_cache_entry;
+
+static width_cache_entry widthCache[WIDTH_CACHE_SIZE];
+static unsigned long widthCacheHits;
+static unsigned long widthCacheMisses;
+
+/** Whether the port measures strings at all */
+static jboolean portMeasuresChars = KNI_FALSE;
+
+static width_cache_entry *
+getWidthCacheEntry(int face, int style, int size,
+                   const jchar *charArray, int n) {
+    unsigned int hash = ((face * 31) + style) * 31 + size;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        hash = hash * 31 + charArray[i];
+    }
+    return &widthCache[hash & (WIDTH_CACHE_SIZE - 1)];
+}
+
+#endif /* ENABLE_GLYPH_CACHE */
+
+#if ENABLE_GLYPH_CACHE
+#define DRAW_CHAR drawGlyph
+#else
+#define DRAW_CHAR drawChar
+#endif
+
 /*
  * @file
  *
@@ -405,9 +560,9 @@ drawString(jint pixel, const jshort *clip,
         }
 
         /* Clipped, draw the right part of the first char. */
-        drawChar(dest, charArray[charToDraw], pixelColor, xDest, yDest,
-                 xStart, yCharSource, xLimit, yLimit,
-                 FontBitmaps, fontWidth, fontHeight);
+        DRAW_CHAR(dest, charArray[charToDraw], pixelColor, xDest, yDest,
+                  xStart, yCharSource, xLimit, yLimit,
+                  FontBitmaps, fontWidth, fontHeight);
         charToDraw += direction;
         xDest += startWidth;
         widthRemaining -= startWidth;
@@ -417,16 +572,16 @@ drawString(jint pixel, const jshort *clip,
     for (i = charToDraw; i != charToStop && widthRemaining >= fontWidth;
          i+=direction, xDest += fontWidth, widthRemaining -= fontWidth) {
 
-        drawChar(dest, charArray[i], pixelColor, xDest, yDest,
-                 0, yCharSource, fontWidth, yLimit,
-                 FontBitmaps, fontWidth, fontHeight);
+        DRAW_CHAR(dest, charArray[i], pixelColor, xDest, yDest,
+                  0, yCharSource, fontWidth, yLimit,
+                  FontBitmaps, fontWidth, fontHeight);
     }
 
     if (i != charToStop && widthRemaining > 0) {
         /* Clipped, draw the left part of the last char. */
-        drawChar(dest, charArray[i], pixelColor, xDest, yDest,
-                 0, yCharSource, widthRemaining, yLimit,
-                 FontBitmaps, fontWidth, fontHeight);
+        DRAW_CHAR(dest, charArray[i], pixelColor, xDest, yDest,
+                  0, yCharSource, widthRemaining, yLimit,
+                  FontBitmaps, fontWidth, fontHeight);
     }
 }
 
@@ -504,11 +659,43 @@ int
 gx_get_charswidth(int face, int style, int size, 
 		  const jchar *charArray, int n) {
     int width;
+#if ENABLE_GLYPH_CACHE
+    width_cache_entry *entry;
+#endif
 
     REPORT_CALL_TRACE(LC_LOWUI, "gx_get_charswidth()\n");
 
+#if ENABLE_GLYPH_CACHE
+    if (portMeasuresChars && n <= WIDTH_CACHE_MAX_CHARS) {
+        entry = getWidthCacheEntry(face, style, size, charArray, n);
+        if (entry->n == n && entry->face == face && entry->style == style &&
+                entry->size == size &&
+                memcmp(entry->chars, charArray, n * sizeof(jchar)) == 0) {
+            widthCacheHits++;
+            return entry->width;
+        }
+        widthCacheMisses++;
+        if ((widthCacheMisses & 0xff) == 0) {
+            REPORT_INFO2(LC_LOWUI, "width cache: %lu hits, %lu misses\n",
+                         widthCacheHits, widthCacheMisses);
+        }
+    }
+#endif
+
     width = gxjport_get_chars_width(face, style, size, charArray, n); 
     if (width > 0) {
+#if ENABLE_GLYPH_CACHE
+        portMeasuresChars = KNI_TRUE;
+        if (n > 0 && n <= WIDTH_CACHE_MAX_CHARS) {
+            entry = getWidthCacheEntry(face, style, size, charArray, n);
+            entry->face = face;
+            entry->style = style;
+            entry->size = size;
+            entry->n = n;
+            entry->width = width;
+            memcpy(entry->chars, charArray, n * sizeof(jchar));
+        }
+#endif
         return width;
     }
 
@@ -115,7 +115,11 @@ public class Protocol extends ConnectionBaseAdapter
     private static SecurityToken classSecurityToken =
         SecurityInitializer.requestToken(new SecurityTrusted());
 
-    /** Default size for input buffer. */
+    /**
+     * Default size for the read ahead buffer of the socket connection.
+     * Buffering in the socket instead of in this class lets the buffered
+     * data stay with the connection when it goes back to the pool.
+     */
     private static int inputBufferSize = 256;
     /** Default size for output buffer. */
     private static int outputBufferSize = 2048;
@@ -133,6 +137,13 @@ public class Protocol extends ConnectionBaseAdapter
     protected static StreamConnectionPool connectionPool; 
     /** True if com.sun.midp.io.http.force_non_persistent = true. */
     private static boolean nonPersistentFlag;
+    /**
+     * Maximum number of requests to pipeline behind the one being
+     * answered on a persistent connection, 0 turns pipelining off.
+     */
+    private static int maxPipelinedRequests = 0;
+    /** How long a pipelined request waits for its turn, in milliseconds. */
+    private static int pipelinedResponseTimeout = 30000;
     /**
      * The methods other than openPrim need to know that the
      * permission occurred. com.sun.midp.io.j2me.https.Protocol
@@ -191,6 +202,15 @@ public class Protocol extends ConnectionBaseAdapter
                                  maxNumberOfPersistentConnections,
                                  connectionLingerTime);
 
+        // Pipelining is off unless a depth is configured.
+        maxPipelinedRequests = Configuration.getNonNegativeIntProperty(
+                "com.sun.midp.io.http.max_pipelined_requests",
+                maxPipelinedRequests);
+
+        pipelinedResponseTimeout = Configuration.getNonNegativeIntProperty(
+                "com.sun.midp.io.http.pipelined_response_timeout",
+                pipelinedResponseTimeout);
+
         /*
          * Get the buffer sizes from the configuration file.
          * 0 for the input buffer size shuts off input buffering.
@@ -275,12 +295,6 @@ public class Protocol extends ConnectionBaseAdapter
     private boolean requestFinished;
     /** True if eof seen. */
     private boolean eof;           
-    /** Internal stream buffer to minimize the number of TCP socket reads. */
-    private byte[] readbuf;         
-    /** Number of bytes left in internal input stream buffer. */
-    private int bytesleft;
-    /** Number of bytes read from the internal input stream buffer. */ 
-    private int bytesread;     
     /** Buffered data output for content length calculation. */
     private byte[] writebuf;         
     /** Number of bytes of data that need to be written from the buffer. */
@@ -296,6 +310,15 @@ public class Protocol extends ConnectionBaseAdapter
      * pool, forcing an IOException on the read thread.
      */
     private boolean readInProgress;
+    /** Time the request header was sent. */
+    private long requestTime;
+    /** Time from sending the request to receiving the response headers. */
+    private long responseTime;
+    /**
+     * Position of the request among the requests sent on a pooled
+     * connection, -1 if the connection was not taken from the pool.
+     */
+    private int pipelineTicket = -1;
 
     /**
      * Create a new instance of this class and intialize variables.
@@ -314,8 +337,6 @@ public class Protocol extends ConnectionBaseAdapter
         if (nonPersistentFlag) {
             ConnectionCloseFlag = true;
         }
-
-        readbuf = new byte[inputBufferSize];
     }
 
     /**
@@ -541,44 +562,19 @@ public class Protocol extends ConnectionBaseAdapter
             }
 
             /*
-             * Non-chunked unknown length
+             * Non-chunked unknown length, read until the server closes
+             * the connection. The socket buffers small reads.
              */
-
-            if (bytesleft == 0) {
+            rc = streamInput.read(b, off, len);
+            if (rc == -1) {
                 /*
-                 * the internal input stream buffer is empty, read from the
-                 * stream
+                 * The next call to this method should not read.
                  */
-                if (len >= inputBufferSize) {
-                    /*
-                     * No need to buffer, if the caller has given a big buffer.
-                     */
-                    rc = streamInput.read(b, off, len);
-                } else {
-                    rc = streamInput.read(readbuf, 0, inputBufferSize);
-                    bytesleft = rc;
-                    bytesread = 0;
-                }
-
-                if (rc == -1) {
-                    /*
-                     * The next call to this method should not read.
-                     */
-                    eof = true;
-                    return -1;
-                }
-
-                totalbytesread += rc;
-
-                if (bytesleft == 0) {
-                    /*
-                     * The data was read directly into the caller's buffer.
-                     */
-                    return rc;
-                }
+                eof = true;
+                return -1;
             }
 
-            rc = readFromBuffer(b, off, len);
+            totalbytesread += rc;
             return rc;
         } finally {
             synchronized (streamInput) {
@@ -587,43 +583,6 @@ public class Protocol extends ConnectionBaseAdapter
         }
     }
     
-    /**
-     * Reads up to <code>len</code> bytes of data from the internal buffer into
-     * an array of bytes.
-     *
-     * @param      b     the buffer into which the data is read.
-     * @param      off   the start offset in array <code>b</code>
-     *                   at which the data is written.
-     * @param      len   the maximum number of bytes to read.
-     * @return     the total number of bytes read into the buffer, or
-     *             <code>-1</code> if there is no more data because the end of
-     *             the stream has been reached.
-     * @exception  IOException  if an I/O error occurs.
-     */
-    private int readFromBuffer(byte b[], int off, int len)
-        throws IOException {
-        
-        /*
-         * copy http buffer data into user buffer, then
-         * increment and decrement counters
-         */
-        
-        int rc;
-
-        if (len > bytesleft) {
-            rc = bytesleft;
-        } else {
-            rc = len;            
-        }
-
-        System.arraycopy(readbuf, bytesread, b, off, rc);
-
-        bytesleft -= rc;
-        bytesread += rc;
-        
-        return rc;
-    }
-
     /**
      * Returns the number of bytes that can be read (or skipped over) from
      * this input stream without blocking by the next caller of a method for
@@ -645,15 +604,6 @@ public class Protocol extends ConnectionBaseAdapter
             return 0;
         }
 
-        /*
-         * Regardless of chunked or non-chunked transfers -
-         * if data is already buffered return the amount 
-         * buffered.
-         */
-        if (bytesleft > 0) { 
-            return bytesleft; 
-        }
-                
         if (chunkedIn && totalbytesread == chunksize) { 
             /* 
              * Check if a new chunk size header is available.
@@ -666,8 +616,9 @@ public class Protocol extends ConnectionBaseAdapter
          * count for the nonchunked input stream.
          */
         bytesAvailable =  streamInput.available();
-        if (chunksize <= bytesAvailable) {
-            return chunksize;
+        if (chunksize >= 0 && chunksize - totalbytesread < bytesAvailable) {
+            // the rest of the stream belongs to the next response
+            return chunksize - totalbytesread;
         }
 
         return bytesAvailable;
@@ -789,99 +740,69 @@ public class Protocol extends ConnectionBaseAdapter
 
         int rc;
 
-
-        if (bytesleft == 0) {
+        if (totalbytesread == chunksize) {
             /*
-             * the internal input stream buffer is empty, read from the stream
+             * read the end of the chunk and get the size of the
+             * the next if there is one
              */
 
-            if (totalbytesread == chunksize) {
-                /*
-                 * read the end of the chunk and get the size of the
-                 * the next if there is one
-                 */
-
-                if (!chunkedIn) {
-                    /*
-                     * non-chucked data is treated as one big chunk so there
-                     * is no more data so just return as if there are no
-                     * more chunks
-                     */
-                    eof = true;
-                    return -1;
-                }
-
-                skipEndOfChunkCRLF();
-
-                chunksize = readChunkSize();
-                if (chunksize == 0) {
-                    eof = true;
-
-                    /*
-                     * REFERENCE: HTTP1.1 document 
-                     * SECTION: 3.6.1 Chunked Transfer Coding
-                     * in some cases there may be an OPTIONAL trailer
-                     * containing entity-header fields. since we don't support
-                     * the available() method for TCP socket input streams and
-                     * for performance and reuse reasons we do not attempt to
-                     * clean up the current connections input stream. 
-                     * check readResponseMessage() method in this class for
-                     * more details
-                     */
-                    return -1;
-                }
-
+            if (!chunkedIn) {
                 /*
-                 * we have not read any bytes from this new chunk
+                 * non-chucked data is treated as one big chunk so there
+                 * is no more data so just return as if there are no
+                 * more chunks
                  */
-                totalbytesread = 0;
+                eof = true;
+                return -1;
             }
 
-            int bytesToRead = chunksize - totalbytesread;
+            skipEndOfChunkCRLF();
 
-            if (len >= bytesToRead) {
-
-                /*
-                 * No need to buffer, if the caller has given a big buffer.
-                 */
-                rc = streamInput.read(b, off, bytesToRead);
+            chunksize = readChunkSize();
+            if (chunksize == 0) {
+                eof = true;
 
-            } else if (len >= inputBufferSize) {
                 /*
-                 * No need to buffer, if the caller has given a big buffer.
+                 * REFERENCE: HTTP1.1 document 
+                 * SECTION: 3.6.1 Chunked Transfer Coding
+                 * in some cases there may be an OPTIONAL trailer
+                 * containing entity-header fields. since we don't support
+                 * the available() method for TCP socket input streams and
+                 * for performance and reuse reasons we do not attempt to
+                 * clean up the current connections input stream. 
+                 * check readResponseMessage() method in this class for
+                 * more details
                  */
-                rc = streamInput.read(b, off, len);
-            } else {
-                if (inputBufferSize >= bytesToRead) {
-                    rc = streamInput.read(readbuf, 0, bytesToRead);
-                } else {
-                    rc = streamInput.read(readbuf, 0, inputBufferSize);
-                }
-
-                bytesleft = rc;
-                bytesread = 0;
+                return -1;
             }
 
-            if (rc == -1) {
-                /*
-                 * Network problem or the wrong length was sent by the server.
-                 */
-                eof = true;
-                throw new IOException("unexpected end of stream");
-            }
+            /*
+             * we have not read any bytes from this new chunk
+             */
+            totalbytesread = 0;
+        }
 
-            totalbytesread += rc;
+        /*
+         * Read straight into the caller's buffer, the socket buffers
+         * small reads. Never read past the chunk, what follows it
+         * belongs to the next chunk or the next response.
+         */
+        int bytesToRead = chunksize - totalbytesread;
 
-            if (bytesleft == 0) {
-                /*
-                 * The data was read directly into the caller's buffer.
-                 */
-                return rc;
-            }
+        if (len > bytesToRead) {
+            len = bytesToRead;
         }
 
-        rc = readFromBuffer(b, off, len);
+        rc = streamInput.read(b, off, len);
+        if (rc == -1) {
+            /*
+             * Network problem or the wrong length was sent by the server.
+             */
+            eof = true;
+            throw new IOException("unexpected end of stream");
+        }
 
+        totalbytesread += rc;
         return rc;
     }
 
@@ -1047,6 +968,9 @@ public class Protocol extends ConnectionBaseAdapter
         }
 
         sendRequest(true, false);
+
+        /* Send the chunk now, also if the stream buffers its output */
+        streamOutput.flush();
     }
 
     /** 
@@ -1558,7 +1482,8 @@ public class Protocol extends ConnectionBaseAdapter
 
                 try {
                     connectionPool.remove(
-                        (StreamConnectionElement)streamConnection);
+                        (StreamConnectionElement)streamConnection,
+                        pipelineTicket);
                 } catch (Exception e) {
                     // do not over throw the previous exception
                 }
@@ -1631,6 +1556,13 @@ public class Protocol extends ConnectionBaseAdapter
 
         streamConnection = connect();
 
+        if (streamConnection instanceof StreamConnectionElement) {
+            pipelineTicket =
+                ((StreamConnectionElement)streamConnection).m_ticket;
+        } else {
+            pipelineTicket = -1;
+        }
+
         /*
          * Because StreamConnection.open*Stream cannot be called twice
          * the HTTP connect method may have already open the streams
@@ -1666,6 +1598,8 @@ public class Protocol extends ConnectionBaseAdapter
         String filename;
         int numberOfKeys;
 
+        requestTime = System.currentTimeMillis();
+
         /*
          * JTWI security policy for untrusted MIDlets says to add a
          * user-agent field with the value "UNTRUSTED/1.0" but still include
@@ -1916,6 +1850,18 @@ public class Protocol extends ConnectionBaseAdapter
 
         streamOutput.flush();
 
+        boolean pipelined = false;
+
+        if (streamConnection instanceof StreamConnectionElement) {
+            StreamConnectionElement sce =
+                (StreamConnectionElement)streamConnection;
+
+            // let the next request go out before our response is read
+            connectionPool.requestSent(sce);
+            pipelined = connectionPool.waitForResponse(sce,
+                            pipelineTicket, pipelinedResponseTimeout);
+        }
+
         readResponseMessage(streamInput);
         
         readHeaders(streamInput);
@@ -1928,6 +1874,35 @@ public class Protocol extends ConnectionBaseAdapter
             readResponseMessage(streamInput);
             readHeaders(streamInput);
         }
+
+        responseTime = System.currentTimeMillis() - requestTime;
+
+        if (streamConnection instanceof StreamConnectionElement) {
+            ((StreamConnectionElement)streamConnection).addResponseTime(
+                responseTime, pipelined);
+        }
+    }
+
+    /**
+     * Gets how many requests may wait for their response behind the one
+     * being answered when this request is sent on a pooled connection.
+     * Only requests without a body whose method is safe to repeat are
+     * pipelined, since a pipelined request is sent again on another
+     * connection if the connection closes before its response.
+     *
+     * @return maximum number of pipelined requests, 0 to not pipeline
+     */
+    protected int getPipelineDepth() {
+        if (!method.equals(GET) && !method.equals(HEAD)) {
+            return 0;
+        }
+
+        if (ConnectionCloseFlag || chunkedOut ||
+                (writebuf != null && bytesToWrite > 0)) {
+            return 0;
+        }
+
+        return maxPipelinedRequests;
     }
 
     /**
@@ -1949,7 +1924,7 @@ public class Protocol extends ConnectionBaseAdapter
         }
 
         sc = connectionPool.get(classSecurityToken, protocol,
-                                              url.host, url.port);
+                                url.host, url.port, getPipelineDepth());
 
         if (sc != null) {
             return sc;
@@ -2013,7 +1988,7 @@ public class Protocol extends ConnectionBaseAdapter
     private com.sun.midp.io.j2me.socket.Protocol createConnection(String url)
         throws IOException {
         com.sun.midp.io.j2me.socket.Protocol conn =
-            new com.sun.midp.io.j2me.socket.Protocol();
+            new com.sun.midp.io.j2me.socket.Protocol(inputBufferSize);
 
         conn.openPrim(classSecurityToken, url);
 
@@ -2214,9 +2189,7 @@ public class Protocol extends ConnectionBaseAdapter
         /*
          * Initialize and set the current input stream variables
          */
-        bytesleft = 0;
         chunksize = -1;
-        bytesread = 0;
         totalbytesread = 0;
         chunkedIn = false;
         eof = false;
@@ -2312,7 +2285,8 @@ public class Protocol extends ConnectionBaseAdapter
             chunksize = readChunkSize();
         } else {
             // do not let the read block if there is no data.
-            if (method.equals(HEAD)) {
+            if (method.equals(HEAD) || responseCode == HTTP_NO_CONTENT ||
+                    responseCode == HTTP_NOT_MODIFIED) {
                 chunksize = 0;
             } else {
                 // treat non chunked data of known length as one big chunk
@@ -2436,7 +2410,8 @@ public class Protocol extends ConnectionBaseAdapter
             if (streamConnection instanceof StreamConnectionElement) {
                 // we got this connection from the pool
                 connectionPool.remove(
-                        (StreamConnectionElement)streamConnection);
+                        (StreamConnectionElement)streamConnection,
+                        pipelineTicket);
             } else {
                 disconnect(streamConnection);
             }
@@ -2454,13 +2429,17 @@ public class Protocol extends ConnectionBaseAdapter
         }
 
         // save the connection for reuse
-        if (!connectionPool.add(protocol, url.host, url.port,
-                 streamConnection, streamOutput, streamInput)) {
+        StreamConnectionElement sce = connectionPool.add(protocol, url.host,
+                 url.port, streamConnection, streamOutput, streamInput);
+        if (sce == null) {
             // pool full, disconnect
             disconnect(streamConnection);
             connReused = false;
             return;
         }
+
+        // the first response on a connection is counted when it is pooled
+        sce.addResponseTime(responseTime, false);
         connReused = true;
     }
 
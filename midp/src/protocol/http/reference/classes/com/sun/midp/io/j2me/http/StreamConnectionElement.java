@@ -34,6 +34,7 @@ import java.io.DataOutputStream;
 
 import java.util.Hashtable;
 import java.util.Enumeration;
+import java.util.Vector;
 
 import javax.microedition.io.StreamConnection;
 import javax.microedition.io.Connector;
@@ -70,6 +71,35 @@ public class StreamConnectionElement
     long                      m_time;
     /** Removed from pool flag while in use. (lingered too long) */
     boolean m_removed;
+
+    /*
+     * Pipelining state, guarded by the connection pool. Each request
+     * sent on the connection gets a ticket, the responses are read
+     * in ticket order.
+     */
+    /** Number of requests handed out on this connection. */
+    int m_requestsSent;
+    /** Number of responses completely read from this connection. */
+    int m_responsesRead;
+    /** Ticket of the request last handed out. */
+    int m_ticket;
+    /** True while a request is being written to the connection. */
+    boolean m_writing;
+    /** True if the connection must be closed after the current response. */
+    boolean m_broken;
+    /** Threads that sent the requests whose responses are pending. */
+    Vector m_requesters = new Vector(2);
+
+    /** Number of responses received on this connection. */
+    private int m_responses;
+    /** Number of responses to pipelined requests. */
+    private int m_pipelinedResponses;
+    /** Sum of the response times in milliseconds. */
+    private long m_totalResponseTime;
+    /** Longest response time in milliseconds. */
+    private long m_maxResponseTime;
+    /** True once close() has been called. */
+    private boolean m_closed;
     
     /**
      * Create a new instance of this class.
@@ -102,6 +132,21 @@ public class StreamConnectionElement
      * as well as the connection itself.
      */
     public void close() {
+        if (m_closed) {
+            return;
+        }
+        m_closed = true;
+
+        if (m_responses > 0 &&
+                Logging.REPORT_LEVEL <= Logging.INFORMATION) {
+            Logging.report(Logging.INFORMATION, LogChannels.LC_PROTOCOL,
+                m_protocol + "://" + m_host + ":" + m_port + " " +
+                m_responses + " responses (" + m_pipelinedResponses +
+                " pipelined), average time " +
+                (m_totalResponseTime / m_responses) + " ms, maximum " +
+                m_maxResponseTime + " ms");
+        }
+
         try {
             if (m_data_output_stream != null) {
                 m_data_output_stream.close();
@@ -129,6 +174,69 @@ public class StreamConnectionElement
         }
     }
 
+    /**
+     * Records the time from sending a request on this connection to
+     * receiving the response headers.
+     *
+     * @param time response time in milliseconds
+     * @param pipelined true if the request was sent while an earlier
+     *                  response was still being read
+     */
+    synchronized void addResponseTime(long time, boolean pipelined) {
+        m_responses++;
+        if (pipelined) {
+            m_pipelinedResponses++;
+        }
+
+        m_totalResponseTime += time;
+        if (time > m_maxResponseTime) {
+            m_maxResponseTime = time;
+        }
+    }
+
+    /**
+     * Get the number of responses received on this connection.
+     *
+     * @return number of responses
+     */
+    public synchronized int getResponseCount() {
+        return m_responses;
+    }
+
+    /**
+     * Get the number of responses to requests that were pipelined
+     * behind another request on this connection.
+     *
+     * @return number of pipelined responses
+     */
+    public synchronized int getPipelinedResponseCount() {
+        return m_pipelinedResponses;
+    }
+
+    /**
+     * Get the average time from sending a request on this connection
+     * to receiving the response headers.
+     *
+     * @return average response time in milliseconds
+     */
+    public synchronized long getAverageResponseTime() {
+        if (m_responses == 0) {
+            return 0;
+        }
+
+        return m_totalResponseTime / m_responses;
+    }
+
+    /**
+     * Get the longest time from sending a request on this connection
+     * to receiving the response headers.
+     *
+     * @return maximum response time in milliseconds
+     */
+    public synchronized long getMaxResponseTime() {
+        return m_maxResponseTime;
+    }
+
     /**
      * Get the stream connection for this element.
      *
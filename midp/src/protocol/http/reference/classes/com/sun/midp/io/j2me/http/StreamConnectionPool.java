@@ -48,9 +48,16 @@ package com.sun.midp.io.j2me.http;
  * in-use flag is set to (true) and once that is closed its set to (false).
  * Once the connection stream element is (false) its available for reuse.
  *
+ * <p> When pipelining is requested, a connection that is in use may also
+ * be handed out, once its current request has been sent completely. The
+ * new request is written right away and its response is read when the
+ * responses to the earlier requests have been read, in the order the
+ * requests were sent.
+ *
  */
 
 import java.io.IOException;
+import java.io.InterruptedIOException;
 import java.io.InputStream;
 import java.io.OutputStream;
 import java.io.DataInputStream;
@@ -115,9 +122,10 @@ public class StreamConnectionPool {
      * @param dis                   The data input stream from the base
      *                                connection
      *
-     * @return true if the connection was added, otherwise false
+     * @return the pool element of the connection if it was added,
+     *         otherwise null
      */
-    synchronized boolean add(String p_protocol,
+    synchronized StreamConnectionElement add(String p_protocol,
             String p_host, int p_port, StreamConnection sc,
             DataOutputStream dos, DataInputStream dis) {
 
@@ -131,7 +139,7 @@ public class StreamConnectionPool {
 
             if (sce.m_in_use) {
                 if (p_host.equals(sce.m_host) && p_port == sce.m_port) {
-                    return false;
+                    return null;
                 }
 
                 continue;
@@ -160,16 +168,17 @@ public class StreamConnectionPool {
          */
         if (m_connections.size() >= m_max_connections) {
             if (oldestNotInUse == null) {
-                return false;
+                return null;
             }
 
             oldestNotInUse.close();
             m_connections.removeElement(oldestNotInUse);
         }
      
-        m_connections.addElement(new StreamConnectionElement(p_protocol,
-                          p_host, p_port, sc, dos, dis));
-        return true;
+        StreamConnectionElement added = new StreamConnectionElement(
+            p_protocol, p_host, p_port, sc, dos, dis);
+        m_connections.addElement(added);
+        return added;
     }
     
     /**
@@ -181,6 +190,26 @@ public class StreamConnectionPool {
     synchronized void remove(StreamConnectionElement sce) {
 	sce.close();
         m_connections.removeElement(sce);
+
+        // pipelined requests waiting for this connection fail now
+        notifyAll();
+    }
+
+    /**
+     * Removes a connection that failed for the request with the given
+     * ticket. If the responses to earlier requests are still being read
+     * from the connection, it is closed after the current response.
+     *
+     * @param sce                 The stream connection element to remove
+     * @param ticket              The ticket of the failed request
+     */
+    synchronized void remove(StreamConnectionElement sce, int ticket) {
+        if (ticket != sce.m_responsesRead) {
+            sce.m_broken = true;
+            return;
+        }
+
+        remove(sce);
     }
     
     /**
@@ -197,11 +226,43 @@ public class StreamConnectionPool {
      * @return                      A stream connection element or
      *                              null if not found
      */
-    public synchronized StreamConnectionElement get(
+    public StreamConnectionElement get(
             SecurityToken callerSecurityToken,
             String p_protocol, String p_host, int p_port) {
+        return get(callerSecurityToken, p_protocol, p_host, p_port, 0);
+    }
+
+    /**
+     * get an available connection and set the boolean flag to 
+     * true (unavailable) in the connection pool. If there is no
+     * available connection, get a connection in use to pipeline the
+     * request on, if allowed.
+     * Also removes any stale connections, since this method gets
+     * called more than add or remove.
+     * <p>
+     * The caller must send its request and then call
+     * {@link #requestSent}, and must call {@link #waitForResponse}
+     * before reading the response.
+     *
+     * @param callerSecurityToken   The security token of the caller
+     * @param p_protocol            The protocol for the connection
+     * @param p_host                The Hostname for the connection
+     * @param p_port                The port number for the connection
+     * @param maxPipelined          The maximum number of requests that may
+     *                              wait for their response behind the one
+     *                              being answered, 0 for no pipelining
+     *
+     * @return                      A stream connection element or
+     *                              null if not found
+     */
+    public synchronized StreamConnectionElement get(
+            SecurityToken callerSecurityToken,
+            String p_protocol, String p_host, int p_port,
+            int maxPipelined) {
 
         StreamConnectionElement result = null;
+        StreamConnectionElement busy = null;
+        Thread current = Thread.currentThread();
         long c_time = System.currentTimeMillis();
         Enumeration cons = m_connections.elements();
 
@@ -223,22 +284,109 @@ public class StreamConnectionPool {
                 continue;
             }
 
-            if (p_host.equals(sce.m_host) && p_port == sce.m_port &&
-                    p_protocol.equals(sce.m_protocol) && !sce.m_in_use) {
+            if (!p_host.equals(sce.m_host) || p_port != sce.m_port ||
+                    !p_protocol.equals(sce.m_protocol)) {
+                continue;
+            }
+
+            if (!sce.m_in_use) {
                 result = sce;
 
                 // do not break out so old connections can be removed
                 continue;
             }
+
+            /*
+             * A request can be pipelined once the requests before it have
+             * been sent. A thread must not pipeline behind its own
+             * request, it would wait for itself to read that response.
+             */
+            if (sce.m_writing || sce.m_broken ||
+                    sce.m_requesters.size() > maxPipelined ||
+                    sce.m_requesters.contains(current)) {
+                continue;
+            }
+
+            if (busy == null ||
+                    sce.m_requesters.size() < busy.m_requesters.size()) {
+                busy = sce;
+            }
+        }
+
+        if (result == null) {
+            result = busy;
         }
 
         if (result != null) {
             result.m_in_use = true;
+            result.m_writing = true;
+            result.m_ticket = result.m_requestsSent++;
+            result.m_requesters.addElement(current);
         }
 
         return result;
     }
 
+    /**
+     * Signals that the request last handed out on a connection has been
+     * sent completely, so another request may be pipelined behind it.
+     *
+     * @param sce                 The stream connection element
+     */
+    synchronized void requestSent(StreamConnectionElement sce) {
+        sce.m_writing = false;
+    }
+
+    /**
+     * Waits until the responses to the requests sent on a connection
+     * before the one with the given ticket have been read.
+     *
+     * @param sce                 The stream connection element
+     * @param ticket              The ticket of the request
+     * @param timeout             How many milliseconds to wait at most
+     *
+     * @return true if the caller had to wait for other responses
+     *
+     * @exception IOException if the connection was closed or the wait
+     *            timed out, the request has to be sent again on another
+     *            connection then
+     */
+    synchronized boolean waitForResponse(StreamConnectionElement sce,
+            int ticket, long timeout) throws IOException {
+        boolean waited = false;
+        long end = System.currentTimeMillis() + timeout;
+
+        while (sce.m_responsesRead != ticket) {
+            long remaining = end - System.currentTimeMillis();
+
+            if (sce.getBaseConnection() == null) {
+                break;
+            }
+
+            if (remaining <= 0) {
+                sce.m_broken = true;
+                throw new InterruptedIOException(
+                    "timed out waiting for the pipelined response");
+            }
+
+            waited = true;
+
+            try {
+                wait(remaining);
+            } catch (InterruptedException ie) {
+                sce.m_broken = true;
+                throw new InterruptedIOException(
+                    "interrupted waiting for the pipelined response");
+            }
+        }
+
+        if (sce.getBaseConnection() == null) {
+            throw new IOException("pipelined connection closed");
+        }
+
+        return waited;
+    }
+
     /**
      * Return an instance of the stream connection element to the 
      * connection pool so it can be reused. It is done in the method
@@ -247,7 +395,24 @@ public class StreamConnectionPool {
      * @param returned            The stream connection element to return
      */
     synchronized void returnForReuse(StreamConnectionElement returned) {
-        returned.m_in_use = false;
+        returned.m_responsesRead++;
+        if (!returned.m_requesters.isEmpty()) {
+            returned.m_requesters.removeElementAt(0);
+        }
+
+        returned.m_in_use = !returned.m_requesters.isEmpty();
+
+        if (returned.m_broken) {
+            // a pipelined request gave up, its response is in the way
+            remove(returned);
+            return;
+        }
+
+        if (returned.m_in_use) {
+            // let the next pipelined request read its response
+            notifyAll();
+            return;
+        }
 
         if (returned.m_removed) {
             // the connection was out too long
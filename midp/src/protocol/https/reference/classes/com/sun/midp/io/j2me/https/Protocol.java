@@ -342,7 +342,7 @@ public class Protocol extends com.sun.midp.io.j2me.http.Protocol
         }
 
         sc = connectionPool.get(classSecurityToken, protocol,
-                                url.host, url.port);
+                                url.host, url.port, getPipelineDepth());
 
         if (sc != null) {
             return sc;
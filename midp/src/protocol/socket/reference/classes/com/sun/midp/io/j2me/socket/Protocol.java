@@ -114,6 +114,15 @@ public class Protocol extends NetworkConnectionBase
         super(bufferSize);
     }
 
+    /**
+     * Creates a TCP client connection with its own read ahead buffer size.
+     *
+     * @param sizeOfBuffer size of the read ahead buffer, 0 for no buffering
+     */
+    public Protocol(int sizeOfBuffer) {
+        super(sizeOfBuffer);
+    }
+
     /**
      * Open a client or server socket connection.
      * <p>
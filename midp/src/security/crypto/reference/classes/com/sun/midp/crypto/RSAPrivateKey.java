@@ -31,6 +31,21 @@ package com.sun.midp.crypto;
  * us until both the modulus and exponent have been set.
  */ 
 public final class RSAPrivateKey extends RSAKey implements PrivateKey {
+    /** First prime factor of the modulus, or null if not known. */
+    byte[] p = null;
+
+    /** Second prime factor of the modulus. */
+    byte[] q = null;
+
+    /** Private exponent mod (p - 1). */
+    byte[] dp = null;
+
+    /** Private exponent mod (q - 1). */
+    byte[] dq = null;
+
+    /** Inverse of q mod p. */
+    byte[] qinv = null;
+
     /**
      * Constructor for RSA public key.
      *
@@ -55,4 +70,48 @@ public final class RSAPrivateKey extends RSAKey implements PrivateKey {
                          byte[] exponent, int expOffset, int expLen) {
         super(modulus, modOffset, modLen, exponent, expOffset, expLen);
     }
+
+    /**
+     * Constructor for RSA private key with the Chinese Remainder Theorem
+     * parameters, which let private key operations work with the prime
+     * factors of the modulus instead of the modulus itself.
+     *
+     * @param modulus modulus of key to process
+     * @param exponent private exponent of the key
+     * @param p first prime factor of the modulus
+     * @param q second prime factor of the modulus
+     * @param dp private exponent mod (p - 1)
+     * @param dq private exponent mod (q - 1)
+     * @param qinv inverse of q mod p
+     */
+    public RSAPrivateKey(byte[] modulus, byte[] exponent, byte[] p,
+                         byte[] q, byte[] dp, byte[] dq, byte[] qinv) {
+        super(modulus, 0, modulus.length, exponent, 0, exponent.length);
+        this.p = copy(p);
+        this.q = copy(q);
+        this.dp = copy(dp);
+        this.dq = copy(dq);
+        this.qinv = copy(qinv);
+    }
+
+    /**
+     * Tells if the key has the Chinese Remainder Theorem parameters.
+     *
+     * @return true if p, q, dp, dq and qinv are set
+     */
+    boolean hasCRTParameters() {
+        return p != null;
+    }
+
+    /**
+     * Copies a key parameter.
+     *
+     * @param buf the parameter
+     * @return a copy of the parameter
+     */
+    private static byte[] copy(byte[] buf) {
+        byte[] res = new byte[buf.length];
+        System.arraycopy(buf, 0, res, 0, buf.length);
+        return res;
+    }
 }
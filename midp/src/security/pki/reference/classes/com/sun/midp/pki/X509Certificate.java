@@ -1514,6 +1514,22 @@ public class X509Certificate implements Certificate {
          return res;
     }
 
+    /**
+     * Gets the ASN.1 DER encoding this certificate was parsed from.
+     * <P />
+     * @return a copy of the encoding, or null if this certificate
+     * was not created by generateCertificate
+     */
+    public byte[] getEncoded() {
+        if (enc == null) {
+            return null;
+        }
+
+        byte[] res = new byte[enc.length];
+        System.arraycopy(enc, 0, res, 0, res.length);
+        return res;
+    }
+
     /**
      * Gets the name of this certificate's issuer. <BR />
      * <B>NOTE:</B> The corresponding method in the standard edition
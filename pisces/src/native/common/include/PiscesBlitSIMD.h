@@ -0,0 +1,56 @@
+/*
+ * 
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved. 
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER 
+ *  
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License version 
+ * 2 only, as published by the Free Software Foundation. 
+ *  
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License version 2 for more details (a copy is 
+ * included at /legal/license.txt). 
+ *  
+ * You should have received a copy of the GNU General Public License 
+ * version 2 along with this work; if not, write to the Free Software 
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 
+ * 02110-1301 USA 
+ *  
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa 
+ * Clara, CA 95054 or visit www.sun.com if you need additional 
+ * information or have any questions.
+ */
+
+#ifndef PISCES_BLIT_SIMD_H
+#define PISCES_BLIT_SIMD_H
+
+#include <PiscesDefs.h>
+#include <PiscesRenderer.h>
+
+/*
+ * SIMD versions of the hottest span loops of PiscesBlit.c. They are built
+ * when PISCES_USE_SIMD is defined and the compiler targets SSE2 or NEON,
+ * and are only used if the CPU we run on supports them. Every kernel
+ * produces exactly the same pixels as the scalar loop it replaces.
+ */
+#if defined(PISCES_USE_SIMD) && (defined(__SSE2__) || defined(__ARM_NEON__))
+#define PISCES_SIMD_BLIT
+
+void blitSrcOver8888_preSIMD(Renderer *rdr, jint height);
+void blitSrcOver565SIMD(Renderer *rdr, jint height);
+void blitPTSrcOver8888_preSIMD(Renderer *rdr, jint height);
+void blitPTSrcOver565SIMD(Renderer *rdr, jint height);
+void genLinearGradientPaintSIMD(Renderer *rdr, jint height);
+
+/**
+ * Replaces the blitting and paint generation routines just chosen for the
+ * renderer's surface and paint by their SIMD versions, if the CPU supports
+ * them.
+ */
+void piscesSIMDUpdateRoutines(Renderer *rdr);
+
+#endif
+
+#endif
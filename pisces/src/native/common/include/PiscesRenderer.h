@@ -37,6 +37,7 @@
 #include <PiscesSurface.h>
 #include <PiscesPipelines.h>
 #include <PiscesTransform.h>
+#include <PiscesTiles.h>
 
 /**
  * @defgroup CompositingRules Compositing rules supported by PISCES 
@@ -137,6 +138,17 @@
 #define NUM_ALPHA_ROWS 8
 #define MIN_QUAD_OPT_WIDTH (100 << 16)
 
+/*
+ * With PISCES_ANALYTIC_AA antialiased paths are rendered by computing the
+ * exact area each pixel cell is covered by, instead of by supersampling.
+ * See renderAnalytic().
+ */
+#ifdef PISCES_ANALYTIC_AA
+#define USES_ANALYTIC_AA(rdr) ((rdr)->_MAX_AA_ALPHA > 1)
+#else
+#define USES_ANALYTIC_AA(rdr) XNI_FALSE
+#endif
+
 #define INVALID_RENDERER_SURFACE 16
 
 /**
@@ -420,6 +432,33 @@ typedef struct _Renderer {
     jint _crossingRowOffset;
     jint _crossingRowIndex;
 
+#ifdef PISCES_ANALYTIC_AA
+    // Analytic rasterizer: edges bucketed by first pixel row, active
+    // edge table and the coverage accumulation buffer of one row
+    jint *_edgeTable;
+    jint _edgeTable_length;
+    jint *_edgeList;
+    jint _edgeList_length;
+    jint *_activeEdges;
+    jint _activeEdges_length;
+    jlong *_activeX;
+    jint _activeX_length;
+    jlong *_activeStep;
+    jint _activeStep_length;
+    jint *_cellAcc;
+    jint _cellAcc_length;
+#endif
+
+#ifdef PISCES_TILED_AA
+    // Tile-parallel rendering: edge indices binned by tile, and the
+    // renderers holding the buffers of each thread
+    jint *_tileEdges;
+    jint _tileEdges_length;
+    jint *_tileStart;
+    jint _tileStart_length;
+    struct _Renderer *_tileRenderers[PISCES_TILE_THREADS];
+#endif
+
     // Current drawing position, i.e., final point of last segment
     jint _x0, _y0;
 
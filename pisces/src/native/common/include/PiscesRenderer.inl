@@ -34,6 +34,7 @@
 #include <PiscesUtil.h>
 #include <PiscesMath.h>
 #include <PiscesBlit.h>
+#include <PiscesBlitSIMD.h>
 #include <PiscesTransform.h>
 
 #include <PiscesSysutils.h>
@@ -188,6 +189,20 @@ static void computeCrossingsForEdge(Renderer *rdr, jint index,
                                     jint boundsMinY, jint boundsMaxY);
 static void computeBounds(Renderer* rdr);
 static void renderStrip(Renderer* rdr);
+#ifdef PISCES_ANALYTIC_AA
+static void renderAnalytic(Renderer* rdr, jint minY, jint maxY);
+static void renderAnalyticRows(Renderer* rdr, jint* edgeList, jint numEdges,
+                               jint rowY0, jint rowY1,
+                               jint originX, jint width);
+#ifdef PISCES_TILED_AA
+static void renderAnalyticTiles(Renderer* rdr, jint rowY0, jint rowY1,
+                                jint originX, jint width);
+static void disposeTileRenderer(Renderer* trdr);
+#endif
+static void addAnalyticSegment(jint* acc, jint width, jint dir,
+                               jint xa, jint ya, jint xb, jint yb,
+                               jint* minCell, jint* maxCell);
+#endif
 static void clearAlpha(jbyte* alpha, jint alphaOffset, jint alphaStride,
                        jint width, jint height, jint *minTouched,
                        jint *maxTouched);
@@ -248,6 +263,26 @@ renderer_dispose(Renderer* rdr) {
     my_free(rdr->_crossingIndices);
     my_free(rdr->_edges);
     my_free(rdr->_ovalPoints);
+#ifdef PISCES_ANALYTIC_AA
+    my_free(rdr->_edgeTable);
+    my_free(rdr->_edgeList);
+    my_free(rdr->_activeEdges);
+    my_free(rdr->_activeX);
+    my_free(rdr->_activeStep);
+    my_free(rdr->_cellAcc);
+#endif
+#ifdef PISCES_TILED_AA
+    my_free(rdr->_tileEdges);
+    my_free(rdr->_tileStart);
+    {
+        jint i;
+        for (i = 0; i < PISCES_TILE_THREADS; i++) {
+            if (rdr->_tileRenderers[i] != NULL) {
+                disposeTileRenderer(rdr->_tileRenderers[i]);
+            }
+        }
+    }
+#endif
 
     my_free(rdr->_texture_intData);
     my_free(rdr->_texture_byteData);
@@ -1227,6 +1262,10 @@ updateSurfaceDependedRoutines(Renderer* rdr) {
             // unsupported!
             break;
     }
+
+#ifdef PISCES_SIMD_BLIT
+    piscesSIMDUpdateRoutines(rdr);
+#endif
     
     updateCompositeDependedRoutines(rdr);
 }
@@ -1287,6 +1326,10 @@ updatePaintDependedRoutines(Renderer* rdr) {
             break;
     }
 
+#ifdef PISCES_SIMD_BLIT
+    piscesSIMDUpdateRoutines(rdr);
+#endif
+
     rdr->_rendererState &= ~INVALID_PAINT_DEPENDED_ROUTINES;
 }
 
@@ -1517,6 +1560,13 @@ endRenderingImpl(Renderer* rdr) {
         return;
     }
 
+#ifdef PISCES_ANALYTIC_AA
+    if (USES_ANALYTIC_AA(rdr)) {
+        renderAnalytic(rdr, minY, maxY);
+        return;
+    }
+#endif
+
     iminY = (minY >> rdr->_YSHIFT) & ~rdr->_SUBPIXEL_MASK_Y;
     imaxY = (maxY >> rdr->_YSHIFT) | rdr->_SUBPIXEL_MASK_Y;
     yextent = (imaxY - iminY) + 1;
@@ -1838,6 +1888,517 @@ renderStrip(Renderer* rdr) {
     }
 }
 
+#ifdef PISCES_ANALYTIC_AA
+
+/*
+ * Analytic coverage rasterizer.
+ *
+ * Instead of sampling _SUBPIXEL_POSITIONS_Y scanlines per pixel row and
+ * sorting the crossings of each, every edge is clipped to the pixel rows
+ * it spans and the area it bounds in each cell it passes through is
+ * accumulated in a buffer of the row: the part of the cell right of the
+ * edge goes into that cell, the rest of the edge's height into the next
+ * one. A running sum over the row then gives the signed coverage of each
+ * pixel, ANALYTIC_ONE for a fully covered one.
+ *
+ * Edges are bucketed by the first pixel row they touch and kept in an
+ * active edge table while they span the current row, so the work per row
+ * depends on the number of edges crossing it and not on the subpixel
+ * resolution. Only the cells between the leftmost and the rightmost edge
+ * of a row are visited.
+ *
+ * Coverage is quantized to _MAX_AA_ALPHA levels, so the alpha maps and
+ * blitters are the same as for the supersampling rasterizer.
+ */
+
+#define ANALYTIC_ONE 0x10000
+
+/* Rows per tile when rendering with several threads */
+#define ANALYTIC_TILE_ROWS (4*NUM_ALPHA_ROWS)
+
+static INLINE void
+addAnalyticCell(jint* acc, jint cell, jint x0, jint x1, jint dy) {
+    // twice the distance of the segment's middle from the cell's left side
+    jint fx2 = x0 + x1 - (cell << 9);
+    jint area = (dy*(512 - fx2)) >> 1;
+
+    acc[cell] += area;
+    acc[cell + 1] += dy*256 - area;
+}
+
+/*
+ * Adds the coverage of the segment (xa, ya)-(xb, yb) to the row buffer
+ * 'acc'. Coordinates are 24.8, x relative to the left of the raster, y
+ * relative to the top of the row, and ya < yb. 'dir' is the orientation
+ * of the edge. Parts left of the raster cover the whole row to their
+ * right, parts right of it nothing.
+ */
+static void
+addAnalyticSegment(jint* acc, jint width, jint dir,
+                   jint xa, jint ya, jint xb, jint yb,
+                   jint* minCell, jint* maxCell) {
+    jint xmax = width << 8;
+    jint c, cend, x, y, nx, ny;
+
+    if (ya == yb) {
+        return;
+    }
+
+    if (xa <= 0 && xb <= 0) {
+        acc[0] += dir*(yb - ya)*256;
+        *minCell = 0;
+        *maxCell = MAX(*maxCell, 0);
+        return;
+    }
+    if (xa >= xmax && xb >= xmax) {
+        // the row is covered up to its end by the edges left of this one
+        *maxCell = width;
+        return;
+    }
+    if ((xa < 0) != (xb < 0)) {
+        y = ya + (jint)((jlong)(0 - xa)*(yb - ya)/(xb - xa));
+        addAnalyticSegment(acc, width, dir, xa, ya, 0, y, minCell, maxCell);
+        addAnalyticSegment(acc, width, dir, 0, y, xb, yb, minCell, maxCell);
+        return;
+    }
+    if ((xa > xmax) != (xb > xmax)) {
+        y = ya + (jint)((jlong)(xmax - xa)*(yb - ya)/(xb - xa));
+        addAnalyticSegment(acc, width, dir, xa, ya, xmax, y,
+                           minCell, maxCell);
+        addAnalyticSegment(acc, width, dir, xmax, y, xb, yb,
+                           minCell, maxCell);
+        return;
+    }
+
+    if (xa <= xb) {
+        c = xa >> 8;
+        cend = (xa == xb) ? c : (xb - 1) >> 8;
+    } else {
+        c = (xa - 1) >> 8;
+        cend = xb >> 8;
+    }
+    *minCell = MIN(*minCell, MIN(c, cend));
+    *maxCell = MAX(*maxCell, MAX(c, cend) + 1);
+
+    x = xa;
+    y = ya;
+    while (c != cend) {
+        if (xa < xb) {
+            nx = (c + 1) << 8;
+            ny = ya + (jint)((jlong)(nx - xa)*(yb - ya)/(xb - xa));
+            addAnalyticCell(acc, c, x, nx, dir*(ny - y));
+            c++;
+        } else {
+            nx = c << 8;
+            ny = ya + (jint)((jlong)(nx - xa)*(yb - ya)/(xb - xa));
+            addAnalyticCell(acc, c, x, nx, dir*(ny - y));
+            c--;
+        }
+        x = nx;
+        y = ny;
+    }
+    addAnalyticCell(acc, c, x, xb, dir*(yb - y));
+}
+
+static void
+renderAnalytic(Renderer* rdr, jint minY, jint maxY) {
+    jint rowY0, rowY1, originX, width;
+    jint minX, maxX, index;
+
+    rowY0 = minY >> 16;
+    rowY1 = (maxY - 1) >> 16;
+
+    minX = INTEGER_MAX_VALUE;
+    maxX = INTEGER_MIN_VALUE;
+    for (index = 0; index < rdr->_edgeIdx; index += 5) {
+        minX = MIN(minX, MIN(rdr->_edges[index], rdr->_edges[index + 2]));
+        maxX = MAX(maxX, MAX(rdr->_edges[index], rdr->_edges[index + 2]));
+    }
+    originX = MAX(minX >> 16, rdr->_boundsMinX >> 16);
+    width = MIN(maxX >> 16, (rdr->_boundsMaxX >> 16) - 1) - originX + 1;
+
+    rdr->_bboxX0 = rdr->_bboxY0 = 0;
+    rdr->_bboxX1 = rdr->_bboxY1 = -1;
+    if (rowY1 < rowY0 || width <= 0) {
+        return;
+    }
+
+    rdr->_bboxX0 = INTEGER_MAX_VALUE;
+    rdr->_bboxX1 = INTEGER_MIN_VALUE;
+    rdr->_bboxY0 = rowY0;
+    rdr->_bboxY1 = rowY1 + 1;
+
+#ifdef PISCES_TILED_AA
+    if (rowY1 - rowY0 + 1 >= 2*ANALYTIC_TILE_ROWS &&
+            piscestiles_getThreads() > 1) {
+        renderAnalyticTiles(rdr, rowY0, rowY1, originX, width);
+    } else {
+        renderAnalyticRows(rdr, NULL, rdr->_edgeIdx/5,
+                           rowY0, rowY1, originX, width);
+    }
+#else
+    renderAnalyticRows(rdr, NULL, rdr->_edgeIdx/5,
+                       rowY0, rowY1, originX, width);
+#endif
+
+    if (rdr->_bboxX1 < rdr->_bboxX0) {
+        rdr->_bboxX0 = rdr->_bboxY0 = 0;
+        rdr->_bboxX1 = rdr->_bboxY1 = -1;
+    }
+}
+
+/*
+ * Renders pixel rows rowY0..rowY1 of the path, originX..originX+width-1
+ * horizontally, and widens the bounding box of 'rdr' by the pixels
+ * touched. 'edgeList' holds the _edges indices of the numEdges edges to
+ * consider, or is NULL to consider the first numEdges ones.
+ *
+ * The x of an edge at a row boundary is computed at the first boundary
+ * it crosses and then advanced by a fixed step per row, also when the
+ * edge starts above rowY0, so any range of rows comes out the same as
+ * when the whole path is rendered at once.
+ */
+static void
+renderAnalyticRows(Renderer* rdr, jint* edgeList, jint numEdges,
+                   jint rowY0, jint rowY1, jint originX, jint width) {
+    jint rows, numActive;
+    jint index, r, i, k, x;
+    jint rowTop, rowBot, firstBot, minCell, maxCell, lastCell;
+    jint sum, cov, maxAlpha;
+    jint x0, y0, x1, y1, dx, dy, ya, yb;
+    jlong xa, xb, originX16;
+    jint* acc;
+
+    rows = rowY1 - rowY0 + 1;
+
+    // Bucket the edges by the first row they touch
+    ALLOC3(rdr->_edgeTable, jint, rows + 1);
+    ASSERT_ALLOC(rdr->_edgeTable);
+    ALLOC3(rdr->_edgeList, jint, MAX(numEdges, 1));
+    ASSERT_ALLOC(rdr->_edgeList);
+    memset(rdr->_edgeTable, 0, (rows + 1)*sizeof(jint));
+
+    rowTop = rowY0 << 16;
+    for (k = 0; k < numEdges; k++) {
+        index = (edgeList != NULL) ? edgeList[k] : 5*k;
+        if (rdr->_edges[index + 3] > rowTop) {
+            r = (MAX(rdr->_edges[index + 1], rowTop) >> 16) - rowY0;
+            if (r < rows) {
+                rdr->_edgeTable[r]++;
+            }
+        }
+    }
+    for (r = 1; r <= rows; r++) {
+        rdr->_edgeTable[r] += rdr->_edgeTable[r - 1];
+    }
+    for (k = numEdges - 1; k >= 0; k--) {
+        index = (edgeList != NULL) ? edgeList[k] : 5*k;
+        if (rdr->_edges[index + 3] > rowTop) {
+            r = (MAX(rdr->_edges[index + 1], rowTop) >> 16) - rowY0;
+            if (r < rows) {
+                rdr->_edgeList[--rdr->_edgeTable[r]] = index;
+            }
+        }
+    }
+
+    ALLOC3(rdr->_activeEdges, jint, MAX(numEdges, 1));
+    ASSERT_ALLOC(rdr->_activeEdges);
+    ALLOC3(rdr->_activeX, jlong, MAX(numEdges, 1));
+    ASSERT_ALLOC(rdr->_activeX);
+    ALLOC3(rdr->_activeStep, jlong, MAX(numEdges, 1));
+    ASSERT_ALLOC(rdr->_activeStep);
+
+    ALLOC3(rdr->_cellAcc, jint, width + 1);
+    ASSERT_ALLOC(rdr->_cellAcc);
+    acc = rdr->_cellAcc;
+    memset(acc, 0, (width + 1)*sizeof(jint));
+
+    rdr->_alphaWidth = width;
+    ALLOC3(rdr->_rowAA, jbyte, NUM_ALPHA_ROWS*width + 1);
+    ASSERT_ALLOC(rdr->_rowAA);
+
+    ALLOC3(rdr->_paint, jint, (NUM_ALPHA_ROWS*width + 1)*((jint)sizeof(jint)));
+    ASSERT_ALLOC(rdr->_paint);
+
+    rdr->_currX = originX;
+    rdr->_currY = rowY0;
+    rdr->_currImageOffset = rdr->_imageOffset +
+                            rdr->_currY*rdr->_imageScanlineStride +
+                            rdr->_currX*rdr->_imagePixelStride;
+    rdr->_rowAAOffset = 0;
+    rdr->_rowNum = 0;
+
+    maxAlpha = rdr->_MAX_AA_ALPHA;
+    originX16 = (jlong)originX << 16;
+    numActive = 0;
+    for (r = 0; r < rows; r++) {
+        rowTop = (rowY0 + r) << 16;
+        rowBot = rowTop + 0x10000;
+
+        for (k = rdr->_edgeTable[r]; k < rdr->_edgeTable[r + 1]; k++) {
+            index = rdr->_edgeList[k];
+            x0 = rdr->_edges[index];
+            y0 = rdr->_edges[index + 1];
+            dx = rdr->_edges[index + 2] - x0;
+            dy = rdr->_edges[index + 3] - y0;
+
+            rdr->_activeEdges[numActive] = index;
+            rdr->_activeStep[numActive] = ((jlong)dx << 16)/dy;
+            if (y0 >= rowTop) {
+                rdr->_activeX[numActive] = x0;
+            } else {
+                firstBot = ((y0 >> 16) + 1) << 16;
+                rdr->_activeX[numActive] =
+                        x0 + ((jlong)firstBot - y0)*dx/dy +
+                        (((jlong)rowTop - firstBot) >> 16)*
+                        rdr->_activeStep[numActive];
+            }
+            numActive++;
+        }
+
+        minCell = INTEGER_MAX_VALUE;
+        maxCell = INTEGER_MIN_VALUE;
+        for (i = 0; i < numActive; ) {
+            index = rdr->_activeEdges[i];
+            x0 = rdr->_edges[index];
+            y0 = rdr->_edges[index + 1];
+            x1 = rdr->_edges[index + 2];
+            y1 = rdr->_edges[index + 3];
+
+            ya = MAX(y0, rowTop);
+            xa = rdr->_activeX[i];
+            if (y1 <= rowBot) {
+                yb = y1;
+                xb = x1;
+            } else {
+                yb = rowBot;
+                xb = (ya == rowTop) ? xa + rdr->_activeStep[i] :
+                        x0 + ((jlong)rowBot - y0)*((jlong)x1 - x0)/
+                        ((jlong)y1 - y0);
+            }
+
+            addAnalyticSegment(acc, width, rdr->_edges[index + 4],
+                               (jint)((xa - originX16) >> 8),
+                               (ya - rowTop) >> 8,
+                               (jint)((xb - originX16) >> 8),
+                               (yb - rowTop) >> 8,
+                               &minCell, &maxCell);
+
+            if (y1 <= rowBot) {
+                numActive--;
+                rdr->_activeEdges[i] = rdr->_activeEdges[numActive];
+                rdr->_activeX[i] = rdr->_activeX[numActive];
+                rdr->_activeStep[i] = rdr->_activeStep[numActive];
+            } else {
+                rdr->_activeX[i] = xb;
+                i++;
+            }
+        }
+
+        lastCell = MIN(maxCell, width - 1);
+        if (minCell <= lastCell) {
+            jbyte* rowAA = &rdr->_rowAA[rdr->_rowAAOffset];
+
+            sum = 0;
+            for (x = minCell; x <= lastCell; x++) {
+                sum += acc[x];
+                cov = ABS(sum);
+                if (rdr->_windingRule == WIND_EVEN_ODD) {
+                    cov &= 2*ANALYTIC_ONE - 1;
+                    if (cov > ANALYTIC_ONE) {
+                        cov = 2*ANALYTIC_ONE - cov;
+                    }
+                } else if (cov > ANALYTIC_ONE) {
+                    cov = ANALYTIC_ONE;
+                }
+                rowAA[x] = (jbyte)((cov*maxAlpha + ANALYTIC_ONE/2) >> 16);
+            }
+            memset(&acc[minCell], 0,
+                   (MIN(maxCell, width) - minCell + 1)*sizeof(jint));
+
+            rdr->_bboxX0 = MIN(rdr->_bboxX0, originX + minCell);
+            rdr->_bboxX1 = MAX(rdr->_bboxX1, originX + lastCell + 1);
+            emitRow(rdr, minCell, lastCell, (jboolean)(r == rows - 1));
+        } else {
+            if (maxCell >= minCell) {
+                memset(&acc[minCell], 0,
+                       (MIN(maxCell, width) - minCell + 1)*sizeof(jint));
+            }
+            emitRow(rdr, 0, -1, (jboolean)(r == rows - 1));
+        }
+        /* Check for error in memory allocation */
+        if (XNI_TRUE == readMemErrorFlag()) {
+            return;
+        }
+    }
+}
+
+#ifdef PISCES_TILED_AA
+
+typedef struct _AnalyticTileJob {
+    Renderer* rdr;
+    jint rowY0, rowY1;
+    jint originX, width;
+} AnalyticTileJob;
+
+static void
+renderAnalyticTile(void* arg, jint slot, jint tile) {
+    AnalyticTileJob* job = (AnalyticTileJob*)arg;
+    Renderer* rdr = job->rdr;
+    jint first = rdr->_tileStart[tile];
+    jint rowY0 = job->rowY0 + tile*ANALYTIC_TILE_ROWS;
+
+    renderAnalyticRows(rdr->_tileRenderers[slot], &rdr->_tileEdges[first],
+                       rdr->_tileStart[tile + 1] - first,
+                       rowY0, MIN(rowY0 + ANALYTIC_TILE_ROWS - 1, job->rowY1),
+                       job->originX, job->width);
+}
+
+/*
+ * Copies the rendering state of 'rdr' to the renderer a tile thread
+ * works with, keeping the tile renderer's own buffers.
+ */
+static void
+copyTileRenderer(Renderer* rdr, Renderer* trdr) {
+    Renderer buffers = *trdr;
+
+    *trdr = *rdr;
+    trdr->_edgeTable = buffers._edgeTable;
+    trdr->_edgeTable_length = buffers._edgeTable_length;
+    trdr->_edgeList = buffers._edgeList;
+    trdr->_edgeList_length = buffers._edgeList_length;
+    trdr->_activeEdges = buffers._activeEdges;
+    trdr->_activeEdges_length = buffers._activeEdges_length;
+    trdr->_activeX = buffers._activeX;
+    trdr->_activeX_length = buffers._activeX_length;
+    trdr->_activeStep = buffers._activeStep;
+    trdr->_activeStep_length = buffers._activeStep_length;
+    trdr->_cellAcc = buffers._cellAcc;
+    trdr->_cellAcc_length = buffers._cellAcc_length;
+    trdr->_rowAA = buffers._rowAA;
+    trdr->_rowAA_length = buffers._rowAA_length;
+    trdr->_paint = buffers._paint;
+    trdr->_paint_length = buffers._paint_length;
+}
+
+static void
+disposeTileRenderer(Renderer* trdr) {
+    my_free(trdr->_edgeTable);
+    my_free(trdr->_edgeList);
+    my_free(trdr->_activeEdges);
+    my_free(trdr->_activeX);
+    my_free(trdr->_activeStep);
+    my_free(trdr->_cellAcc);
+    my_free(trdr->_rowAA);
+    my_free(trdr->_paint);
+    my_free(trdr);
+}
+
+/*
+ * Splits the rows of the path in tiles of ANALYTIC_TILE_ROWS rows, bins
+ * the edges by the tiles they span and renders the tiles in parallel.
+ * Tiles cover disjoint rows, so the output is the same as that of
+ * renderAnalyticRows() for the whole path. All memory the tiles need is
+ * allocated here, on the calling thread.
+ */
+static void
+renderAnalyticTiles(Renderer* rdr, jint rowY0, jint rowY1,
+                    jint originX, jint width) {
+    AnalyticTileJob job;
+    jint numTiles, numThreads, numEdges, maxTileEdges;
+    jint top, bot, index, t, t0, t1, i, total;
+
+    numTiles = (rowY1 - rowY0 + ANALYTIC_TILE_ROWS)/ANALYTIC_TILE_ROWS;
+    numThreads = MIN(piscestiles_getThreads(), numTiles);
+    numEdges = rdr->_edgeIdx/5;
+    top = rowY0 << 16;
+    bot = (rowY1 + 1) << 16;
+
+    ALLOC3(rdr->_tileStart, jint, numTiles + 1);
+    ASSERT_ALLOC(rdr->_tileStart);
+    memset(rdr->_tileStart, 0, (numTiles + 1)*sizeof(jint));
+
+    total = 0;
+    for (index = 0; index < rdr->_edgeIdx; index += 5) {
+        if (rdr->_edges[index + 3] <= top || rdr->_edges[index + 1] >= bot) {
+            continue;
+        }
+        t0 = ((MAX(rdr->_edges[index + 1], top) >> 16) - rowY0)/
+             ANALYTIC_TILE_ROWS;
+        t1 = (((MIN(rdr->_edges[index + 3], bot) - 1) >> 16) - rowY0)/
+             ANALYTIC_TILE_ROWS;
+        for (t = t0; t <= t1; t++) {
+            rdr->_tileStart[t]++;
+        }
+        total += t1 - t0 + 1;
+    }
+    maxTileEdges = 1;
+    for (t = 0; t < numTiles; t++) {
+        maxTileEdges = MAX(maxTileEdges, rdr->_tileStart[t]);
+        rdr->_tileStart[t + 1] += rdr->_tileStart[t];
+    }
+
+    ALLOC3(rdr->_tileEdges, jint, MAX(total, 1));
+    ASSERT_ALLOC(rdr->_tileEdges);
+    for (index = rdr->_edgeIdx - 5; index >= 0; index -= 5) {
+        if (rdr->_edges[index + 3] <= top || rdr->_edges[index + 1] >= bot) {
+            continue;
+        }
+        t0 = ((MAX(rdr->_edges[index + 1], top) >> 16) - rowY0)/
+             ANALYTIC_TILE_ROWS;
+        t1 = (((MIN(rdr->_edges[index + 3], bot) - 1) >> 16) - rowY0)/
+             ANALYTIC_TILE_ROWS;
+        for (t = t0; t <= t1; t++) {
+            rdr->_tileEdges[--rdr->_tileStart[t]] = index;
+        }
+    }
+
+    for (i = 0; i < numThreads; i++) {
+        Renderer* trdr = rdr->_tileRenderers[i];
+
+        if (trdr == NULL) {
+            trdr = my_malloc(Renderer, 1);
+            ASSERT_ALLOC(trdr);
+            rdr->_tileRenderers[i] = trdr;
+        }
+        copyTileRenderer(rdr, trdr);
+
+        ALLOC3(trdr->_edgeTable, jint, ANALYTIC_TILE_ROWS + 1);
+        ASSERT_ALLOC(trdr->_edgeTable);
+        ALLOC3(trdr->_edgeList, jint, maxTileEdges);
+        ASSERT_ALLOC(trdr->_edgeList);
+        ALLOC3(trdr->_activeEdges, jint, maxTileEdges);
+        ASSERT_ALLOC(trdr->_activeEdges);
+        ALLOC3(trdr->_activeX, jlong, maxTileEdges);
+        ASSERT_ALLOC(trdr->_activeX);
+        ALLOC3(trdr->_activeStep, jlong, maxTileEdges);
+        ASSERT_ALLOC(trdr->_activeStep);
+        ALLOC3(trdr->_cellAcc, jint, width + 1);
+        ASSERT_ALLOC(trdr->_cellAcc);
+        ALLOC3(trdr->_rowAA, jbyte, NUM_ALPHA_ROWS*width + 1);
+        ASSERT_ALLOC(trdr->_rowAA);
+        ALLOC3(trdr->_paint, jint,
+               (NUM_ALPHA_ROWS*width + 1)*((jint)sizeof(jint)));
+        ASSERT_ALLOC(trdr->_paint);
+    }
+
+    job.rdr = rdr;
+    job.rowY0 = rowY0;
+    job.rowY1 = rowY1;
+    job.originX = originX;
+    job.width = width;
+    piscestiles_run(numTiles, numThreads, renderAnalyticTile, &job);
+
+    for (i = 0; i < numThreads; i++) {
+        rdr->_bboxX0 = MIN(rdr->_bboxX0, rdr->_tileRenderers[i]->_bboxX0);
+        rdr->_bboxX1 = MAX(rdr->_bboxX1, rdr->_tileRenderers[i]->_bboxX1);
+    }
+}
+
+#endif /* PISCES_TILED_AA */
+
+#endif /* PISCES_ANALYTIC_AA */
+
 static void
 clearAlpha(jbyte* alpha, jint alphaOffset, jint alphaStride,
            jint width, jint height, jint *minTouched, jint *maxTouched) {
@@ -0,0 +1,67 @@
+/*
+ * 
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved. 
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER 
+ *  
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License version 
+ * 2 only, as published by the Free Software Foundation. 
+ *  
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License version 2 for more details (a copy is 
+ * included at /legal/license.txt). 
+ *  
+ * You should have received a copy of the GNU General Public License 
+ * version 2 along with this work; if not, write to the Free Software 
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 
+ * 02110-1301 USA 
+ *  
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa 
+ * Clara, CA 95054 or visit www.sun.com if you need additional 
+ * information or have any questions.
+ */
+
+#ifndef PISCES_TILES_H
+#define PISCES_TILES_H
+
+#include <PiscesDefs.h>
+
+/*
+ * Worker pool used to rasterize the horizontal tiles of large paths in
+ * parallel. PISCES_TILE_THREADS is the maximum (and default) number of
+ * threads working on a path, the calling thread included. It is only
+ * used together with the analytic rasterizer, see renderAnalyticTiles().
+ */
+#if defined(PISCES_TILE_THREADS) && defined(PISCES_ANALYTIC_AA)
+#define PISCES_TILED_AA
+
+/*
+ * Renders one tile. 'slot' is the index of the thread running it,
+ * 0 for the calling thread, and selects the buffers to use.
+ */
+typedef void PiscesTileFunc(void* arg, jint slot, jint tile);
+
+/*
+ * Runs fn(arg, slot, tile) for tile = 0..numTiles-1 on the calling
+ * thread and at most maxThreads - 1 worker threads, and returns when
+ * all tiles are done. Tiles must not allocate memory. If the workers
+ * are busy with another path, or cannot be started, all tiles are run
+ * on the calling thread in slot 0.
+ */
+void piscestiles_run(jint numTiles, jint maxThreads,
+                     PiscesTileFunc* fn, void* arg);
+
+/* Number of threads paths are rendered with */
+jint piscestiles_getThreads();
+
+/*
+ * Sets the number of threads paths are rendered with, between 1 and
+ * PISCES_TILE_THREADS. Meant for measuring how rendering scales.
+ */
+void piscestiles_setThreads(jint threads);
+
+#endif /* PISCES_TILE_THREADS && PISCES_ANALYTIC_AA */
+
+#endif /* PISCES_TILES_H */
@@ -0,0 +1,618 @@
+/*
+ * 
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved. 
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER 
+ *  
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License version 
+ * 2 only, as published by the Free Software Foundation. 
+ *  
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License version 2 for more details (a copy is 
+ * included at /legal/license.txt). 
+ *  
+ * You should have received a copy of the GNU General Public License 
+ * version 2 along with this work; if not, write to the Free Software 
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 
+ * 02110-1301 USA 
+ *  
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa 
+ * Clara, CA 95054 or visit www.sun.com if you need additional 
+ * information or have any questions.
+ */
+
+#include <PiscesBlitSIMD.h>
+
+#ifdef PISCES_SIMD_BLIT
+
+#include <PiscesBlit.h>
+#include <PiscesUtil.h>
+#include <PiscesSysutils.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if !defined(__x86_64__)
+#include <cpuid.h>
+#endif
+#else
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#endif
+
+#define MAX_ALPHA 256
+
+/*
+ * The kernels below work on 4 (8888) or 8 (565) pixels at a time. Spans
+ * whose length is not a multiple of that are finished by running the
+ * kernel on a copy of the remaining pixels.
+ */
+
+#if defined(__SSE2__)
+
+/*
+ * Blends 4 non-premultiplied colors src into 4 premultiplied pixels dst
+ * with coverages aval, like blendSrcOver8888_pre(). aval may also be 0 or
+ * MAX_ALPHA, for which the result is dst and src respectively.
+ */
+static void
+blend4SrcOver8888_pre(jint *dst, const jint *src, const jint *aval) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i bias = _mm_set_epi32(0, 127, 127, 127);
+    __m128i d = _mm_loadu_si128((const __m128i *)dst);
+    __m128i s = _mm_or_si128(_mm_loadu_si128((const __m128i *)src),
+                             _mm_set1_epi32((jint)0xff000000));
+    __m128i a = _mm_loadu_si128((const __m128i *)aval);
+    /* (aval, 256 - aval) pairs of 16 bit weights, one per pixel */
+    __m128i w = _mm_or_si128(a, _mm_slli_epi32(
+            _mm_sub_epi32(_mm_set1_epi32(MAX_ALPHA), a), 16));
+    __m128i slo = _mm_unpacklo_epi8(s, zero);
+    __m128i shi = _mm_unpackhi_epi8(s, zero);
+    __m128i dlo = _mm_unpacklo_epi8(d, zero);
+    __m128i dhi = _mm_unpackhi_epi8(d, zero);
+    __m128i r0, r1, r2, r3;
+
+    /* s * aval + d * (256 - aval) for the 4 components of each pixel */
+    r0 = _mm_madd_epi16(_mm_unpacklo_epi16(slo, dlo),
+                        _mm_shuffle_epi32(w, 0x00));
+    r1 = _mm_madd_epi16(_mm_unpackhi_epi16(slo, dlo),
+                        _mm_shuffle_epi32(w, 0x55));
+    r2 = _mm_madd_epi16(_mm_unpacklo_epi16(shi, dhi),
+                        _mm_shuffle_epi32(w, 0xaa));
+    r3 = _mm_madd_epi16(_mm_unpackhi_epi16(shi, dhi),
+                        _mm_shuffle_epi32(w, 0xff));
+    r0 = _mm_srli_epi32(_mm_add_epi32(r0, bias), 8);
+    r1 = _mm_srli_epi32(_mm_add_epi32(r1, bias), 8);
+    r2 = _mm_srli_epi32(_mm_add_epi32(r2, bias), 8);
+    r3 = _mm_srli_epi32(_mm_add_epi32(r3, bias), 8);
+
+    _mm_storeu_si128((__m128i *)dst,
+                     _mm_packus_epi16(_mm_packs_epi32(r0, r1),
+                                      _mm_packs_epi32(r2, r3)));
+}
+
+/*
+ * Blends 8 565 colors src into 8 565 pixels dst with 6 bit opacities op
+ * (0..64), like blendSrcOver565().
+ */
+static void
+blend8SrcOver565(jshort *dst, const jshort *src, const jshort *op) {
+    __m128i mask5 = _mm_set1_epi16(0x1f);
+    __m128i mask6 = _mm_set1_epi16(0x3f);
+    __m128i d = _mm_loadu_si128((const __m128i *)dst);
+    __m128i s = _mm_loadu_si128((const __m128i *)src);
+    __m128i o = _mm_loadu_si128((const __m128i *)op);
+    __m128i dr = _mm_srli_epi16(d, 11);
+    __m128i dg = _mm_and_si128(_mm_srli_epi16(d, 5), mask6);
+    __m128i db = _mm_and_si128(d, mask5);
+    __m128i sr = _mm_srli_epi16(s, 11);
+    __m128i sg = _mm_and_si128(_mm_srli_epi16(s, 5), mask6);
+    __m128i sb = _mm_and_si128(s, mask5);
+
+    dr = _mm_add_epi16(dr, _mm_srai_epi16(
+            _mm_mullo_epi16(_mm_sub_epi16(sr, dr), o), 6));
+    dg = _mm_add_epi16(dg, _mm_srai_epi16(
+            _mm_mullo_epi16(_mm_sub_epi16(sg, dg), o), 6));
+    db = _mm_add_epi16(db, _mm_srai_epi16(
+            _mm_mullo_epi16(_mm_sub_epi16(sb, db), o), 6));
+
+    _mm_storeu_si128((__m128i *)dst,
+                     _mm_or_si128(_mm_or_si128(_mm_slli_epi16(dr, 11),
+                                               _mm_slli_epi16(dg, 5)),
+                                  db));
+}
+
+/*
+ * Computes the gradient map indices of 4 pixels starting at fraction
+ * frac, like pad() followed by the shift in genLinearGradientPaint().
+ * Only the low 32 bits of the fractions matter.
+ */
+static void
+gradientIndices4(jint *idx, jint frac, jint mx, jint cycleMethod) {
+    unsigned int f = (unsigned int)frac;
+    unsigned int m = (unsigned int)mx;
+    __m128i maxFrac = _mm_set1_epi32(0xffff);
+    __m128i v = _mm_set_epi32((jint)(f + 3 * m), (jint)(f + 2 * m),
+                              (jint)(f + m), (jint)f);
+    __m128i mask;
+
+    switch (cycleMethod) {
+    case CYCLE_NONE:
+        mask = _mm_cmpgt_epi32(v, maxFrac);
+        v = _mm_or_si128(_mm_andnot_si128(mask, v),
+                         _mm_and_si128(mask, maxFrac));
+        v = _mm_andnot_si128(_mm_cmplt_epi32(v, _mm_setzero_si128()), v);
+        break;
+    case CYCLE_REPEAT:
+        v = _mm_and_si128(v, maxFrac);
+        break;
+    case CYCLE_REFLECT:
+        mask = _mm_srai_epi32(v, 31);
+        v = _mm_sub_epi32(_mm_xor_si128(v, mask), mask);
+        v = _mm_and_si128(v, _mm_set1_epi32(0x1ffff));
+        mask = _mm_cmpgt_epi32(v, maxFrac);
+        v = _mm_or_si128(_mm_andnot_si128(mask, v),
+                         _mm_and_si128(mask, _mm_sub_epi32(
+                                 _mm_set1_epi32(0x1ffff), v)));
+        break;
+    }
+
+    _mm_storeu_si128((__m128i *)idx,
+                     _mm_srai_epi32(v, 16 - LG_GRADIENT_MAP_SIZE));
+}
+
+static jboolean
+cpuSupportsSIMD() {
+#if defined(__x86_64__)
+    return XNI_TRUE;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return XNI_FALSE;
+    }
+    return (edx & bit_SSE2) ? XNI_TRUE : XNI_FALSE;
+#endif
+}
+
+#else /* NEON */
+
+static void
+blend4SrcOver8888_pre(jint *dst, const jint *src, const jint *aval) {
+    static const uint32_t biasData[4] = { 127, 127, 127, 0 };
+    uint32x4_t bias = vld1q_u32(biasData);
+    uint8x16_t d = vld1q_u8((const uint8_t *)dst);
+    uint8x16_t s = vreinterpretq_u8_u32(
+            vorrq_u32(vld1q_u32((const uint32_t *)src),
+                      vdupq_n_u32(0xff000000)));
+    uint32x4_t a = vld1q_u32((const uint32_t *)aval);
+    uint16x4_t wa = vmovn_u32(a);
+    uint16x4_t wd = vmovn_u32(vsubq_u32(vdupq_n_u32(MAX_ALPHA), a));
+    uint16x8_t slo = vmovl_u8(vget_low_u8(s));
+    uint16x8_t shi = vmovl_u8(vget_high_u8(s));
+    uint16x8_t dlo = vmovl_u8(vget_low_u8(d));
+    uint16x8_t dhi = vmovl_u8(vget_high_u8(d));
+    uint32x4_t r0, r1, r2, r3;
+
+    /* s * aval + d * (256 - aval) for the 4 components of each pixel */
+    r0 = vmlal_u16(vmull_u16(vget_low_u16(slo), vdup_lane_u16(wa, 0)),
+                   vget_low_u16(dlo), vdup_lane_u16(wd, 0));
+    r1 = vmlal_u16(vmull_u16(vget_high_u16(slo), vdup_lane_u16(wa, 1)),
+                   vget_high_u16(dlo), vdup_lane_u16(wd, 1));
+    r2 = vmlal_u16(vmull_u16(vget_low_u16(shi), vdup_lane_u16(wa, 2)),
+                   vget_low_u16(dhi), vdup_lane_u16(wd, 2));
+    r3 = vmlal_u16(vmull_u16(vget_high_u16(shi), vdup_lane_u16(wa, 3)),
+                   vget_high_u16(dhi), vdup_lane_u16(wd, 3));
+
+    vst1q_u8((uint8_t *)dst, vcombine_u8(
+            vmovn_u16(vcombine_u16(vshrn_n_u32(vaddq_u32(r0, bias), 8),
+                                   vshrn_n_u32(vaddq_u32(r1, bias), 8))),
+            vmovn_u16(vcombine_u16(vshrn_n_u32(vaddq_u32(r2, bias), 8),
+                                   vshrn_n_u32(vaddq_u32(r3, bias), 8)))));
+}
+
+static void
+blend8SrcOver565(jshort *dst, const jshort *src, const jshort *op) {
+    uint16x8_t mask5 = vdupq_n_u16(0x1f);
+    uint16x8_t mask6 = vdupq_n_u16(0x3f);
+    uint16x8_t d = vld1q_u16((const uint16_t *)dst);
+    uint16x8_t s = vld1q_u16((const uint16_t *)src);
+    int16x8_t o = vld1q_s16((const int16_t *)op);
+    int16x8_t dr = vreinterpretq_s16_u16(vshrq_n_u16(d, 11));
+    int16x8_t dg = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(d, 5), mask6));
+    int16x8_t db = vreinterpretq_s16_u16(vandq_u16(d, mask5));
+    int16x8_t sr = vreinterpretq_s16_u16(vshrq_n_u16(s, 11));
+    int16x8_t sg = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(s, 5), mask6));
+    int16x8_t sb = vreinterpretq_s16_u16(vandq_u16(s, mask5));
+
+    dr = vaddq_s16(dr, vshrq_n_s16(vmulq_s16(vsubq_s16(sr, dr), o), 6));
+    dg = vaddq_s16(dg, vshrq_n_s16(vmulq_s16(vsubq_s16(sg, dg), o), 6));
+    db = vaddq_s16(db, vshrq_n_s16(vmulq_s16(vsubq_s16(sb, db), o), 6));
+
+    vst1q_u16((uint16_t *)dst, vorrq_u16(
+            vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(dr), 11),
+                      vshlq_n_u16(vreinterpretq_u16_s16(dg), 5)),
+            vreinterpretq_u16_s16(db)));
+}
+
+static void
+gradientIndices4(jint *idx, jint frac, jint mx, jint cycleMethod) {
+    unsigned int f = (unsigned int)frac;
+    unsigned int m = (unsigned int)mx;
+    int32x4_t maxFrac = vdupq_n_s32(0xffff);
+    int32x4_t v;
+
+    idx[0] = (jint)f;
+    idx[1] = (jint)(f + m);
+    idx[2] = (jint)(f + 2 * m);
+    idx[3] = (jint)(f + 3 * m);
+    v = vld1q_s32((const int32_t *)idx);
+
+    switch (cycleMethod) {
+    case CYCLE_NONE:
+        v = vminq_s32(vmaxq_s32(v, vdupq_n_s32(0)), maxFrac);
+        break;
+    case CYCLE_REPEAT:
+        v = vandq_s32(v, maxFrac);
+        break;
+    case CYCLE_REFLECT:
+        v = vandq_s32(vabsq_s32(v), vdupq_n_s32(0x1ffff));
+        v = vbslq_s32(vcgtq_s32(v, maxFrac),
+                      vsubq_s32(vdupq_n_s32(0x1ffff), v), v);
+        break;
+    }
+
+    vst1q_s32((int32_t *)idx, vshrq_n_s32(v, 16 - LG_GRADIENT_MAP_SIZE));
+}
+
+static jboolean
+cpuSupportsSIMD() {
+#if defined(__linux__)
+    /* Look for HWCAP_NEON in the AT_HWCAP entry of the aux vector */
+    unsigned long entry[2];
+    jboolean neon = XNI_FALSE;
+    int fd = open("/proc/self/auxv", O_RDONLY);
+    if (fd < 0) {
+        return XNI_FALSE;
+    }
+    while (read(fd, entry, sizeof(entry)) == sizeof(entry) && entry[0] != 0) {
+        if (entry[0] == 16 /* AT_HWCAP */) {
+            neon = (entry[1] & (1 << 12)) ? XNI_TRUE : XNI_FALSE;
+            break;
+        }
+    }
+    close(fd);
+    return neon;
+#else
+    /* Trust the build to only enable NEON for CPUs that have it */
+    return XNI_TRUE;
+#endif
+}
+
+#endif /* NEON */
+
+/*
+ * Computes the length of the span of row j, as in the scalar loops.
+ */
+static INLINE jint
+spanWidth(Renderer *rdr, jint j) {
+    jint minX = rdr->_minTouched[j];
+    jint maxX = rdr->_maxTouched[j];
+    jint w = (maxX >= minX) ? (maxX - minX + 1) : 0;
+    if ((w > 0) && (w + minX > rdr->_alphaWidth)) {
+        w = rdr->_alphaWidth - minX;
+    }
+    return w;
+}
+
+void
+blitSrcOver8888_preSIMD(Renderer *rdr, jint height) {
+    jint i, j, k, n, w, minX;
+    jint *intData = rdr->_data;
+    jint imageOffset = rdr->_currImageOffset;
+    jint imageScanlineStride = rdr->_imageScanlineStride;
+    jbyte *alpha = rdr->_rowAA;
+    jint alphaOffset = 0;
+    jint alphaStride = rdr->_alphaWidth;
+    jint *alphaMap = rdr->_colorAlphaMap;
+    jint *dst;
+    jbyte *a;
+    jint src[4], aval[4], tail[4];
+
+    if (rdr->_imagePixelStride != 1) {
+        blitSrcOver8888_pre(rdr, height);
+        return;
+    }
+
+    src[0] = (rdr->_cred << 16) | (rdr->_cgreen << 8) | rdr->_cblue;
+    src[1] = src[2] = src[3] = src[0];
+
+    for (j = 0; j < height; j++) {
+        minX = rdr->_minTouched[j];
+        w = spanWidth(rdr, j);
+        a = alpha + alphaOffset + minX;
+        dst = intData + imageOffset + minX;
+
+        for (i = 0; i < w; i += 4) {
+            n = (w - i < 4) ? w - i : 4;
+            for (k = 0; k < n; k++) {
+                aval[k] = alphaMap[a[i + k] & 0xff];
+            }
+            if (n == 4) {
+                if ((aval[0] | aval[1] | aval[2] | aval[3]) != 0) {
+                    blend4SrcOver8888_pre(dst + i, src, aval);
+                }
+            } else {
+                for (k = n; k < 4; k++) {
+                    aval[k] = 0;
+                }
+                memcpy(tail, dst + i, n * sizeof(jint));
+                blend4SrcOver8888_pre(tail, src, aval);
+                memcpy(dst + i, tail, n * sizeof(jint));
+            }
+        }
+
+        imageOffset += imageScanlineStride;
+        alphaOffset += alphaStride;
+    }
+}
+
+void
+blitPTSrcOver8888_preSIMD(Renderer *rdr, jint height) {
+    jint i, j, k, n, w, minX, cval, palpha;
+    jint *intData = rdr->_data;
+    jint imageOffset = rdr->_currImageOffset;
+    jint imageScanlineStride = rdr->_imageScanlineStride;
+    jbyte *alpha = rdr->_rowAA;
+    jint alphaOffset = 0;
+    jint alphaStride = rdr->_alphaWidth;
+    jint *alphaMap = rdr->_paintAlphaMap;
+    jint denom = rdr->_MAX_AA_ALPHA * 255;
+    jint denom2 = denom / 2;
+    jint *paint = rdr->_paint;
+    jint *dst, *src;
+    jbyte *a;
+    jint aval[4], tail[4], tailSrc[4];
+
+    if (rdr->_imagePixelStride != 1) {
+        blitPTSrcOver8888_pre(rdr, height);
+        return;
+    }
+
+    for (j = 0; j < height; j++) {
+        minX = rdr->_minTouched[j];
+        w = spanWidth(rdr, j);
+        a = alpha + alphaOffset + minX;
+        src = paint + alphaOffset + minX;
+        dst = intData + imageOffset + minX;
+
+        for (i = 0; i < w; i += 4) {
+            n = (w - i < 4) ? w - i : 4;
+            for (k = 0; k < n; k++) {
+                jint aa = alphaMap[(src[i + k] >> 24) & 0xff];
+                /* Scale combined alpha into [0, MAX_ALPHA] */
+                aval[k] = (aa * (a[i + k] & 0xff) * MAX_ALPHA + denom2) /
+                          denom;
+            }
+            if (n == 4) {
+                if ((aval[0] | aval[1] | aval[2] | aval[3]) != 0) {
+                    blend4SrcOver8888_pre(dst + i, src + i, aval);
+                }
+            } else {
+                for (k = n; k < 4; k++) {
+                    aval[k] = 0;
+                    tailSrc[k] = 0;
+                }
+                memcpy(tailSrc, src + i, n * sizeof(jint));
+                memcpy(tail, dst + i, n * sizeof(jint));
+                blend4SrcOver8888_pre(tail, tailSrc, aval);
+                memcpy(dst + i, tail, n * sizeof(jint));
+            }
+
+            /*
+             * Fully covered pixels take the premultiplied paint color,
+             * which the blend only gets right for opaque paint.
+             */
+            for (k = 0; k < n; k++) {
+                cval = src[i + k];
+                palpha = (cval >> 24) & 0xff;
+                if (aval[k] == MAX_ALPHA && palpha != 0xff) {
+                    dst[i + k] = (palpha << 24) |
+                        (((((cval >> 16) & 0xff) * palpha + 127) / 255) << 16) |
+                        (((((cval >> 8) & 0xff) * palpha + 127) / 255) << 8) |
+                        (((cval & 0xff) * palpha + 127) / 255);
+                }
+            }
+        }
+
+        imageOffset += imageScanlineStride;
+        alphaOffset += alphaStride;
+    }
+}
+
+void
+blitSrcOver565SIMD(Renderer *rdr, jint height) {
+    jint i, j, k, n, w, minX;
+    jshort *shortData = (jshort *)rdr->_data;
+    jint imageOffset = rdr->_currImageOffset;
+    jint imageScanlineStride = rdr->_imageScanlineStride;
+    jbyte *alpha = rdr->_rowAA;
+    jint alphaOffset = 0;
+    jint alphaStride = rdr->_alphaWidth;
+    jint *alphaMap = rdr->_colorAlphaMap;
+    jshort *dst;
+    jbyte *a;
+    jshort src[8], op[8], tail[8];
+    jshort cval = (jshort)((rdr->_cred << 11) | (rdr->_cgreen << 5) |
+                           rdr->_cblue);
+
+    if (rdr->_imagePixelStride != 1) {
+        blitSrcOver565(rdr, height);
+        return;
+    }
+
+    for (k = 0; k < 8; k++) {
+        src[k] = cval;
+    }
+
+    for (j = 0; j < height; j++) {
+        minX = rdr->_minTouched[j];
+        w = spanWidth(rdr, j);
+        a = alpha + alphaOffset + minX;
+        dst = shortData + imageOffset + minX;
+
+        for (i = 0; i < w; i += 8) {
+            jint any = 0;
+            n = (w - i < 8) ? w - i : 8;
+            /* A coverage of MAX_ALPHA gives an opacity of 64, i.e. cval */
+            for (k = 0; k < n; k++) {
+                op[k] = (jshort)(alphaMap[a[i + k] & 0xff] >> 2);
+                any |= op[k];
+            }
+            if (n == 8) {
+                if (any != 0) {
+                    blend8SrcOver565(dst + i, src, op);
+                }
+            } else {
+                for (k = n; k < 8; k++) {
+                    op[k] = 0;
+                }
+                memcpy(tail, dst + i, n * sizeof(jshort));
+                blend8SrcOver565(tail, src, op);
+                memcpy(dst + i, tail, n * sizeof(jshort));
+            }
+        }
+
+        imageOffset += imageScanlineStride;
+        alphaOffset += alphaStride;
+    }
+}
+
+void
+blitPTSrcOver565SIMD(Renderer *rdr, jint height) {
+    jint i, j, k, n, w, minX;
+    jshort *shortData = (jshort *)rdr->_data;
+    jint imageOffset = rdr->_currImageOffset;
+    jint imageScanlineStride = rdr->_imageScanlineStride;
+    jbyte *alpha = rdr->_rowAA;
+    jint alphaOffset = 0;
+    jint alphaStride = rdr->_alphaWidth;
+    jint *alphaMap = rdr->_paintAlphaMap;
+    jint denom = rdr->_MAX_AA_ALPHA * 255;
+    jint denom2 = denom / 2;
+    jint *paint = rdr->_paint;
+    jint *p;
+    jshort *dst;
+    jbyte *a;
+    jshort src[8], op[8], tail[8];
+
+    if (rdr->_imagePixelStride != 1) {
+        blitPTSrcOver565(rdr, height);
+        return;
+    }
+
+    for (j = 0; j < height; j++) {
+        minX = rdr->_minTouched[j];
+        w = spanWidth(rdr, j);
+        a = alpha + alphaOffset + minX;
+        p = paint + alphaOffset + minX;
+        dst = shortData + imageOffset + minX;
+
+        for (i = 0; i < w; i += 8) {
+            jint any = 0;
+            n = (w - i < 8) ? w - i : 8;
+            for (k = 0; k < n; k++) {
+                jint cval = p[i + k];
+                jint aa = alphaMap[(cval >> 24) & 0xff];
+                /* Scale combined alpha into [0, MAX_ALPHA] */
+                jint aval = (aa * (a[i + k] & 0xff) * MAX_ALPHA + denom2) /
+                            denom;
+                src[k] = (jshort)CONVERT_888_TO_565(cval);
+                op[k] = (jshort)(aval >> 2);
+                any |= op[k];
+            }
+            if (n == 8) {
+                if (any != 0) {
+                    blend8SrcOver565(dst + i, src, op);
+                }
+            } else {
+                for (k = n; k < 8; k++) {
+                    op[k] = 0;
+                }
+                memcpy(tail, dst + i, n * sizeof(jshort));
+                blend8SrcOver565(tail, src, op);
+                memcpy(dst + i, tail, n * sizeof(jshort));
+            }
+        }
+
+        imageOffset += imageScanlineStride;
+        alphaOffset += alphaStride;
+    }
+}
+
+void
+genLinearGradientPaintSIMD(Renderer *rdr, jint height) {
+    jint paintOffset = 0;
+    jint width = rdr->_alphaWidth;
+    jint i, j, k, n, w, minX, x, y;
+    jint cycleMethod = rdr->_gradient_cycleMethod;
+    jlong mx = rdr->_lg_mx;
+    jlong my = rdr->_lg_my;
+    jlong b = rdr->_lg_b;
+    jint *paint = rdr->_paint;
+    jint *colors = rdr->_gradient_colors;
+    jint *p;
+    jint idx[4];
+    jlong frac;
+
+    y = rdr->_currY;
+    for (j = 0; j < height; j++, y++) {
+        minX = rdr->_minTouched[j];
+        w = spanWidth(rdr, j);
+        x = rdr->_currX + minX;
+        p = paint + paintOffset + minX;
+
+        frac = x * mx + y * my + b;
+        for (i = 0; i < w; i += 4) {
+            gradientIndices4(idx, (jint)frac, (jint)mx, cycleMethod);
+            n = (w - i < 4) ? w - i : 4;
+            for (k = 0; k < n; k++) {
+                p[i + k] = colors[idx[k]];
+            }
+            frac += 4 * mx;
+        }
+
+        paintOffset += width;
+    }
+}
+
+void
+piscesSIMDUpdateRoutines(Renderer *rdr) {
+    static jint supported = -1;
+
+    if (supported < 0) {
+        supported = cpuSupportsSIMD() ? 1 : 0;
+    }
+    if (!supported) {
+        return;
+    }
+
+    if (rdr->_bl_SourceOver == blitSrcOver8888_pre) {
+        rdr->_bl_SourceOver = blitSrcOver8888_preSIMD;
+    } else if (rdr->_bl_SourceOver == blitSrcOver565) {
+        rdr->_bl_SourceOver = blitSrcOver565SIMD;
+    }
+    if (rdr->_bl_PT_SourceOver == blitPTSrcOver8888_pre) {
+        rdr->_bl_PT_SourceOver = blitPTSrcOver8888_preSIMD;
+    } else if (rdr->_bl_PT_SourceOver == blitPTSrcOver565) {
+        rdr->_bl_PT_SourceOver = blitPTSrcOver565SIMD;
+    }
+    if (rdr->_genPaint == genLinearGradientPaint) {
+        rdr->_genPaint = genLinearGradientPaintSIMD;
+    }
+}
+
+#endif /* PISCES_SIMD_BLIT */
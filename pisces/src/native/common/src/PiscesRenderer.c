@@ -118,11 +118,18 @@ addEdge(Renderer* rdr, jint x0, jint y0, jint x1, jint y1) {
         orientation = -1;
     }
 
-    // Skip edges that don't cross a subsampled scanline
-    eminY = ((y0 + rdr->_HYSTEP) & rdr->_YMASK);
-    emaxY = ((y1 - rdr->_HYSTEP) & rdr->_YMASK);
-    if (eminY > emaxY) {
-        return;
+    // Skip edges that don't cross a subsampled scanline. The analytic
+    // rasterizer needs every edge that has some height.
+    if (USES_ANALYTIC_AA(rdr)) {
+        if (y0 == y1) {
+            return;
+        }
+    } else {
+        eminY = ((y0 + rdr->_HYSTEP) & rdr->_YMASK);
+        emaxY = ((y1 - rdr->_HYSTEP) & rdr->_YMASK);
+        if (eminY > emaxY) {
+            return;
+        }
     }
 
     if (orientation == -1) {
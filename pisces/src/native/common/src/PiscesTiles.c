@@ -0,0 +1,165 @@
+/*
+ * 
+ * Copyright  1990-2008 Sun Microsystems, Inc. All Rights Reserved. 
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER 
+ *  
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License version 
+ * 2 only, as published by the Free Software Foundation. 
+ *  
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License version 2 for more details (a copy is 
+ * included at /legal/license.txt). 
+ *  
+ * You should have received a copy of the GNU General Public License 
+ * version 2 along with this work; if not, write to the Free Software 
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 
+ * 02110-1301 USA 
+ *  
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa 
+ * Clara, CA 95054 or visit www.sun.com if you need additional 
+ * information or have any questions.
+ */
+
+#include <PiscesTiles.h>
+#include <PiscesUtil.h>
+
+#ifdef PISCES_TILED_AA
+
+#include <pthread.h>
+
+typedef struct _TilePool {
+    pthread_mutex_t lock;
+    pthread_cond_t start;       // a job was posted
+    pthread_cond_t done;        // the last worker left the job
+
+    jint threads;               // threads to render with
+    jint numWorkers;            // worker threads started
+    jboolean running;           // a job is in progress
+
+    jint job;                   // incremented for every job
+    jint seenJob[PISCES_TILE_THREADS]; // last job seen by each worker
+    PiscesTileFunc* fn;
+    void* arg;
+    jint numTiles;
+    jint nextTile;
+    jint participants;          // workers taking part in the job
+    jint busy;                  // workers not yet done with the job
+} TilePool;
+
+static TilePool pool = {
+    PTHREAD_MUTEX_INITIALIZER,  // lock
+    PTHREAD_COND_INITIALIZER,   // start
+    PTHREAD_COND_INITIALIZER,   // done
+    PISCES_TILE_THREADS,        // threads
+    0,                          // numWorkers
+    XNI_FALSE,                  // running
+    0,                          // job
+    { 0 },                      // seenJob
+    NULL,                       // fn
+    NULL,                       // arg
+    0,                          // numTiles
+    0,                          // nextTile
+    0,                          // participants
+    0                           // busy
+};
+
+/* Runs tiles until there are none left. Called with the lock held. */
+static void
+runTiles(jint slot) {
+    while (pool.nextTile < pool.numTiles) {
+        jint tile = pool.nextTile++;
+
+        pthread_mutex_unlock(&pool.lock);
+        pool.fn(pool.arg, slot, tile);
+        pthread_mutex_lock(&pool.lock);
+    }
+}
+
+static void*
+tileWorker(void* arg) {
+    jint slot = (jint)(size_t)arg;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (pool.job == pool.seenJob[slot]) {
+            pthread_cond_wait(&pool.start, &pool.lock);
+        }
+        pool.seenJob[slot] = pool.job;
+
+        if (slot <= pool.participants) {
+            runTiles(slot);
+            if (--pool.busy == 0) {
+                pthread_cond_signal(&pool.done);
+            }
+        }
+    }
+    return NULL;
+}
+
+void
+piscestiles_run(jint numTiles, jint maxThreads,
+                PiscesTileFunc* fn, void* arg) {
+    jint tile;
+
+    pthread_mutex_lock(&pool.lock);
+    maxThreads = MIN(maxThreads, pool.threads);
+    if (pool.running || maxThreads <= 1) {
+        pthread_mutex_unlock(&pool.lock);
+        for (tile = 0; tile < numTiles; tile++) {
+            fn(arg, 0, tile);
+        }
+        return;
+    }
+
+    while (pool.numWorkers < maxThreads - 1) {
+        pthread_t thread;
+        pthread_attr_t attr;
+        int err;
+
+        // the worker takes part from the job posted below on
+        pool.seenJob[pool.numWorkers + 1] = pool.job;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        err = pthread_create(&thread, &attr, tileWorker,
+                             (void*)(size_t)(pool.numWorkers + 1));
+        pthread_attr_destroy(&attr);
+        if (err != 0) {
+            break;
+        }
+        pool.numWorkers++;
+    }
+
+    pool.running = XNI_TRUE;
+    pool.fn = fn;
+    pool.arg = arg;
+    pool.numTiles = numTiles;
+    pool.nextTile = 0;
+    pool.participants = MIN(pool.numWorkers, maxThreads - 1);
+    pool.busy = pool.participants;
+    pool.job++;
+    pthread_cond_broadcast(&pool.start);
+
+    runTiles(0);
+    while (pool.busy > 0) {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pool.running = XNI_FALSE;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+jint
+piscestiles_getThreads() {
+    return pool.threads;
+}
+
+void
+piscestiles_setThreads(jint threads) {
+    pthread_mutex_lock(&pool.lock);
+    pool.threads = MAX(1, MIN(threads, PISCES_TILE_THREADS));
+    pthread_mutex_unlock(&pool.lock);
+}
+
+#endif /* PISCES_TILED_AA */
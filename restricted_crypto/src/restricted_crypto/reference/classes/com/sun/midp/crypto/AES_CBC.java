@@ -124,6 +124,14 @@ public class AES_CBC extends AES_ECB {
         holdCount = 0;
     }
 
+    /**
+     * Returns the chaining block for processBlocks.
+     * @return the chaining block
+     */
+    byte[] getChainingBlock() {
+        return state;
+    }
+
     /**
      * Saves internal state.
      */
@@ -240,6 +240,54 @@ public class AES_ECB extends BlockCipherBase {
         System.arraycopy(state, 0, out, offset, BLOCK_SIZE);
     }
 
+    /**
+     * Depending on the mode, either encrypts or decrypts a run of whole
+     * blocks using the native engine.
+     * @param in the input buffer
+     * @param offset the offset in <code>in</code> where the input starts
+     * @param len the input length, a multiple of the block size
+     * @param out the buffer for the result
+     * @param outOffset the offset in <code>out</code> where the result
+     * is stored
+     * @return the number of bytes processed, 0 if the native engine
+     * does not support the key and processBlock has to do the work
+     */
+    int processBlocks(byte[] in, int offset, int len,
+                      byte[] out, int outOffset) {
+        if (nativeProcess(W, Nr, mode == Cipher.ENCRYPT_MODE,
+                          getChainingBlock(), in, offset, len,
+                          out, outOffset)) {
+            return len;
+        }
+        return 0;
+    }
+
+    /**
+     * Returns the chaining block for processBlocks.
+     * @return null, ECB mode does not chain blocks
+     */
+    byte[] getChainingBlock() {
+        return null;
+    }
+
+    /**
+     * Encrypts or decrypts whole blocks.
+     * @param W key schedule
+     * @param Nr number of rounds
+     * @param encrypt true to encrypt, false to decrypt
+     * @param chain CBC chaining block, updated on return, or null for ECB
+     * @param inBuf input data
+     * @param inOff offset of the input data
+     * @param len length of the data, a multiple of the block size
+     * @param outBuf output buffer
+     * @param outOff offset of the output data
+     * @return true if the blocks were processed, false if the number
+     * of rounds or the key schedule length is not supported
+     */
+    private static native boolean nativeProcess(int[] W, int Nr,
+            boolean encrypt, byte[] chain, byte[] inBuf, int inOff,
+            int len, byte[] outBuf, int outOff);
+
     /**
      * Performs the encryption of data.
      */
@@ -297,6 +297,22 @@ abstract class BlockCipherBase extends Cipher {
         int counter = 0;
         while (true)  {
 
+            if (holdCount == 0) {
+                // Whole blocks go to the native engine, if there is one.
+                // In decryption with padding the last block is held back
+                // for the padder.
+                int bulk = len - (keepLastBlock ? 1 : 0);
+                bulk -= bulk % blockSize;
+                if (bulk > 0) {
+                    int done = processBlocks(in, offset, bulk,
+                                             out, outOffset);
+                    offset    += done;
+                    len       -= done;
+                    counter   += done;
+                    outOffset += done;
+                }
+            }
+
             int got;
             System.arraycopy(in, offset, holdData, holdCount,
                              got = Math.min(blockSize - holdCount, len));
@@ -354,6 +370,24 @@ abstract class BlockCipherBase extends Cipher {
      */
     abstract void processBlock(byte[] out, int offset);
 
+    /**
+     * Depending on the mode, either encrypts or decrypts a run of whole
+     * blocks straight from the input buffer. Ciphers with a native
+     * engine override this, the default leaves all blocks to
+     * processBlock.
+     * @param in the input buffer
+     * @param offset the offset in <code>in</code> where the input starts
+     * @param len the input length, a multiple of the block size
+     * @param out the buffer for the result
+     * @param outOffset the offset in <code>out</code> where the result
+     * is stored
+     * @return the number of bytes processed
+     */
+    int processBlocks(byte[] in, int offset, int len,
+                      byte[] out, int outOffset) {
+        return 0;
+    }
+
     /**
      * Initializes key.
      * @param data key data
@@ -131,6 +131,14 @@ public class DES_CBC extends DES_ECB {
         }
     }
 
+    /**
+     * Returns the chaining block for processBlocks.
+     * @return the chaining block
+     */
+    byte[] getChainingBlock() {
+        return chainingBlock;
+    }
+
     /**
      * Saves cipher state.
      */
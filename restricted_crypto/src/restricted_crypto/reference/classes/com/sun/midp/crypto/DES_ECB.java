@@ -220,6 +220,53 @@ class DES_ECB extends BlockCipherBase {
         holdCount = 0;
     }
 
+    /**
+     * Depending on the mode, either encrypts or decrypts a run of whole
+     * blocks using the native engine.
+     * @param in the input buffer
+     * @param offset the offset in <code>in</code> where the input starts
+     * @param len the input length, a multiple of the block size
+     * @param out the buffer for the result
+     * @param outOffset the offset in <code>out</code> where the result
+     * is stored
+     * @return the number of bytes processed
+     */
+    int processBlocks(byte[] in, int offset, int len,
+                      byte[] out, int outOffset) {
+        boolean single = dkey.length == 1;
+
+        nativeProcess(dkey[0], single ? null : dkey[1],
+                      single ? null : dkey[2],
+                      mode == Cipher.ENCRYPT_MODE, getChainingBlock(),
+                      in, offset, len, out, outOffset);
+        return len;
+    }
+
+    /**
+     * Returns the chaining block for processBlocks.
+     * @return null, ECB mode does not chain blocks
+     */
+    byte[] getChainingBlock() {
+        return null;
+    }
+
+    /**
+     * Encrypts or decrypts whole blocks.
+     * @param key1 first expanded key
+     * @param key2 second expanded key, or null for DES
+     * @param key3 third expanded key, or null for DES
+     * @param encrypt true to encrypt, false to decrypt
+     * @param chain CBC chaining block, updated on return, or null for ECB
+     * @param inBuf input data
+     * @param inOff offset of the input data
+     * @param len length of the data, a multiple of the block size
+     * @param outBuf output buffer
+     * @param outOff offset of the output data
+     */
+    private static native void nativeProcess(byte[] key1, byte[] key2,
+            byte[] key3, boolean encrypt, byte[] chain, byte[] inBuf,
+            int inOff, int len, byte[] outBuf, int outOff);
+
     /**
      * Initializes data for permutation.
      * @param value seed value
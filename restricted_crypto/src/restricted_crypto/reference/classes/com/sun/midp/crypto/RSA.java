@@ -65,6 +65,28 @@ public final class RSA extends Cipher {
                                       byte[] modulus, byte[] result)
         throws IllegalArgumentException;
 
+    /**
+     * A native method for performing a private key modular exponentiation
+     * with the Chinese Remainder Theorem.
+     *
+     * @param data      contains the data on which exponentiation is to
+     *                  be performed
+     * @param p         first prime factor of the modulus
+     * @param q         second prime factor of the modulus
+     * @param dp        private exponent mod (p - 1)
+     * @param dq        private exponent mod (q - 1)
+     * @param qinv      inverse of q mod p
+     * @param result    the result of the modular exponentiation is 
+     *                  returned in this array
+     * @return          length of the result in bytes
+     * @exception IllegalArgumentException if a argument is too long for
+     *    the native code to handle. (currently (32K - 8) bits max)
+     */
+    private static native int modExpCRT(byte[] data, byte[] p, byte[] q,
+                                         byte[] dp, byte[] dq, byte[] qinv,
+                                         byte[] result)
+        throws IllegalArgumentException;
+
     /**
      * Performs an RSA operation on specified data. If the data length
      * is not the same as the modulus length (as may happen for an 
@@ -79,19 +101,27 @@ public final class RSA extends Cipher {
     private byte[] doIt(byte[] data) {
         int modLen = ckey.getModulusLen();
         byte[] buf = new byte[modLen];
-        byte[] mod = new byte[modLen];
         int bufLen;
+        byte[] tmp = new byte[modLen];
         
-        // Note: Both RSAPublicKey and RSAPrivateKey provide the same
-        // interface
-        short val = ckey.getModulus(mod, (short) 0);
+        if (ckey instanceof RSAPrivateKey &&
+                ((RSAPrivateKey)ckey).hasCRTParameters()) {
+            RSAPrivateKey pkey = (RSAPrivateKey)ckey;
+
+            bufLen = modExpCRT(data, pkey.p, pkey.q, pkey.dp, pkey.dq,
+                               pkey.qinv, buf);
+        } else {
+            // Note: Both RSAPublicKey and RSAPrivateKey provide the same
+            // interface
+            byte[] mod = new byte[modLen];
+            short val = ckey.getModulus(mod, (short) 0);
         
-        byte[] tmp = new byte[modLen];
-        val = ckey.getExponent(tmp, (short) 0);
-        byte[] exp = new byte [val];
-        System.arraycopy(tmp, 0, exp, 0, val);
+            val = ckey.getExponent(tmp, (short) 0);
+            byte[] exp = new byte [val];
+            System.arraycopy(tmp, 0, exp, 0, val);
         
-        bufLen = modExp(data, exp, mod, buf);
+            bufLen = modExp(data, exp, mod, buf);
+        }
 
         if (bufLen == modLen) {
             return buf;
@@ -95,18 +95,62 @@
 #ifndef HEADER_BN_H
 #define HEADER_BN_H
 
+/*
+ * Size of the words (limbs) numbers are kept in. 64-bit limbs need a
+ * compiler with a 128-bit integer type for the double word products,
+ * 32-bit limbs only need long long. The original 16-bit limbs can still
+ * be selected with BN_SIXTEEN_BIT_LIMBS.
+ */
+#if defined(BN_SIXTEEN_BIT_LIMBS)
 #define SIXTEEN_BIT
+#elif defined(__SIZEOF_INT128__)
+#define SIXTY_FOUR_BIT
+#else
+#define THIRTY_TWO_BIT
+#endif
+
 #define BN_LLONG
-#define INTEGER short
+#define INTEGER int
 #define BN_MAX_INTEGER (0x7FFF)
 
 #define BN_RECP
 #define MONT_WORD
 
-#ifdef SIXTEEN_BIT
 #ifndef BN_DIV2W
 #define BN_DIV2W
 #endif
+
+#ifdef SIXTY_FOUR_BIT
+#define BN_ULLONG	unsigned __int128
+#define BN_ULONG	unsigned long long
+#define BN_LONG		long long
+#define BN_BITS		128
+#define BN_BYTES	8
+#define BN_BITS2	64
+#define BN_BITS4	32
+#define BN_MASK2	(0xffffffffffffffffLL)
+#define BN_MASK2l	(0xffffffffL)
+#define BN_MASK2h1	(0xffffffff80000000LL)
+#define BN_MASK2h	(0xffffffff00000000LL)
+#define BN_TBIT		(0x8000000000000000LL)
+#endif
+
+#ifdef THIRTY_TWO_BIT
+#define BN_ULLONG	unsigned long long
+#define BN_ULONG	unsigned int
+#define BN_LONG		int
+#define BN_BITS		64
+#define BN_BYTES	4
+#define BN_BITS2	32
+#define BN_BITS4	16
+#define BN_MASK2	(0xffffffffL)
+#define BN_MASK2l	(0xffff)
+#define BN_MASK2h1	(0xffff8000L)
+#define BN_MASK2h	(0xffff0000L)
+#define BN_TBIT		(0x80000000L)
+#endif
+
+#ifdef SIXTEEN_BIT
 #define BN_ULLONG	unsigned long
 #define BN_ULONG	unsigned short
 #define BN_LONG		short
@@ -121,6 +165,15 @@
 #define BN_TBIT		(0x8000)
 #endif
 
+/*
+ * Operands of at least this many words are multiplied and squared with
+ * the Karatsuba method, which splits them in halves and needs three half
+ * size products instead of four.
+ */
+#ifndef BN_KARATSUBA_THRESHOLD
+#define BN_KARATSUBA_THRESHOLD 16
+#endif
+
 typedef struct bignum_st
 	{
 	BN_ULONG *d;	/* Pointer to an array of 'BN_BITS2' bit chunks. */
@@ -185,6 +238,8 @@ typedef struct bn_mont_ctx_st
 
 
 INTEGER BN_mod_exp_mont(BIGNUM *r, BIGNUM *a, BIGNUM *p, BIGNUM *m,BN_CTX *ctx);
+INTEGER BN_mod_exp_crt(BIGNUM *r, BIGNUM *a, BIGNUM *p, BIGNUM *q,
+                       BIGNUM *dp, BIGNUM *dq, BIGNUM *qinv, BN_CTX *ctx);
 BIGNUM  *BN_value_one();
 INTEGER BN_mask_bits();
 BIGNUM  *BN_mod_inverse();
@@ -220,9 +275,9 @@ INTEGER	BN_ucmp(BIGNUM *a, BIGNUM *b);
 INTEGER	BN_is_bit_set(BIGNUM *a, INTEGER n);
 INTEGER	BN_mod(BIGNUM *rem, BIGNUM *m, BIGNUM *d, BN_CTX *ctx);
 INTEGER	BN_mul(BIGNUM *r, BIGNUM *a, BIGNUM *b);
-BN_ULONG bn_mul_add_word(BN_ULONG *rp, BN_ULONG *ap, short num, BN_ULONG w);
-BN_ULONG bn_mul_word(BN_ULONG *rp, BN_ULONG *ap, short num, BN_ULONG w);
-void     bn_sqr_words(BN_ULONG *rp, BN_ULONG *ap, short num);
+BN_ULONG bn_mul_add_word(BN_ULONG *rp, BN_ULONG *ap, int num, BN_ULONG w);
+BN_ULONG bn_mul_word(BN_ULONG *rp, BN_ULONG *ap, int num, BN_ULONG w);
+void     bn_sqr_words(BN_ULONG *rp, BN_ULONG *ap, int num);
 BN_ULONG bn_div64(BN_ULONG h, BN_ULONG l, BN_ULONG d);
 INTEGER	BN_rshift(BIGNUM *r, BIGNUM *a, INTEGER n);
 INTEGER	BN_lshift(BIGNUM *r, BIGNUM *a, INTEGER n);
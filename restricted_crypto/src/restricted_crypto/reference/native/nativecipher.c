@@ -0,0 +1,839 @@
+/*
+ *   
+ *
+ * Copyright  1990-2007 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ * 
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ * 
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ */
+
+/**
+ * @file
+ *
+ * Native engines for the AES and DES block ciphers. The Java cipher
+ * classes keep their key schedules and chaining blocks, and hand runs of
+ * whole blocks to the functions here instead of feeding them one block
+ * at a time through processBlock(). The engines use the key schedules
+ * exactly as the Java code computes them, so both paths can be mixed
+ * freely within one operation.
+ *
+ * AES uses the AES-NI instructions if the compiler can generate them and
+ * the CPU supports them, and the same table driven algorithm as
+ * AES_ECB.java otherwise.
+ */
+
+#include <kni.h>
+#include <commonKNIMacros.h>
+#include <string.h>
+
+#ifndef ENABLE_AES_NI
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define ENABLE_AES_NI 1
+#else
+#define ENABLE_AES_NI 0
+#endif
+#endif
+
+#if ENABLE_AES_NI
+#include <cpuid.h>
+#include <wmmintrin.h>
+#endif
+
+#define AES_BLOCK_SIZE 16
+#define AES_MAX_ROUNDS 14
+#define DES_BLOCK_SIZE 8
+#define DES_KEY_SIZE   128
+
+#define GET_INT(p) (((unsigned int)(p)[0] << 24) | \
+                    ((unsigned int)(p)[1] << 16) | \
+                    ((unsigned int)(p)[2] << 8) | (unsigned int)(p)[3])
+
+/*=========================================================================
+ * AES
+ *=======================================================================*/
+
+static unsigned char aesSBox[256];
+static unsigned char aesISBox[256];
+static unsigned int aesTe[4][256];
+static unsigned int aesTd[4][256];
+static int aesTablesReady = 0;
+
+#if ENABLE_AES_NI
+/* 1 if the CPU has AES-NI, 0 if not, -1 if not checked yet */
+static int aesNiSupported = -1;
+#endif
+
+/**
+ * Multiplies the matrix column <code>a</code> by <code>b</code>,
+ * like AES_ECB.multiply().
+ */
+static unsigned int
+aesMultiply(unsigned int a, unsigned int b) {
+    unsigned int result = 0;
+    int i;
+
+    b &= 0xff;
+    for (i = 0; i < 4; i++) {
+        result ^= ((a >> i) & 0x01010101) * b;
+        b = b < 128 ? b << 1 : (b << 1) ^ 0x11b;
+    }
+    return result;
+}
+
+/**
+ * Computes the S-boxes and the round tables the first time they are
+ * needed.
+ */
+static void
+aesInitTables() {
+    unsigned int p = 1, q = 1, x;
+    int i;
+
+    if (aesTablesReady) {
+        return;
+    }
+
+    /* walk the multiplicative group with generator 3 and its inverse */
+    do {
+        p ^= (p << 1) ^ ((p & 0x80) ? 0x1b : 0);
+        p &= 0xff;
+        q ^= q << 1;
+        q ^= q << 2;
+        q ^= q << 4;
+        q &= 0xff;
+        if (q & 0x80) {
+            q ^= 0x09;
+        }
+        x = q ^ (q << 1) ^ (q << 2) ^ (q << 3) ^ (q << 4);
+        x = (x ^ (x >> 8) ^ 0x63) & 0xff;
+        aesSBox[p] = (unsigned char)x;
+    } while (p != 1);
+    aesSBox[0] = 0x63;
+
+    for (i = 0; i < 256; i++) {
+        aesISBox[aesSBox[i]] = (unsigned char)i;
+    }
+
+    for (i = 0; i < 256; i++) {
+        unsigned int e = aesMultiply(0x02010103, aesSBox[i]);
+        unsigned int d = aesMultiply(0x0e090d0b, aesISBox[i]);
+
+        aesTe[0][i] = e;
+        aesTe[1][i] = (e >> 8) | (e << 24);
+        aesTe[2][i] = (e >> 16) | (e << 16);
+        aesTe[3][i] = (e >> 24) | (e << 8);
+        aesTd[0][i] = d;
+        aesTd[1][i] = (d >> 8) | (d << 24);
+        aesTd[2][i] = (d >> 16) | (d << 16);
+        aesTd[3][i] = (d >> 24) | (d << 8);
+    }
+
+#if ENABLE_AES_NI
+    {
+        unsigned int eax, ebx, ecx, edx;
+        aesNiSupported = __get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+                         (ecx & bit_AES) != 0;
+    }
+#endif
+
+    aesTablesReady = 1;
+}
+
+/**
+ * Encrypts one block, like AES_ECB.cipherBlock().
+ */
+static void
+aesEncryptBlock(const unsigned int *W, int Nr,
+                const unsigned char *in, unsigned char *out) {
+    const unsigned int *T0 = aesTe[0], *T1 = aesTe[1];
+    const unsigned int *T2 = aesTe[2], *T3 = aesTe[3];
+    unsigned int t0 = GET_INT(in) ^ W[0];
+    unsigned int t1 = GET_INT(in + 4) ^ W[1];
+    unsigned int t2 = GET_INT(in + 8) ^ W[2];
+    unsigned int t3 = GET_INT(in + 12) ^ W[3];
+    unsigned int v0, v1, v2, k;
+    int i;
+
+    for (i = 1; i < Nr; i++) {
+        W += 4;
+        v0 = t0;
+        v1 = t1;
+        v2 = t2;
+        t0 = T0[v0 >> 24] ^ T1[(v1 >> 16) & 0xff] ^
+             T2[(v2 >> 8) & 0xff] ^ T3[t3 & 0xff] ^ W[0];
+        t1 = T0[v1 >> 24] ^ T1[(v2 >> 16) & 0xff] ^
+             T2[(t3 >> 8) & 0xff] ^ T3[v0 & 0xff] ^ W[1];
+        t2 = T0[v2 >> 24] ^ T1[(t3 >> 16) & 0xff] ^
+             T2[(v0 >> 8) & 0xff] ^ T3[v1 & 0xff] ^ W[2];
+        t3 = T0[t3 >> 24] ^ T1[(v0 >> 16) & 0xff] ^
+             T2[(v1 >> 8) & 0xff] ^ T3[v2 & 0xff] ^ W[3];
+    }
+    W += 4;
+
+    k = W[0];
+    out[0] = (unsigned char)(aesSBox[t0 >> 24] ^ (k >> 24));
+    out[1] = (unsigned char)(aesSBox[(t1 >> 16) & 0xff] ^ (k >> 16));
+    out[2] = (unsigned char)(aesSBox[(t2 >> 8) & 0xff] ^ (k >> 8));
+    out[3] = (unsigned char)(aesSBox[t3 & 0xff] ^ k);
+    k = W[1];
+    out[4] = (unsigned char)(aesSBox[t1 >> 24] ^ (k >> 24));
+    out[5] = (unsigned char)(aesSBox[(t2 >> 16) & 0xff] ^ (k >> 16));
+    out[6] = (unsigned char)(aesSBox[(t3 >> 8) & 0xff] ^ (k >> 8));
+    out[7] = (unsigned char)(aesSBox[t0 & 0xff] ^ k);
+    k = W[2];
+    out[8] = (unsigned char)(aesSBox[t2 >> 24] ^ (k >> 24));
+    out[9] = (unsigned char)(aesSBox[(t3 >> 16) & 0xff] ^ (k >> 16));
+    out[10] = (unsigned char)(aesSBox[(t0 >> 8) & 0xff] ^ (k >> 8));
+    out[11] = (unsigned char)(aesSBox[t1 & 0xff] ^ k);
+    k = W[3];
+    out[12] = (unsigned char)(aesSBox[t3 >> 24] ^ (k >> 24));
+    out[13] = (unsigned char)(aesSBox[(t0 >> 16) & 0xff] ^ (k >> 16));
+    out[14] = (unsigned char)(aesSBox[(t1 >> 8) & 0xff] ^ (k >> 8));
+    out[15] = (unsigned char)(aesSBox[t2 & 0xff] ^ k);
+}
+
+/**
+ * Decrypts one block with the inverse key schedule computed by
+ * AES_ECB.KeyExpansion(), like AES_ECB.decipherBlock().
+ */
+static void
+aesDecryptBlock(const unsigned int *W, int Nr,
+                const unsigned char *in, unsigned char *out) {
+    const unsigned int *T0 = aesTd[0], *T1 = aesTd[1];
+    const unsigned int *T2 = aesTd[2], *T3 = aesTd[3];
+    const unsigned int *K = W + Nr * 4;
+    unsigned int t0 = GET_INT(in) ^ K[0];
+    unsigned int t1 = GET_INT(in + 4) ^ K[1];
+    unsigned int t2 = GET_INT(in + 8) ^ K[2];
+    unsigned int t3 = GET_INT(in + 12) ^ K[3];
+    unsigned int v0, v1, v2, k;
+    int i;
+
+    for (i = 1; i < Nr; i++) {
+        K -= 4;
+        v0 = t0;
+        v1 = t1;
+        v2 = t2;
+        t0 = T0[v0 >> 24] ^ T1[(t3 >> 16) & 0xff] ^
+             T2[(v2 >> 8) & 0xff] ^ T3[v1 & 0xff] ^ K[0];
+        t1 = T0[v1 >> 24] ^ T1[(v0 >> 16) & 0xff] ^
+             T2[(t3 >> 8) & 0xff] ^ T3[v2 & 0xff] ^ K[1];
+        t2 = T0[v2 >> 24] ^ T1[(v1 >> 16) & 0xff] ^
+             T2[(v0 >> 8) & 0xff] ^ T3[t3 & 0xff] ^ K[2];
+        t3 = T0[t3 >> 24] ^ T1[(v2 >> 16) & 0xff] ^
+             T2[(v1 >> 8) & 0xff] ^ T3[v0 & 0xff] ^ K[3];
+    }
+
+    k = W[0];
+    out[0] = (unsigned char)(aesISBox[t0 >> 24] ^ (k >> 24));
+    out[1] = (unsigned char)(aesISBox[(t3 >> 16) & 0xff] ^ (k >> 16));
+    out[2] = (unsigned char)(aesISBox[(t2 >> 8) & 0xff] ^ (k >> 8));
+    out[3] = (unsigned char)(aesISBox[t1 & 0xff] ^ k);
+    k = W[1];
+    out[4] = (unsigned char)(aesISBox[t1 >> 24] ^ (k >> 24));
+    out[5] = (unsigned char)(aesISBox[(t0 >> 16) & 0xff] ^ (k >> 16));
+    out[6] = (unsigned char)(aesISBox[(t3 >> 8) & 0xff] ^ (k >> 8));
+    out[7] = (unsigned char)(aesISBox[t2 & 0xff] ^ k);
+    k = W[2];
+    out[8] = (unsigned char)(aesISBox[t2 >> 24] ^ (k >> 24));
+    out[9] = (unsigned char)(aesISBox[(t1 >> 16) & 0xff] ^ (k >> 16));
+    out[10] = (unsigned char)(aesISBox[(t0 >> 8) & 0xff] ^ (k >> 8));
+    out[11] = (unsigned char)(aesISBox[t3 & 0xff] ^ k);
+    k = W[3];
+    out[12] = (unsigned char)(aesISBox[t3 >> 24] ^ (k >> 24));
+    out[13] = (unsigned char)(aesISBox[(t2 >> 16) & 0xff] ^ (k >> 16));
+    out[14] = (unsigned char)(aesISBox[(t1 >> 8) & 0xff] ^ (k >> 8));
+    out[15] = (unsigned char)(aesISBox[t0 & 0xff] ^ k);
+}
+
+/**
+ * Encrypts or decrypts <code>len</code> bytes (a multiple of the block
+ * size) in ECB mode, or in CBC mode if <code>chain</code> is not NULL.
+ * <code>chain</code> is updated to the chaining block for the data
+ * that follows. <code>in</code> and <code>out</code> may be the same.
+ */
+static void
+aesProcessTables(const unsigned int *W, int Nr, int encrypt,
+                 unsigned char *chain, const unsigned char *in,
+                 unsigned char *out, int len) {
+    unsigned char block[AES_BLOCK_SIZE];
+    int i;
+
+    for (; len > 0; len -= AES_BLOCK_SIZE,
+                    in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE) {
+        if (chain == NULL) {
+            if (encrypt) {
+                aesEncryptBlock(W, Nr, in, out);
+            } else {
+                aesDecryptBlock(W, Nr, in, out);
+            }
+        } else if (encrypt) {
+            for (i = 0; i < AES_BLOCK_SIZE; i++) {
+                block[i] = in[i] ^ chain[i];
+            }
+            aesEncryptBlock(W, Nr, block, out);
+            memcpy(chain, out, AES_BLOCK_SIZE);
+        } else {
+            memcpy(block, in, AES_BLOCK_SIZE);
+            aesDecryptBlock(W, Nr, block, out);
+            for (i = 0; i < AES_BLOCK_SIZE; i++) {
+                out[i] ^= chain[i];
+            }
+            memcpy(chain, block, AES_BLOCK_SIZE);
+        }
+    }
+}
+
+#if ENABLE_AES_NI
+
+#define AESNI __attribute__((target("aes,sse2")))
+
+/**
+ * Loads round key <code>r</code> of the key schedule. The schedule holds
+ * big-endian words, AES-NI wants the key bytes in memory order.
+ */
+static AESNI __m128i
+aesNiRoundKey(const unsigned int *W, int r) {
+    W += r * 4;
+    return _mm_set_epi8((char)W[3], (char)(W[3] >> 8),
+                        (char)(W[3] >> 16), (char)(W[3] >> 24),
+                        (char)W[2], (char)(W[2] >> 8),
+                        (char)(W[2] >> 16), (char)(W[2] >> 24),
+                        (char)W[1], (char)(W[1] >> 8),
+                        (char)(W[1] >> 16), (char)(W[1] >> 24),
+                        (char)W[0], (char)(W[0] >> 8),
+                        (char)(W[0] >> 16), (char)(W[0] >> 24));
+}
+
+/**
+ * Like aesProcessTables(), using the AES-NI instructions. The inverse
+ * key schedule of AES_ECB is the one AESDEC expects. ECB blocks and CBC
+ * decryption have no dependency between blocks and are done four at a
+ * time to keep the AES unit busy.
+ */
+static AESNI void
+aesProcessNi(const unsigned int *W, int Nr, int encrypt,
+             unsigned char *chain, const unsigned char *in,
+             unsigned char *out, int len) {
+    __m128i rk[AES_MAX_ROUNDS + 1];
+    __m128i iv = _mm_setzero_si128();
+    int r;
+
+    /* rk is in the order the rounds use it */
+    for (r = 0; r <= Nr; r++) {
+        rk[r] = aesNiRoundKey(W, encrypt ? r : Nr - r);
+    }
+
+    if (chain != NULL) {
+        iv = _mm_loadu_si128((const __m128i *)chain);
+    }
+
+    if (encrypt && chain != NULL) {
+        for (; len > 0; len -= AES_BLOCK_SIZE,
+                        in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE) {
+            __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)in),
+                                      iv);
+            b = _mm_xor_si128(b, rk[0]);
+            for (r = 1; r < Nr; r++) {
+                b = _mm_aesenc_si128(b, rk[r]);
+            }
+            iv = _mm_aesenclast_si128(b, rk[Nr]);
+            _mm_storeu_si128((__m128i *)out, iv);
+        }
+        _mm_storeu_si128((__m128i *)chain, iv);
+        return;
+    }
+
+    for (; len >= 4 * AES_BLOCK_SIZE; len -= 4 * AES_BLOCK_SIZE,
+             in += 4 * AES_BLOCK_SIZE, out += 4 * AES_BLOCK_SIZE) {
+        __m128i c0 = _mm_loadu_si128((const __m128i *)in);
+        __m128i c1 = _mm_loadu_si128((const __m128i *)(in + 16));
+        __m128i c2 = _mm_loadu_si128((const __m128i *)(in + 32));
+        __m128i c3 = _mm_loadu_si128((const __m128i *)(in + 48));
+        __m128i b0 = _mm_xor_si128(c0, rk[0]);
+        __m128i b1 = _mm_xor_si128(c1, rk[0]);
+        __m128i b2 = _mm_xor_si128(c2, rk[0]);
+        __m128i b3 = _mm_xor_si128(c3, rk[0]);
+
+        if (encrypt) {
+            for (r = 1; r < Nr; r++) {
+                b0 = _mm_aesenc_si128(b0, rk[r]);
+                b1 = _mm_aesenc_si128(b1, rk[r]);
+                b2 = _mm_aesenc_si128(b2, rk[r]);
+                b3 = _mm_aesenc_si128(b3, rk[r]);
+            }
+            b0 = _mm_aesenclast_si128(b0, rk[Nr]);
+            b1 = _mm_aesenclast_si128(b1, rk[Nr]);
+            b2 = _mm_aesenclast_si128(b2, rk[Nr]);
+            b3 = _mm_aesenclast_si128(b3, rk[Nr]);
+        } else {
+            for (r = 1; r < Nr; r++) {
+                b0 = _mm_aesdec_si128(b0, rk[r]);
+                b1 = _mm_aesdec_si128(b1, rk[r]);
+                b2 = _mm_aesdec_si128(b2, rk[r]);
+                b3 = _mm_aesdec_si128(b3, rk[r]);
+            }
+            b0 = _mm_aesdeclast_si128(b0, rk[Nr]);
+            b1 = _mm_aesdeclast_si128(b1, rk[Nr]);
+            b2 = _mm_aesdeclast_si128(b2, rk[Nr]);
+            b3 = _mm_aesdeclast_si128(b3, rk[Nr]);
+            if (chain != NULL) {
+                b0 = _mm_xor_si128(b0, iv);
+                b1 = _mm_xor_si128(b1, c0);
+                b2 = _mm_xor_si128(b2, c1);
+                b3 = _mm_xor_si128(b3, c2);
+                iv = c3;
+            }
+        }
+
+        _mm_storeu_si128((__m128i *)out, b0);
+        _mm_storeu_si128((__m128i *)(out + 16), b1);
+        _mm_storeu_si128((__m128i *)(out + 32), b2);
+        _mm_storeu_si128((__m128i *)(out + 48), b3);
+    }
+
+    for (; len > 0; len -= AES_BLOCK_SIZE,
+                    in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE) {
+        __m128i c = _mm_loadu_si128((const __m128i *)in);
+        __m128i b = _mm_xor_si128(c, rk[0]);
+
+        if (encrypt) {
+            for (r = 1; r < Nr; r++) {
+                b = _mm_aesenc_si128(b, rk[r]);
+            }
+            b = _mm_aesenclast_si128(b, rk[Nr]);
+        } else {
+            for (r = 1; r < Nr; r++) {
+                b = _mm_aesdec_si128(b, rk[r]);
+            }
+            b = _mm_aesdeclast_si128(b, rk[Nr]);
+            if (chain != NULL) {
+                b = _mm_xor_si128(b, iv);
+                iv = c;
+            }
+        }
+        _mm_storeu_si128((__m128i *)out, b);
+    }
+
+    if (chain != NULL) {
+        _mm_storeu_si128((__m128i *)chain, iv);
+    }
+}
+
+#endif /* ENABLE_AES_NI */
+
+/**
+ * Processes whole AES blocks with the fastest engine available.
+ */
+static void
+aesProcess(const unsigned int *W, int Nr, int encrypt,
+           unsigned char *chain, const unsigned char *in,
+           unsigned char *out, int len) {
+    aesInitTables();
+#if ENABLE_AES_NI
+    if (aesNiSupported) {
+        aesProcessNi(W, Nr, encrypt, chain, in, out, len);
+        return;
+    }
+#endif
+    aesProcessTables(W, Nr, encrypt, chain, in, out, len);
+}
+
+/*=========================================================================
+ * DES
+ *=======================================================================*/
+
+static unsigned int desSP[8][64];
+static unsigned int desInitPermLeft[256];
+static unsigned int desInitPermRight[256];
+static unsigned int desPerm[256];
+static int desTablesReady = 0;
+
+/**
+ * Builds an S-box/permutation table, like DES_ECB.initTable().
+ */
+static void
+desInitTable(unsigned int *data, unsigned int bitmask,
+             unsigned long long l1, unsigned long long l2,
+             unsigned long long l3, unsigned long long l4) {
+    unsigned int words[16];
+    unsigned int mask;
+    int count = 1;
+    int i, j;
+
+    memset(words, 0, sizeof(words));
+    for (i = 0; i < 8; i++) {
+        if ((mask = bitmask & (0xfU << (i << 2))) == 0) {
+            continue;
+        }
+        for (j = 0; j < count; j++) {
+            words[count + j] = words[j] | mask;
+        }
+        count += count;
+    }
+
+    for (i = 0; i < 64; i++) {
+        unsigned long long l = i < 32 ? (i < 16 ? l1 : l2) :
+                                        (i < 48 ? l3 : l4);
+        data[i] = words[(int)(l >> ((15 - (i & 0xf)) << 2)) & 0xf];
+    }
+}
+
+/**
+ * Builds a bit permutation table, like DES_ECB.initPerm().
+ */
+static void
+desInitPerm(unsigned int *result, unsigned int value, int period,
+            unsigned int divisor, int offset,
+            unsigned long long deltas1, unsigned long long deltas2) {
+    int count = 0;
+
+    memset(result, 0, 256 * sizeof(unsigned int));
+    for (;;) {
+        offset += (int)((((count & 0x1f) < 16 ? deltas1 : deltas2) >>
+                         (((15 - count) & 0xf) << 2)) & 0xf) + 1;
+        if (offset > 1023) {
+            return;
+        }
+
+        count++;
+        if (count > 1 && count % period == 1) {
+            value = value == 1 ? 128 : (value / divisor);
+        }
+
+        result[offset >> 2] |= value << (((3 - offset) & 3) << 3);
+    }
+}
+
+/**
+ * Computes the DES tables the first time they are needed. The seeds are
+ * the ones DES_ECB.java uses.
+ */
+static void
+desInitTables() {
+    if (desTablesReady) {
+        return;
+    }
+
+    desInitTable(desSP[0], 0x40410100,
+                 0x72cf4bacb769d40aULL, 0x2853f695813e1de0ULL,
+                 0xf5a7295e13cb8c6ULL, 0xf36d49a024d78e1bULL);
+    desInitTable(desSP[1], 0x08021002,
+                 0xf06c93a62d1a5ec1ULL, 0x4bd27805b7e9843fULL,
+                 0x5ea7f590834d287bULL, 0xe2091f6cd43ab1c6ULL);
+    desInitTable(desSP[2], 0x20808020,
+                 0xc71da4d35268f98eULL, 0xa719f2ce5b6304bULL,
+                 0x71829a6d073ea4f8ULL, 0xbc4f25d350e9cb16ULL);
+    desInitTable(desSP[3], 0x02080201,
+                 0x7a1f0cb5e9839748ULL, 0xd6216bc2305eadf4ULL,
+                 0xd3496a1cb0250de2ULL, 0x8f74f1a756cb389eULL);
+    desInitTable(desSP[4], 0x01002084,
+                 0x842fda7c4196bde0ULL, 0x6853a7091bf5c23eULL,
+                 0xeb5c419a86f07825ULL, 0xb20fde346da317c9ULL);
+    desInitTable(desSP[5], 0x10040408,
+                 0x950e52b43f68a9c7ULL, 0x4bd021edfc83167aULL,
+                 0x38a7e50a82d45f61ULL, 0xf64b9c7029bec31dULL);
+    desInitTable(desSP[6], 0x80200840,
+                 0x215cfa304d968769ULL, 0xd2af05c3eb78be14ULL,
+                 0xb6e9214edb301c85ULL, 0xd5392f478afc76aULL);
+    desInitTable(desSP[7], 0x04104010,
+                 0xde30a5cf18637b9cULL, 0x275af90684bd42e1ULL,
+                 0x429f3806dba5e15aULL, 0xf4c963bc1e708d27ULL);
+
+    desInitPerm(desInitPermRight, 128, 32, 2, -3,
+                0xc3b3432020332020ULL, 0x83b3432020332020ULL);
+    desInitPerm(desInitPermLeft, 128, 32, 2, -3,
+                0x8742032067420320ULL, 0x4742032067420320ULL);
+    desInitPerm(desPerm, 64, 64, 4, -1,
+                0x4420411201004021ULL, 0x1001200101000000ULL);
+
+    desTablesReady = 1;
+}
+
+/**
+ * Encrypts or decrypts one block in place with a key expanded by
+ * DES_ECB.expandKey(), like DES_ECB.cipherBlock().
+ */
+static void
+desCipherBlock(const unsigned char *key, int encrypt, unsigned char *data) {
+    const unsigned int *ipl = desInitPermLeft;
+    const unsigned int *ipr = desInitPermRight;
+    const unsigned int *p = desPerm;
+    int j = encrypt ? 0 : 128 - DES_BLOCK_SIZE;
+    int step = encrypt ? DES_BLOCK_SIZE : -DES_BLOCK_SIZE;
+    unsigned int left = 0, right = 0, temp, high, low;
+    int i;
+
+    /* initial permutations */
+    for (i = 0; i < 8; i++) {
+        unsigned int t = data[i];
+        int v = i << 5;
+        left |= ipl[v + 16 + (t & 0xf)] | ipl[v + (t >> 4)];
+        right |= ipr[v + 16 + (t & 0xf)] | ipr[v + (t >> 4)];
+    }
+
+    for (i = 0; ; i++) {
+        /* move the first bit of right next to the last one */
+        temp = (right << 1) | (right >> 31);
+
+        left ^= desSP[0][(temp & 0x3f) ^ key[j]]
+              ^ desSP[1][((temp >>  4) & 0x3f) ^ key[j + 1]]
+              ^ desSP[2][((temp >>  8) & 0x3f) ^ key[j + 2]]
+              ^ desSP[3][((temp >> 12) & 0x3f) ^ key[j + 3]]
+              ^ desSP[4][((temp >> 16) & 0x3f) ^ key[j + 4]]
+              ^ desSP[5][((temp >> 20) & 0x3f) ^ key[j + 5]]
+              ^ desSP[6][((temp >> 24) & 0x3f) ^ key[j + 6]];
+
+        temp = ((right & 1) << 5) | (right >> 27);
+        left ^= desSP[7][temp ^ key[j + 7]];
+
+        if (i == 15) {
+            break;
+        }
+
+        temp = left;
+        left = right;
+        right = temp;
+        j += step;
+    }
+
+    /* final permutation */
+    high = p[left & 0xf] |
+           p[32 + ((left >> 8) & 0xf)] |
+           p[64 + ((left >> 16) & 0xf)] |
+           p[96 + ((left >> 24) & 0xf)] |
+           p[128 + (right & 0xf)] |
+           p[160 + ((right >> 8) & 0xf)] |
+           p[192 + ((right >> 16) & 0xf)] |
+           p[224 + ((right >> 24) & 0xf)];
+
+    low  = p[16 + ((left >> 4) & 0xf)] |
+           p[48 + ((left >> 12) & 0xf)] |
+           p[80 + ((left >> 20) & 0xf)] |
+           p[112 + (left >> 28)] |
+           p[144 + ((right >> 4) & 0xf)] |
+           p[176 + ((right >> 12) & 0xf)] |
+           p[208 + ((right >> 20) & 0xf)] |
+           p[240 + (right >> 28)];
+
+    data[0] = (unsigned char)low;
+    data[1] = (unsigned char)(low >> 8);
+    data[2] = (unsigned char)(low >> 16);
+    data[3] = (unsigned char)(low >> 24);
+    data[4] = (unsigned char)high;
+    data[5] = (unsigned char)(high >> 8);
+    data[6] = (unsigned char)(high >> 16);
+    data[7] = (unsigned char)(high >> 24);
+}
+
+/**
+ * Encrypts or decrypts <code>len</code> bytes (a multiple of the block
+ * size) with DES, or with triple DES (EDE) if <code>keyCount</code> is
+ * 3. Chaining works as for aesProcessTables().
+ */
+static void
+desProcess(unsigned char keys[3][DES_KEY_SIZE], int keyCount,
+           int encrypt, unsigned char *chain, const unsigned char *in,
+           unsigned char *out, int len) {
+    unsigned char block[DES_BLOCK_SIZE];
+    unsigned char saved[DES_BLOCK_SIZE];
+    int i;
+
+    desInitTables();
+
+    for (; len > 0; len -= DES_BLOCK_SIZE,
+                    in += DES_BLOCK_SIZE, out += DES_BLOCK_SIZE) {
+        memcpy(block, in, DES_BLOCK_SIZE);
+        if (chain != NULL) {
+            if (encrypt) {
+                for (i = 0; i < DES_BLOCK_SIZE; i++) {
+                    block[i] ^= chain[i];
+                }
+            } else {
+                memcpy(saved, block, DES_BLOCK_SIZE);
+            }
+        }
+
+        if (keyCount == 1) {
+            desCipherBlock(keys[0], encrypt, block);
+        } else if (encrypt) {
+            desCipherBlock(keys[0], 1, block);
+            desCipherBlock(keys[1], 0, block);
+            desCipherBlock(keys[2], 1, block);
+        } else {
+            desCipherBlock(keys[2], 0, block);
+            desCipherBlock(keys[1], 1, block);
+            desCipherBlock(keys[0], 0, block);
+        }
+
+        if (chain != NULL) {
+            if (encrypt) {
+                memcpy(chain, block, DES_BLOCK_SIZE);
+            } else {
+                for (i = 0; i < DES_BLOCK_SIZE; i++) {
+                    block[i] ^= chain[i];
+                }
+                memcpy(chain, saved, DES_BLOCK_SIZE);
+            }
+        }
+        memcpy(out, block, DES_BLOCK_SIZE);
+    }
+}
+
+/*=========================================================================
+ * FUNCTION:      nativeProcess([IIZ[B[BII[BI)Z (STATIC)
+ * CLASS:         com/sun/midp/crypto/AES_ECB
+ * TYPE:          static native function
+ * OVERVIEW:      Encrypt or decrypt whole AES blocks.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  W         key schedule computed by initKey
+ *                Nr        number of rounds
+ *                encrypt   true to encrypt, false to decrypt
+ *                chain     CBC chaining block, updated on return,
+ *                           or null for ECB
+ *                inBuf     input data
+ *                inOff     offset of the input data
+ *                len       length of the data, a multiple of 16
+ *                outBuf    output buffer
+ *                outOff    offset of the output data
+ *   returns:     true if the blocks were processed, false if the key
+ *                schedule is not one of AES-128, AES-192 or AES-256
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_BOOLEAN
+Java_com_sun_midp_crypto_AES_1ECB_nativeProcess() {
+    unsigned int W[4 * (AES_MAX_ROUNDS + 1)];
+    unsigned char chain[AES_BLOCK_SIZE];
+    jint Nr = KNI_GetParameterAsInt(2);
+    jboolean encrypt = KNI_GetParameterAsBoolean(3);
+    jint inOff = KNI_GetParameterAsInt(6);
+    jint len = KNI_GetParameterAsInt(7);
+    jint outOff = KNI_GetParameterAsInt(9);
+    jboolean processed = KNI_FALSE;
+    int cbc;
+
+    KNI_StartHandles(4);
+
+    KNI_DeclareHandle(keyObj);
+    KNI_DeclareHandle(chainObj);
+    KNI_DeclareHandle(inObj);
+    KNI_DeclareHandle(outObj);
+
+    KNI_GetParameterAsObject(1, keyObj);
+    KNI_GetParameterAsObject(4, chainObj);
+    KNI_GetParameterAsObject(5, inObj);
+    KNI_GetParameterAsObject(8, outObj);
+
+    cbc = !KNI_IsNullHandle(chainObj);
+
+    if ((Nr == 10 || Nr == 12 || Nr == 14) &&
+            KNI_GetArrayLength(keyObj) == 4 * (Nr + 1)) {
+        KNI_GetRawArrayRegion(keyObj, 0, 16 * (Nr + 1), (jbyte*)W);
+        if (cbc) {
+            KNI_GetRawArrayRegion(chainObj, 0, AES_BLOCK_SIZE,
+                                  (jbyte*)chain);
+        }
+
+        aesProcess(W, Nr, encrypt, cbc ? chain : NULL,
+                   (unsigned char*)&JavaByteArray(inObj)[inOff],
+                   (unsigned char*)&JavaByteArray(outObj)[outOff],
+                   len & ~(AES_BLOCK_SIZE - 1));
+
+        if (cbc) {
+            KNI_SetRawArrayRegion(chainObj, 0, AES_BLOCK_SIZE,
+                                  (jbyte*)chain);
+        }
+        processed = KNI_TRUE;
+    }
+
+    KNI_EndHandles();
+    KNI_ReturnBoolean(processed);
+}
+
+/*=========================================================================
+ * FUNCTION:      nativeProcess([B[B[BZ[B[BII[BI)V (STATIC)
+ * CLASS:         com/sun/midp/crypto/DES_ECB
+ * TYPE:          static native function
+ * OVERVIEW:      Encrypt or decrypt whole DES or triple DES blocks.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  key1      first expanded key
+ *                key2      second expanded key, or null for DES
+ *                key3      third expanded key, or null for DES
+ *                encrypt   true to encrypt, false to decrypt
+ *                chain     CBC chaining block, updated on return,
+ *                           or null for ECB
+ *                inBuf     input data
+ *                inOff     offset of the input data
+ *                len       length of the data, a multiple of 8
+ *                outBuf    output buffer
+ *                outOff    offset of the output data
+ *   returns:     nothing
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_VOID
+Java_com_sun_midp_crypto_DES_1ECB_nativeProcess() {
+    unsigned char keys[3][DES_KEY_SIZE];
+    unsigned char chain[DES_BLOCK_SIZE];
+    jboolean encrypt = KNI_GetParameterAsBoolean(4);
+    jint inOff = KNI_GetParameterAsInt(7);
+    jint len = KNI_GetParameterAsInt(8);
+    jint outOff = KNI_GetParameterAsInt(10);
+    int keyCount = 1;
+    int cbc;
+
+    KNI_StartHandles(6);
+
+    KNI_DeclareHandle(key1Obj);
+    KNI_DeclareHandle(key2Obj);
+    KNI_DeclareHandle(key3Obj);
+    KNI_DeclareHandle(chainObj);
+    KNI_DeclareHandle(inObj);
+    KNI_DeclareHandle(outObj);
+
+    KNI_GetParameterAsObject(1, key1Obj);
+    KNI_GetParameterAsObject(2, key2Obj);
+    KNI_GetParameterAsObject(3, key3Obj);
+    KNI_GetParameterAsObject(5, chainObj);
+    KNI_GetParameterAsObject(6, inObj);
+    KNI_GetParameterAsObject(9, outObj);
+
+    KNI_GetRawArrayRegion(key1Obj, 0, DES_KEY_SIZE, (jbyte*)keys[0]);
+    if (!KNI_IsNullHandle(key2Obj) && !KNI_IsNullHandle(key3Obj)) {
+        KNI_GetRawArrayRegion(key2Obj, 0, DES_KEY_SIZE, (jbyte*)keys[1]);
+        KNI_GetRawArrayRegion(key3Obj, 0, DES_KEY_SIZE, (jbyte*)keys[2]);
+        keyCount = 3;
+    }
+
+    cbc = !KNI_IsNullHandle(chainObj);
+    if (cbc) {
+        KNI_GetRawArrayRegion(chainObj, 0, DES_BLOCK_SIZE, (jbyte*)chain);
+    }
+
+    desProcess(keys, keyCount, encrypt, cbc ? chain : NULL,
+               (unsigned char*)&JavaByteArray(inObj)[inOff],
+               (unsigned char*)&JavaByteArray(outObj)[outOff],
+               len & ~(DES_BLOCK_SIZE - 1));
+
+    if (cbc) {
+        KNI_SetRawArrayRegion(chainObj, 0, DES_BLOCK_SIZE, (jbyte*)chain);
+    }
+
+    KNI_EndHandles();
+    KNI_ReturnVoid();
+}
@@ -139,6 +139,124 @@ Java_com_sun_midp_crypto_RSA_modExp() {
     KNI_ReturnInt((jint)numbytes);
 }
 
+/*=========================================================================
+ * FUNCTION:      modExpCRT([B[B[B[B[B[B[B)I (STATIC)
+ * CLASS:         com/sun/midp/crypto/RSA
+ * TYPE:          static native function
+ * OVERVIEW:      Perform RSA private key exponentiation using the
+ *                Chinese Remainder Theorem.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  data      contains the data on which exponentiation is to
+ *                           be performed
+ *                p         contains the first prime factor of the modulus
+ *                q         contains the second prime factor of the modulus
+ *                dp        contains the private exponent mod (p - 1)
+ *                dq        contains the private exponent mod (q - 1)
+ *                qinv      contains the inverse of q mod p
+ *                result    the result of the modular exponentiation is 
+ *                           returned in this array
+ *   returns: the length of the result
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_INT
+Java_com_sun_midp_crypto_RSA_modExpCRT() {
+    jint dataLen, pLen, qLen, dpLen, dqLen, qinvLen, resLen;
+    jint maxLen;
+    INTEGER numbytes = 0;
+    unsigned char *buf;
+    BIGNUM *a, *p, *q, *dp, *dq, *qinv, *d;
+    BN_CTX *ctx;
+
+    KNI_StartHandles(7);
+
+    KNI_DeclareHandle(ires);
+    KNI_DeclareHandle(iqinv);
+    KNI_DeclareHandle(idq);
+    KNI_DeclareHandle(idp);
+    KNI_DeclareHandle(iq);
+    KNI_DeclareHandle(ip);
+    KNI_DeclareHandle(idata);
+
+    KNI_GetParameterAsObject(7, ires);
+    KNI_GetParameterAsObject(6, iqinv);
+    KNI_GetParameterAsObject(5, idq);
+    KNI_GetParameterAsObject(4, idp);
+    KNI_GetParameterAsObject(3, iq);
+    KNI_GetParameterAsObject(2, ip);
+    KNI_GetParameterAsObject(1, idata);
+
+    resLen    = KNI_GetArrayLength(ires);
+    qinvLen   = KNI_GetArrayLength(iqinv);
+    dqLen     = KNI_GetArrayLength(idq);
+    dpLen     = KNI_GetArrayLength(idp);
+    qLen      = KNI_GetArrayLength(iq);
+    pLen      = KNI_GetArrayLength(ip);
+    dataLen   = KNI_GetArrayLength(idata);
+
+    /* Find which parameter is largest and allocate that much space */
+    maxLen = MAX(MAX(MAX(resLen, dataLen), MAX(pLen, qLen)),
+                 MAX(MAX(dpLen, dqLen), qinvLen));
+    if (maxLen > (BN_MAX_INTEGER / 8)) {
+        /* The number of BITS must fit in a BN integer. */
+        KNI_ThrowNew(midpIllegalArgumentException, "arg too long");
+    } else {
+        buf = (unsigned char *) midpMalloc(maxLen * sizeof(unsigned char));
+        if (buf == NULL) {
+            KNI_ThrowNew(midpOutOfMemoryError, NULL);
+        } else {
+
+            KNI_GetRawArrayRegion(idata, 0, dataLen, (jbyte*)buf);
+            a = BN_bin2bn(buf, (INTEGER)dataLen, NULL);
+
+            KNI_GetRawArrayRegion(ip, 0, pLen, (jbyte*)buf);
+            p = BN_bin2bn(buf, (INTEGER)pLen, NULL);
+
+            KNI_GetRawArrayRegion(iq, 0, qLen, (jbyte*)buf);
+            q = BN_bin2bn(buf, (INTEGER)qLen, NULL);
+
+            KNI_GetRawArrayRegion(idp, 0, dpLen, (jbyte*)buf);
+            dp = BN_bin2bn(buf, (INTEGER)dpLen, NULL);
+
+            KNI_GetRawArrayRegion(idq, 0, dqLen, (jbyte*)buf);
+            dq = BN_bin2bn(buf, (INTEGER)dqLen, NULL);
+
+            KNI_GetRawArrayRegion(iqinv, 0, qinvLen, (jbyte*)buf);
+            qinv = BN_bin2bn(buf, (INTEGER)qinvLen, NULL);
+
+            d = BN_new((INTEGER)resLen);
+
+            ctx = BN_CTX_new((INTEGER)maxLen);
+
+            /* do the actual exponentiation */
+            if (a != NULL && p != NULL && q != NULL && dp != NULL &&
+                    dq != NULL && qinv != NULL && d != NULL &&
+                    ctx != NULL &&
+                    BN_mod_exp_crt(d, a, p, q, dp, dq, qinv, ctx)) {
+                /* Covert result from BIGNUM d to char array */
+                numbytes = BN_bn2bin(d, buf);
+                KNI_SetRawArrayRegion(ires, 0, numbytes, (jbyte*)buf);
+            } else {
+                /* assume out of mem */
+                KNI_ThrowNew(midpOutOfMemoryError, "Mod Exp CRT");
+            }
+
+            midpFree(buf);
+
+            BN_free(a);
+            BN_clear_free(p);
+            BN_clear_free(q);
+            BN_clear_free(dp);
+            BN_clear_free(dq);
+            BN_clear_free(qinv);
+            BN_free(d);
+            BN_CTX_free(ctx);
+        }
+    }
+
+    KNI_EndHandles();
+
+    KNI_ReturnInt((jint)numbytes);
+}
+
 /*=========================================================================
  * FUNCTION:      nativetx([B[I[I[BII[BI)V (STATIC)
  * CLASS:         com/sun/midp/crypto/ARC4
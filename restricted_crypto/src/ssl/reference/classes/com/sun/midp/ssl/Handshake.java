@@ -1031,7 +1031,7 @@ class Handshake {
          * byte with value 0x01.
          */
         rec.rdRec(true, Record.CCS);
-        if ((rec.inputData == null) || (rec.inputData.length != 1) ||
+        if ((rec.inputData == null) || (rec.plainTextLength != 1) ||
                 (rec.inputData[0] != (byte) 0x01)) {
             return -1;
         }
@@ -1254,6 +1254,7 @@ class Handshake {
     void doHandShake(byte aswho, byte proposedVersion) throws IOException {
         long t1 = System.currentTimeMillis();
         int code = 0;
+        boolean resumed = false;
         
         ver = proposedVersion;  
         role = aswho;
@@ -1330,6 +1331,7 @@ class Handshake {
              */
             master = cSession.master;
             sCert = cSession.cert;
+            resumed = true;
 
             try {
                 rec.init(role, crand, srand, negSuite, master);
@@ -1354,6 +1356,15 @@ class Handshake {
         }
 
         Session.add(peerHost, peerPort, sSessionId, master, sCert);
+        Session.countHandshake0(resumed);
+
+        if (Logging.REPORT_LEVEL <= Logging.INFORMATION) {
+            Logging.report(Logging.INFORMATION, LogChannels.LC_SECURITY,
+                           (resumed ? "Resumed" : "Full") +
+                           " handshake, session cache hits " +
+                           Session.getHitCount() + ", misses " +
+                           Session.getMissCount());
+        }
        
         // Zero out the premaster and master secrets
         if (preMaster != null) {
@@ -1403,12 +1414,21 @@ class Handshake {
 /**
  * This class implements methods to maintain resumable SSL
  * sessions.
+ * <P />
+ * The sessions are kept in native memory, so that all isolates
+ * resume each other's sessions, and are saved to internal storage,
+ * so that they survive a restart of the VM. A session expires a day
+ * after its full handshake. This class only keeps the certificates
+ * of the last few sessions it used, to save parsing them again.
  */
 // visible within the package
 class Session {
-    /**  Maximum number of cached resumable sessions. */
+    /** Maximum number of sessions whose certificate is kept. */
     private static final byte MAX_SESSIONS = 4;
 
+    /** Length of an SSL master secret. */
+    private static final int MASTER_LENGTH = 48;
+
     /**
      * Stores the last index where a session was overwritten, we
      * try to do a round-robin selection of places to overwrite
@@ -1431,7 +1451,7 @@ class Session {
     /** Target Certificate. */
     X509Certificate cert;
 
-    /** A cache of currently resumable sessions. */
+    /** The sessions last used by this isolate. */
     private static Session[] sessions = new Session[MAX_SESSIONS];
 
     /**
@@ -1445,17 +1465,47 @@ class Session {
      * @return matching session
      */ 
     static synchronized Session get(String h, int p) {
-        for (int i = 0; i < MAX_SESSIONS; i++) {
-            if ((sessions[i] == null) ||
-                (sessions[i].id == null)) continue;
+        byte[] data = get0(h, p, System.currentTimeMillis());
+        Session s;
+        Session local;
+        int idx;
 
-            if (sessions[i].host.compareTo(h) == 0 &&
-                    sessions[i].port == p) {
-                return sessions[i];
+        if (data == null) {
+            return null;
+        }
+
+        s = new Session();
+        s.host = h;
+        s.port = p;
+
+        idx = 1;
+        s.id = new byte[data[0] & 0xff];
+        System.arraycopy(data, idx, s.id, 0, s.id.length);
+        idx += s.id.length;
+
+        s.master = new byte[MASTER_LENGTH];
+        System.arraycopy(data, idx, s.master, 0, MASTER_LENGTH);
+        idx += MASTER_LENGTH;
+
+        local = find(h, p);
+        if (local != null && local.id.length == s.id.length &&
+                Utils.byteMatch(local.id, 0, s.id, 0, s.id.length)) {
+            s.cert = local.cert;
+        } else if (idx < data.length) {
+            try {
+                s.cert = X509Certificate.generateCertificate(data, idx,
+                    data.length - idx);
+            } catch (IOException e) {
+                // fall through, the session cannot be used
+            }
+
+            if (s.cert == null) {
+                return null;
             }
         }
 
-        return null;
+        remember(s);
+        return s;
     }
     
     /**
@@ -1471,48 +1521,37 @@ class Session {
      */ 
     static synchronized void add(String h, int p, byte[] id, byte[] mas,
                     X509Certificate cert) {
-        // IMPL_NOTE: This will change if we stop using linear arrays
-        int idx = MAX_SESSIONS;
-        for (int i = 0; i < MAX_SESSIONS; i++) {
-            if ((sessions[i] == null) || 
-                (sessions[i].id == null)) {
-                idx = i;            // possible candidate for overwriting
-                continue;
-            }
-            
-            if ((sessions[i].host.compareTo(h) == 0) && 
-                (sessions[i].port == p)) {  // preferred candidate
-                idx = i;
-                break;
-            }
-        }
-
-        /*
-         * If all else is taken, overwrite the one specified by 
-         * delIdx and move delIdx over to the next one. Simulates FIFO.
-         */ 
-        if (idx == MAX_SESSIONS) {
-            idx = delIdx;
-            delIdx++;
-            if (delIdx == MAX_SESSIONS) delIdx = 0;
-        }
+        Session s = new Session();
+        byte[] enc = null;
 
-        if (sessions[idx] == null) {
-            sessions[idx] = new Session();
-        }
-
-        sessions[idx].id = id;
+        s.id = id;
 
         /*
          * Since the master will change after this method, we need to
          * copy it, to preserve its current value for later.
          */
-        sessions[idx].master = new byte[mas.length];
-        System.arraycopy(mas, 0, sessions[idx].master, 0, mas.length);
+        s.master = new byte[mas.length];
+        System.arraycopy(mas, 0, s.master, 0, mas.length);
+
+        s.host = new String(h); // "h" will be a substring of URL
+        s.port = p;
+        s.cert = cert;
+
+        remember(s);
+
+        if (id == null) {
+            return;
+        }
+
+        if (cert != null) {
+            enc = cert.getEncoded();
+        }
 
-        sessions[idx].host = new String(h); // "h" will be a substring of URL
-        sessions[idx].port = p;
-        sessions[idx].cert = cert;
+        if (enc == null) {
+            enc = new byte[0];
+        }
+
+        add0(s.host, p, id, s.master, enc, System.currentTimeMillis());
     }
 
     /**
@@ -1540,5 +1579,125 @@ class Session {
                 break;
             }
         }
+
+        del0(h, p, sid);
     }
+
+    /**
+     * Finds the session this isolate last used for a host and port.
+     *
+     * @param h host name of peer
+     * @param p port number of peer
+     *
+     * @return matching session or null
+     */
+    private static Session find(String h, int p) {
+        for (int i = 0; i < MAX_SESSIONS; i++) {
+            if ((sessions[i] == null) ||
+                (sessions[i].id == null)) continue;
+
+            if (sessions[i].host.compareTo(h) == 0 &&
+                    sessions[i].port == p) {
+                return sessions[i];
+            }
+        }
+
+        return null;
+    }
+
+    /**
+     * Keeps a session in the sessions last used by this isolate,
+     * replacing the one of the same host and port.
+     *
+     * @param s session to keep
+     */
+    private static void remember(Session s) {
+        int idx = MAX_SESSIONS;
+        for (int i = 0; i < MAX_SESSIONS; i++) {
+            if ((sessions[i] == null) || 
+                (sessions[i].id == null)) {
+                idx = i;            // possible candidate for overwriting
+                continue;
+            }
+            
+            if ((sessions[i].host.compareTo(s.host) == 0) && 
+                (sessions[i].port == s.port)) {  // preferred candidate
+                idx = i;
+                break;
+            }
+        }
+
+        /*
+         * If all else is taken, overwrite the one specified by 
+         * delIdx and move delIdx over to the next one. Simulates FIFO.
+         */ 
+        if (idx == MAX_SESSIONS) {
+            idx = delIdx;
+            delIdx++;
+            if (delIdx == MAX_SESSIONS) delIdx = 0;
+        }
+
+        sessions[idx] = s;
+    }
+
+    /**
+     * Counts a completed handshake for the session cache statistics.
+     *
+     * @param resumed true if the handshake resumed a cached session
+     */
+    static native void countHandshake0(boolean resumed);
+
+    /**
+     * Gets the number of handshakes of all isolates that resumed
+     * a cached session.
+     *
+     * @return number of resumed handshakes
+     */
+    static native int getHitCount();
+
+    /**
+     * Gets the number of handshakes of all isolates that needed
+     * a full key exchange.
+     *
+     * @return number of full handshakes
+     */
+    static native int getMissCount();
+
+    /**
+     * Looks up the shared session of a host and port, and expires
+     * old sessions.
+     *
+     * @param h host name of peer
+     * @param p port number of peer
+     * @param now current time in milliseconds
+     *
+     * @return null if there is no session, otherwise the length
+     * of the session identifier in one byte, followed by the
+     * session identifier, the master secret and the DER encoding
+     * of the peer certificate
+     */
+    private static native byte[] get0(String h, int p, long now);
+
+    /**
+     * Adds or replaces the shared session of a host and port.
+     *
+     * @param h host name of peer
+     * @param p port number of peer
+     * @param id session identifier
+     * @param mas master secret
+     * @param cert DER encoding of the peer certificate, may be empty
+     * @param now current time in milliseconds
+     */
+    private static native void add0(String h, int p, byte[] id, byte[] mas,
+                                    byte[] cert, long now);
+
+    /**
+     * Deletes the shared session of a host and port if it has
+     * the given session identifier.
+     *
+     * @param h host name of peer
+     * @param p port number of peer
+     * @param sid session identifier
+     */
+    private static native void del0(String h, int p, byte[] sid);
 }
@@ -32,7 +32,9 @@ import java.io.InterruptedIOException;
 
 /**
  * This class is a subclass of OutputStream and is used for
- * writing data to an SSL connection.
+ * writing data to an SSL connection. Like a plain socket stream it
+ * is not buffered: the data of each write is sent, in records of up
+ * to <code>MAX_RECORD_SIZE</code> bytes, before the write returns.
  * <P />
  * @see com.sun.midp.ssl.SSLStreamConnection
  * @see com.sun.midp.ssl.In
@@ -106,16 +108,8 @@ class Out extends OutputStream {
         }
 
         synchronized(rec) {
-            int bytesToWrite = MAX_RECORD_SIZE;
-            while (len > 0) {
-                if (len < bytesToWrite) {
-                    bytesToWrite = len;
-                }
-
-                rec.wrRec(Record.APP, b, off, bytesToWrite);
-                len -= bytesToWrite;
-                off += bytesToWrite;
-            }
+            rec.wrAppData(b, off, len, MAX_RECORD_SIZE);
+            rec.flushAppData();
         }
     }
 
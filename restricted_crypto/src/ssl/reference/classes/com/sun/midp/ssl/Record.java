@@ -45,10 +45,13 @@ import com.sun.midp.pki.*;
  */
 class Record {
     /*
-     * IMPL_NOTE: We should try to avoid multiple buffer copies by defining a 
-     * new message class that allocates a large enough buffer to begin with 
-     * so new headers can be prepended and MAC/padding can be appended by 
-     * simple pointer manipulation.
+     * Records are read into and written from buffers that are reused
+     * for the life of the connection. An output record is built with
+     * room for its header in front and its MAC behind the fragment,
+     * and is MAC'ed and encrypted in place, so writing a record copies
+     * the data only once. Application data written in small pieces is
+     * collected into one record until the record is full or the
+     * output stream is flushed.
      */ 
 
     /*
@@ -105,6 +108,8 @@ class Record {
     
      /** Size of record header */
     private final int HEADER_SIZE = 5;
+    /** Maximum number of bytes the MAC adds to a record fragment. */
+    private static final int MAX_MAC_SIZE = 20;
     /** Underlying input stream beneath the record layer. */
     private InputStream in; 
     /** Underlying output stream beneath the record layer. */
@@ -160,11 +165,22 @@ class Record {
     /** Shutdown flag, true if connection has been shutdown. */
     private boolean shutdown;
 
-    /** Current input record data. */
+    /**
+     * Current input record data. The buffer is reused for the next
+     * record, so it may be longer than the record.
+     */
     byte[] inputData;
     /** Length of the plain text in the input buffer */
     int plainTextLength;
 
+    /**
+     * Output record buffer, holds the record header, the fragment and
+     * room for its MAC.
+     */
+    private byte[] outputData;
+    /** Number of application data bytes waiting in outputData. */
+    private int pendingLength;
+
     /** Records encoder */
     private RecordEncoder encoder = null;
     /** Records decoder */
@@ -269,6 +285,8 @@ class Record {
             return;
         }
 
+        int length = plainTextLength;
+
         if (inputHeader[0] == type) {
             // success
             return;
@@ -290,7 +308,7 @@ class Record {
             
         case ALRT:
             // An Alert record needs to be atleast 2 bytes of data
-            if (inputData.length < 2) {
+            if (length < 2) {
                 throw new IOException("Bad alert length");
             }
 
@@ -388,7 +406,9 @@ class Record {
         
             dataLength = ((inputHeader[3] & 0xff) << 8) + 
                 (inputHeader[4] & 0xff);
-            inputData = new byte[dataLength];
+            if (inputData == null || inputData.length < dataLength) {
+                inputData = new byte[dataLength];
+            }
         }
 
         while (dataBytesRead < dataLength) {
@@ -408,7 +428,8 @@ class Record {
 
         if (rActive == 1) {
             try {
-                plainTextLength = decoder.decode(inputHeader, inputData);
+                plainTextLength = decoder.decode(inputHeader, inputData,
+                                                 dataLength);
             } catch (IOException e) {
                 if (e.getMessage().compareTo("Bad MAC") == 0) {
                     alert(FATAL, BAD_MAC);
@@ -449,29 +470,118 @@ class Record {
      * handshake messages as well???
      */ 
     void wrRec(byte type, byte[] buf, int off, int len) throws IOException {
-        byte[] rec;
+        if (shutdown) {
+            throw new IOException("Server has shutdown the connection");
+        }
+
+        // Application data written before goes out first
+        flushAppData();
+
+        ensureOutputCapacity(len);
+        System.arraycopy(buf, off, outputData, HEADER_SIZE, len);
+        sendRec(type, len);
+    }
+
+    /**
+     * Writes application data to the SSL peer. Data is collected
+     * until a record of <code>maxLength</code> bytes is full, the
+     * remainder is kept for the next call or for flushAppData().
+     * 
+     * @param buf byte array containing the data
+     * @param off starting offset of the data inside buf
+     * @param len length of the data
+     * @param maxLength maximum length of an application data record
+     *
+     * @exception IOException if an I/O error occurs.
+     */
+    void wrAppData(byte[] buf, int off, int len, int maxLength)
+            throws IOException {
+        int count;
 
         if (shutdown) {
             throw new IOException("Server has shutdown the connection");
         }
 
-        /*
-         * Create a new byte array with room for the header and
-         * fill the record header with type, version and length
-         */
-        rec = new byte[len + 5];
-        rec[0] = type;
-        rec[1] = (byte) (ver >>> 4);
-        rec[2] = (byte) (ver & 0x0f);
-        rec[3] = (byte) (len >>> 8);
-        rec[4] = (byte) (len & 0xff);
-        // Fill the rest of the record
-        System.arraycopy(buf, off, rec, 5, len);
+        ensureOutputCapacity(maxLength);
+
+        while (len > 0) {
+            count = maxLength - pendingLength;
+            if (count > len) {
+                count = len;
+            }
+
+            System.arraycopy(buf, off, outputData, HEADER_SIZE + pendingLength,
+                             count);
+            pendingLength += count;
+            off += count;
+            len -= count;
+
+            if (pendingLength == maxLength) {
+                flushAppData();
+            }
+        }
+    }
+
+    /**
+     * Writes the application data collected by wrAppData() as a
+     * record, if there is any.
+     *
+     * @exception IOException if an I/O error occurs.
+     */
+    void flushAppData() throws IOException {
+        int len = pendingLength;
+
+        if (len > 0) {
+            pendingLength = 0;
+            sendRec(APP, len);
+        }
+    }
+
+    /**
+     * Makes sure the output buffer can hold a record with a fragment
+     * of the given length and its MAC. Application data waiting in
+     * the buffer is kept.
+     *
+     * @param len length of the record fragment
+     */
+    private void ensureOutputCapacity(int len) {
+        int size = HEADER_SIZE + len + MAX_MAC_SIZE;
+
+        if (outputData == null || outputData.length < size) {
+            byte[] tmp = new byte[size];
+
+            if (pendingLength > 0) {
+                System.arraycopy(outputData, HEADER_SIZE, tmp, HEADER_SIZE,
+                                 pendingLength);
+            }
+
+            outputData = tmp;
+        }
+    }
+
+    /**
+     * Fills in the header of the record in the output buffer, encodes
+     * the record in place if a cipher spec is active, and writes it
+     * to the underlying socket's output stream.
+     *
+     * @param type record type (one of CCS, ALRT, HNDSHK or APP)
+     * @param len length of the record fragment following the header
+     *
+     * @exception IOException if an I/O error occurs.
+     */
+    private void sendRec(byte type, int len) throws IOException {
+        outputData[0] = type;
+        outputData[1] = (byte) (ver >>> 4);
+        outputData[2] = (byte) (ver & 0x0f);
+
         if (wActive == 1) {
-            out.write(encoder.encode(rec));
-        } else {
-            out.write(rec);
+            len = encoder.encode(type, outputData, HEADER_SIZE, len);
         }
+
+        outputData[3] = (byte) (len >>> 8);
+        outputData[4] = (byte) (len & 0xff);
+        out.write(outputData, 0, HEADER_SIZE + len);
+
         if (type == CCS) wActive = 1;
     }       
             
@@ -1008,7 +1118,17 @@ class MAC {
     protected int padLength = 0;
     /** Write sequence number */
     private long sequenceNumber = 0;
-        
+    /**
+     * Sequence number, type, version and length of the record
+     * being MAC'ed, reused for every record.
+     */
+    private byte[] macHeader = new byte[13];
+    /** Inner hash of the MAC, reused for every record. */
+    private byte[] innerHash = null;
+    /** MAC secret XOR'ed with the HMAC inner pad, for TLS. */
+    private byte[] hmacInnerKey = null;
+    /** MAC secret XOR'ed with the HMAC outer pad, for TLS. */
+    private byte[] hmacOuterKey = null;
         
     /** 
      * Computes the MAC for an SSLCompressed structure.
@@ -1017,33 +1137,37 @@ class MAC {
      * @param buf byte array containing the SSLCompressed fragment
      * @param offset starting offset of the fragment in buf
      * @param length length of the fragment
-     *
-     * @return a byte array containing the MAC
+     * @param mac byte array to receive the MAC
+     * @param macOffset offset of the MAC in mac
      */
-    byte[] getMAC(byte type, byte[] buf, int offset, int length) {
+    void getMAC(byte type, byte[] buf, int offset, int length,
+                byte[] mac, int macOffset) {
         /* 
          * MAC = hash(MAC_secret + PAD2 +
          *    hash(MAC_secret + PAD1 + seq_num + type + len +
          *         compressed_fragment));
          */ 
 
-	 if(Record.getNegVersion( ) == 0x31) { //SSL3.1
-	 	return getMac31(type, buf, offset,  length);
-	 }
+        if (innerHash == null) {
+            innerHash = new byte[digestLength];
+        }
+
+        for (int i = 0; i < 8; i++) {
+            macHeader[i] = (byte) (sequenceNumber >>> (56 - (i << 3)));
+        }
+        macHeader[8] = type;
+
+        if (Record.getNegVersion() == 0x31) { //SSL3.1
+            getMac31(buf, offset, length, mac, macOffset);
+            return;
+        }
 
         // Compute the inner hash first
-        byte[] byteArray = null;
+        macHeader[9] = (byte) (length >>> 8);
+        macHeader[10] = (byte) (length & 0xff);
         digest.update(macSecret, 0, macSecret.length);
         digest.update(PAD1, 0, padLength);
-        byteArray = Utils.longToBytes(sequenceNumber);
-        digest.update(byteArray, 0, byteArray.length);
-        
-        byteArray = new byte[3];
-        byteArray[0] = type;
-        byteArray[1] = (byte) (length >>> 8);
-        byteArray[2] = (byte) (length & 0xff);
-        digest.update(byteArray, 0, byteArray.length);
-        byte[] innerHash = new byte[digest.getDigestLength()];
+        digest.update(macHeader, 0, 11);
         digest.update(buf, offset, length);
         try {
             digest.digest(innerHash, 0, innerHash.length);
@@ -1054,57 +1178,63 @@ class MAC {
         // Now, the outer hash
         digest.update(macSecret, 0, macSecret.length);
         digest.update(PAD2, 0, padLength);
-        byte[] mac = new byte[innerHash.length];
         digest.update(innerHash, 0, innerHash.length);
         try {
-            digest.digest(mac, 0, mac.length);
+            digest.digest(mac, macOffset, digestLength);
         } catch (DigestException e) {
             // Ignore this exception, it should never happen
         }
-            
-            return mac;
     }
         
 
-  /**
-     *  Calculates MAC for TLS aka SSlv3.1 messages
+    /**
+     * Calculates MAC for TLS aka SSlv3.1 messages. The sequence number
+     * and type must already be in macHeader.
      * <P />
-     * @param who one of CLIENT or SERVER to indicate whether 
-     * client-side or server-side MAC secrets and sequence numbers
-     * ought to be used in the MAC computation
-     * @param type SSL record type of the SSLCompressed structure
      * @param buf byte array containing the SSLCompressed fragment
      * @param off starting offset of the fragment in buf
      * @param len length of the fragment
-     * @return a byte array containing the MAC
+     * @param mac byte array to receive the MAC
+     * @param macOffset offset of the MAC in mac
      */ 
-   private byte [] getMac31(byte type, byte[] buf, int off,  int len) {
+    private void getMac31(byte[] buf, int off, int len,
+                          byte[] mac, int macOffset) {
+        byte ver = Record.getNegVersion();
+
+        if (hmacInnerKey == null) {
+            // the MAC secret is never longer than the 64 byte block
+            hmacInnerKey = new byte[64];
+            hmacOuterKey = new byte[64];
+            for (int i = 0; i < 64; i++) {
+                byte k = (i < macSecret.length) ? macSecret[i] : 0;
+                hmacInnerKey[i] = (byte) (k ^ 0x36);
+                hmacOuterKey[i] = (byte) (k ^ 0x5c);
+            }
+        }
 
-	String alg = digest.getAlgorithm(); //this value can be set as a constant when d is assigned 
+        // seqNum + TLSCompressed.type + TLSCompressed.version +
+        // TLSCompressed.length + TLSCompressed.fragment
+        macHeader[9] = (byte) (ver >>> 4);
+        macHeader[10] = (byte) (ver & 0x0f);
+        macHeader[11] = (byte) (len >>> 8);
+        macHeader[12] = (byte) (len & 0xff);
 
-       byte ver = Record.getNegVersion( );
-	   
-       byte[] seqArr;
-	byte[] macWriteKey;
-	
-	//tmp=seqNum + TLSCompressed.type + TLSCompressed.version + TLSCompressed.length + TLSCompressed.fragment(len)
-	seqArr = Utils.longToBytes(sequenceNumber);  
-	macWriteKey = macSecret;
-	
-	byte[] res = new byte[5];
-	res[0] = type;
-       res[1] = (byte)(ver >>> 4);
-	res[2] = (byte)(ver & 0x0f);
-       res[3] = (byte) (len >>> 8);
-       res[4] = (byte) (len & 0xff);
-
-       byte[] temp = new byte[ seqArr.length + res.length + len];
-	System.arraycopy(seqArr, 0, temp, 0, seqArr.length);
-	System.arraycopy(res, 0, temp, seqArr.length, res.length);
-	System.arraycopy(buf, off, temp, seqArr.length + res.length, len);
-	
-       return Handshake.hmac(alg, macWriteKey, temp);
+        digest.update(hmacInnerKey, 0, hmacInnerKey.length);
+        digest.update(macHeader, 0, 13);
+        digest.update(buf, off, len);
+        try {
+            digest.digest(innerHash, 0, innerHash.length);
+        } catch (DigestException e) {
+            // Ignore this exception, it should never happen
+        }
 
+        digest.update(hmacOuterKey, 0, hmacOuterKey.length);
+        digest.update(innerHash, 0, innerHash.length);
+        try {
+            digest.digest(mac, macOffset, digestLength);
+        } catch (DigestException e) {
+            // Ignore this exception, it should never happen
+        }
     } //end of getMac31 
     		
     /**
@@ -1141,73 +1271,52 @@ class RecordEncoder extends MAC {
     }
 
     /**
-     * Converts a byte array containing an SSLPlaintext structure
-     * to the corresponding SSLCiphertext structure. The process 
-     * typically involves the addition of a MAC followed by 
-     * encryption.
+     * Converts an SSLPlaintext fragment to the corresponding
+     * SSLCiphertext fragment in place. The process typically involves
+     * the addition of a MAC followed by encryption.
      * 
-     * @param plainText byte array containing SSLPlaintext
-     * @return the number of bytes written to the OutputStream
+     * @param type SSL record type
+     * @param buf byte array containing the fragment, with room for
+     *            the MAC after it
+     * @param off starting offset of the fragment in buf
+     * @param len length of the fragment
+     * @return the length of the encoded fragment
      *
      * @exception IOException if a problem is encountered during
      * encryption
      */ 
-    byte[] encode(byte[] plainText) throws IOException {
+    int encode(byte type, byte[] buf, int off, int len) throws IOException {
         /*
          * Since we only support NULL compression, SSLPlaintext
          * the same as SSLCompressed.
          */ 
-        byte[] fragAndMAC = null; // fragment plus MAC
-        
         if (digest != null) {
-            fragAndMAC = new byte[plainText.length - 5 + digestLength];
-            System.arraycopy(plainText, 5, fragAndMAC, 
-                    0, plainText.length - 5);
-            byte[] mac = getMAC(plainText[0], 
-                    plainText, 5, plainText.length - 5);
-            System.arraycopy(mac, 0, fragAndMAC, 
-                    (plainText.length - 5), digestLength);
-            } else {
-                fragAndMAC = new byte[plainText.length - 5];
-                System.arraycopy(plainText, 5, fragAndMAC, 
-                        0, plainText.length - 5);
+            getMAC(type, buf, off, len, buf, off + len);
+            len += digestLength;
         }
         
-        // ... now we need to encrypt fragAndMAC and possibly update IVs
-        byte[] efragAndMAC = null; 
+        // ... now we need to encrypt fragment and MAC
         if (cipher != null) {
             try {
                 /*
-                * NOTE: For now, we always have a stream cipher so this
-                * is commented out.
-                */ 
-                // We have a stream cipher
-                efragAndMAC = fragAndMAC;
-                cipher.update(fragAndMAC, 0, 
-                        fragAndMAC.length, efragAndMAC, 0);
+                 * NOTE: For now, we always have a stream cipher, which
+                 * can encrypt in place without padding or IVs.
+                 */ 
+                cipher.update(buf, off, len, buf, off);
             } catch (Exception e) {
                 throw new IOException("Encode caught " + e);
             }
-        } else {
-            // Cipher algorithm is NULL
-            efragAndMAC = fragAndMAC;
         }
         
-    	if (Logging.REPORT_LEVEL <= Logging.INFORMATION) {
-	        Logging.report(Logging.INFORMATION, LogChannels.LC_SECURITY,
-			   "efragAndMAC: " + Utils.hexEncode(efragAndMAC));
-	    }
-        
-        byte[] record = new byte[efragAndMAC.length + 5];
-        System.arraycopy(plainText, 0, record, 0, 3);
-        record[3] = (byte) (efragAndMAC.length >>> 8);
-        record[4] = (byte) (efragAndMAC.length & 0xff);
-        System.arraycopy(efragAndMAC, 0, record, 5, efragAndMAC.length);
+        if (Logging.REPORT_LEVEL <= Logging.INFORMATION) {
+            Logging.report(Logging.INFORMATION, LogChannels.LC_SECURITY,
+                           "efragAndMAC: " + Utils.hexEncode(buf, off, len));
+        }
         
         // We have encoded one more record, increment seq number
         incrementSequenceNumber();
         
-        return record;
+        return len;
     }
 }
 
@@ -1217,6 +1326,8 @@ class RecordEncoder extends MAC {
 class RecordDecoder extends MAC {
     /** Cipher used for decryption */
     private Cipher cipher;
+    /** Expected MAC of a record, reused for every record. */
+    private byte[] expMAC;
 
     /**
      * Constructs RecordDecoder object
@@ -1232,22 +1343,24 @@ class RecordDecoder extends MAC {
         digestLength = digest.getDigestLength();
         padLength = padLen;
         cipher = cphr;
+        expMAC = new byte[digestLength];
     }    
     
 
     /**
      * Converts a byte array containing an SSLCiphertext structure
-     * to the corresponding SSLPlaintext structure. The process
+     * to the corresponding SSLPlaintext structure in place. The process
      * typically involves decryption followed by MAC verification
      * and MAC stripping.
      * @param recordHeader record header
      * @param recordData record data
+     * @param dataLength length of the record data in recordData
      * @return Length of the decrypted data in the input buffer.
      * 
      * @exception IOException if a problem is encountered during decryption
      *                        or MAC verification
      */ 
-    int decode(byte[] recordHeader, byte[] recordData) 
+    int decode(byte[] recordHeader, byte[] recordData, int dataLength) 
                throws IOException {
         if (cipher != null) {
             // Cipher algorithm is not NULL (ctxt needs to be decrypted)
@@ -1264,16 +1377,19 @@ class RecordDecoder extends MAC {
                 // We have a stream cipher (NOTE: assuming CLIENT role)
 
                 // We can decode in place w/o using additional memory
-                cipher.update(recordData, 0, recordData.length, recordData, 0);
+                cipher.update(recordData, 0, dataLength, recordData, 0);
             } catch (Exception e) {
                 throw new IOException("Decode caught " + e);
             }
         }
 
-        int length = recordData.length - digestLength;
+        int length = dataLength - digestLength;
+        if (length < 0) {
+            throw new IOException("Bad MAC");
+        }
+
         if (digest != null) {
-            byte[] expMAC = null;  // expected MAC
-            expMAC = getMAC(recordHeader[0], recordData, 0, length);
+            getMAC(recordHeader[0], recordData, 0, length, expMAC, 0);
             if (!Utils.byteMatch(expMAC, 0, recordData, length, 
                         digestLength)) {
                 throw new IOException("Bad MAC");
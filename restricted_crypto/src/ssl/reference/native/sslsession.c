@@ -0,0 +1,667 @@
+/*
+ *   
+ *
+ * Copyright  1990-2007 Sun Microsystems, Inc. All Rights Reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 2 only, as published by the Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License version 2 for more details (a copy is
+ * included at /legal/license.txt).
+ * 
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ * 
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa
+ * Clara, CA 95054 or visit www.sun.com if you need additional
+ * information or have any questions.
+ */
+
+/**
+ * @file
+ *
+ * Cache of resumable SSL sessions.
+ *
+ * The cache lives in native memory, so all isolates share it, and it is
+ * kept in a file in the internal storage root, next to the suite
+ * storage files, so that sessions survive a restart of the VM. The file
+ * is read the first time the cache is used and rewritten whenever a
+ * session is added or removed.
+ *
+ * At most SSL_SESSION_CACHE_SIZE sessions are kept, one per host and
+ * port. When the cache is full, the least recently used session is
+ * replaced. Sessions expire SSL_SESSION_TIMEOUT milliseconds after they
+ * were established; the SSL 3.0 and TLS 1.0 specifications recommend
+ * at most 24 hours.
+ */
+
+#include <kni.h>
+#include <sni.h>
+#include <string.h>
+#include <midpMalloc.h>
+#include <midpError.h>
+#include <midpStorage.h>
+#include <pcsl_string.h>
+
+#ifndef SSL_SESSION_CACHE_SIZE
+#define SSL_SESSION_CACHE_SIZE 16
+#endif
+
+#ifndef SSL_SESSION_TIMEOUT
+#define SSL_SESSION_TIMEOUT (24 * 60 * 60 * 1000L)
+#endif
+
+/** Set to 0 to keep the sessions in memory only */
+#ifndef ENABLE_SSL_SESSION_FILE
+#define ENABLE_SSL_SESSION_FILE 1
+#endif
+
+/** The longest session ID SSL 3.0 and TLS allow */
+#define SSL_MAX_ID_LENGTH 32
+/** Length of the master secret */
+#define SSL_MASTER_LENGTH 48
+/** Host names longer than this are not cached */
+#define SSL_MAX_HOST_LENGTH 255
+/** Certificates larger than this are not cached */
+#define SSL_MAX_CERT_LENGTH 0x10000
+
+#define SSL_SESSION_FILE_MAGIC   0x53534C53 /* "SSLS" */
+#define SSL_SESSION_FILE_VERSION 1
+
+typedef struct _SslSession {
+    jchar* host;          /* NULL if the entry is free */
+    jint hostLength;
+    jint port;
+    jint idLength;
+    unsigned char id[SSL_MAX_ID_LENGTH];
+    unsigned char master[SSL_MASTER_LENGTH];
+    unsigned char* cert;  /* DER encoding of the server certificate */
+    jint certLength;
+    jlong created;
+    jlong lastUsed;
+} SslSession;
+
+static SslSession sessions[SSL_SESSION_CACHE_SIZE];
+
+/** True when the session file has been read */
+static int sessionsLoaded = 0;
+
+/** Handshakes that resumed a cached session */
+static jint sessionHits = 0;
+
+/** Handshakes that had to do a full key exchange */
+static jint sessionMisses = 0;
+
+#if ENABLE_SSL_SESSION_FILE
+PCSL_DEFINE_ASCII_STRING_LITERAL_START(SSL_SESSION_FILENAME)
+    {'_', 's', 's', 'l', 's', 'e', 's', 's', 'i', 'o', 'n', 's',
+     '.', 'd', 'a', 't', '\0'}
+PCSL_DEFINE_ASCII_STRING_LITERAL_END(SSL_SESSION_FILENAME);
+#endif
+
+/**
+ * Frees the memory of a cache entry and marks it free.
+ *
+ * @param s the entry
+ */
+static void freeSession(SslSession* s) {
+    if (s->host != NULL) {
+        midpFree(s->host);
+    }
+    if (s->cert != NULL) {
+        midpFree(s->cert);
+    }
+    memset(s, 0, sizeof(SslSession));
+}
+
+/**
+ * Fills a free cache entry.
+ *
+ * @return 0 if there is not enough memory, 1 otherwise
+ */
+static int setSession(SslSession* s, const jchar* host, jint hostLength,
+                      jint port, const unsigned char* id, jint idLength,
+                      const unsigned char* master,
+                      const unsigned char* cert, jint certLength,
+                      jlong created) {
+    s->host = (jchar*)midpMalloc(hostLength * sizeof(jchar));
+    s->cert = (unsigned char*)midpMalloc(certLength > 0 ? certLength : 1);
+    if (s->host == NULL || s->cert == NULL) {
+        freeSession(s);
+        return 0;
+    }
+
+    memcpy(s->host, host, hostLength * sizeof(jchar));
+    s->hostLength = hostLength;
+    s->port = port;
+    memcpy(s->id, id, idLength);
+    s->idLength = idLength;
+    memcpy(s->master, master, SSL_MASTER_LENGTH);
+    memcpy(s->cert, cert, certLength);
+    s->certLength = certLength;
+    s->created = created;
+    s->lastUsed = created;
+    return 1;
+}
+
+/**
+ * Finds the session of a host and port.
+ *
+ * @return the cache entry or NULL
+ */
+static SslSession* findSession(const jchar* host, jint hostLength,
+                               jint port) {
+    int i;
+
+    for (i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+        SslSession* s = &sessions[i];
+        if (s->host != NULL && s->port == port &&
+                s->hostLength == hostLength &&
+                memcmp(s->host, host, hostLength * sizeof(jchar)) == 0) {
+            return s;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Drops the sessions that have expired.
+ *
+ * @param now current time in milliseconds
+ * @return 1 if a session was dropped, 0 otherwise
+ */
+static int expireSessions(jlong now) {
+    int changed = 0;
+    int i;
+
+    for (i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+        SslSession* s = &sessions[i];
+        if (s->host != NULL &&
+                (now - s->created >= SSL_SESSION_TIMEOUT ||
+                 now < s->created)) {
+            freeSession(s);
+            changed = 1;
+        }
+    }
+
+    return changed;
+}
+
+#if ENABLE_SSL_SESSION_FILE
+
+/* the file is written in native byte order, as it never leaves the device */
+
+#define PUT_BYTES(p, src, n) (memcpy((p), (src), (n)), (p) += (n))
+#define GET_BYTES(p, end, dst, n) \
+    (((end) - (p) < (long)(n)) ? 0 : (memcpy((dst), (p), (n)), (p) += (n), 1))
+
+/**
+ * Reads the session file into the cache. A missing or damaged file
+ * leaves the cache empty.
+ *
+ * @param now current time in milliseconds
+ */
+static void loadSessions(jlong now) {
+    pcsl_string fileName;
+    char* pszError;
+    unsigned char* buffer = NULL;
+    unsigned char* p;
+    unsigned char* end;
+    long size;
+    int handle;
+    jint header[3];
+    int i;
+
+    if (pcsl_string_cat(storage_get_root(INTERNAL_STORAGE_ID),
+            &SSL_SESSION_FILENAME, &fileName) != PCSL_STRING_OK) {
+        return;
+    }
+
+    handle = storage_open(&pszError, &fileName, OPEN_READ);
+    pcsl_string_free(&fileName);
+    if (pszError != NULL) {
+        storageFreeError(pszError);
+        return;
+    }
+
+    size = storageSizeOf(&pszError, handle);
+    if (pszError == NULL && size > 0) {
+        buffer = (unsigned char*)midpMalloc(size);
+        if (buffer != NULL &&
+                storageRead(&pszError, handle, (char*)buffer, size) != size) {
+            midpFree(buffer);
+            buffer = NULL;
+        }
+    }
+    storageFreeError(pszError);
+    storageClose(&pszError, handle);
+    storageFreeError(pszError);
+
+    if (buffer == NULL) {
+        return;
+    }
+
+    p = buffer;
+    end = buffer + size;
+    if (!GET_BYTES(p, end, header, sizeof(header)) ||
+            header[0] != SSL_SESSION_FILE_MAGIC ||
+            header[1] != SSL_SESSION_FILE_VERSION) {
+        midpFree(buffer);
+        return;
+    }
+
+    for (i = 0; i < header[2] && i < SSL_SESSION_CACHE_SIZE; i++) {
+        jlong created;
+        jint fields[4]; /* port, hostLength, idLength, certLength */
+        unsigned char* host;
+        unsigned char* id;
+        unsigned char* master;
+
+        if (!GET_BYTES(p, end, &created, sizeof(created)) ||
+                !GET_BYTES(p, end, fields, sizeof(fields)) ||
+                fields[1] <= 0 || fields[1] > SSL_MAX_HOST_LENGTH ||
+                fields[2] <= 0 || fields[2] > SSL_MAX_ID_LENGTH ||
+                fields[3] < 0 || fields[3] > SSL_MAX_CERT_LENGTH ||
+                end - p < (long)(fields[1] * sizeof(jchar) + fields[2] +
+                                 SSL_MASTER_LENGTH + fields[3])) {
+            break;
+        }
+
+        host = p;
+        id = host + fields[1] * sizeof(jchar);
+        master = id + fields[2];
+        p = master + SSL_MASTER_LENGTH + fields[3];
+
+        /* the host is not aligned in the buffer */
+        if (now - created < SSL_SESSION_TIMEOUT && now >= created) {
+            jchar hostChars[SSL_MAX_HOST_LENGTH];
+            memcpy(hostChars, host, fields[1] * sizeof(jchar));
+            if (!setSession(&sessions[i], hostChars, fields[1], fields[0],
+                            id, fields[2], master,
+                            master + SSL_MASTER_LENGTH, fields[3],
+                            created)) {
+                break;
+            }
+        }
+    }
+
+    midpFree(buffer);
+}
+
+/**
+ * Rewrites the session file with the current contents of the cache.
+ * Sessions are written with the master secret, so the file is kept in
+ * the internal storage root which MIDlets cannot access.
+ */
+static void saveSessions() {
+    pcsl_string fileName;
+    char* pszError;
+    unsigned char* buffer;
+    unsigned char* p;
+    long size;
+    jint header[3];
+    int handle;
+    int i;
+
+    header[0] = SSL_SESSION_FILE_MAGIC;
+    header[1] = SSL_SESSION_FILE_VERSION;
+    header[2] = 0;
+    size = sizeof(header);
+    for (i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+        SslSession* s = &sessions[i];
+        if (s->host != NULL) {
+            header[2]++;
+            size += sizeof(jlong) + 4 * sizeof(jint) +
+                s->hostLength * sizeof(jchar) + s->idLength +
+                SSL_MASTER_LENGTH + s->certLength;
+        }
+    }
+
+    buffer = (unsigned char*)midpMalloc(size);
+    if (buffer == NULL) {
+        return;
+    }
+
+    p = buffer;
+    PUT_BYTES(p, header, sizeof(header));
+    for (i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+        SslSession* s = &sessions[i];
+        jint fields[4];
+
+        if (s->host == NULL) {
+            continue;
+        }
+
+        fields[0] = s->port;
+        fields[1] = s->hostLength;
+        fields[2] = s->idLength;
+        fields[3] = s->certLength;
+        PUT_BYTES(p, &s->created, sizeof(s->created));
+        PUT_BYTES(p, fields, sizeof(fields));
+        PUT_BYTES(p, s->host, s->hostLength * sizeof(jchar));
+        PUT_BYTES(p, s->id, s->idLength);
+        PUT_BYTES(p, s->master, SSL_MASTER_LENGTH);
+        PUT_BYTES(p, s->cert, s->certLength);
+    }
+
+    if (pcsl_string_cat(storage_get_root(INTERNAL_STORAGE_ID),
+            &SSL_SESSION_FILENAME, &fileName) == PCSL_STRING_OK) {
+        handle = storage_open(&pszError, &fileName, OPEN_READ_WRITE_TRUNCATE);
+        pcsl_string_free(&fileName);
+        if (pszError == NULL) {
+            storageWrite(&pszError, handle, (char*)buffer, size);
+            storageFreeError(pszError);
+            storageClose(&pszError, handle);
+        }
+        storageFreeError(pszError);
+    }
+
+    /* do not leave master secrets in freed memory */
+    memset(buffer, 0, size);
+    midpFree(buffer);
+}
+
+#else
+
+#define loadSessions(now)
+#define saveSessions()
+
+#endif /* ENABLE_SSL_SESSION_FILE */
+
+/**
+ * Reads the session file the first time the cache is used and drops
+ * expired sessions.
+ *
+ * @param now current time in milliseconds
+ */
+static void prepareSessions(jlong now) {
+    if (!sessionsLoaded) {
+        sessionsLoaded = 1;
+        loadSessions(now);
+    }
+
+    if (expireSessions(now)) {
+        saveSessions();
+    }
+}
+
+/**
+ * Copies a string parameter into a new buffer.
+ *
+ * @param strObj handle of the string
+ * @param pLength receives the length of the string
+ * @return the characters, or NULL if the string is too long or there is
+ *         not enough memory
+ */
+static jchar* getHost(jobject strObj, jint* pLength) {
+    jint length = KNI_GetStringLength(strObj);
+    jchar* chars;
+
+    if (length <= 0 || length > SSL_MAX_HOST_LENGTH) {
+        return NULL;
+    }
+
+    chars = (jchar*)midpMalloc(length * sizeof(jchar));
+    if (chars != NULL) {
+        KNI_GetStringRegion(strObj, 0, length, chars);
+    }
+
+    *pLength = length;
+    return chars;
+}
+
+/*=========================================================================
+ * FUNCTION:      get0(Ljava/lang/String;IJ)[B (STATIC)
+ * CLASS:         com/sun/midp/ssl/Session
+ * TYPE:          static native function
+ * OVERVIEW:      Look up the resumable session of a host and port.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  host      host name of the peer
+ *                port      port number of the peer
+ *                now       current time in milliseconds
+ *   returns:     null if there is no session, otherwise the length of
+ *                the session ID in one byte, followed by the session
+ *                ID, the master secret and the DER encoding of the
+ *                server certificate
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_OBJECT
+Java_com_sun_midp_ssl_Session_get0() {
+    jint port = KNI_GetParameterAsInt(2);
+    jlong now = KNI_GetParameterAsLong(3);
+    jchar* host;
+    jint hostLength;
+    SslSession* s = NULL;
+
+    KNI_StartHandles(2);
+    KNI_DeclareHandle(hostObj);
+    KNI_DeclareHandle(result);
+
+    KNI_GetParameterAsObject(1, hostObj);
+    prepareSessions(now);
+
+    host = getHost(hostObj, &hostLength);
+    if (host != NULL) {
+        s = findSession(host, hostLength, port);
+        midpFree(host);
+    }
+
+    if (s != NULL) {
+        jint length = 1 + s->idLength + SSL_MASTER_LENGTH + s->certLength;
+        jbyte idLength = (jbyte)s->idLength;
+
+        SNI_NewArray(SNI_BYTE_ARRAY, length, result);
+        if (KNI_IsNullHandle(result)) {
+            KNI_ThrowNew(midpOutOfMemoryError, NULL);
+        } else {
+            KNI_SetRawArrayRegion(result, 0, 1, &idLength);
+            KNI_SetRawArrayRegion(result, 1, s->idLength, (jbyte*)s->id);
+            KNI_SetRawArrayRegion(result, 1 + s->idLength,
+                                  SSL_MASTER_LENGTH, (jbyte*)s->master);
+            KNI_SetRawArrayRegion(result,
+                                  1 + s->idLength + SSL_MASTER_LENGTH,
+                                  s->certLength, (jbyte*)s->cert);
+            s->lastUsed = now;
+        }
+    }
+
+    KNI_EndHandlesAndReturnObject(result);
+}
+
+/*=========================================================================
+ * FUNCTION:      add0(Ljava/lang/String;I[B[B[BJ)V (STATIC)
+ * CLASS:         com/sun/midp/ssl/Session
+ * TYPE:          static native function
+ * OVERVIEW:      Add or replace the resumable session of a host and port.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  host      host name of the peer
+ *                port      port number of the peer
+ *                id        session identifier
+ *                master    master secret
+ *                cert      DER encoding of the server certificate
+ *                now       current time in milliseconds
+ *   returns:     nothing
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_VOID
+Java_com_sun_midp_ssl_Session_add0() {
+    jint port = KNI_GetParameterAsInt(2);
+    jlong now = KNI_GetParameterAsLong(6);
+    unsigned char id[SSL_MAX_ID_LENGTH];
+    unsigned char master[SSL_MASTER_LENGTH];
+    unsigned char* cert = NULL;
+    jint idLength, certLength;
+    jchar* host = NULL;
+    jint hostLength;
+    SslSession* s;
+    int i;
+
+    KNI_StartHandles(4);
+    KNI_DeclareHandle(hostObj);
+    KNI_DeclareHandle(idObj);
+    KNI_DeclareHandle(masterObj);
+    KNI_DeclareHandle(certObj);
+
+    KNI_GetParameterAsObject(1, hostObj);
+    KNI_GetParameterAsObject(3, idObj);
+    KNI_GetParameterAsObject(4, masterObj);
+    KNI_GetParameterAsObject(5, certObj);
+
+    idLength = KNI_GetArrayLength(idObj);
+    certLength = KNI_GetArrayLength(certObj);
+
+    if (idLength > 0 && idLength <= SSL_MAX_ID_LENGTH &&
+            KNI_GetArrayLength(masterObj) == SSL_MASTER_LENGTH &&
+            certLength >= 0 && certLength <= SSL_MAX_CERT_LENGTH) {
+        host = getHost(hostObj, &hostLength);
+        cert = (unsigned char*)midpMalloc(certLength > 0 ? certLength : 1);
+    }
+
+    if (host != NULL && cert != NULL) {
+        KNI_GetRawArrayRegion(idObj, 0, idLength, (jbyte*)id);
+        KNI_GetRawArrayRegion(masterObj, 0, SSL_MASTER_LENGTH,
+                              (jbyte*)master);
+        KNI_GetRawArrayRegion(certObj, 0, certLength, (jbyte*)cert);
+
+        prepareSessions(now);
+
+        s = findSession(host, hostLength, port);
+        if (s == NULL) {
+            /* take a free entry, or the least recently used one */
+            s = &sessions[0];
+            for (i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+                if (sessions[i].host == NULL) {
+                    s = &sessions[i];
+                    break;
+                }
+                if (sessions[i].lastUsed < s->lastUsed) {
+                    s = &sessions[i];
+                }
+            }
+        }
+
+        if (s->host == NULL || s->idLength != idLength ||
+                memcmp(s->id, id, idLength) != 0) {
+            freeSession(s);
+            setSession(s, host, hostLength, port, id, idLength, master,
+                       cert, certLength, now);
+            saveSessions();
+        } else {
+            /* a resumed session keeps its creation time */
+            s->lastUsed = now;
+        }
+
+        memset(master, 0, sizeof(master));
+    }
+
+    if (host != NULL) {
+        midpFree(host);
+    }
+    if (cert != NULL) {
+        midpFree(cert);
+    }
+
+    KNI_EndHandles();
+    KNI_ReturnVoid();
+}
+
+/*=========================================================================
+ * FUNCTION:      del0(Ljava/lang/String;I[B)V (STATIC)
+ * CLASS:         com/sun/midp/ssl/Session
+ * TYPE:          static native function
+ * OVERVIEW:      Remove a session from the cache.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  host      host name of the peer
+ *                port      port number of the peer
+ *                id        session identifier
+ *   returns:     nothing
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_VOID
+Java_com_sun_midp_ssl_Session_del0() {
+    jint port = KNI_GetParameterAsInt(2);
+    unsigned char id[SSL_MAX_ID_LENGTH];
+    jint idLength;
+    jchar* host;
+    jint hostLength;
+    SslSession* s;
+
+    KNI_StartHandles(2);
+    KNI_DeclareHandle(hostObj);
+    KNI_DeclareHandle(idObj);
+
+    KNI_GetParameterAsObject(1, hostObj);
+    KNI_GetParameterAsObject(3, idObj);
+
+    idLength = KNI_GetArrayLength(idObj);
+    host = getHost(hostObj, &hostLength);
+    if (host != NULL && idLength > 0 && idLength <= SSL_MAX_ID_LENGTH) {
+        KNI_GetRawArrayRegion(idObj, 0, idLength, (jbyte*)id);
+
+        s = findSession(host, hostLength, port);
+        if (s != NULL && s->idLength == idLength &&
+                memcmp(s->id, id, idLength) == 0) {
+            freeSession(s);
+            saveSessions();
+        }
+    }
+    if (host != NULL) {
+        midpFree(host);
+    }
+
+    KNI_EndHandles();
+    KNI_ReturnVoid();
+}
+
+/*=========================================================================
+ * FUNCTION:      countHandshake0(Z)V (STATIC)
+ * CLASS:         com/sun/midp/ssl/Session
+ * TYPE:          static native function
+ * OVERVIEW:      Count a completed handshake.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  resumed   true if a cached session was resumed
+ *   returns:     nothing
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_VOID
+Java_com_sun_midp_ssl_Session_countHandshake0() {
+    if (KNI_GetParameterAsBoolean(1)) {
+        sessionHits++;
+    } else {
+        sessionMisses++;
+    }
+
+    KNI_ReturnVoid();
+}
+
+/*=========================================================================
+ * FUNCTION:      getHitCount()I (STATIC)
+ * CLASS:         com/sun/midp/ssl/Session
+ * TYPE:          static native function
+ * OVERVIEW:      Get the number of handshakes that resumed a session.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  none
+ *   returns:     the number of resumed handshakes of all isolates
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_INT
+Java_com_sun_midp_ssl_Session_getHitCount() {
+    KNI_ReturnInt(sessionHits);
+}
+
+/*=========================================================================
+ * FUNCTION:      getMissCount()I (STATIC)
+ * CLASS:         com/sun/midp/ssl/Session
+ * TYPE:          static native function
+ * OVERVIEW:      Get the number of handshakes with a full key exchange.
+ * INTERFACE (operand stack manipulation):
+ *   parameters:  none
+ *   returns:     the number of full handshakes of all isolates
+ *=======================================================================*/
+KNIEXPORT KNI_RETURNTYPE_INT
+Java_com_sun_midp_ssl_Session_getMissCount() {
+    KNI_ReturnInt(sessionMisses);
+}